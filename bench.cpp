@@ -0,0 +1,849 @@
+
+/**
+ * @brief - Macro benchmark of the simulation: each scenario
+ *          file describes a world to set up and the number
+ *          of ticks to run. For each of them the duration of
+ *          `World::step` is measured and the time spent in
+ *          each phase of the simulation, the allocations per
+ *          tick and the peak memory usage are reported.
+ *          Usage:
+ *            tdef_bench [-o results.json] [-l label]
+ *                       [-j threads] [-a queries] scenario...
+ *          The `-a` option additionally runs the input number
+ *          of path finding queries on a fixed random grid and
+ *          reports the number of nodes expanded per second.
+ *          Scenario files are made of lines of the form
+ *          `key value...` (`#` starts a comment):
+ *            name <name>
+ *            seed <seed>
+ *            difficulty easy|normal|hard
+ *            file <saved game>
+ *            ticks <count>
+ *            warmup <count>
+ *            towers <count per type> <radius>
+ *            spawners easy|normal|hard <count> <wave> <radius>
+ *            maze <walls>
+ *            mobs <count> <radius>
+ */
+
+# include <algorithm>
+# include <atomic>
+# include <chrono>
+# include <cmath>
+# include <cstdio>
+# include <cstdlib>
+# include <fstream>
+# include <new>
+# include <sstream>
+# include <string>
+# include <vector>
+# include <sys/resource.h>
+# include <core_utils/log/StdLogger.hh>
+# include <core_utils/log/Locator.hh>
+# include <core_utils/log/PrefixedLogger.hh>
+# include <core_utils/CoreException.hh>
+# include <core_utils/RNG.hh>
+# include "World.hh"
+# include "Wall.hh"
+# include "Spawner.hh"
+# include "SpawnerFactory.hh"
+# include "TowerFactory.hh"
+# include "MobFactory.hh"
+# include "Locator.hh"
+# include "AStar.hh"
+
+namespace {
+
+  /**
+   * @brief - The number of allocations performed since the
+   *          start of the program.
+   */
+  std::atomic<unsigned long> allocations(0ul);
+
+}
+
+// The replacement operators below allocate with `malloc` and
+// release with `free`: GCC can not see it and reports them as
+// mismatched once inlined in optimized builds.
+# if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#  pragma GCC diagnostic push
+#  pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+# endif
+
+void*
+operator new(std::size_t size) {
+  allocations.fetch_add(1ul, std::memory_order_relaxed);
+
+  void* ptr = std::malloc(size == 0u ? 1u : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  return ptr;
+}
+
+void*
+operator new[](std::size_t size) {
+  return operator new(size);
+}
+
+void
+operator delete(void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, std::size_t /*size*/) noexcept {
+  std::free(ptr);
+}
+
+void
+operator delete[](void* ptr, std::size_t /*size*/) noexcept {
+  std::free(ptr);
+}
+
+# if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#  pragma GCC diagnostic pop
+# endif
+
+namespace {
+
+  /**
+   * @brief - The types of towers and mobs used to populate
+   *          the scenarios.
+   */
+  const tdef::towers::Type towerTypes[] = {
+    tdef::towers::Type::Basic,
+    tdef::towers::Type::Sniper,
+    tdef::towers::Type::Cannon,
+    tdef::towers::Type::Freezing,
+    tdef::towers::Type::Venom,
+    tdef::towers::Type::Splash,
+    tdef::towers::Type::Blast,
+    tdef::towers::Type::Multishot,
+    tdef::towers::Type::Minigun,
+    tdef::towers::Type::Antiair,
+    tdef::towers::Type::Tesla,
+    tdef::towers::Type::Missile
+  };
+
+  const tdef::mobs::Type mobTypes[] = {
+    tdef::mobs::Type::Regular,
+    tdef::mobs::Type::Fast,
+    tdef::mobs::Type::Strong,
+    tdef::mobs::Type::Heli,
+    tdef::mobs::Type::Jet,
+    tdef::mobs::Type::Armored,
+    tdef::mobs::Type::Healer,
+    tdef::mobs::Type::Toxic,
+    tdef::mobs::Type::Icy,
+    tdef::mobs::Type::Fighter,
+    tdef::mobs::Type::Light
+  };
+
+  /**
+   * @brief - Description of a scenario: the world to start
+   *          from, the elements to add to it and the number
+   *          of ticks to run.
+   */
+  struct Scenario {
+    std::string name;
+
+    int seed;
+    tdef::world::Difficulty difficulty;
+    std::string file;
+
+    unsigned long ticks;
+    unsigned long warmup;
+
+    // The list of directives populating the world, each
+    // one being split into its tokens.
+    std::vector<std::vector<std::string>> setup;
+  };
+
+  /**
+   * @brief - The measurements collected for a scenario.
+   */
+  struct Result {
+    std::string name;
+    unsigned long ticks;
+
+    double mean;
+    double p50;
+    double p99;
+    double max;
+
+    tdef::world::Profile profile;
+
+    double allocations;
+    long peakRSS;
+
+    unsigned long pCreated;
+    unsigned long pReused;
+
+    unsigned blocks;
+    unsigned mobs;
+    unsigned projectiles;
+    std::uint64_t hash;
+  };
+
+  /**
+   * @brief - Parse a difficulty from its name.
+   * @param name - the name of the difficulty.
+   * @param d - output difficulty.
+   * @return - `true` if the name is valid.
+   */
+  bool
+  parseDifficulty(const std::string& name, tdef::world::Difficulty& d) noexcept {
+    if (name == "easy") {
+      d = tdef::world::Difficulty::Easy;
+    }
+    else if (name == "normal") {
+      d = tdef::world::Difficulty::Normal;
+    }
+    else if (name == "hard") {
+      d = tdef::world::Difficulty::Hard;
+    }
+    else {
+      return false;
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief - Load a scenario from the input file.
+   * @param file - the path to the scenario.
+   * @param s - the output scenario.
+   * @return - `true` if the scenario could be loaded.
+   */
+  bool
+  load(const std::string& file, Scenario& s) {
+    std::ifstream in(file.c_str());
+    if (!in.good()) {
+      std::fprintf(stderr, "Failed to open scenario \"%s\"\n", file.c_str());
+      return false;
+    }
+
+    s.name = file.substr(file.find_last_of('/') + 1u);
+    s.seed = 0;
+    s.difficulty = tdef::world::Difficulty::Normal;
+    s.ticks = 1000ul;
+    s.warmup = 100ul;
+
+    std::string line;
+    unsigned count = 0u;
+
+    while (std::getline(in, line)) {
+      ++count;
+
+      std::istringstream ss(line.substr(0u, line.find('#')));
+      std::vector<std::string> tokens;
+      std::string t;
+      while (ss >> t) {
+        tokens.push_back(t);
+      }
+
+      if (tokens.empty()) {
+        continue;
+      }
+
+      const std::string& k = tokens[0];
+      bool valid = true;
+
+      if (k == "name" && tokens.size() == 2u) {
+        s.name = tokens[1];
+      }
+      else if (k == "seed" && tokens.size() == 2u) {
+        s.seed = std::atoi(tokens[1].c_str());
+      }
+      else if (k == "difficulty" && tokens.size() == 2u) {
+        valid = parseDifficulty(tokens[1], s.difficulty);
+      }
+      else if (k == "file" && tokens.size() == 2u) {
+        s.file = tokens[1];
+      }
+      else if (k == "ticks" && tokens.size() == 2u) {
+        s.ticks = std::strtoul(tokens[1].c_str(), nullptr, 10);
+      }
+      else if (k == "warmup" && tokens.size() == 2u) {
+        s.warmup = std::strtoul(tokens[1].c_str(), nullptr, 10);
+      }
+      else if ((k == "towers" && tokens.size() == 3u) ||
+               (k == "spawners" && tokens.size() == 5u) ||
+               (k == "maze" && tokens.size() == 2u) ||
+               (k == "mobs" && tokens.size() == 3u))
+      {
+        s.setup.push_back(tokens);
+      }
+      else {
+        valid = false;
+      }
+
+      if (!valid) {
+        std::fprintf(stderr, "Invalid line %u in \"%s\": %s\n", count, file.c_str(), line.c_str());
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  /**
+   * @brief - Return the center of the cell containing the
+   *          input coordinates.
+   * @param x - the abscissa.
+   * @param y - the ordinate.
+   * @return - the center of the cell.
+   */
+  utils::Point2f
+  cellCenter(float x, float y) noexcept {
+    return utils::Point2f(std::floor(x) + 0.5f, std::floor(y) + 0.5f);
+  }
+
+  /**
+   * @brief - Place `count` towers of each type evenly on a
+   *          ring centered on the origin. Positions already
+   *          occupied are skipped.
+   * @param w - the world to populate.
+   * @param count - the number of towers of each type.
+   * @param radius - the radius of the ring.
+   */
+  void
+  placeTowers(tdef::World& w, unsigned count, float radius) {
+    unsigned types = sizeof(towerTypes) / sizeof(towerTypes[0]);
+    unsigned total = count * types;
+
+    for (unsigned id = 0u ; id < total ; ++id) {
+      float theta = 2.0f * 3.14159265f * id / total;
+      utils::Point2f p = cellCenter(radius * std::cos(theta), radius * std::sin(theta));
+
+      if (w.locator()->obstructed(p)) {
+        continue;
+      }
+
+      w.spawn(std::make_shared<tdef::Tower>(tdef::towers::generateProps(towerTypes[id % types], p)));
+    }
+  }
+
+  /**
+   * @brief - Place spawners evenly on a ring centered on the
+   *          origin, as if they already generated some waves.
+   * @param w - the world to populate.
+   * @param lvl - the level of the spawners.
+   * @param count - the number of spawners.
+   * @param wave - the number of waves already generated.
+   * @param radius - the radius of the ring.
+   */
+  void
+  placeSpawners(tdef::World& w,
+                const tdef::spawners::Level& lvl,
+                unsigned count,
+                int wave,
+                float radius)
+  {
+    for (unsigned id = 0u ; id < count ; ++id) {
+      float theta = 2.0f * 3.14159265f * id / count;
+      utils::Point2f p = cellCenter(radius * std::cos(theta), radius * std::sin(theta));
+
+      if (w.locator()->obstructed(p)) {
+        continue;
+      }
+
+      tdef::Spawner::SProps pp = tdef::spawners::generateProps(p, lvl);
+      pp.wave = wave;
+
+      w.spawn(std::make_shared<tdef::Spawner>(pp));
+    }
+  }
+
+  /**
+   * @brief - Build a maze around the origin made of square
+   *          rings of walls. Each ring has a single opening,
+   *          alternatively at the top and at the bottom, so
+   *          that mobs have to wind their way to the center.
+   *          Positions already occupied are skipped.
+   * @param w - the world to populate.
+   * @param walls - the number of walls to place.
+   */
+  void
+  placeMaze(tdef::World& w, unsigned walls) {
+    unsigned placed = 0u;
+
+    for (int r = 2 ; placed < walls ; r += 2) {
+      int gap = ((r / 2) % 2 == 0 ? r : -r);
+
+      for (int y = -r ; y <= r && placed < walls ; ++y) {
+        for (int x = -r ; x <= r && placed < walls ; ++x) {
+          if (std::max(std::abs(x), std::abs(y)) != r || (x == 0 && y == gap)) {
+            continue;
+          }
+
+          utils::Point2f p(x + 0.5f, y + 0.5f);
+          if (w.locator()->obstructed(p)) {
+            continue;
+          }
+
+          w.spawn(std::make_shared<tdef::Wall>(tdef::Wall::newProps(p)));
+          ++placed;
+        }
+      }
+    }
+  }
+
+  /**
+   * @brief - Place mobs of all types at random positions on
+   *          a ring centered on the origin.
+   * @param w - the world to populate.
+   * @param rng - the random number generator.
+   * @param count - the number of mobs.
+   * @param radius - the radius of the ring.
+   */
+  void
+  placeMobs(tdef::World& w, utils::RNG& rng, unsigned count, float radius) {
+    unsigned types = sizeof(mobTypes) / sizeof(mobTypes[0]);
+
+    for (unsigned id = 0u ; id < count ; ++id) {
+      float r = rng.rndFloat(radius - 1.0f, radius + 1.0f);
+      float theta = rng.rndAngle();
+
+      utils::Point2f p(r * std::cos(theta), r * std::sin(theta));
+      w.spawn(std::make_shared<tdef::Mob>(tdef::mobs::generateProps(mobTypes[id % types], p)));
+    }
+  }
+
+  /**
+   * @brief - Setup the world as described by the scenario.
+   * @param w - the world to populate.
+   * @param s - the scenario.
+   */
+  void
+  setup(tdef::World& w, const Scenario& s) {
+    w.reset(2u * sizeof(float), s.file, s.difficulty);
+
+    utils::RNG rng(s.seed);
+
+    for (unsigned id = 0u ; id < s.setup.size() ; ++id) {
+      const std::vector<std::string>& d = s.setup[id];
+
+      if (d[0] == "towers") {
+        placeTowers(w, std::strtoul(d[1].c_str(), nullptr, 10), std::atof(d[2].c_str()));
+      }
+      else if (d[0] == "spawners") {
+        tdef::spawners::Level lvl = tdef::spawners::Level::Normal;
+        if (d[1] == "easy") {
+          lvl = tdef::spawners::Level::Easy;
+        }
+        else if (d[1] == "hard") {
+          lvl = tdef::spawners::Level::Hard;
+        }
+
+        placeSpawners(
+          w,
+          lvl,
+          std::strtoul(d[2].c_str(), nullptr, 10),
+          std::atoi(d[3].c_str()),
+          std::atof(d[4].c_str())
+        );
+      }
+      else if (d[0] == "maze") {
+        placeMaze(w, std::strtoul(d[1].c_str(), nullptr, 10));
+      }
+      else if (d[0] == "mobs") {
+        placeMobs(w, rng, std::strtoul(d[1].c_str(), nullptr, 10), std::atof(d[2].c_str()));
+      }
+    }
+  }
+
+  /**
+   * @brief - Return the peak resident set size of the process
+   *          in kilobytes.
+   * @return - the peak memory usage.
+   */
+  long
+  peakRSS() noexcept {
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) {
+      return -1l;
+    }
+
+    return ru.ru_maxrss;
+  }
+
+  /**
+   * @brief - Return the value at the specified quantile of
+   *          the sorted input samples.
+   * @param sorted - the samples, sorted in ascending order.
+   * @param q - the quantile in the range `[0; 1]`.
+   * @return - the corresponding value.
+   */
+  double
+  quantile(const std::vector<double>& sorted, double q) noexcept {
+    if (sorted.empty()) {
+      return 0.0;
+    }
+
+    unsigned id = static_cast<unsigned>(std::ceil(q * sorted.size()));
+    return sorted[std::min(std::max(id, 1u), static_cast<unsigned>(sorted.size())) - 1u];
+  }
+
+  /**
+   * @brief - Run the input scenario and collect measurements.
+   * @param s - the scenario to run.
+   * @param threads - the number of threads of the world, `0`
+   *                  meaning as many as the machine has.
+   * @return - the measurements.
+   */
+  Result
+  run(const Scenario& s, unsigned threads) {
+    tdef::World w(s.seed);
+    w.setThreads(threads);
+    setup(w, s);
+    w.resume();
+
+    // Each step is given exactly the duration of a tick
+    // so that a single tick is simulated per step.
+    float tDelta = w.getTickDuration();
+
+    for (unsigned long id = 0ul ; id < s.warmup ; ++id) {
+      w.step(tDelta);
+    }
+
+    std::vector<double> samples(s.ticks, 0.0);
+    w.resetProfile();
+    unsigned long allocs = allocations.load(std::memory_order_relaxed);
+    unsigned long created = w.getProjectilePool().created();
+    unsigned long reused = w.getProjectilePool().reused();
+
+    for (unsigned long id = 0ul ; id < s.ticks ; ++id) {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+      w.step(tDelta);
+      std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+
+      samples[id] = d.count();
+    }
+
+    allocs = allocations.load(std::memory_order_relaxed) - allocs;
+
+    Result r;
+    r.name = s.name;
+    r.ticks = s.ticks;
+
+    double total = 0.0;
+    for (unsigned long id = 0ul ; id < samples.size() ; ++id) {
+      total += samples[id];
+    }
+
+    std::sort(samples.begin(), samples.end());
+
+    r.mean = (samples.empty() ? 0.0 : total / samples.size());
+    r.p50 = quantile(samples, 0.5);
+    r.p99 = quantile(samples, 0.99);
+    r.max = (samples.empty() ? 0.0 : samples.back());
+
+    r.profile = w.getProfile();
+
+    r.allocations = (s.ticks > 0ul ? 1.0 * allocs / s.ticks : 0.0);
+    r.peakRSS = peakRSS();
+
+    r.pCreated = w.getProjectilePool().created() - created;
+    r.pReused = w.getProjectilePool().reused() - reused;
+
+    r.blocks = w.getBlocksCount();
+    r.mobs = w.getMobsCount();
+    r.projectiles = w.getProjectilesCount();
+    r.hash = w.hash();
+
+    return r;
+  }
+
+  /**
+   * @brief - Print a human readable report of the input
+   *          result.
+   * @param r - the result to print.
+   */
+  void
+  print(const Result& r) {
+    double n = (r.profile.ticks > 0ul ? 1.0 * r.profile.ticks : 1.0);
+
+    std::printf("%s (%lu ticks)\n", r.name.c_str(), r.ticks);
+    std::printf("  step:        mean %.4fms, p50 %.4fms, p99 %.4fms, max %.4fms\n", r.mean, r.p50, r.p99, r.max);
+    std::printf(
+      "  phases:      blocks %.4fms, mobs %.4fms, paths %.4fms, projectiles %.4fms, deletion %.4fms, update %.4fms\n",
+      r.profile.blocks / n,
+      r.profile.mobs / n,
+      r.profile.paths / n,
+      r.profile.projectiles / n,
+      r.profile.deletion / n,
+      r.profile.update / n
+    );
+    std::printf("  allocations: %.1f per tick\n", r.allocations);
+    std::printf("  projectiles: %lu created, %lu reused\n", r.pCreated, r.pReused);
+    std::printf("  peak RSS:    %ldkB\n", r.peakRSS);
+    std::printf("  final:       %u block(s), %u mob(s), %u projectile(s)\n", r.blocks, r.mobs, r.projectiles);
+    std::printf("  hash:        %016llx\n", static_cast<unsigned long long>(r.hash));
+  }
+
+  /**
+   * @brief - The measurements collected for the path finding
+   *          benchmark.
+   */
+  struct PathResult {
+    unsigned queries;
+    unsigned found;
+
+    unsigned long expanded;
+    double duration;
+  };
+
+  /**
+   * @brief - The size of the grid used to benchmark the path
+   *          finding, the density of walls in it and the max
+   *          distance of the searches.
+   */
+  constexpr int path_grid_size = 64;
+  constexpr float path_wall_density = 0.2f;
+  constexpr float path_max_distance = 40.0f;
+
+  /**
+   * @brief - Run the input number of path finding queries on
+   *          a grid randomly filled with walls. The grid and
+   *          the queries only depend on a fixed seed so that
+   *          runs can be compared.
+   * @param queries - the number of queries to run.
+   * @return - the measurements.
+   */
+  PathResult
+  runPaths(unsigned queries) {
+    utils::RNG rng(42);
+
+    constexpr int s = path_grid_size;
+    std::vector<bool> walls(s * s, false);
+    std::vector<tdef::BlockShPtr> blocks;
+    std::vector<tdef::TowerShPtr> towers;
+    std::vector<tdef::WallShPtr> obstacles;
+    std::vector<tdef::PortalShPtr> portals;
+    std::vector<tdef::SpawnerShPtr> spawners;
+    std::vector<tdef::MobShPtr> mobs;
+    tdef::MobStore store;
+    std::vector<tdef::ProjectileShPtr> projectiles;
+
+    for (int y = 0 ; y < s ; ++y) {
+      for (int x = 0 ; x < s ; ++x) {
+        bool border = (x == 0 || y == 0 || x == s - 1 || y == s - 1);
+        if (!border && rng.rndFloat(0.0f, 1.0f) >= path_wall_density) {
+          continue;
+        }
+
+        walls[y * s + x] = true;
+        utils::Point2f p(x + 0.5f - s / 2, y + 0.5f - s / 2);
+        tdef::WallShPtr wall = std::make_shared<tdef::Wall>(tdef::Wall::newProps(p));
+        obstacles.push_back(wall);
+        blocks.push_back(wall);
+      }
+    }
+
+    // The search does not rely on the flow field nor on the
+    // cache of paths.
+    tdef::LocatorShPtr loc = std::make_shared<tdef::Locator>(
+      blocks,
+      towers,
+      obstacles,
+      portals,
+      spawners,
+      mobs,
+      store,
+      projectiles,
+      nullptr,
+      nullptr
+    );
+    loc->refreshBlocks();
+
+    // Generate the queries beforehand so that only the search
+    // is measured.
+    std::vector<std::pair<utils::Point2f, utils::Point2f>> ends;
+    while (ends.size() < queries) {
+      int a = rng.rndInt(0, s * s - 1);
+      int b = rng.rndInt(0, s * s - 1);
+      if (walls[a] || walls[b] || a == b) {
+        continue;
+      }
+
+      utils::Point2f start(a % s + rng.rndFloat(0.1f, 0.9f) - s / 2, a / s + rng.rndFloat(0.1f, 0.9f) - s / 2);
+      utils::Point2f end(b % s + rng.rndFloat(0.1f, 0.9f) - s / 2, b / s + rng.rndFloat(0.1f, 0.9f) - s / 2);
+      ends.push_back(std::make_pair(start, end));
+    }
+
+    PathResult r;
+    r.queries = queries;
+    r.found = 0u;
+    r.expanded = 0ul;
+
+    std::vector<utils::Point2f> path;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (unsigned id = 0u ; id < ends.size() ; ++id) {
+      tdef::AStar alg(ends[id].first, ends[id].second, loc);
+
+      path.clear();
+      if (alg.findPath(path, path_max_distance)) {
+        ++r.found;
+      }
+
+      r.expanded += alg.getExpandedNodes();
+    }
+
+    std::chrono::duration<double> d = std::chrono::steady_clock::now() - start;
+    r.duration = d.count();
+
+    return r;
+  }
+
+  /**
+   * @brief - Print a human readable report of the path finding
+   *          benchmark.
+   * @param r - the result to print.
+   */
+  void
+  print(const PathResult& r) {
+    double d = (r.duration > 0.0 ? r.duration : 1.0);
+    double n = (r.queries > 0u ? 1.0 * r.queries : 1.0);
+
+    std::printf("astar (%u queries, %dx%d grid)\n", r.queries, path_grid_size, path_grid_size);
+    std::printf("  paths:       %u found\n", r.found);
+    std::printf("  expanded:    %lu node(s) in %.4fs\n", r.expanded, r.duration);
+    std::printf("  throughput:  %.0f nodes/s, %.2fus/query\n", r.expanded / d, 1.0e6 * r.duration / n);
+  }
+
+  /**
+   * @brief - Save the results in JSON format to the input
+   *          file so that runs can be compared.
+   * @param file - the output file.
+   * @param label - a label identifying the run.
+   * @param results - the results to save.
+   * @return - `true` if the file could be written.
+   */
+  bool
+  save(const std::string& file, const std::string& label, const std::vector<Result>& results) {
+    std::FILE* out = std::fopen(file.c_str(), "w");
+    if (out == nullptr) {
+      std::fprintf(stderr, "Failed to open \"%s\"\n", file.c_str());
+      return false;
+    }
+
+    std::fprintf(out, "{\n  \"label\": \"%s\",\n  \"scenarios\": [\n", label.c_str());
+
+    for (unsigned id = 0u ; id < results.size() ; ++id) {
+      const Result& r = results[id];
+      double n = (r.profile.ticks > 0ul ? 1.0 * r.profile.ticks : 1.0);
+
+      std::fprintf(out, "    {\n");
+      std::fprintf(out, "      \"name\": \"%s\",\n", r.name.c_str());
+      std::fprintf(out, "      \"ticks\": %lu,\n", r.ticks);
+      std::fprintf(out, "      \"step_ms\": {\"mean\": %.6f, \"p50\": %.6f, \"p99\": %.6f, \"max\": %.6f},\n", r.mean, r.p50, r.p99, r.max);
+      std::fprintf(
+        out,
+        "      \"phases_ms\": {\"blocks\": %.6f, \"mobs\": %.6f, \"paths\": %.6f, \"projectiles\": %.6f, \"deletion\": %.6f, \"update\": %.6f},\n",
+        r.profile.blocks / n,
+        r.profile.mobs / n,
+        r.profile.paths / n,
+        r.profile.projectiles / n,
+        r.profile.deletion / n,
+        r.profile.update / n
+      );
+      std::fprintf(out, "      \"allocations_per_tick\": %.3f,\n", r.allocations);
+      std::fprintf(out, "      \"projectiles_created\": %lu,\n", r.pCreated);
+      std::fprintf(out, "      \"projectiles_reused\": %lu,\n", r.pReused);
+      std::fprintf(out, "      \"peak_rss_kb\": %ld,\n", r.peakRSS);
+      std::fprintf(out, "      \"blocks\": %u,\n", r.blocks);
+      std::fprintf(out, "      \"mobs\": %u,\n", r.mobs);
+      std::fprintf(out, "      \"projectiles\": %u,\n", r.projectiles);
+      std::fprintf(out, "      \"hash\": \"%016llx\"\n", static_cast<unsigned long long>(r.hash));
+      std::fprintf(out, "    }%s\n", (id + 1u < results.size() ? "," : ""));
+    }
+
+    std::fprintf(out, "  ]\n}\n");
+    std::fclose(out);
+
+    return true;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  // Create the logger: the simulation is quite verbose
+  // so we only keep relevant messages.
+  utils::log::StdLogger raw;
+  raw.setLevel(utils::log::Severity::WARNING);
+  utils::log::PrefixedLogger logger("tdef", "bench");
+  utils::log::Locator::provide(&raw);
+
+  std::string output;
+  std::string label;
+  unsigned threads = 0u;
+  unsigned queries = 0u;
+  std::vector<std::string> files;
+
+  for (int id = 1 ; id < argc ; ++id) {
+    std::string arg(argv[id]);
+
+    if ((arg == "-o" || arg == "-l") && id + 1 < argc) {
+      (arg == "-o" ? output : label) = argv[++id];
+    }
+    else if (arg == "-j" && id + 1 < argc) {
+      threads = static_cast<unsigned>(std::strtoul(argv[++id], nullptr, 10));
+    }
+    else if (arg == "-a" && id + 1 < argc) {
+      queries = static_cast<unsigned>(std::strtoul(argv[++id], nullptr, 10));
+    }
+    else {
+      files.push_back(arg);
+    }
+  }
+
+  if (files.empty() && queries == 0u) {
+    std::fprintf(stderr, "Usage: %s [-o results.json] [-l label] [-j threads] [-a queries] scenario...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  std::vector<Result> results;
+
+  try {
+    if (queries > 0u) {
+      print(runPaths(queries));
+    }
+
+    for (unsigned id = 0u ; id < files.size() ; ++id) {
+      Scenario s;
+      if (!load(files[id], s)) {
+        return EXIT_FAILURE;
+      }
+
+      results.push_back(run(s, threads));
+      print(results.back());
+    }
+  }
+  catch (const utils::CoreException& e) {
+    logger.error("Caught internal exception while running benchmark", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (const std::exception& e) {
+    logger.error("Caught exception while running benchmark", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (...) {
+    logger.error("Unexpected error while running benchmark");
+    return EXIT_FAILURE;
+  }
+
+  if (!output.empty() && !save(output, label, results)) {
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -2,4 +2,4 @@
 
 CURR_DIR=$(dirname $0)
 
-gdb --args ./bin/tdef
+TDEF_THREADS=1 gdb --args ./bin/tdef
@@ -0,0 +1,163 @@
+
+/**
+ * @brief - Headless runner for the simulation: loads or
+ *          generates a world and advances it by a fixed
+ *          number of ticks as fast as possible. It reports
+ *          the throughput along with a digest of the final
+ *          state so that runs can be compared.
+ *          Usage:
+ *            tdef_headless [-t ticks] [-s seed]
+ *                          [-d easy|normal|hard]
+ *                          [-f file] [-m metadata size]
+ *                          [-j threads]
+ */
+
+# include <chrono>
+# include <algorithm>
+# include <cstdio>
+# include <cstdlib>
+# include <string>
+# include <core_utils/log/StdLogger.hh>
+# include <core_utils/log/Locator.hh>
+# include <core_utils/log/PrefixedLogger.hh>
+# include <core_utils/CoreException.hh>
+# include "World.hh"
+
+namespace {
+
+  /**
+   * @brief - Convenience structure holding the options of
+   *          the runner.
+   */
+  struct Options {
+    unsigned long ticks;
+    int seed;
+    tdef::world::Difficulty difficulty;
+    std::string file;
+    unsigned metadata;
+    unsigned threads;
+  };
+
+  /**
+   * @brief - Parse the command line arguments into a set of
+   *          options. Unknown arguments are reported and the
+   *          parsing fails.
+   * @param argc - the number of arguments.
+   * @param argv - the arguments.
+   * @param opts - the output options.
+   * @return - `true` if the arguments are valid.
+   */
+  bool
+  parse(int argc, char** argv, Options& opts) {
+    for (int id = 1 ; id < argc ; ++id) {
+      std::string arg(argv[id]);
+      if (id + 1 >= argc) {
+        std::fprintf(stderr, "Missing value for \"%s\"\n", arg.c_str());
+        return false;
+      }
+
+      std::string val(argv[++id]);
+
+      if (arg == "-t") {
+        opts.ticks = std::strtoul(val.c_str(), nullptr, 10);
+      }
+      else if (arg == "-s") {
+        opts.seed = std::atoi(val.c_str());
+      }
+      else if (arg == "-f") {
+        opts.file = val;
+      }
+      else if (arg == "-m") {
+        opts.metadata = static_cast<unsigned>(std::strtoul(val.c_str(), nullptr, 10));
+      }
+      else if (arg == "-j") {
+        opts.threads = static_cast<unsigned>(std::strtoul(val.c_str(), nullptr, 10));
+      }
+      else if (arg == "-d" && val == "easy") {
+        opts.difficulty = tdef::world::Difficulty::Easy;
+      }
+      else if (arg == "-d" && val == "normal") {
+        opts.difficulty = tdef::world::Difficulty::Normal;
+      }
+      else if (arg == "-d" && val == "hard") {
+        opts.difficulty = tdef::world::Difficulty::Hard;
+      }
+      else {
+        std::fprintf(stderr, "Invalid argument \"%s %s\"\n", arg.c_str(), val.c_str());
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+}
+
+int main(int argc, char** argv) {
+  // Create the logger: the simulation is quite verbose
+  // so we only keep relevant messages.
+  utils::log::StdLogger raw;
+  raw.setLevel(utils::log::Severity::INFO);
+  utils::log::PrefixedLogger logger("tdef", "headless");
+  utils::log::Locator::provide(&raw);
+
+  // Saved games start with the gold and lives of the
+  // player so we skip them by default.
+  Options opts{
+    1000ul,                          // ticks
+    0,                               // seed
+    tdef::world::Difficulty::Normal, // difficulty
+    std::string(),                   // file
+    2u * sizeof(float),              // metadata
+    0u                               // threads
+  };
+
+  if (!parse(argc, argv, opts)) {
+    return EXIT_FAILURE;
+  }
+
+  try {
+    tdef::World w(opts.seed);
+    w.setThreads(opts.threads);
+    w.reset(opts.metadata, opts.file, opts.difficulty);
+    w.resume();
+
+    // Each step is given exactly the duration of a tick
+    // so that a single tick is simulated per step.
+    float tDelta = w.getTickDuration();
+    unsigned peak = 0u;
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (unsigned long id = 0ul ; id < opts.ticks ; ++id) {
+      w.step(tDelta);
+      peak = std::max(peak, w.getMobsCount());
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    double rate = (elapsed.count() > 0.0 ? opts.ticks / elapsed.count() : 0.0);
+
+    std::printf("ticks:       %lu\n", opts.ticks);
+    std::printf("threads:     %u\n", w.getThreads());
+    std::printf("elapsed:     %.3fs\n", elapsed.count());
+    std::printf("throughput:  %.1f ticks/s\n", rate);
+    std::printf("blocks:      %u\n", w.getBlocksCount());
+    std::printf("mobs:        %u (peak %u)\n", w.getMobsCount(), peak);
+    std::printf("projectiles: %u\n", w.getProjectilesCount());
+    std::printf("hash:        %016llx\n", static_cast<unsigned long long>(w.hash()));
+  }
+  catch (const utils::CoreException& e) {
+    logger.error("Caught internal exception while running simulation", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (const std::exception& e) {
+    logger.error("Caught exception while running simulation", e.what());
+    return EXIT_FAILURE;
+  }
+  catch (...) {
+    logger.error("Unexpected error while running simulation");
+    return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
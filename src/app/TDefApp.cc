@@ -3,6 +3,24 @@
 # include <maths_utils/ComparisonUtils.hh>
 # include "SimpleAction.hh"
 
+namespace {
+
+  /**
+   * @brief - Determine whether the input position lies in the
+   *          viewport. The boundaries are considered inside.
+   * @param v - the viewport.
+   * @param x - the abscissa of the position.
+   * @param y - the ordinate of the position.
+   * @return - `true` if the position is in the viewport.
+   */
+  inline
+  bool
+  inViewport(const tdef::Viewport& v, float x, float y) noexcept {
+    return x >= v.p.x && x <= v.p.x + v.dims.x && y >= v.p.y && y <= v.p.y + v.dims.y;
+  }
+
+}
+
 namespace tdef {
 
   TDefApp::TDefApp(const AppDesc& desc):
@@ -21,6 +39,10 @@ namespace tdef {
 
   bool
   TDefApp::onFrame(float fElapsed) {
+    // The paths of the mobs are only needed to display
+    // the debug layer.
+    m_game->setSnapshotPaths(hasDebug());
+
     if (m_gameUI->getScreen() == game::Screen::Game) {
       bool gameOver = !m_game->step(fElapsed);
 
@@ -101,15 +123,7 @@ namespace tdef {
 
     // Fetch elements to display.
     Viewport v = res.cf.cellsViewport();
-    std::vector<world::ItemEntry> items = m_game->getVisible(
-      v.p.x,
-      v.p.y,
-      v.p.x + v.dims.x,
-      v.p.y + v.dims.y,
-      nullptr,
-      nullptr,
-      world::Sort::None
-    );
+    const world::Snapshot& snap = m_game->getSnapshot();
 
     SpriteDesc sd;
     sd.loc = RelativePosition::BottomRight;
@@ -135,69 +149,74 @@ namespace tdef {
       }
     }
 
-    // Render each element.
-    for (unsigned id = 0u ; id < items.size() ; ++id) {
-      const world::ItemEntry& ie = items[id];
-
-      // Case of a block.
-      if (ie.type == world::ItemType::Block) {
-        world::Block t = m_game->block(ie.index);
-
-        sd.x = t.p.x();
-        sd.y = t.p.y();
-        sd.radius = t.radius;
-        sd.loc = RelativePosition::Center;
-
-        bool pack = true;
-        switch (t.type) {
-          case world::BlockType::Spawner:
-            pack = false;
-            sd.sprite.tint = olc::DARK_GREEN;
-            break;
-          case world::BlockType::Wall:
-            sd.sprite.pack = m_wPackID;
-            sd.sprite.sprite = olc::vi2d(0, 0);
-            sd.sprite.tint = olc::WHITE;
-            break;
-          case world::BlockType::Portal:
-            pack = false;
-            sd.sprite.tint = olc::DARK_RED;
-            break;
-          case world::BlockType::Tower:
-            sd.sprite.pack = m_tPackID;
-            sd.sprite.sprite = olc::vi2d(t.id, 0);
-            sd.sprite.tint = olc::WHITE;
-            break;
-        }
-
-        if (pack) {
-          drawSprite(sd, res.cf);
-        }
-        else {
-          drawRect(sd, res.cf);
-        }
+    // Entities are rendered at a position interpolated
+    // between the last two simulation ticks.
+    float alpha = m_game->getInterpolation();
 
-        if (t.type == world::BlockType::Tower) {
-          drawHealthBar(sd, t.health, res.cf, Orientation::Vertical);
-        }
+    // Render each block.
+    for (unsigned id = 0u ; id < snap.blocks.size() ; ++id) {
+      const world::RenderBlock& t = snap.blocks[id];
+      if (!inViewport(v, t.x, t.y)) {
+        continue;
       }
 
-      // Case of a mob.
-      if (ie.type == world::ItemType::Mob) {
-        world::Mob t = m_game->mob(ie.index);
+      sd.x = t.x;
+      sd.y = t.y;
+      sd.radius = t.radius;
+      sd.loc = RelativePosition::Center;
+
+      bool pack = true;
+      switch (t.type) {
+        case world::BlockType::Spawner:
+          pack = false;
+          sd.sprite.tint = olc::DARK_GREEN;
+          break;
+        case world::BlockType::Wall:
+          sd.sprite.pack = m_wPackID;
+          sd.sprite.sprite = olc::vi2d(0, 0);
+          sd.sprite.tint = olc::WHITE;
+          break;
+        case world::BlockType::Portal:
+          pack = false;
+          sd.sprite.tint = olc::DARK_RED;
+          break;
+        case world::BlockType::Tower:
+          sd.sprite.pack = m_tPackID;
+          sd.sprite.sprite = olc::vi2d(t.sprite, 0);
+          sd.sprite.tint = olc::WHITE;
+          break;
+      }
 
-        sd.x = t.p.x();
-        sd.y = t.p.y();
-        sd.radius = t.radius;
-        sd.loc = RelativePosition::Center;
+      if (pack) {
+        drawSprite(sd, res.cf);
+      }
+      else {
+        drawRect(sd, res.cf);
+      }
 
-        sd.sprite.pack = m_mPackID;
-        sd.sprite.sprite = olc::vi2d(t.id, 0);
-        sd.sprite.tint = olc::WHITE;
+      if (t.type == world::BlockType::Tower) {
+        drawHealthBar(sd, t.health, res.cf, Orientation::Vertical);
+      }
+    }
 
-        drawSprite(sd, res.cf);
-        drawHealthBar(sd, t.health, res.cf);
+    // Render each mob.
+    for (unsigned id = 0u ; id < snap.mobs.size() ; ++id) {
+      const world::RenderMob& t = snap.mobs[id];
+      if (!inViewport(v, t.x, t.y)) {
+        continue;
       }
+
+      sd.x = t.xPrev + alpha * (t.x - t.xPrev);
+      sd.y = t.yPrev + alpha * (t.y - t.yPrev);
+      sd.radius = t.radius;
+      sd.loc = RelativePosition::Center;
+
+      sd.sprite.pack = m_mPackID;
+      sd.sprite.sprite = olc::vi2d(t.sprite, 0);
+      sd.sprite.tint = olc::WHITE;
+
+      drawSprite(sd, res.cf);
+      drawHealthBar(sd, t.health, res.cf);
     }
 
     SetPixelMode(olc::Pixel::NORMAL);
@@ -217,32 +236,22 @@ namespace tdef {
 
     // Fetch elements to display.
     Viewport v = res.cf.cellsViewport();
-    world::ItemType ie = world::ItemType::Block;
-    std::vector<world::ItemEntry> items = m_game->getVisible(
-      v.p.x,
-      v.p.y,
-      v.p.x + v.dims.x,
-      v.p.y + v.dims.y,
-      &ie,
-      nullptr,
-      world::Sort::None
-    );
-
-    for (unsigned i = 0 ; i < items.size() ; ++i) {
-      const world::ItemEntry& wi = items[i];
-      world::Block bd = m_game->block(wi.index);
+    const world::Snapshot& snap = m_game->getSnapshot();
+
+    for (unsigned i = 0 ; i < snap.blocks.size() ; ++i) {
+      const world::RenderBlock& bd = snap.blocks[i];
 
       // Represent the orientation as a small line
       // centered on the block and oriented with a
       // direction similar to the parent. We only
       // want to display it for towers.
-      if (bd.type != world::BlockType::Tower) {
+      if (bd.type != world::BlockType::Tower || !inViewport(v, bd.x, bd.y)) {
         continue;
       }
 
       static const float len = 50.0f;
 
-      olc::vf2d p = res.cf.tileCoordsToPixels(bd.p.x(), bd.p.y(), RelativePosition::BottomRight, bd.radius);
+      olc::vf2d p = res.cf.tileCoordsToPixels(bd.x, bd.y, RelativePosition::BottomRight, bd.radius);
       olc::vf2d e;
 
       e.x = p.x + len * std::cos(bd.orientation);
@@ -261,60 +270,50 @@ namespace tdef {
       }
     }
 
-    // Fetch mobs to display.
-    ie = world::ItemType::Mob;
-    items = m_game->getVisible(
-      v.p.x,
-      v.p.y,
-      v.p.x + v.dims.x,
-      v.p.y + v.dims.y,
-      &ie,
-      nullptr,
-      world::Sort::ZOrder
-    );
-
     olc::Pixel fColor = olc::CYAN;
     olc::Pixel pColor = olc::DARK_GREEN;
     olc::Pixel sColor = olc::DARK_GREY;
 
-    for (unsigned i = 0 ; i < items.size() ; ++i) {
-      const world::ItemEntry& wi = items[i];
-      world::Mob md = m_game->mob(wi.index);
+    // Entities are rendered at a position interpolated
+    // between the last two simulation ticks.
+    float alpha = m_game->getInterpolation();
+
+    for (unsigned i = 0 ; i < snap.mobs.size() ; ++i) {
+      const world::RenderMob& md = snap.mobs[i];
+      if (!inViewport(v, md.x, md.y)) {
+        continue;
+      }
+
+      float x = md.xPrev + alpha * (md.x - md.xPrev);
+      float y = md.yPrev + alpha * (md.y - md.yPrev);
 
       // Represent the effects currently applied to
       // the mob as small circles with an appropriate
       // color.
-      if (md.freezed) {
-        olc::vf2d p = res.cf.tileCoordsToPixels(md.p.x() - 0.3f, md.p.y());
+      if ((md.effects & world::Snapshot::sk_freezed) != 0u) {
+        olc::vf2d p = res.cf.tileCoordsToPixels(x - 0.3f, y);
         FillCircle(p, 3, fColor);
       }
-      if (md.poisoned) {
-        olc::vf2d p = res.cf.tileCoordsToPixels(md.p.x() + 0.0f, md.p.y());
+      if ((md.effects & world::Snapshot::sk_poisoned) != 0u) {
+        olc::vf2d p = res.cf.tileCoordsToPixels(x + 0.0f, y);
         FillCircle(p, 3, pColor);
       }
-      if (md.stunned) {
-        olc::vf2d p = res.cf.tileCoordsToPixels(md.p.x() + 0.3f, md.p.y());
+      if ((md.effects & world::Snapshot::sk_stunned) != 0u) {
+        olc::vf2d p = res.cf.tileCoordsToPixels(x + 0.3f, y);
         FillCircle(p, 3, sColor);
       }
     }
 
-    // Fetch projectiles to display.
-    ie = world::ItemType::Projectile;
-    items = m_game->getVisible(
-      v.p.x,
-      v.p.y,
-      v.p.x + v.dims.x,
-      v.p.y + v.dims.y,
-      &ie,
-      nullptr,
-      world::Sort::None
-    );
+    for (unsigned i = 0 ; i < snap.projectiles.size() ; ++i) {
+      const world::RenderProjectile& pd = snap.projectiles[i];
+      if (!inViewport(v, pd.x, pd.y)) {
+        continue;
+      }
 
-    for (unsigned i = 0 ; i < items.size() ; ++i) {
-      const world::ItemEntry& wi = items[i];
-      world::Projectile pd = m_game->projectile(wi.index);
+      float x = pd.xPrev + alpha * (pd.x - pd.xPrev);
+      float y = pd.yPrev + alpha * (pd.y - pd.yPrev);
 
-      olc::vf2d p = res.cf.tileCoordsToPixels(pd.p.x(), pd.p.y(), RelativePosition::BottomRight, 2.0f);
+      olc::vf2d p = res.cf.tileCoordsToPixels(x, y, RelativePosition::BottomRight, 2.0f);
 
       FillCircle(p, 4, olc::PINK);
     }
@@ -395,46 +394,30 @@ namespace tdef {
     DrawString(olc::vi2d(0, h / 2 + 1 * dOffset), "World cell coords : " + toString(mtp), olc::CYAN);
     DrawString(olc::vi2d(0, h / 2 + 2 * dOffset), "Intra cell        : " + toString(it), olc::CYAN);
 
-    // Render entities' path and position.
+    // Render entities' path and position. The paths are
+    // only part of the snapshot once the debug layer has
+    // been enabled.
     Viewport v = res.cf.cellsViewport();
-    world::ItemType ie = world::ItemType::Mob;
-    std::vector<world::ItemEntry> items = m_game->getVisible(
-      v.p.x,
-      v.p.y,
-      v.p.x + v.dims.x,
-      v.p.y + v.dims.y,
-      &ie,
-      nullptr,
-      world::Sort::ZOrder
-    );
-
-    for (unsigned i = 0 ; i < items.size() ; ++i) {
-      const world::ItemEntry& wi = items[i];
-
-      // Be on the safe side.
-      if (wi.type != world::ItemType::Mob) {
-        warn(
-          "Fetched item with type " + std::to_string(static_cast<int>(wi.type)) + " while requesting only entities"
-        );
+    const world::Snapshot& snap = m_game->getSnapshot();
 
+    for (unsigned i = 0 ; i < snap.mobs.size() ; ++i) {
+      const world::RenderMob& md = snap.mobs[i];
+      if (!inViewport(v, md.x, md.y)) {
         continue;
       }
 
-      world::Mob md = m_game->mob(wi.index);
-
       // Draw the path of this entity if any.
-      if (md.path.valid()) {
-        olc::vf2d old;
-        const std::vector<utils::Point2f>& cPoints = md.path.getPassagePoints();
-        for (unsigned id = 0u ; id < cPoints.size() ; ++id) {
-          olc::vf2d p = res.cf.tileCoordsToPixels(cPoints[id].x(), cPoints[id].y());
-          FillCircle(p, 3, olc::CYAN);
-
-          if (id > 0u) {
-            DrawLine(old, p, olc::WHITE);
-          }
-          old = p;
+      olc::vf2d old;
+      for (unsigned id = 0u ; id < md.points ; ++id) {
+        const world::RenderPoint& cp = snap.points[md.path + id];
+
+        olc::vf2d p = res.cf.tileCoordsToPixels(cp.x, cp.y);
+        FillCircle(p, 3, olc::CYAN);
+
+        if (id > 0u) {
+          DrawLine(old, p, olc::WHITE);
         }
+        old = p;
       }
     }
 
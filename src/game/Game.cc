@@ -1,6 +1,6 @@
 
 # include "Game.hh"
-# include <cxxabi.h>
+# include <cstdlib>
 # include <maths_utils/AngleUtils.hh>
 # include "TowerFactory.hh"
 # include "GameMenu.hh"
@@ -12,6 +12,53 @@
 
 namespace {
 
+  /**
+   * @brief - Find the block of the snapshot spanning the input
+   *          position. Blocks are traversed in the order of the
+   *          world just like the locator does.
+   * @param snap - the snapshot of the world.
+   * @param p - the position to search.
+   * @return - the block or `null` if none spans the position.
+   */
+  const tdef::world::RenderBlock*
+  blockAt(const tdef::world::Snapshot& snap, const utils::Point2f& p) noexcept {
+    for (unsigned id = 0u ; id < snap.blocks.size() ; ++id) {
+      const tdef::world::RenderBlock& b = snap.blocks[id];
+      float hr = b.radius / 2.0f;
+
+      if (p.x() >= b.x - hr && p.x() <= b.x + hr &&
+          p.y() >= b.y - hr && p.y() <= b.y + hr)
+      {
+        return &b;
+      }
+    }
+
+    return nullptr;
+  }
+
+  /**
+   * @brief - Find the mob of the snapshot spanning the input
+   *          position.
+   * @param snap - the snapshot of the world.
+   * @param p - the position to search.
+   * @return - the mob or `null` if none spans the position.
+   */
+  const tdef::world::RenderMob*
+  mobAt(const tdef::world::Snapshot& snap, const utils::Point2f& p) noexcept {
+    for (unsigned id = 0u ; id < snap.mobs.size() ; ++id) {
+      const tdef::world::RenderMob& m = snap.mobs[id];
+      float hr = m.radius / 2.0f;
+
+      if (p.x() >= m.x - hr && p.x() <= m.x + hr &&
+          p.y() >= m.y - hr && p.y() <= m.y + hr)
+      {
+        return &m;
+      }
+    }
+
+    return nullptr;
+  }
+
   tdef::GameMenuShPtr
   generateTowerMenu(const tdef::towers::Type& type) {
     return std::make_shared<tdef::GameMenu>(
@@ -44,6 +91,30 @@ namespace {
     );
   }
 
+  /**
+   * @brief - The environment variable defining the number of
+   *          threads used by the simulation.
+   */
+  constexpr const char* threads_variable = "TDEF_THREADS";
+
+  /**
+   * @brief - Fetch the number of threads the simulation should
+   *          use from the environment. Setting it to `1` runs
+   *          the simulation on a single thread, which is useful
+   *          to debug.
+   * @return - the number of threads or `0` in case it is not
+   *           defined, meaning as many as the machine has.
+   */
+  unsigned
+  threadsFromEnvironment() noexcept {
+    const char* val = std::getenv(threads_variable);
+    if (val == nullptr) {
+      return 0u;
+    }
+
+    return static_cast<unsigned>(std::strtoul(val, nullptr, 10));
+  }
+
 }
 
 namespace tdef {
@@ -52,7 +123,7 @@ namespace tdef {
     utils::CoreObject("game"),
 
     m_world(nullptr),
-    m_loc(nullptr),
+    m_sim(nullptr),
     m_state(
       State{
         true,                  // paused
@@ -61,6 +132,7 @@ namespace tdef {
         InfoPanelStatus::None, // infoState
         false,                 // wallBuilding
         nullptr,               // tType
+        false,                 // paths
         BASE_LIVES,            // lives
         BASE_GOLD              // gold
       }
@@ -73,9 +145,7 @@ namespace tdef {
       nullptr, // gold
 
       nullptr, // play
-      nullptr, // pause
-
-      -1       // goldEarnedSlot
+      nullptr  // pause
     }),
 
     m_tDisplay(),
@@ -91,11 +161,14 @@ namespace tdef {
 
     // By default a new world is generated.
     m_world = std::make_shared<World>(100);
-    m_loc = m_world->locator();
-
-    // Register this item as a listener of the gold
-    // earned signal.
-    m_statusDisplay.goldEarnedSlot = m_world->onGoldEarned.connect_member<Game>(this, &Game::updateGold);
+    m_world->setThreads(threadsFromEnvironment());
+    m_world->setGold(m_state.gold);
+    m_world->setSnapshot(true);
+    m_world->acquireSnapshot();
+
+    // The world is stepped by its own thread from now on.
+    m_sim = std::make_shared<Simulation>(m_world);
+    m_sim->start();
   }
 
   std::vector<MenuShPtr>
@@ -125,50 +198,46 @@ namespace tdef {
     // cell corresponding to the input position.
     utils::Point2f p(std::floor(x) + 0.5f, std::floor(y) + 0.5f);
 
-    // Check whether this position is obstructed.
-    WorldElementShPtr we = m_loc->itemAt(p, true);
-    if (we != nullptr) {
+    // Check whether this position is obstructed. The
+    // snapshot may be slightly late compared to the
+    // world: the world checks it again when building.
+    const world::Snapshot& snap = m_world->getSnapshot();
+
+    const world::RenderBlock* b = blockAt(snap, p);
+    if (b != nullptr) {
       // Select this element to be displayed in
       // the side panel.
-      MobShPtr m = std::dynamic_pointer_cast<Mob>(we);
-      if (m != nullptr) {
-        displayMob(m);
+      if (b->type == world::BlockType::Tower) {
+        displayTower(b->handle);
         updateUI();
         return;
       }
 
-      TowerShPtr t = std::dynamic_pointer_cast<Tower>(we);
-      if (t != nullptr) {
-        displayTower(t);
+      if (b->type == world::BlockType::Spawner) {
+        displaySpawner(b->handle);
         updateUI();
         return;
       }
 
-      SpawnerShPtr s = std::dynamic_pointer_cast<Spawner>(we);
-      if (s != nullptr) {
-        displaySpawner(s);
-        updateUI();
-        return;
-      }
-
-      WallShPtr w = std::dynamic_pointer_cast<Wall>(we);
-      if (w != nullptr) {
-        displayWall(w);
+      if (b->type == world::BlockType::Wall) {
+        displayWall(b->handle);
         updateUI();
         return;
       }
 
       // Unknown element to display.
-      int status;
-      std::string et = abi::__cxa_demangle(typeid(*we).name(), 0, 0, &status);
-      warn(
-        "Failed to display element at " + we->getPos().toString() +
-        " with type \"" + et + "\""
-      );
+      warn("Failed to display block at " + p.toString());
 
       return;
     }
 
+    const world::RenderMob* m = mobAt(snap, p);
+    if (m != nullptr) {
+      displayMob(m->handle);
+      updateUI();
+      return;
+    }
+
     // As no world element is located at the
     // position of the action, we can attempt
     // to build a tower or a wall, assuming
@@ -194,92 +263,39 @@ namespace tdef {
   void
   Game::upgradeTower(const towers::Upgrade& upgrade) {
     // Make sure there's a tower to upgrade.
-    if (m_tDisplay.tower == nullptr) {
+    if (!m_tDisplay.tower.valid()) {
       warn("Attempting to upgrade " + towers::toString(upgrade) + " with no active tower");
       return;
     }
 
-    // Make sure there's enough money.
-    towers::Type t = m_tDisplay.tower->getType();
-    int level = m_tDisplay.tower->getUpgradeLevel(upgrade);
-    float cost = towers::getUpgradeCost(t, upgrade, level);
-    if (m_state.gold < cost) {
-      warn(
-        "Upgrading " + towers::toString(upgrade) + " costs " + std::to_string(cost) +
-        " but only " + std::to_string(m_state.gold) + "available, aborting"
-      );
-
-      return;
-    }
-
-    m_tDisplay.tower->upgrade(upgrade, level + 1);
-    m_state.gold -= cost;
-    debug("Gold is now " + std::to_string(m_state.gold) + " due to cost " + std::to_string(cost));
-
-    updateUI();
+    // The world makes sure there's enough money.
+    m_sim->push(world::Command::upgradeTower(m_tDisplay.tower, upgrade));
   }
 
   void
   Game::toggleTowerTargetMode() {
     // Make sure there's a tower to update.
-    if (m_tDisplay.tower == nullptr) {
+    if (!m_tDisplay.tower.valid()) {
       warn("Attempting to change target mode with no active tower");
       return;
     }
 
-    // Determine the next target mode to assign
-    // to the tower.
-    const towers::Targetting& cur = m_tDisplay.tower->getTargetMode();
-    towers::Targetting next = cur;
-
-    switch (cur) {
-      case towers::Targetting::First:
-        next = towers::Targetting::Last;
-        break;
-      case towers::Targetting::Last:
-        next = towers::Targetting::Strongest;
-        break;
-      case towers::Targetting::Strongest:
-        next = towers::Targetting::Weak;
-        break;
-      case towers::Targetting::Weak:
-        next = towers::Targetting::Closest;
-        break;
-      case towers::Targetting::Closest:
-      default:
-        // Make sure to come back to a known value.
-        next = towers::Targetting::First;
-        break;
-    }
-
-    m_tDisplay.tower->setTargetMode(next);
-
-    updateUI();
+    m_sim->push(world::Command::toggleTargetMode(m_tDisplay.tower));
   }
 
   void
   Game::sellTower() {
     // Make sure there's a tower to upgrade.
-    if (m_tDisplay.tower == nullptr) {
+    if (!m_tDisplay.tower.valid()) {
       warn("Attempting to sell tower while none is selected");
       return;
     }
 
-    float cost = m_tDisplay.tower->getTotalCost();
-    m_state.gold += cost;
-
-    debug(
-      "Selling tower " + towers::toString(m_tDisplay.tower->getType()) +
-      " for " + std::to_string(cost) +
-      ", " + std::to_string(m_state.gold) + " now available"
-    );
-
-    m_tDisplay.tower->markForDeletion(true);
-    m_world->forceDelete();
+    m_sim->push(world::Command::sellTower(m_tDisplay.tower));
 
     // Hide the upgrade menu.
     m_tDisplay.main->setVisible(false);
-    m_tDisplay.tower = nullptr;
+    m_tDisplay.tower = world::Handle::invalid();
 
     // Should be the case as we don't allow selling a tower
     // outside of the corresponding menu.
@@ -292,18 +308,7 @@ namespace tdef {
 
   float
   Game::lives() const noexcept {
-    float l = 0.0f;
-
-    std::vector<BlockShPtr> bs = m_loc->getVisibleBlocks(utils::Point2f(), -1.0f, world::BlockType::Portal);
-
-    for (unsigned id = 0u ; id < bs.size() ; ++id) {
-      PortalShPtr p = std::dynamic_pointer_cast<Portal>(bs[id]);
-      if (p != nullptr) {
-        l += p->getLives();
-      }
-    }
-
-    return l;
+    return m_world->getSnapshot().lives;
   }
 
   void
@@ -339,47 +344,53 @@ namespace tdef {
       in.close();
     }
 
+    // The world can't be modified while it is stepped.
+    m_sim->stop();
+
+    m_world->setGold(m_state.gold);
     m_world->reset(2u * sizeof(float), file);
+    m_world->acquireSnapshot();
+
+    m_sim->start();
 
     // And reset menus.
     m_statusDisplay.main->setVisible(true);
     m_buildings->setVisible(true);
 
     m_tDisplay.main->setVisible(false);
-    m_tDisplay.tower = nullptr;
+    m_tDisplay.tower = world::Handle::invalid();
 
     m_mDisplay.main->setVisible(false);
-    m_mDisplay.mob = nullptr;
+    m_mDisplay.mob = world::Handle::invalid();
 
     m_sDisplay.main->setVisible(false);
-    m_sDisplay.spawner = nullptr;
+    m_sDisplay.spawner = world::Handle::invalid();
 
     m_wDisplay.main->setVisible(false);
-    m_wDisplay.wall = nullptr;
+    m_wDisplay.wall = world::Handle::invalid();
 
     // And update the UI.
     updateUI();
   }
 
   bool
-  Game::step(float tDelta) {
+  Game::step(float /*tDelta*/) {
+    // Fetch the last state of the world: it is used
+    // until the next frame.
+    m_world->acquireSnapshot();
+
     // When the game is paused it is not over yet.
     if (m_state.paused) {
       return true;
     }
 
-    // Step the world.
-    m_world->step(tDelta);
-
-    // Update lives.
+    // Update lives and gold.
     m_state.lives = lives();
+    m_state.gold = m_world->getSnapshot().gold;
 
-    // Disable the mob display in case it is either
-    // dead or not in this world anymore.
-    if (m_mDisplay.mob != nullptr && m_mDisplay.mob->isDeleted()) {
-      m_mDisplay.main->setVisible(false);
-      m_mDisplay.mob = nullptr;
-    }
+    // Disable the display of the selected element in
+    // case it is not in this world anymore.
+    updateSelection();
 
     // And redraw the UI.
     updateUI();
@@ -426,14 +437,22 @@ namespace tdef {
       );
     }
 
+    // The world can't be accessed while it is stepped:
+    // this also makes sure that the commands sent so far
+    // are applied.
+    m_sim->stop();
+
     // Save the lives and the gold amount.
+    float gold = m_world->getGold();
     out.write(reinterpret_cast<const char*>(&m_state.lives), sizeof(float));
-    out.write(reinterpret_cast<const char*>(&m_state.gold), sizeof(float));
+    out.write(reinterpret_cast<const char*>(&gold), sizeof(float));
 
     // Close the file so that we save the data.
     out.close();
 
     m_world->save(file);
+
+    m_sim->start();
   }
 
   MenuShPtr
@@ -652,7 +671,8 @@ namespace tdef {
     m_tDisplay.main->setVisible(false);
 
     // No mob being tracked for now.
-    m_tDisplay.tower = nullptr;
+    m_tDisplay.tower = world::Handle::invalid();
+    m_tDisplay.bound = false;
 
     return m_tDisplay.main;
   }
@@ -694,7 +714,7 @@ namespace tdef {
     m_mDisplay.main->setVisible(false);
 
     // No mob being tracked for now.
-    m_mDisplay.mob = nullptr;
+    m_mDisplay.mob = world::Handle::invalid();
 
     return m_mDisplay.main;
   }
@@ -724,7 +744,7 @@ namespace tdef {
     m_sDisplay.main->setVisible(false);
 
     // No spawner being tracked for now.
-    m_sDisplay.spawner = nullptr;
+    m_sDisplay.spawner = world::Handle::invalid();
 
     return m_sDisplay.main;
   }
@@ -754,15 +774,16 @@ namespace tdef {
     m_wDisplay.main->setVisible(false);
 
     // No wall being tracked for now.
-    m_wDisplay.wall = nullptr;
+    m_wDisplay.wall = world::Handle::invalid();
 
     return m_wDisplay.main;
   }
 
   void
   Game::spawnTower(const utils::Point2f& p) {
-    // Generate the tower. Also make sure that the
-    // player owns enough gold to do so.
+    // Make sure that the player owns enough gold to
+    // build the tower. The world checks it again as
+    // some gold may be spent in the meantime.
     float c = towers::getCost(*m_state.tType);
     if (m_state.gold < c) {
       warn(
@@ -774,123 +795,128 @@ namespace tdef {
       return;
     }
 
-    m_state.gold -= c;
-
-    Tower::TProps pp = towers::generateProps(*m_state.tType, p);
-
-    info("Generated tower " + towers::toString(*m_state.tType) + " at " + p.toString());
-
-    TowerShPtr t = std::make_shared<Tower>(pp);
-    m_world->spawn(t);
+    m_sim->push(world::Command::buildTower(p.x(), p.y(), *m_state.tType, c));
   }
 
   void
   Game::spawnWall(const utils::Point2f& p) {
-    debug("Generated wall at " + p.toString());
-
-    m_state.gold -= WALL_COST;
-
-    Wall::WProps pp = Wall::newProps(p);
-
-    WallShPtr w = std::make_shared<Wall>(pp);
-    m_world->spawn(w);
+    m_sim->push(world::Command::buildWall(p.x(), p.y(), WALL_COST));
   }
 
   void
-  Game::displayMob(MobShPtr m) noexcept {
+  Game::displayMob(const world::Handle& m) noexcept {
     // Deactivate any other menu and activate the
     // one corresponding to mob props.
     m_tDisplay.main->setVisible(false);
-    m_tDisplay.tower = nullptr;
+    m_tDisplay.tower = world::Handle::invalid();
     m_mDisplay.main->setVisible(true);
     m_sDisplay.main->setVisible(false);
-    m_sDisplay.spawner = nullptr;
+    m_sDisplay.spawner = world::Handle::invalid();
     m_wDisplay.main->setVisible(false);
-    m_wDisplay.wall = nullptr;
+    m_wDisplay.wall = world::Handle::invalid();
 
     m_state.infoState = InfoPanelStatus::Mob;
 
-    // Register the mob as the one being followed.
+    // Register the mob as the one being followed: its
+    // properties are published by the world from now
+    // on.
     m_mDisplay.mob = m;
+    m_sim->push(world::Command::select(m, world::SelectionType::Mob));
   }
 
   void
-  Game::displayTower(TowerShPtr t) noexcept {
+  Game::displayTower(const world::Handle& t) noexcept {
     // Deactivate any other menu and activate the
     // one corresponding to mob props.
     m_tDisplay.main->setVisible(true);
     m_mDisplay.main->setVisible(false);
-    m_mDisplay.mob = nullptr;
+    m_mDisplay.mob = world::Handle::invalid();
     m_sDisplay.main->setVisible(false);
-    m_sDisplay.spawner = nullptr;
+    m_sDisplay.spawner = world::Handle::invalid();
     m_wDisplay.main->setVisible(false);
-    m_wDisplay.wall = nullptr;
+    m_wDisplay.wall = world::Handle::invalid();
 
     m_state.infoState = InfoPanelStatus::Tower;
 
-    // Register the tower as the one being followed.
+    // Register the tower as the one being followed. The
+    // menus are updated to display its upgrades once its
+    // properties are published by the world.
     m_tDisplay.tower = t;
+    m_tDisplay.bound = false;
+    m_sim->push(world::Command::select(t, world::SelectionType::Tower));
 
-    // Update the menus to display the props of the
-    // tower.
-    towers::Upgrades ugs = t->getUpgrades();
-
-    unsigned id = 0u;
-    for (towers::Upgrades::const_iterator it = ugs.cbegin() ;
-         it != ugs.cend() && id < m_tDisplay.props.size();
-         ++it)
-    {
-      towers::Upgrade u = it->first;
-
-      m_tDisplay.props[id]->setAction(
-        [u](std::vector<tdef::ActionShPtr>& actions) {
-          actions.push_back(
-            std::make_shared<tdef::SimpleAction>(
-              [u](tdef::Game& g) {
-                g.upgradeTower(u);
-              }
-            )
-          );
-        }
-      );
-      ++id;
+    for (unsigned id = 0u ; id < m_tDisplay.props.size() ; ++id) {
+      m_tDisplay.props[id]->setVisible(false);
     }
   }
 
   void
-  Game::displaySpawner(SpawnerShPtr s) noexcept {
+  Game::displaySpawner(const world::Handle& s) noexcept {
     // Deactivate any other menu and activate the
     // one corresponding to mob props.
     m_tDisplay.main->setVisible(false);
-    m_tDisplay.tower = nullptr;
+    m_tDisplay.tower = world::Handle::invalid();
     m_mDisplay.main->setVisible(false);
-    m_mDisplay.mob = nullptr;
+    m_mDisplay.mob = world::Handle::invalid();
     m_sDisplay.main->setVisible(true);
     m_wDisplay.main->setVisible(false);
-    m_wDisplay.wall = nullptr;
+    m_wDisplay.wall = world::Handle::invalid();
 
     m_state.infoState = InfoPanelStatus::Spawner;
 
     // Register the spawner as the one being followed.
     m_sDisplay.spawner = s;
+    m_sim->push(world::Command::select(s, world::SelectionType::Spawner));
   }
 
   void
-  Game::displayWall(WallShPtr w) noexcept {
+  Game::displayWall(const world::Handle& w) noexcept {
     // Deactivate any other menu and activate the
     // one corresponding to mob props.
     m_tDisplay.main->setVisible(false);
-    m_tDisplay.tower = nullptr;
+    m_tDisplay.tower = world::Handle::invalid();
     m_mDisplay.main->setVisible(false);
-    m_mDisplay.mob = nullptr;
+    m_mDisplay.mob = world::Handle::invalid();
     m_sDisplay.main->setVisible(false);
-    m_sDisplay.spawner = nullptr;
+    m_sDisplay.spawner = world::Handle::invalid();
     m_wDisplay.main->setVisible(true);
 
     m_state.infoState = InfoPanelStatus::Wall;
 
     // Register the wall as the one being followed.
     m_wDisplay.wall = w;
+    m_sim->push(world::Command::select(w, world::SelectionType::Wall));
+  }
+
+  void
+  Game::updateSelection() noexcept {
+    // The selection of the snapshot only describes the
+    // element displayed once the world processed the
+    // command selecting it.
+    const world::Selection& s = m_world->getSnapshot().selection;
+    if (s.type != world::SelectionType::None || !s.handle.valid()) {
+      return;
+    }
+
+    if (m_tDisplay.tower == s.handle) {
+      m_tDisplay.main->setVisible(false);
+      m_tDisplay.tower = world::Handle::invalid();
+    }
+
+    if (m_mDisplay.mob == s.handle) {
+      m_mDisplay.main->setVisible(false);
+      m_mDisplay.mob = world::Handle::invalid();
+    }
+
+    if (m_sDisplay.spawner == s.handle) {
+      m_sDisplay.main->setVisible(false);
+      m_sDisplay.spawner = world::Handle::invalid();
+    }
+
+    if (m_wDisplay.wall == s.handle) {
+      m_wDisplay.main->setVisible(false);
+      m_wDisplay.wall = world::Handle::invalid();
+    }
   }
 
   void
@@ -914,81 +940,86 @@ namespace tdef {
     v = static_cast<int>(m_state.gold);
     m_statusDisplay.gold->setText("Gold: " + std::to_string(v));
 
-    // Update display values for visible menus.
-    if (m_tDisplay.tower != nullptr) {
-      std::string t = towers::toString(m_tDisplay.tower->getType());
+    // Update display values for visible menus. The
+    // values are only available once the world has
+    // processed the selection.
+    const world::Selection& s = m_world->getSnapshot().selection;
+
+    if (m_tDisplay.tower.valid() && s.handle == m_tDisplay.tower && s.type == world::SelectionType::Tower) {
+      std::string t = towers::toString(s.tower);
       m_tDisplay.type->setText("Type: " + t);
 
-      towers::Upgrades ug = m_tDisplay.tower->getUpgrades();
+      // Bind the upgrade menus to the upgrades of the
+      // tower the first time they're known.
+      if (!m_tDisplay.bound) {
+        for (unsigned id = 0u ; id < s.count && id < m_tDisplay.props.size() ; ++id) {
+          towers::Upgrade u = s.upgrades[id].upgrade;
+
+          m_tDisplay.props[id]->setAction(
+            [u](std::vector<tdef::ActionShPtr>& actions) {
+              actions.push_back(
+                std::make_shared<tdef::SimpleAction>(
+                  [u](tdef::Game& g) {
+                    g.upgradeTower(u);
+                  }
+                )
+              );
+            }
+          );
+        }
+
+        m_tDisplay.bound = true;
+      }
 
       unsigned id = 0u;
-      for (towers::Upgrades::const_iterator it = ug.cbegin() ;
-           it != ug.cend() && id < m_tDisplay.props.size() ;
-           ++it)
-      {
-        float v;
+      for ( ; id < s.count && id < m_tDisplay.props.size() ; ++id) {
+        const world::SelectedUpgrade& su = s.upgrades[id];
+
+        float v = su.value;
         bool intVal = false;
         std::string unit;
 
-        switch (it->first) {
+        switch (su.upgrade) {
           case towers::Upgrade::Range:
-            v = m_tDisplay.tower->getRange();
+          case towers::Upgrade::AttackSpeed:
+          case towers::Upgrade::AimSpeed:
             break;
           case towers::Upgrade::Damage:
-            v = m_tDisplay.tower->getAttack();
+          case towers::Upgrade::ProjectileSpeed:
             intVal = true;
             break;
           case towers::Upgrade::RotationSpeed:
-            v = utils::radToDeg(m_tDisplay.tower->getRotationSpeed());
+            v = utils::radToDeg(v);
             intVal = true;
             unit = "deg";
             break;
-          case towers::Upgrade::AttackSpeed:
-            v = m_tDisplay.tower->getAttackSpeed();
-            break;
-          case towers::Upgrade::AimSpeed:
-            v = m_tDisplay.tower->getAimingSpeed();
-            break;
           case towers::Upgrade::Accuracy:
-            v = 100.0f * m_tDisplay.tower->getAccuracy();
+            v = 100.0f * v;
             intVal = true;
             unit = "%";
             break;
-          case towers::Upgrade::ProjectileSpeed:
-            v = m_tDisplay.tower->getProjectileSpeed();
-            intVal = true;
-            break;
           case towers::Upgrade::FreezingPower:
-            v = m_tDisplay.tower->getFreezingPower();
-            intVal = true;
-            unit = "%";
-            break;
           case towers::Upgrade::FreezingSpeed:
-            v = m_tDisplay.tower->getFreezingSpeed();
-            intVal = true;
-            unit = "%";
-            break;
           case towers::Upgrade::StunChance:
-            v = m_tDisplay.tower->getStunChance();
             intVal = true;
             unit = "%";
             break;
           case towers::Upgrade::StunDuration:
             // Convert milliseconds to seconds.
-            v = m_tDisplay.tower->getStunDuration() / 1000.0f;
+            v = v / 1000.0f;
             intVal = true;
             unit = "s";
             break;
           default:
             // Unhandled for now.
-            warn("Unhandled props " + towers::toString(it->first));
+            warn("Unhandled props " + towers::toString(su.upgrade));
             v = -1.0f;
             break;
         }
 
-        std::string msg = towers::toString(it->first);
+        std::string msg = towers::toString(su.upgrade);
         msg += "(";
-        msg += std::to_string(it->second);
+        msg += std::to_string(su.level);
         msg += "):";
         if (intVal) {
           msg += std::to_string(static_cast<int>(std::round(v)));
@@ -1004,7 +1035,7 @@ namespace tdef {
           msg += unit;
         }
 
-        float cost = towers::getUpgradeCost(m_tDisplay.tower->getType(), it->first, it->second);
+        float cost = towers::getUpgradeCost(s.tower, su.upgrade, su.level);
         msg += " (cost: ";
         msg += std::to_string(static_cast<int>(std::round(cost)));
         msg += ")";
@@ -1012,12 +1043,10 @@ namespace tdef {
         m_tDisplay.props[id]->setVisible(true);
         m_tDisplay.props[id]->setText(msg);
         m_tDisplay.props[id]->enable(m_state.gold >= cost);
-
-        ++id;
       }
 
-      if (id < ug.size()) {
-        warn("Only interpreted " + std::to_string(id) + " among " + std::to_string(ug.size()) + " available");
+      if (id < s.count) {
+        warn("Only interpreted " + std::to_string(id) + " among " + std::to_string(s.count) + " available");
       }
       if (id < UPGRADE_COUNT) {
         // Deactivate elements that are not used.
@@ -1029,37 +1058,36 @@ namespace tdef {
       }
 
       std::string msg = "Sell (";
-      float tc = m_tDisplay.tower->getTotalCost();
-      msg += std::to_string(static_cast<int>(std::round(tc)));
+      msg += std::to_string(static_cast<int>(std::round(s.cost)));
       msg += " gold)";
       m_tDisplay.sell->setText(msg);
 
       msg = "Target mode: ";
-      msg += towers::toString(m_tDisplay.tower->getTargetMode());
+      msg += towers::toString(s.mode);
       m_tDisplay.targetMode->setText(msg);
     }
 
-    if (m_mDisplay.mob != nullptr) {
-      std::string t = mobs::toString(m_mDisplay.mob->getType());
+    if (m_mDisplay.mob.valid() && s.handle == m_mDisplay.mob && s.type == world::SelectionType::Mob) {
+      std::string t = mobs::toString(s.mob);
       m_mDisplay.type->setText("Type: " + t);
 
-      float v = m_mDisplay.mob->getHealth();
+      float v = s.health;
       m_mDisplay.health->setText("Health: " + std::to_string(v));
 
-      v = m_mDisplay.mob->getSpeed();
+      v = s.speed;
       m_mDisplay.speed->setText("Speed: " + std::to_string(v));
 
-      v = m_mDisplay.mob->getBounty();
+      v = s.bounty;
       m_mDisplay.bounty->setText("Bounty: " + std::to_string(v));
     }
 
-    if (m_sDisplay.spawner != nullptr) {
-      float v = m_sDisplay.spawner->getHealth();
+    if (m_sDisplay.spawner.valid() && s.handle == m_sDisplay.spawner && s.type == world::SelectionType::Spawner) {
+      float v = s.health;
       m_sDisplay.health->setText("Health: " + std::to_string(v));
     }
 
-    if (m_wDisplay.wall != nullptr) {
-      float v = m_wDisplay.wall->getHealth();
+    if (m_wDisplay.wall.valid() && s.handle == m_wDisplay.wall && s.type == world::SelectionType::Wall) {
+      float v = s.health;
       m_wDisplay.health->setText("Health: " + std::to_string(v));
     }
 
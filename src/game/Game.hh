@@ -5,6 +5,7 @@
 # include <memory>
 # include <core_utils/CoreObject.hh>
 # include "World.hh"
+# include "Simulation.hh"
 # include "Tower.hh"
 # include "Mob.hh"
 # include "Spawner.hh"
@@ -19,7 +20,10 @@ namespace tdef {
     public:
 
       /**
-       * @brief - Create a new game with default parameters.
+       * @brief - Create a new game with default parameters. The
+       *          world is stepped by its own thread: the game only
+       *          reads the snapshots it publishes and sends it the
+       *          actions of the player as commands.
        */
       Game();
 
@@ -130,67 +134,40 @@ namespace tdef {
       terminated() const noexcept;
 
       /**
-       * @brief - Forward the call to the internal world so
-       *          that one can fetch the list of visible
-       *          elements.
-       * @param xMin - the abscissa of the top left corner
-       *               of the view frustum.
-       * @param yMin - the ordinate of the top left corner
-       *               of the view frustum.
-       * @param xMax - the abscissa of the bottom right
-       *               corner of the view frustum.
-       * @param yMax - the ordinate of the bottom right
-       *               corner of the view frustum.
-       * @param type - the type of elements to consider. If
-       *               this value is set to `null` all the
-       *               item types will be included.
-       * @param filters - include a description of a uuid and
-       *                  whether or not it should be used
-       *                  and considered when fetching items.
-       * @param sort - the algorithm to use when performing the
-       *               sorting operation (none by default).
-       * @return - the list of items that are visible in the
-       *           input view frustum.
-       */
-      std::vector<world::ItemEntry>
-      getVisible(float xMin,
-                 float yMin,
-                 float xMax,
-                 float yMax,
-                 const world::ItemType* type = nullptr,
-                 const world::Filter* filters = nullptr,
-                 world::Sort sort = world::Sort::None) const noexcept;
-
-      /**
-       * @brief - Forward the call to the locator to fetch the
-       *          block with the specified index.
-       * @param id - index of the tile to access.
-       * @return - the tile at the specified index.
-       */
-      world::Block
-      block(int id) const noexcept;
-
-      /**
-       * @brief - Forward the call to the locator to fetch the
-       *          mob with the specified index.
-       * @param id - the index of the entity to get.
-       * @return - the corresponding entity.
-       */
-      world::Mob
-      mob(int id) const noexcept;
-
-      /**
-       * @brief - Forward the call to the locator to fetch the
-       *          projectile with the specified index.
-       * @param id - the index of the entity to get.
-       * @return - the corresponding entity.
-       */
-      world::Projectile
-      projectile(int id) const noexcept;
-
-      /**
-       * @brief - Forward the call to step one step ahead
-       *          in time to the internal world.
+       * @brief - Forward the call to the world to fetch the last
+       *          snapshot of its elements. It is meant to be used
+       *          by the renderer and is refreshed by each call to
+       *          `step`.
+       * @return - the last snapshot of the world.
+       */
+      const world::Snapshot&
+      getSnapshot() const noexcept;
+
+      /**
+       * @brief - Define whether the snapshots of the world should
+       *          include the paths of the mobs. This is typically
+       *          only needed when debug information is displayed.
+       * @param paths - `true` to include the paths.
+       */
+      void
+      setSnapshotPaths(bool paths);
+
+      /**
+       * @brief - Compute how far the simulation is between the
+       *          tick of the last snapshot and the next one from
+       *          the time elapsed since it was simulated. This is
+       *          used to interpolate the position of entities
+       *          when rendering them.
+       * @return - the interpolation factor in the range `[0; 1]`.
+       */
+      float
+      getInterpolation() const noexcept;
+
+      /**
+       * @brief - Fetch the last snapshot published by the world
+       *          and update the game state and the UI from it.
+       *          The world itself is stepped by the simulation
+       *          thread.
        * @param tDelta - the duration of the last frame in
        *                 seconds.
        * @param bool - `true` in case the game continues,
@@ -234,7 +211,8 @@ namespace tdef {
 
       /**
        * @brief - Used to perform a save operation on this world's
-       *          data to the specified file.
+       *          data to the specified file. The simulation thread
+       *          is stopped while the world is saved.
        * @param file - the name of the file into which the world's
        *               data should be saved.
        */
@@ -328,7 +306,7 @@ namespace tdef {
        * @param m - the mob whose props should be displayed.
        */
       void
-      displayMob(MobShPtr m) noexcept;
+      displayMob(const world::Handle& m) noexcept;
 
       /**
        * @brief - Used to setup the menu allowing to display
@@ -337,7 +315,7 @@ namespace tdef {
        * @param t - the tower whose props should be displayed.
        */
       void
-      displayTower(TowerShPtr t) noexcept;
+      displayTower(const world::Handle& t) noexcept;
 
       /**
        * @brief - Used to setup the menu allowing to display
@@ -346,7 +324,7 @@ namespace tdef {
        * @param s - the spawner whose props will be displayed.
        */
       void
-      displaySpawner(SpawnerShPtr s) noexcept;
+      displaySpawner(const world::Handle& s) noexcept;
 
       /**
        * @brief - Used to setup the menu allowing to display
@@ -355,18 +333,15 @@ namespace tdef {
        * @param w - the wall whose props should be displayed.
        */
       void
-      displayWall(WallShPtr w) noexcept;
+      displayWall(const world::Handle& w) noexcept;
 
       /**
-       * @brief - Updates the amount of gold available for the
-       *          game with the provided amount. Note that we
-       *          consider that this method will not be called
-       *          in a concurrent context as it is not thread
-       *          safe.
-       * @param earned - the amount of gold earned.
+       * @brief - Used to hide the menus displaying the properties
+       *          of the selected element in case it is not part
+       *          of the world anymore.
        */
       void
-      updateGold(float earned);
+      updateSelection() noexcept;
 
       /**
        * @brief - Used to enable or disable the menus that
@@ -434,10 +409,6 @@ namespace tdef {
 
         // The menu representing the pause action.
         SimpleMenuShPtr pause;
-
-        // Holds the slot index returned by the world when
-        // registering for gold earned update.
-        int goldEarnedSlot;
       };
 
       /**
@@ -457,10 +428,16 @@ namespace tdef {
         MenuShPtr sell;
         MenuShPtr targetMode;
 
-        // `tower` defines a pointer to the tower being displayed.
-        // It allows to continuously update the values displayed
-        // in the menus.
-        TowerShPtr tower;
+        // `tower` defines the handle of the tower being displayed.
+        // Its properties are published in the snapshots of the
+        // world which allows to continuously update the values
+        // displayed in the menus.
+        world::Handle tower;
+
+        // Whether the actions of the upgrade menus were bound to
+        // the upgrades of the tower. This is done once the first
+        // snapshot describing the tower is received.
+        bool bound;
       };
 
       /**
@@ -480,10 +457,10 @@ namespace tdef {
         MenuShPtr speed;
         MenuShPtr bounty;
 
-        // `mob` defines a pointer to the mob being displayed. It
+        // `mob` defines the handle of the mob being displayed. It
         // allows to continuously update the values displayed in
         // the menus.
-        MobShPtr mob;
+        world::Handle mob;
       };
 
       /**
@@ -500,10 +477,10 @@ namespace tdef {
         // various props of a spawner.
         MenuShPtr health;
 
-        // `spawner` defines a pointer to the wall being displayed.
+        // `spawner` defines the handle of the spawner being shown.
         // It allows to continuously update the value displayed
         // in the menus.
-        SpawnerShPtr spawner;
+        world::Handle spawner;
       };
 
       /**
@@ -520,10 +497,10 @@ namespace tdef {
         // various props of a spawner.
         MenuShPtr health;
 
-        // `wall` defines a pointer to the wall being displayed.
+        // `wall` defines the handle of the wall being displayed.
         // It allows to continuously update the value displayed
         // in the menus.
-        WallShPtr wall;
+        world::Handle wall;
       };
 
       /**
@@ -581,10 +558,15 @@ namespace tdef {
         // The type of tower to spawn if needed.
         std::shared_ptr<towers::Type> tType;
 
+        // Whether the snapshots of the world include the paths
+        // of the mobs.
+        bool paths;
+
         // The available lives for this game.
         float lives;
 
-        // The available gold for this game.
+        // The available gold for this game, as published by the
+        // world.
         float gold;
       };
 
@@ -600,14 +582,10 @@ namespace tdef {
       WorldShPtr m_world;
 
       /**
-       * @brief - An element to use to interact with elements from
-       *          the world. This object provide convenience methods
-       *          to access in an efficient way elements that are
-       *          within a particular region or in a way that allow
-       *          efficient drawing on screen (such as in ascending
-       *          `z` order).
+       * @brief - The simulation stepping the world on its own
+       *          thread and receiving the commands of the game.
        */
-      LocatorShPtr m_loc;
+      SimulationShPtr m_sim;
 
       /**
        * @brief - The definition of the game state.
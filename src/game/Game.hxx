@@ -2,15 +2,15 @@
 # define   GAME_HXX
 
 # include "Game.hh"
+# include <chrono>
+# include <algorithm>
 
 namespace tdef {
 
   inline
   Game::~Game() {
-    // Disconnect the gold earned slot.
-    if (m_statusDisplay.goldEarnedSlot >= 0) {
-      m_world->onGoldEarned.disconnect(m_statusDisplay.goldEarnedSlot);
-    }
+    // Stop the simulation before the world is released.
+    m_sim->stop();
   }
 
   inline
@@ -60,7 +60,7 @@ namespace tdef {
       return;
     }
 
-    m_world->pause();
+    m_sim->push(world::Command::pause());
     m_state.paused = true;
   }
 
@@ -72,45 +72,39 @@ namespace tdef {
       return;
     }
 
-    m_world->resume();
+    m_sim->push(world::Command::resume());
     m_state.paused = false;
   }
 
   inline
-  std::vector<world::ItemEntry>
-  Game::getVisible(float xMin,
-                   float yMin,
-                   float xMax,
-                   float yMax,
-                   const world::ItemType* type,
-                   const world::Filter* filters,
-                   world::Sort sort) const noexcept
-  {
-    return m_loc->getVisible(xMin, yMin, xMax, yMax, type, filters, sort);
+  const world::Snapshot&
+  Game::getSnapshot() const noexcept {
+    return m_world->getSnapshot();
   }
 
   inline
-  world::Block
-  Game::block(int id) const noexcept {
-    return m_loc->block(id);
-  }
+  void
+  Game::setSnapshotPaths(bool paths) {
+    if (m_state.paths == paths) {
+      return;
+    }
 
-  inline
-  world::Mob
-  Game::mob(int id) const noexcept {
-    return m_loc->mob(id);
+    m_sim->push(world::Command::includePaths(paths));
+    m_state.paths = paths;
   }
 
   inline
-  world::Projectile
-  Game::projectile(int id) const noexcept {
-    return m_loc->projectile(id);
-  }
+  float
+  Game::getInterpolation() const noexcept {
+    const world::Snapshot& snap = m_world->getSnapshot();
+    if (snap.tick <= 0.0f) {
+      return 1.0f;
+    }
 
-  inline
-  void
-  Game::updateGold(float earned) {
-    m_state.gold += earned;
+    std::chrono::duration<double> now = std::chrono::steady_clock::now().time_since_epoch();
+    float alpha = static_cast<float>((now.count() - snap.moment) / snap.tick);
+
+    return std::min(std::max(alpha, 0.0f), 1.0f);
   }
 
 }
@@ -2,6 +2,7 @@
 # include "Blast.hh"
 # include <maths_utils/AngleUtils.hh>
 # include "TowerData.hh"
+# include "TowerTraits.hh"
 
 namespace tdef {
   namespace towers {
@@ -34,15 +35,13 @@ namespace tdef {
 
       constexpr float cost = 75.0f;
 
-      Processes
-      generateData(int /*level*/) noexcept {
-        Processes dd;
+      // The behaviors known at compile time for this type
+      // should match its stats.
+      using Behavior = Traits<Type::Blast>;
 
-        dd.pickMob = multipleTargetPicking;
-        dd.damage = basicDamaging;
-
-        return dd;
-      }
+      static_assert(Behavior::hitscan == (projectileSpeed == infinite_projectile_speed), "Invalid hitscan trait");
+      static_assert(Behavior::instantAim == (aimSpeed == infinite_aim_speed), "Invalid aim trait");
+      static_assert(Behavior::areaOfEffect == (aoeRadius > 0.0f), "Invalid area of effect trait");
 
       Tower::TProps
       generateProps(const utils::Point2f& p, int /*level*/) noexcept {
@@ -8,16 +8,6 @@ namespace tdef {
 
     namespace freezing {
 
-      /**
-       * @brief - Generate the tower's data for the specified
-       *          level.
-       * @param level - the level for which the data should be
-       *                generated.
-       * @return - the generated data.
-       */
-      Processes
-      generateData(int level = 0) noexcept;
-
       /**
        * @brief - Generate the tower's properties for the level
        *          and position provided in input.
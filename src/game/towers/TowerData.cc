@@ -7,24 +7,33 @@
 namespace tdef {
   namespace towers {
 
-    std::vector<MobShPtr>
-    basicTargetPicking(StepInfo& info, PickData& data) {
-      MobShPtr m = info.frustum->getClosestMob(data.pos, data.maxRange, nullptr);
+    void
+    basicTargetPicking(const StepInfo& info,
+                       PickData& data,
+                       std::vector<world::Handle>& picked)
+    {
+      Mob* m = info.frustum->nearestMob(data.pos, data.maxRange);
 
-      if (m == nullptr) {
-        return std::vector<MobShPtr>();
+      if (m != nullptr) {
+        picked.push_back(m->getHandle());
       }
-
-      return std::vector<MobShPtr>{m};
     }
 
-    std::vector<MobShPtr>
-    multipleTargetPicking(StepInfo& info, PickData& data) {
-      return info.frustum->getVisibleMobs(data.pos, data.maxRange, nullptr);
+    void
+    multipleTargetPicking(const StepInfo& info,
+                          PickData& data,
+                          std::vector<world::Handle>& picked)
+    {
+      info.frustum->forEachMobInRadius(data.pos, data.maxRange, nullptr,
+        [&picked](Mob& m) {
+          picked.push_back(m.getHandle());
+          return true;
+        }
+      );
     }
 
     bool
-    basicDamaging(StepInfo& info, MobShPtr mob, Damage& data) {
+    basicDamaging(StepInfo& info, Mob& mob, Damage& data) {
       mobs::Damage d;
       d.hit = data.damage;
 
@@ -39,7 +48,7 @@ namespace tdef {
       d.sDuration = data.sDuration;
       d.pDuration = data.pDuration;
 
-      return mob->hit(info, d);
+      return mob.hit(info, d);
     }
 
     towers::Upgradable
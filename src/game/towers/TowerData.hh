@@ -50,20 +50,26 @@ namespace tdef {
      *          the closest mob from a position.
      * @param info - the data to use to pick a target.
      * @param data - the data to use to perform picking.
-     * @return - the picked mobs.
+     * @param picked - output list where the handle of the
+     *                 picked mob is appended.
      */
-    std::vector<MobShPtr>
-    basicTargetPicking(StepInfo& info, PickData& data);
+    void
+    basicTargetPicking(const StepInfo& info,
+                       PickData& data,
+                       std::vector<world::Handle>& picked);
 
     /**
      * @brief - Target picking method which picks all the
      *          mobs visible in a particular radius.
      * @param info - the data to use to pick a target.
      * @param data - the data to use to perform picking.
-     * @return - the picked mobs.
+     * @param picked - output list where the handles of the
+     *                 picked mobs are appended.
      */
-    std::vector<MobShPtr>
-    multipleTargetPicking(StepInfo& info, PickData& data);
+    void
+    multipleTargetPicking(const StepInfo& info,
+                          PickData& data,
+                          std::vector<world::Handle>& picked);
 
     /**
      * @brief - Basic damaging function which just applies
@@ -75,7 +81,7 @@ namespace tdef {
      * @return - `true` if the mob is still alive.
      */
     bool
-    basicDamaging(StepInfo& info, MobShPtr mob, Damage& data);
+    basicDamaging(StepInfo& info, Mob& mob, Damage& data);
 
     /**
      * @brief - Generate an upgradable which has a linear relation
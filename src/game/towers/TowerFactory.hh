@@ -6,18 +6,6 @@
 namespace tdef {
   namespace towers {
 
-    /**
-     * @brief - Generates the data for a tower given its type.
-     * @param type - the type of the tower for which the data
-     *               should be generated.
-     * @param level - the level for which the data should be
-     *                generated.
-     * @return - the generated data.
-     */
-    Processes
-    generateData(const Type& type,
-                 int level = 0);
-
     /**
      * @brief - Generates the properties for a tower given its
      *          type.
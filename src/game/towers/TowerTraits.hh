@@ -0,0 +1,164 @@
+#ifndef    TOWER_TRAITS_HH
+# define   TOWER_TRAITS_HH
+
+# include "Tower.hh"
+
+namespace tdef {
+  namespace towers {
+
+    /**
+     * @brief - Describes the behaviors of a type of tower which
+     *          are known at compile time. Each type specializes
+     *          this structure with the following values:
+     *            - `hitscan`: the projectiles have an infinite
+     *              speed and the damage is applied right away.
+     *            - `instantAim`: the tower has an infinite aim
+     *              speed.
+     *            - `multiTarget`: the tower attacks all the mobs
+     *              in its range rather than the closest one.
+     *            - `areaOfEffect`: the projectiles damage all the
+     *              mobs around their target.
+     *          The values should match the stats of the tower as
+     *          defined by its props at any level.
+     */
+    template <Type T>
+    struct Traits;
+
+    template <>
+    struct Traits<Type::Basic> {
+      static constexpr Type type = Type::Basic;
+
+      static constexpr bool hitscan = false;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = false;
+      static constexpr bool areaOfEffect = false;
+    };
+
+    template <>
+    struct Traits<Type::Sniper> {
+      static constexpr Type type = Type::Sniper;
+
+      static constexpr bool hitscan = true;
+      static constexpr bool instantAim = false;
+      static constexpr bool multiTarget = false;
+      static constexpr bool areaOfEffect = false;
+    };
+
+    template <>
+    struct Traits<Type::Cannon> {
+      static constexpr Type type = Type::Cannon;
+
+      static constexpr bool hitscan = false;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = false;
+      static constexpr bool areaOfEffect = true;
+    };
+
+    template <>
+    struct Traits<Type::Freezing> {
+      static constexpr Type type = Type::Freezing;
+
+      static constexpr bool hitscan = true;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = true;
+      static constexpr bool areaOfEffect = false;
+    };
+
+    template <>
+    struct Traits<Type::Venom> {
+      static constexpr Type type = Type::Venom;
+
+      static constexpr bool hitscan = false;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = false;
+      static constexpr bool areaOfEffect = false;
+    };
+
+    template <>
+    struct Traits<Type::Splash> {
+      static constexpr Type type = Type::Splash;
+
+      static constexpr bool hitscan = false;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = false;
+      static constexpr bool areaOfEffect = false;
+    };
+
+    template <>
+    struct Traits<Type::Blast> {
+      static constexpr Type type = Type::Blast;
+
+      static constexpr bool hitscan = true;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = true;
+      static constexpr bool areaOfEffect = false;
+    };
+
+    template <>
+    struct Traits<Type::Multishot> {
+      static constexpr Type type = Type::Multishot;
+
+      static constexpr bool hitscan = false;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = false;
+      static constexpr bool areaOfEffect = false;
+    };
+
+    template <>
+    struct Traits<Type::Minigun> {
+      static constexpr Type type = Type::Minigun;
+
+      static constexpr bool hitscan = true;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = false;
+      static constexpr bool areaOfEffect = false;
+    };
+
+    template <>
+    struct Traits<Type::Antiair> {
+      static constexpr Type type = Type::Antiair;
+
+      static constexpr bool hitscan = false;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = false;
+      static constexpr bool areaOfEffect = false;
+    };
+
+    template <>
+    struct Traits<Type::Tesla> {
+      static constexpr Type type = Type::Tesla;
+
+      static constexpr bool hitscan = true;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = false;
+      static constexpr bool areaOfEffect = false;
+    };
+
+    template <>
+    struct Traits<Type::Missile> {
+      static constexpr Type type = Type::Missile;
+
+      static constexpr bool hitscan = false;
+      static constexpr bool instantAim = true;
+      static constexpr bool multiTarget = false;
+      static constexpr bool areaOfEffect = true;
+    };
+
+    /**
+     * @brief - Call the kernel with the traits describing the
+     *          input type of tower. The kernel is called with
+     *          a default constructed instance of the traits so
+     *          that it can be a generic lambda.
+     * @param type - the type of the tower.
+     * @param kernel - the kernel to call.
+     */
+    template <typename Kernel>
+    void
+    dispatch(const Type& type, Kernel&& kernel);
+
+  }
+}
+
+# include "TowerTraits.hxx"
+
+#endif    /* TOWER_TRAITS_HH */
@@ -0,0 +1,58 @@
+#ifndef    TOWER_TRAITS_HXX
+# define   TOWER_TRAITS_HXX
+
+# include "TowerTraits.hh"
+
+namespace tdef {
+  namespace towers {
+
+    template <typename Kernel>
+    inline
+    void
+    dispatch(const Type& type, Kernel&& kernel) {
+      switch (type) {
+        case Type::Sniper:
+          kernel(Traits<Type::Sniper>());
+          break;
+        case Type::Cannon:
+          kernel(Traits<Type::Cannon>());
+          break;
+        case Type::Freezing:
+          kernel(Traits<Type::Freezing>());
+          break;
+        case Type::Venom:
+          kernel(Traits<Type::Venom>());
+          break;
+        case Type::Splash:
+          kernel(Traits<Type::Splash>());
+          break;
+        case Type::Blast:
+          kernel(Traits<Type::Blast>());
+          break;
+        case Type::Multishot:
+          kernel(Traits<Type::Multishot>());
+          break;
+        case Type::Minigun:
+          kernel(Traits<Type::Minigun>());
+          break;
+        case Type::Antiair:
+          kernel(Traits<Type::Antiair>());
+          break;
+        case Type::Tesla:
+          kernel(Traits<Type::Tesla>());
+          break;
+        case Type::Missile:
+          kernel(Traits<Type::Missile>());
+          break;
+        case Type::Basic:
+        default:
+          // Assume default is basic tower.
+          kernel(Traits<Type::Basic>());
+          break;
+      }
+    }
+
+  }
+}
+
+#endif    /* TOWER_TRAITS_HXX */
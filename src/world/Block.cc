@@ -4,9 +4,11 @@
 namespace tdef {
 
   Block::Block(const BProps& props,
+               const world::BlockType& type,
                const std::string& name):
     WorldElement(props, name),
 
+    m_blockType(type),
     m_orientation(props.orientation)
   {}
 
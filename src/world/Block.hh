@@ -7,6 +7,20 @@
 # include "StepInfo.hh"
 
 namespace tdef {
+  namespace world {
+
+    /**
+     * @brief - Defines the possible types for a block
+     *          in the world.
+     */
+    enum class BlockType {
+      Spawner,
+      Wall,
+      Portal,
+      Tower,
+    };
+
+  }
 
   class Block: public WorldElement {
     public:
@@ -14,6 +28,15 @@ namespace tdef {
       float
       getOrientation() const noexcept;
 
+      /**
+       * @brief - Return the type of this block. This allows to
+       *          know which concrete class the block belongs to
+       *          without relying on RTTI.
+       * @return - the type of the block.
+       */
+      const world::BlockType&
+      getBlockType() const noexcept;
+
       std::ostream&
       operator<<(std::ostream& out) const override;
 
@@ -36,7 +59,18 @@ namespace tdef {
       destroy(StepInfo& info) override;
 
       void
-      worldUpdate(LocatorShPtr loc) override;
+      worldUpdate(LocatorShPtr loc, const world::Update& update) override;
+
+      /**
+       * @brief - Interface method called before the step of
+       *          the blocks to let them prepare it. Blocks are
+       *          prepared concurrently so the implementation
+       *          should only modify the block itself and only
+       *          read the rest of the world.
+       * @param info - the information about the step.
+       */
+      virtual void
+      prepare(const StepInfo& info);
 
     protected:
 
@@ -58,13 +92,22 @@ namespace tdef {
        *          and name. Only used to forward the args
        *          to the base class.
        * @param props - the properties defining this block.
+       * @param type - the type of the block.
        * @param name- the name of the block.
        */
       Block(const BProps& props,
+            const world::BlockType& type,
             const std::string& name);
 
     protected:
 
+      /**
+       * @brief - The type of this block. It is defined by the
+       *          concrete class at construction and never changes
+       *          afterwards.
+       */
+      world::BlockType m_blockType;
+
       /**
        * @brief - The current orientation of this block. This
        *          defines the general direction where it can
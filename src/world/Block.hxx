@@ -22,6 +22,12 @@ namespace tdef {
     return m_orientation;
   }
 
+  inline
+  const world::BlockType&
+  Block::getBlockType() const noexcept {
+    return m_blockType;
+  }
+
   inline
   std::ostream&
   Block::operator<<(std::ostream& out) const {
@@ -76,7 +82,13 @@ namespace tdef {
 
   inline
   void
-  Block::worldUpdate(LocatorShPtr /*loc*/) {
+  Block::worldUpdate(LocatorShPtr /*loc*/, const world::Update& /*update*/) {
+    // Nothing to do.
+  }
+
+  inline
+  void
+  Block::prepare(const StepInfo& /*info*/) {
     // Nothing to do.
   }
 
@@ -0,0 +1,22 @@
+#ifndef    CELL_SPAN_HH
+# define   CELL_SPAN_HH
+
+namespace tdef {
+  namespace world {
+
+    /**
+     * @brief - Convenience structure defining a range of cells
+     *          on a row of the spatial indices of the locator.
+     *          The coordinates are absolute so that the range
+     *          stays valid when the indices are rebuilt.
+     */
+    struct CellSpan {
+      int y;
+      int xMin;
+      int xMax;
+    };
+
+  }
+}
+
+#endif    /* CELL_SPAN_HH */
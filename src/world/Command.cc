@@ -0,0 +1,111 @@
+
+# include "Command.hh"
+# include "Tower.hh"
+
+namespace {
+
+  /**
+   * @brief - Create a command of the input type with all its
+   *          fields set to default values.
+   * @param type - the type of the command.
+   * @return - the command.
+   */
+  tdef::world::Command
+  newCommand(const tdef::world::CommandType& type) noexcept {
+    return tdef::world::Command{
+      type,                                 // type
+
+      false,                                // paths
+
+      tdef::world::Handle::invalid(),       // handle
+      tdef::world::SelectionType::None,     // selection
+
+      0.0f,                                 // x
+      0.0f,                                 // y
+      tdef::towers::Type::Basic,            // tower
+      0.0f,                                 // cost
+
+      tdef::towers::Upgrade::Range          // upgrade
+    };
+  }
+
+}
+
+namespace tdef {
+  namespace world {
+
+    Command
+    Command::pause() noexcept {
+      return newCommand(CommandType::Pause);
+    }
+
+    Command
+    Command::resume() noexcept {
+      return newCommand(CommandType::Resume);
+    }
+
+    Command
+    Command::includePaths(bool paths) noexcept {
+      Command c = newCommand(CommandType::Paths);
+      c.paths = paths;
+
+      return c;
+    }
+
+    Command
+    Command::select(const Handle& h, const SelectionType& type) noexcept {
+      Command c = newCommand(CommandType::Select);
+      c.handle = h;
+      c.selection = type;
+
+      return c;
+    }
+
+    Command
+    Command::buildTower(float x, float y, const towers::Type& type, float cost) noexcept {
+      Command c = newCommand(CommandType::Tower);
+      c.x = x;
+      c.y = y;
+      c.tower = type;
+      c.cost = cost;
+
+      return c;
+    }
+
+    Command
+    Command::buildWall(float x, float y, float cost) noexcept {
+      Command c = newCommand(CommandType::Wall);
+      c.x = x;
+      c.y = y;
+      c.cost = cost;
+
+      return c;
+    }
+
+    Command
+    Command::upgradeTower(const Handle& h, const towers::Upgrade& upgrade) noexcept {
+      Command c = newCommand(CommandType::Upgrade);
+      c.handle = h;
+      c.upgrade = upgrade;
+
+      return c;
+    }
+
+    Command
+    Command::toggleTargetMode(const Handle& h) noexcept {
+      Command c = newCommand(CommandType::TargetMode);
+      c.handle = h;
+
+      return c;
+    }
+
+    Command
+    Command::sellTower(const Handle& h) noexcept {
+      Command c = newCommand(CommandType::Sell);
+      c.handle = h;
+
+      return c;
+    }
+
+  }
+}
@@ -0,0 +1,154 @@
+#ifndef    COMMAND_HH
+# define   COMMAND_HH
+
+# include "Handle.hh"
+# include "Snapshot.hh"
+
+namespace tdef {
+  namespace world {
+
+    /**
+     * @brief - The kind of action requested by the player on
+     *          the world.
+     */
+    enum class CommandType {
+      Pause,
+      Resume,
+      Paths,
+      Select,
+      Tower,
+      Wall,
+      Upgrade,
+      TargetMode,
+      Sell
+    };
+
+    /**
+     * @brief - Convenience structure describing an action that
+     *          the player wants to perform on the world. It is
+     *          made of plain values only so that it can be sent
+     *          to the thread stepping the world. Only the fields
+     *          relevant to the type of the command are used.
+     */
+    struct Command {
+      // The type of the command.
+      CommandType type;
+
+      // Whether the paths of the mobs should be included in
+      // the snapshots.
+      bool paths;
+
+      // The element targeted by the command and its type for
+      // a selection.
+      Handle handle;
+      SelectionType selection;
+
+      // The position of the element to build, its type for a
+      // tower and its cost.
+      float x;
+      float y;
+      towers::Type tower;
+      float cost;
+
+      // The upgrade to apply to a tower.
+      towers::Upgrade upgrade;
+
+      /**
+       * @brief - Create a command pausing the world.
+       * @return - the command.
+       */
+      static
+      Command
+      pause() noexcept;
+
+      /**
+       * @brief - Create a command resuming the world.
+       * @return - the command.
+       */
+      static
+      Command
+      resume() noexcept;
+
+      /**
+       * @brief - Create a command defining whether the paths of
+       *          the mobs are included in the snapshots.
+       * @param paths - `true` to include the paths.
+       * @return - the command.
+       */
+      static
+      Command
+      includePaths(bool paths) noexcept;
+
+      /**
+       * @brief - Create a command selecting an element of the
+       *          world so that its properties are published in
+       *          the snapshots.
+       * @param h - the handle of the element.
+       * @param type - the type of the element.
+       * @return - the command.
+       */
+      static
+      Command
+      select(const Handle& h, const SelectionType& type) noexcept;
+
+      /**
+       * @brief - Create a command building a tower at the input
+       *          position. It fails in case the position is not
+       *          free or the player can't afford it.
+       * @param x - the abscissa of the tower.
+       * @param y - the ordinate of the tower.
+       * @param type - the type of the tower.
+       * @param cost - the price of the tower.
+       * @return - the command.
+       */
+      static
+      Command
+      buildTower(float x, float y, const towers::Type& type, float cost) noexcept;
+
+      /**
+       * @brief - Create a command building a wall at the input
+       *          position. Just like for towers it may fail.
+       * @param x - the abscissa of the wall.
+       * @param y - the ordinate of the wall.
+       * @param cost - the price of the wall.
+       * @return - the command.
+       */
+      static
+      Command
+      buildWall(float x, float y, float cost) noexcept;
+
+      /**
+       * @brief - Create a command upgrading a tower to the next
+       *          level for the input upgrade.
+       * @param h - the handle of the tower.
+       * @param upgrade - the upgrade to apply.
+       * @return - the command.
+       */
+      static
+      Command
+      upgradeTower(const Handle& h, const towers::Upgrade& upgrade) noexcept;
+
+      /**
+       * @brief - Create a command switching the way a tower picks
+       *          its targets to the next mode.
+       * @param h - the handle of the tower.
+       * @return - the command.
+       */
+      static
+      Command
+      toggleTargetMode(const Handle& h) noexcept;
+
+      /**
+       * @brief - Create a command selling a tower.
+       * @param h - the handle of the tower.
+       * @return - the command.
+       */
+      static
+      Command
+      sellTower(const Handle& h) noexcept;
+    };
+
+  }
+}
+
+#endif    /* COMMAND_HH */
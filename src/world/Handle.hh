@@ -0,0 +1,59 @@
+#ifndef    HANDLE_HH
+# define   HANDLE_HH
+
+# include <istream>
+# include <ostream>
+
+namespace tdef {
+  namespace world {
+
+    /**
+     * @brief - A reference to an element of the world. It is
+     *          made of the index of the slot of the element in
+     *          the registry of the world and of the generation
+     *          of this slot when the element was registered: a
+     *          handle to an element removed from the world can
+     *          thus be detected even if its slot was reused.
+     *          Handles are cheap to copy and do not keep the
+     *          element alive.
+     */
+    struct Handle {
+      unsigned index;
+      unsigned generation;
+
+      /**
+       * @brief - Create a handle not referring to any element.
+       * @return - an invalid handle.
+       */
+      static
+      Handle
+      invalid() noexcept;
+
+      /**
+       * @brief - Whether this handle was assigned to an element.
+       *          Note that it does not guarantee that the element
+       *          is still alive.
+       * @return - `true` if the handle was assigned.
+       */
+      bool
+      valid() const noexcept;
+
+      bool
+      operator==(const Handle& rhs) const noexcept;
+
+      bool
+      operator!=(const Handle& rhs) const noexcept;
+    };
+
+  }
+}
+
+std::ostream&
+operator<<(std::ostream& out, const tdef::world::Handle& h) noexcept;
+
+std::istream&
+operator>>(std::istream& in, tdef::world::Handle& h) noexcept;
+
+# include "Handle.hxx"
+
+#endif    /* HANDLE_HH */
@@ -0,0 +1,52 @@
+#ifndef    HANDLE_HXX
+# define   HANDLE_HXX
+
+# include "Handle.hh"
+# include <limits>
+
+namespace tdef {
+  namespace world {
+
+    inline
+    Handle
+    Handle::invalid() noexcept {
+      return Handle{std::numeric_limits<unsigned>::max(), 0u};
+    }
+
+    inline
+    bool
+    Handle::valid() const noexcept {
+      return index != std::numeric_limits<unsigned>::max();
+    }
+
+    inline
+    bool
+    Handle::operator==(const Handle& rhs) const noexcept {
+      return index == rhs.index && generation == rhs.generation;
+    }
+
+    inline
+    bool
+    Handle::operator!=(const Handle& rhs) const noexcept {
+      return !operator==(rhs);
+    }
+
+  }
+}
+
+inline
+std::ostream&
+operator<<(std::ostream& out, const tdef::world::Handle& h) noexcept {
+  out << h.index << " " << h.generation << " ";
+  return out;
+}
+
+inline
+std::istream&
+operator>>(std::istream& in, tdef::world::Handle& h) noexcept {
+  in >> h.index;
+  in >> h.generation;
+  return in;
+}
+
+#endif    /* HANDLE_HXX */
@@ -0,0 +1,188 @@
+
+# include "JobPool.hh"
+# include <algorithm>
+
+namespace tdef {
+
+  JobPool::JobPool(unsigned threads):
+    utils::CoreObject("pool"),
+
+    m_queues(),
+    m_workers(),
+
+    m_lock(),
+    m_wake(),
+    m_done(),
+
+    m_batch(0u),
+    m_stop(false),
+
+    m_job(nullptr),
+    m_remaining(0u)
+  {
+    setService("jobs");
+
+    start(threads);
+  }
+
+  JobPool::~JobPool() {
+    stop();
+  }
+
+  void
+  JobPool::resize(unsigned threads) {
+    stop();
+    start(threads);
+  }
+
+  void
+  JobPool::run(unsigned count, const Job& job, unsigned grain) {
+    grain = std::max(grain, 1u);
+
+    // Not worth waking up the workers.
+    if (m_workers.empty() || count < 2u * grain) {
+      for (unsigned id = 0u ; id < count ; ++id) {
+        job(id, 0u);
+      }
+
+      return;
+    }
+
+    unsigned chunks = (count + grain - 1u) / grain;
+
+    m_job = &job;
+    m_remaining.store(chunks);
+
+    // Distribute the chunks to the threads in a round
+    // robin fashion: this gives each thread a similar
+    // share of the items.
+    for (unsigned id = 0u ; id < m_queues.size() ; ++id) {
+      std::lock_guard<std::mutex> guard(m_queues[id]->lock);
+      m_queues[id]->chunks.clear();
+      m_queues[id]->head = 0u;
+      m_queues[id]->tail = 0u;
+    }
+
+    for (unsigned id = 0u ; id < chunks ; ++id) {
+      Queue& q = *m_queues[id % m_queues.size()];
+
+      std::lock_guard<std::mutex> guard(q.lock);
+      q.chunks.push_back(Chunk{id * grain, std::min((id + 1u) * grain, count)});
+      q.tail = q.chunks.size();
+    }
+
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      ++m_batch;
+    }
+    m_wake.notify_all();
+
+    // Help processing and wait for the other threads.
+    process(0u);
+
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_done.wait(guard, [this]{ return m_remaining.load() == 0u; });
+
+    m_job = nullptr;
+  }
+
+  void
+  JobPool::start(unsigned threads) {
+    if (threads == 0u) {
+      threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    m_stop = false;
+
+    m_queues.clear();
+    for (unsigned id = 0u ; id < threads ; ++id) {
+      m_queues.push_back(std::make_unique<Queue>());
+      m_queues.back()->head = 0u;
+      m_queues.back()->tail = 0u;
+    }
+
+    for (unsigned id = 1u ; id < threads ; ++id) {
+      m_workers.push_back(std::thread(&JobPool::loop, this, id));
+    }
+
+    debug("Started pool with " + std::to_string(threads) + " thread(s)");
+  }
+
+  void
+  JobPool::stop() {
+    {
+      std::lock_guard<std::mutex> guard(m_lock);
+      m_stop = true;
+    }
+    m_wake.notify_all();
+
+    for (unsigned id = 0u ; id < m_workers.size() ; ++id) {
+      m_workers[id].join();
+    }
+
+    m_workers.clear();
+  }
+
+  void
+  JobPool::loop(unsigned id) {
+    unsigned seen = 0u;
+
+    while (true) {
+      {
+        std::unique_lock<std::mutex> guard(m_lock);
+        m_wake.wait(guard, [this, &seen]{ return m_stop || m_batch != seen; });
+
+        if (m_stop) {
+          return;
+        }
+
+        seen = m_batch;
+      }
+
+      process(id);
+    }
+  }
+
+  void
+  JobPool::process(unsigned id) {
+    unsigned count = m_queues.size();
+    Chunk c;
+
+    while (true) {
+      // Start with our own queue and then try to steal
+      // from the others.
+      bool found = take(*m_queues[id], true, c);
+      for (unsigned off = 1u ; !found && off < count ; ++off) {
+        found = take(*m_queues[(id + off) % count], false, c);
+      }
+
+      if (!found) {
+        return;
+      }
+
+      for (unsigned item = c.begin ; item < c.end ; ++item) {
+        (*m_job)(item, id);
+      }
+
+      // The last chunk wakes up the calling thread.
+      if (m_remaining.fetch_sub(1u) == 1u) {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_done.notify_all();
+      }
+    }
+  }
+
+  bool
+  JobPool::take(Queue& q, bool own, Chunk& c) {
+    std::lock_guard<std::mutex> guard(q.lock);
+
+    if (q.head >= q.tail) {
+      return false;
+    }
+
+    c = (own ? q.chunks[--q.tail] : q.chunks[q.head++]);
+
+    return true;
+  }
+
+}
@@ -0,0 +1,186 @@
+#ifndef    JOB_POOL_HH
+# define   JOB_POOL_HH
+
+# include <vector>
+# include <memory>
+# include <mutex>
+# include <atomic>
+# include <thread>
+# include <functional>
+# include <condition_variable>
+# include <core_utils/CoreObject.hh>
+
+namespace tdef {
+
+  class JobPool: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Convenience define to refer to a job: it is
+       *          called with the index of the item to process
+       *          and the index of the thread processing it in
+       *          the range `[0; size()[`. The calling thread
+       *          always has index `0`. Jobs should not throw.
+       */
+      using Job = std::function<void(unsigned, unsigned)>;
+
+      /**
+       * @brief - Create a new pool with the specified number of
+       *          threads, including the calling thread. A value
+       *          of `0` sizes the pool to the machine while `1`
+       *          disables the worker threads entirely.
+       * @param threads - the number of threads to use.
+       */
+      explicit
+      JobPool(unsigned threads = 0u);
+
+      /**
+       * @brief - Stops and joins the worker threads.
+       */
+      ~JobPool();
+
+      /**
+       * @brief - Return the number of threads used to run the
+       *          jobs, including the calling thread.
+       * @return - the number of threads.
+       */
+      unsigned
+      size() const noexcept;
+
+      /**
+       * @brief - Change the number of threads of the pool. See
+       *          the constructor for the meaning of the value.
+       *          Should not be called while jobs are running.
+       * @param threads - the number of threads to use.
+       */
+      void
+      resize(unsigned threads);
+
+      /**
+       * @brief - Run the job for all the indices in `[0; count[`
+       *          and wait for all of them to be processed. The
+       *          indices are split in chunks of `grain` items
+       *          distributed to the threads which steal chunks
+       *          from each other once they run out of work. The
+       *          calling thread also processes chunks. In case
+       *          there are not enough items for at least two
+       *          chunks the job is run on the calling thread.
+       * @param count - the number of items to process.
+       * @param job - the job to run for each item.
+       * @param grain - the number of items in a chunk.
+       */
+      void
+      run(unsigned count, const Job& job, unsigned grain = 1u);
+
+    private:
+
+      /**
+       * @brief - A range of items `[begin; end[` to process.
+       */
+      struct Chunk {
+        unsigned begin;
+        unsigned end;
+      };
+
+      /**
+       * @brief - The chunks assigned to a thread. The owner
+       *          takes chunks from the back while the other
+       *          threads steal from the front.
+       */
+      struct Queue {
+        std::mutex lock;
+        std::vector<Chunk> chunks;
+        unsigned head;
+        unsigned tail;
+      };
+
+      /**
+       * @brief - Start the worker threads so that the pool uses
+       *          the specified number of threads.
+       * @param threads - the number of threads to use, `0`
+       *                  meaning as many as the machine has.
+       */
+      void
+      start(unsigned threads);
+
+      /**
+       * @brief - Stop and join all the worker threads.
+       */
+      void
+      stop();
+
+      /**
+       * @brief - The main loop of a worker thread: it waits for
+       *          a new batch of chunks and processes it.
+       * @param id - the index of the queue of the worker.
+       */
+      void
+      loop(unsigned id);
+
+      /**
+       * @brief - Process chunks until none are left, starting
+       *          with the ones of the queue at the specified
+       *          index and stealing from the others.
+       * @param id - the index of the queue to start with.
+       */
+      void
+      process(unsigned id);
+
+      /**
+       * @brief - Take a chunk from the specified queue.
+       * @param q - the queue to take from.
+       * @param own - `true` if the queue belongs to the caller.
+       * @param c - output chunk.
+       * @return - `true` if a chunk was available.
+       */
+      static
+      bool
+      take(Queue& q, bool own, Chunk& c);
+
+    private:
+
+      /**
+       * @brief - One queue per thread, the calling thread uses
+       *          the first one.
+       */
+      std::vector<std::unique_ptr<Queue>> m_queues;
+
+      /**
+       * @brief - The worker threads.
+       */
+      std::vector<std::thread> m_workers;
+
+      /**
+       * @brief - Protects the batch counter and the stop flag
+       *          and is used with the condition variables to
+       *          wake up the workers and the calling thread.
+       */
+      std::mutex m_lock;
+      std::condition_variable m_wake;
+      std::condition_variable m_done;
+
+      /**
+       * @brief - Increased each time a new batch of chunks is
+       *          available for the workers.
+       */
+      unsigned m_batch;
+
+      /**
+       * @brief - Whether the workers should terminate.
+       */
+      bool m_stop;
+
+      /**
+       * @brief - The job of the current batch and the number
+       *          of chunks not yet processed.
+       */
+      const Job* m_job;
+      std::atomic<unsigned> m_remaining;
+  };
+
+  using JobPoolShPtr = std::shared_ptr<JobPool>;
+}
+
+# include "JobPool.hxx"
+
+#endif    /* JOB_POOL_HH */
@@ -0,0 +1,16 @@
+#ifndef    JOB_POOL_HXX
+# define   JOB_POOL_HXX
+
+# include "JobPool.hh"
+
+namespace tdef {
+
+  inline
+  unsigned
+  JobPool::size() const noexcept {
+    return m_queues.size();
+  }
+
+}
+
+#endif    /* JOB_POOL_HXX */
@@ -1,37 +1,244 @@
 
 # include "Locator.hxx"
+# include <cmath>
+# include <algorithm>
+# include <limits>
+# include <memory>
 # include <maths_utils/LocationUtils.hh>
 
+namespace {
+
+  /**
+   * @brief - The maximum coordinate of a cell in the spatial
+   *          indices. Elements further away are registered
+   *          in the cells at the border of the index so that
+   *          a single stray element does not blow up the size
+   *          of the index.
+   */
+  constexpr float max_cell_coord = 256.0f;
+
+  /**
+   * @brief - The distance by which the first obstructed point
+   *          of a segment is moved inside the obstructing block
+   *          to determine the cell it belongs to.
+   */
+  constexpr float obstruction_nudge = 0.001f;
+
+  /**
+   * @brief - The distance by which the half width of a row of
+   *          cells covering a disk is extended so that rounding
+   *          errors do not leave out elements on the border of
+   *          the disk.
+   */
+  constexpr float coverage_margin = 0.001f;
+
+  /**
+   * @brief - Convert the input coordinate to the coordinate of
+   *          the cell containing it for the input cell size.
+   * @param v - the coordinate to convert.
+   * @param size - the size of a cell.
+   * @return - the coordinate of the cell containing `v`.
+   */
+  inline
+  int
+  cellCoord(float v, float size) noexcept {
+    float c = std::floor(v / size);
+    return static_cast<int>(std::min(std::max(c, -max_cell_coord), max_cell_coord));
+  }
+
+
+  /**
+   * @brief - The lists holding the candidates of the queries
+   *          run by the current thread. Each nested query uses
+   *          the list at its depth: the lists are allocated on
+   *          the heap so that they don't move when new ones are
+   *          added.
+   */
+  thread_local std::vector<std::unique_ptr<std::vector<unsigned>>> g_scratch;
+  thread_local unsigned g_scratchDepth = 0u;
+
+  /**
+   * @brief - Fetch the list to use for the query starting at
+   *          the current depth and register the query.
+   * @return - the list, emptied.
+   */
+  std::vector<unsigned>&
+  acquireScratch() noexcept {
+    if (g_scratchDepth >= g_scratch.size()) {
+      g_scratch.push_back(std::make_unique<std::vector<unsigned>>());
+    }
+
+    std::vector<unsigned>& ids = *g_scratch[g_scratchDepth];
+    ++g_scratchDepth;
+
+    ids.clear();
+
+    return ids;
+  }
+
+}
+
 namespace tdef {
 
   Locator::Locator(const std::vector<BlockShPtr>& blocks,
+                   const std::vector<TowerShPtr>& towers,
+                   const std::vector<WallShPtr>& walls,
+                   const std::vector<PortalShPtr>& portals,
+                   const std::vector<SpawnerShPtr>& spawners,
                    const std::vector<MobShPtr>& mobs,
-                   const std::vector<ProjectileShPtr>& projectiles):
+                   const MobStore& store,
+                   const std::vector<ProjectileShPtr>& projectiles,
+                   FlowFieldShPtr field,
+                   PathCacheShPtr cache):
     utils::CoreObject("locator"),
 
     m_blocks(blocks),
+    m_towers(towers),
+    m_walls(walls),
+    m_portals(portals),
+    m_spawners(spawners),
     m_mobs(mobs),
-    m_projectiles(projectiles)
+    m_store(store),
+    m_projectiles(projectiles),
+
+    m_field(field),
+    m_cache(cache),
+    m_epoch(0u),
+
+    m_occupancy(),
+
+    m_blocksIndex(),
+    m_mobsIndex(),
+    m_projectilesIndex()
   {
     setService("locator");
+
+    refreshBlocks();
+    refreshEntities();
+  }
+
+  void
+  Locator::refreshBlocks() noexcept {
+    rebuild(
+      m_blocks.size(),
+      [this](unsigned id) -> const utils::Point2f& {
+        return m_blocks[id]->getPos();
+      },
+      m_blocksIndex
+    );
+    rebuildOccupancy();
+
+    ++m_epoch;
+  }
+
+  void
+  Locator::refreshEntities() noexcept {
+    rebuild(
+      m_mobs.size(),
+      [this](unsigned id) -> const utils::Point2f& {
+        return m_store.pos(id);
+      },
+      m_mobsIndex
+    );
+    rebuild(
+      m_projectiles.size(),
+      [this](unsigned id) -> const utils::Point2f& {
+        return m_projectiles[id]->getPos();
+      },
+      m_projectilesIndex
+    );
+  }
+
+  void
+  Locator::coverage(const utils::Point2f& p,
+                    float r,
+                    std::vector<world::CellSpan>& spans) noexcept
+  {
+    spans.clear();
+
+    if (r < 0.0f) {
+      return;
+    }
+
+    int cxMin = cellCoord(p.x() - r, sk_cellSize);
+    int cxMax = cellCoord(p.x() + r, sk_cellSize);
+    int cyMin = cellCoord(p.y() - r, sk_cellSize);
+    int cyMax = cellCoord(p.y() + r, sk_cellSize);
+
+    for (int y = cyMin ; y <= cyMax ; ++y) {
+      world::CellSpan s{y, cxMin, cxMax};
+
+      // Rows at the border of the index also hold the
+      // elements beyond it: they are kept whole. Other
+      // rows only need the cells within the half width
+      // of the disk at the closest ordinate of the row.
+      if (std::abs(y) < max_cell_coord) {
+        float dy = std::max(std::max(y * sk_cellSize - p.y(), p.y() - (y + 1) * sk_cellSize), 0.0f);
+        float hw = std::sqrt(std::max(r * r - dy * dy, 0.0f)) + coverage_margin;
+
+        s.xMin = std::max(cellCoord(p.x() - hw, sk_cellSize), cxMin);
+        s.xMax = std::min(cellCoord(p.x() + hw, sk_cellSize), cxMax);
+      }
+
+      spans.push_back(s);
+    }
+  }
+
+  bool
+  Locator::occupied(const std::vector<world::CellSpan>& spans) const noexcept {
+    const CellIndex& index = m_mobsIndex;
+
+    for (unsigned id = 0u ; id < spans.size() ; ++id) {
+      const world::CellSpan& s = spans[id];
+      if (s.y < index.yMin || s.y >= index.yMin + index.h) {
+        continue;
+      }
+
+      int xMin = std::max(s.xMin, index.xMin);
+      int xMax = std::min(s.xMax, index.xMin + index.w - 1);
+      if (xMin > xMax) {
+        continue;
+      }
+
+      // The offsets being a prefix sum of the number of
+      // mobs in each cell, the cells of the span hold at
+      // least one mob if the offsets differ.
+      int row = (s.y - index.yMin) * index.w - index.xMin;
+      if (index.offsets[row + xMax + 1] > index.offsets[row + xMin]) {
+        return true;
+      }
+    }
+
+    return false;
   }
 
   WorldElementShPtr
   Locator::itemAt(float x, float y, bool includeMobs) const noexcept {
-    // Search each block and see whether it spans the
-    // input coordinates.
-    unsigned id = 0;
-    while (id < m_blocks.size()) {
-      const utils::Point2f& p = m_blocks[id]->getPos();
-      float hr = m_blocks[id]->getRadius() / 2.0f;
+    // Search each block overlapping the cell of the
+    // input coordinates and see whether it spans it.
+    // Blocks are sorted by ascending index in each
+    // cell so we keep the precedence of a linear
+    // traversal.
+    int c = occupancyCell(x, y);
+
+    if (c >= 0 && (m_occupancy.states[c] & sk_touched) != 0u) {
+      const CellIndex& ci = m_occupancy.blocks;
+
+      for (unsigned i = ci.offsets[c] ; i < ci.offsets[c + 1] ; ++i) {
+        unsigned id = ci.items[i];
+        if (id >= m_blocks.size()) {
+          continue;
+        }
 
-      if (x >= p.x() - hr && x <= p.x() + hr &&
-          y >= p.y() - hr && y <= p.y() + hr)
-      {
-        return m_blocks[id];
-      }
+        const utils::Point2f& p = m_blocks[id]->getPos();
+        float hr = m_blocks[id]->getRadius() / 2.0f;
 
-      ++id;
+        if (x >= p.x() - hr && x <= p.x() + hr &&
+            y >= p.y() - hr && y <= p.y() + hr)
+        {
+          return m_blocks[id];
+        }
+      }
     }
 
     // In case the mobs should not be included, we
@@ -42,9 +249,9 @@ namespace tdef {
 
     // Otherwise follow a similar process to see
     // if a mob spans the input coordinates.
-    id = 0u;
+    unsigned id = 0u;
     while (id < m_mobs.size()) {
-      const utils::Point2f& p = m_mobs[id]->getPos();
+      const utils::Point2f& p = m_store.pos(id);
       float hr = m_mobs[id]->getRadius() / 2.0f;
 
       if (x >= p.x() - hr && x <= p.x() + hr &&
@@ -176,6 +383,104 @@ namespace tdef {
     return obstruction;
   }
 
+  bool
+  Locator::firstObstruction(const utils::Point2f& p,
+                            const utils::Point2f& e,
+                            world::Cell& cell,
+                            utils::Point2f* obs) const noexcept
+  {
+    // This is an implementation of the algorithm described
+    // by Amanatides and Woo in "A Fast Voxel Traversal
+    // Algorithm for Ray Tracing": the segment is described
+    // as `p + t * (e - p)` and we move from one cell to the
+    // next by picking the closest boundary along the `x` or
+    // the `y` axis.
+    float dx = e.x() - p.x();
+    float dy = e.y() - p.y();
+
+    // Similarly to the sampling approach, a segment with
+    // no length is never considered obstructed.
+    if (dx == 0.0f && dy == 0.0f) {
+      return false;
+    }
+
+    int x = static_cast<int>(std::floor(p.x()));
+    int y = static_cast<int>(std::floor(p.y()));
+    int ex = static_cast<int>(std::floor(e.x()));
+    int ey = static_cast<int>(std::floor(e.y()));
+
+    int sx = (dx > 0.0f ? 1 : (dx < 0.0f ? -1 : 0));
+    int sy = (dy > 0.0f ? 1 : (dy < 0.0f ? -1 : 0));
+
+    // `tMx` and `tMy` hold the parameter at which the next
+    // vertical and horizontal boundaries are crossed while
+    // `tDx` and `tDy` hold the parameter needed to cross a
+    // whole cell along each axis.
+    const float inf = std::numeric_limits<float>::infinity();
+
+    float tDx = (sx != 0 ? 1.0f / std::abs(dx) : inf);
+    float tDy = (sy != 0 ? 1.0f / std::abs(dy) : inf);
+
+    float tMx = (sx > 0 ? (x + 1.0f - p.x()) / dx : (sx < 0 ? (x - p.x()) / dx : inf));
+    float tMy = (sy > 0 ? (y + 1.0f - p.y()) / dy : (sy < 0 ? (y - p.y()) / dy : inf));
+
+    float tIn = 0.0f;
+    float t = 0.0f, tEnd = 0.0f;
+    bool found = false;
+
+    while (!found) {
+      float tOut = std::min(std::min(tMx, tMy), 1.0f);
+
+      found = crosses(x, y, p, dx, dy, tIn, tOut, t, tEnd);
+      if (found || (x == ex && y == ey) || tOut >= 1.0f) {
+        break;
+      }
+
+      if (tMx < tMy) {
+        x += sx;
+        tIn = tMx;
+        tMx += tDx;
+      }
+      else if (tMy < tMx) {
+        y += sy;
+        tIn = tMy;
+        tMy += tDy;
+      }
+      else {
+        // The segment goes exactly through the corner of
+        // the cell: the two cells sharing this corner are
+        // only touched at a single point but they should
+        // still be considered.
+        found = crosses(x + sx, y, p, dx, dy, tMx, tMx, t, tEnd) ||
+                crosses(x, y + sy, p, dx, dy, tMy, tMy, t, tEnd);
+
+        x += sx;
+        y += sy;
+        tIn = tMx;
+        tMx += tDx;
+        tMy += tDy;
+      }
+    }
+
+    if (!found) {
+      return false;
+    }
+
+    // Attribute the obstruction to the cell containing a
+    // point slightly inside the obstructing block.
+    float l = std::sqrt(dx * dx + dy * dy);
+    float tc = t + std::min(tEnd - t, obstruction_nudge / l);
+
+    cell.x = static_cast<int>(std::floor(p.x() + tc * dx));
+    cell.y = static_cast<int>(std::floor(p.y() + tc * dy));
+
+    if (obs != nullptr) {
+      *obs = utils::Point2f(p.x() + t * dx, p.y() + t * dy);
+    }
+
+    return true;
+  }
+
   std::vector<world::ItemEntry>
   Locator::getVisible(float xMin,
                       float yMin,
@@ -186,40 +491,61 @@ namespace tdef {
                       world::Sort sort) const noexcept
   {
     std::vector<world::ItemEntry> out;
-    std::vector<SortEntry> entries;
+    getVisible(xMin, yMin, xMax, yMax, out, type, filter, sort);
+
+    return out;
+  }
+
+  std::vector<world::ItemEntry>
+  Locator::getVisible(const utils::Point2f& p,
+                      float r,
+                      const world::ItemType* type,
+                      const world::Filter* filter,
+                      world::Sort sort) const noexcept
+  {
+    std::vector<world::ItemEntry> out;
+    getVisible(p, r, out, type, filter, sort);
+
+    return out;
+  }
+
+  void
+  Locator::getVisible(float xMin,
+                      float yMin,
+                      float xMax,
+                      float yMax,
+                      std::vector<world::ItemEntry>& out,
+                      const world::ItemType* type,
+                      const world::Filter* filter,
+                      world::Sort sort) const noexcept
+  {
+    out.clear();
 
+    Scratch s;
     world::ItemEntry ie;
 
-    // Traverse first the blocks if needed.
+    // Traverse first the blocks if needed. We only
+    // consider the elements registered in the cells
+    // overlapping the view frustum.
     if (type == nullptr || *type == world::ItemType::Block) {
       ie.type = world::ItemType::Block;
 
-      for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      s.ids.clear();
+      candidates(m_blocksIndex, m_blocks.size(), xMin, yMin, xMax, yMax, s.ids);
+
+      for (unsigned i = 0u ; i < s.ids.size() ; ++i) {
+        unsigned id = s.ids[i];
         const utils::Point2f& p = m_blocks[id]->getPos();
 
         if (p.x() < xMin || p.x() > xMax || p.y() < yMin || p.y() > yMax) {
           continue;
         }
 
-        // Check the owner: if the filtering is defined we
-        // we want to reject the item if:
-        //  - the filter says to include the specified id
-        //    and the item's one is different.
-        //  - the filter says to exclude the specified id
-        //    and the item's one is identical.
-        const utils::Uuid& uuid = m_blocks[id]->getOwner();
-        if (filter != nullptr &&
-            (
-              (filter->include && uuid != filter->id) ||
-              (!filter->include && uuid == filter->id)
-            )
-           )
-        {
+        if (!accepts(m_blocks[id]->getOwner(), filter)) {
           continue;
         }
 
         ie.index = id;
-        entries.push_back(SortEntry{p, static_cast<unsigned>(out.size())});
         out.push_back(ie);
       }
     }
@@ -228,27 +554,22 @@ namespace tdef {
     if (type == nullptr || *type == world::ItemType::Mob) {
       ie.type = world::ItemType::Mob;
 
-      for (unsigned id = 0u ; id < m_mobs.size() ; ++id) {
-        const utils::Point2f& p = m_mobs[id]->getPos();
+      s.ids.clear();
+      candidates(m_mobsIndex, m_mobs.size(), xMin, yMin, xMax, yMax, s.ids);
+
+      for (unsigned i = 0u ; i < s.ids.size() ; ++i) {
+        unsigned id = s.ids[i];
+        const utils::Point2f& p = m_store.pos(id);
 
         if (p.x() < xMin || p.x() > xMax || p.y() < yMin || p.y() > yMax) {
           continue;
         }
 
-        // See above for details.
-        const utils::Uuid& uuid = m_mobs[id]->getOwner();
-        if (filter != nullptr &&
-            (
-              (filter->include && uuid != filter->id) ||
-              (!filter->include && uuid == filter->id)
-            )
-           )
-        {
+        if (!accepts(m_mobs[id]->getOwner(), filter)) {
           continue;
         }
 
         ie.index = id;
-        entries.push_back(SortEntry{p, static_cast<unsigned>(out.size())});
         out.push_back(ie);
       }
     }
@@ -257,101 +578,89 @@ namespace tdef {
     if (type == nullptr || *type == world::ItemType::Projectile) {
       ie.type = world::ItemType::Projectile;
 
-      for (unsigned id = 0u ; id < m_projectiles.size() ; ++id) {
+      s.ids.clear();
+      candidates(m_projectilesIndex, m_projectiles.size(), xMin, yMin, xMax, yMax, s.ids);
+
+      for (unsigned i = 0u ; i < s.ids.size() ; ++i) {
+        unsigned id = s.ids[i];
         const utils::Point2f& p = m_projectiles[id]->getPos();
 
         if (p.x() < xMin || p.x() > xMax || p.y() < yMin || p.y() > yMax) {
           continue;
         }
 
-        // See above for details.
-        const utils::Uuid& uuid = m_projectiles[id]->getOwner();
-        if (filter != nullptr &&
-            (
-              (filter->include && uuid != filter->id) ||
-              (!filter->include && uuid == filter->id)
-            )
-           )
-        {
+        if (!accepts(m_projectiles[id]->getOwner(), filter)) {
           continue;
         }
 
         ie.index = id;
-        entries.push_back(SortEntry{p, static_cast<unsigned>(out.size())});
         out.push_back(ie);
       }
     }
 
     // Check whether we need to sort the output
-    // vector.
+    // vector. Note that we will actually always
+    // sort by `z` order: indeed we don't have any
+    // ref point to sort by distance so it would
+    // be pointless anyway.
     if (sort != world::Sort::None) {
-      // Sort the entries by ascending `z` order.
-      auto cmp = [](const SortEntry& lhs, const SortEntry& rhs) {
-        // Note that we will actually always sort by
-        // `z` order: indeed we don't have any ref
-        // point to sort by distance so it would be
-        // pointless anyway.
-        return lhs.p.x() < rhs.p.x() || (lhs.p.x() == rhs.p.x() && lhs.p.y() < rhs.p.y());
+      utils::Point2f ref;
+      auto cmp = [this, &ref](const world::ItemEntry& lhs, const world::ItemEntry& rhs) {
+        return before(world::Sort::ZOrder, ref, position(lhs), position(rhs));
       };
 
-      std::sort(entries.begin(), entries.end(), cmp);
-
-      // Reorder the output vector based on the
-      // result of the sort.
-      std::vector<world::ItemEntry> sorted;
-      sorted.swap(out);
-
-      for (unsigned id = 0u ; id < entries.size() ; ++id) {
-        out.push_back(sorted[entries[id].id]);
-      }
+      std::sort(out.begin(), out.end(), cmp);
     }
-
-    return out;
   }
 
-  std::vector<world::ItemEntry>
+  void
   Locator::getVisible(const utils::Point2f& p,
                       float r,
+                      std::vector<world::ItemEntry>& out,
                       const world::ItemType* type,
                       const world::Filter* filter,
                       world::Sort sort) const noexcept
   {
-    std::vector<world::ItemEntry> out;
-    std::vector<SortEntry> entries;
+    out.clear();
 
+    Scratch s;
     world::ItemEntry ie;
     float r2 = r * r;
 
-    // Traverse first the blocks if needed.
+    // In case the radius is not limited, we need to
+    // consider all the cells of the indices.
+    float lim = (r > 0.0f ? r : std::numeric_limits<float>::infinity());
+
+    // Traverse first the blocks if needed. Note that
+    // the distance is computed from the center of the
+    // block: we need to offset the area accordingly.
     if (type == nullptr || *type == world::ItemType::Block) {
       ie.type = world::ItemType::Block;
 
-      for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      s.ids.clear();
+      candidates(
+        m_blocksIndex,
+        m_blocks.size(),
+        p.x() - 0.5f - lim,
+        p.y() - 0.5f - lim,
+        p.x() - 0.5f + lim,
+        p.y() - 0.5f + lim,
+        s.ids
+      );
+
+      for (unsigned i = 0u ; i < s.ids.size() ; ++i) {
+        unsigned id = s.ids[i];
         const utils::Point2f& bp = m_blocks[id]->getPos();
 
         if (r > 0.0f && utils::d2(bp.x() + 0.5f, bp.y() + 0.5f, p.x(), p.y()) > r2) {
           continue;
         }
 
-        // Check the owner: if the filtering is defined we
-        // we want to reject the item if:
-        //  - the filter says to include the specified id
-        //    and the item's one is different.
-        //  - the filter says to exclude the specified id
-        //    and the item's one is identical.
-        const utils::Uuid& uuid = m_blocks[id]->getOwner();
-        if (filter != nullptr &&
-            (
-              (filter->include && uuid != filter->id) ||
-              (!filter->include && uuid == filter->id)
-            )
-           )
-        {
+        if (!accepts(m_blocks[id]->getOwner(), filter)) {
           continue;
         }
 
         ie.index = id;
-        entries.push_back(SortEntry{bp, static_cast<unsigned>(out.size())});
         out.push_back(ie);
       }
     }
@@ -360,27 +669,22 @@ namespace tdef {
     if (type == nullptr || *type == world::ItemType::Mob) {
       ie.type = world::ItemType::Mob;
 
-      for (unsigned id = 0u ; id < m_mobs.size() ; ++id) {
-        const utils::Point2f& mp = m_mobs[id]->getPos();
+      s.ids.clear();
+      candidates(m_mobsIndex, m_mobs.size(), p.x() - lim, p.y() - lim, p.x() + lim, p.y() + lim, s.ids);
+
+      for (unsigned i = 0u ; i < s.ids.size() ; ++i) {
+        unsigned id = s.ids[i];
+        const utils::Point2f& mp = m_store.pos(id);
 
         if (r > 0.0f && utils::d2(mp.x(), mp.y(), p.x(), p.y()) > r2) {
           continue;
         }
 
-        // See above for details.
-        const utils::Uuid& uuid = m_mobs[id]->getOwner();
-        if (filter != nullptr &&
-            (
-              (filter->include && uuid != filter->id) ||
-              (!filter->include && uuid == filter->id)
-            )
-           )
-        {
+        if (!accepts(m_mobs[id]->getOwner(), filter)) {
           continue;
         }
 
         ie.index = id;
-        entries.push_back(SortEntry{mp, static_cast<unsigned>(out.size())});
         out.push_back(ie);
       }
     }
@@ -389,60 +693,719 @@ namespace tdef {
     if (type == nullptr || *type == world::ItemType::Projectile) {
       ie.type = world::ItemType::Projectile;
 
-      for (unsigned id = 0u ; id < m_projectiles.size() ; ++id) {
+      s.ids.clear();
+      candidates(m_projectilesIndex, m_projectiles.size(), p.x() - lim, p.y() - lim, p.x() + lim, p.y() + lim, s.ids);
+
+      for (unsigned i = 0u ; i < s.ids.size() ; ++i) {
+        unsigned id = s.ids[i];
         const utils::Point2f& pp = m_projectiles[id]->getPos();
 
         if (r > 0.0f && utils::d2(pp.x(), pp.y(), p.x(), p.y()) > r2) {
           continue;
         }
 
-        // See above for details.
-        const utils::Uuid& uuid = m_projectiles[id]->getOwner();
-        if (filter != nullptr &&
-            (
-              (filter->include && uuid != filter->id) ||
-              (!filter->include && uuid == filter->id)
-            )
-           )
-        {
+        if (!accepts(m_projectiles[id]->getOwner(), filter)) {
           continue;
         }
 
         ie.index = id;
-        entries.push_back(SortEntry{pp, static_cast<unsigned>(out.size())});
         out.push_back(ie);
       }
     }
 
     // Check whether we need to sort the output
-    // vector.
+    // vector: the items are sorted in place so
+    // that no additional list is needed.
     if (sort != world::Sort::None) {
-      // Sort the entries by ascending `z` order.
-      auto cmp = [&sort, &p](const SortEntry& lhs, const SortEntry& rhs) {
-        switch (sort) {
-          case world::Sort::Distance:
-            return utils::d(p, lhs.p) < utils::d(p, rhs.p);
-          case world::Sort::ZOrder:
-            // Use `z` order as default sorting alg
-            // in case the input is unknown.
-          default:
-            return lhs.p.x() < rhs.p.x() || (lhs.p.x() == rhs.p.x() && lhs.p.y() < rhs.p.y());
-        }
+      auto cmp = [this, &sort, &p](const world::ItemEntry& lhs, const world::ItemEntry& rhs) {
+        return before(sort, p, position(lhs), position(rhs));
       };
 
-      std::sort(entries.begin(), entries.end(), cmp);
+      std::sort(out.begin(), out.end(), cmp);
+    }
+  }
 
-      // Reorder the output vector based on the
-      // result of the sort.
-      std::vector<world::ItemEntry> sorted;
-      sorted.swap(out);
+  void
+  Locator::getVisibleMobs(const utils::Point2f& p,
+                          float r,
+                          std::vector<Mob*>& out,
+                          const world::Filter* filter,
+                          world::Sort sort) const noexcept
+  {
+    out.clear();
 
-      for (unsigned id = 0u ; id < entries.size() ; ++id) {
-        out.push_back(sorted[entries[id].id]);
+    forEachMobInRadius(p, r, filter,
+      [&out](Mob& m) {
+        out.push_back(&m);
+        return true;
       }
+    );
+
+    if (sort != world::Sort::None) {
+      auto cmp = [&sort, &p](const Mob* lhs, const Mob* rhs) {
+        return before(sort, p, lhs->getPos(), rhs->getPos());
+      };
+
+      std::sort(out.begin(), out.end(), cmp);
     }
+  }
 
-    return out;
+  Block*
+  Locator::nearestBlock(const utils::Point2f& p,
+                        const world::BlockType& type,
+                        float r,
+                        const world::Filter* filter) const noexcept
+  {
+    // In case only a few blocks have the requested
+    // type, checking all of them is faster than the
+    // traversal of the index which holds all blocks.
+    switch (type) {
+      case world::BlockType::Spawner:
+        if (m_spawners.size() <= sk_linearScan) {
+          return closestBlock(m_spawners, p, r, filter);
+        }
+        break;
+      case world::BlockType::Wall:
+        if (m_walls.size() <= sk_linearScan) {
+          return closestBlock(m_walls, p, r, filter);
+        }
+        break;
+      case world::BlockType::Portal:
+        if (m_portals.size() <= sk_linearScan) {
+          return closestBlock(m_portals, p, r, filter);
+        }
+        break;
+      case world::BlockType::Tower:
+        if (m_towers.size() <= sk_linearScan) {
+          return closestBlock(m_towers, p, r, filter);
+        }
+        break;
+    }
+
+    int best = -1;
+    float bestD2 = std::numeric_limits<float>::infinity();
+    float r2 = r * r;
+
+    // The radius is measured from the center of the
+    // blocks while the index uses their position: a
+    // block further than the radius and half of its
+    // diagonal can't be in range.
+    float lim = (r > 0.0f ? r + 1.0f : std::numeric_limits<float>::infinity());
+
+    visitRings(m_blocksIndex, m_blocks.size(), p, lim, bestD2,
+      [this, &p, &type, r, r2, filter, &best, &bestD2](unsigned id) {
+        const Block& b = *m_blocks[id];
+        if (b.getBlockType() != type) {
+          return;
+        }
+
+        const utils::Point2f& bp = b.getPos();
+        if (r > 0.0f && utils::d2(bp.x() + 0.5f, bp.y() + 0.5f, p.x(), p.y()) > r2) {
+          return;
+        }
+
+        if (!accepts(b.getOwner(), filter)) {
+          return;
+        }
+
+        // Cells are not traversed by ascending index so we
+        // need to resolve ties explicitly.
+        float d2 = utils::d2(bp.x(), bp.y(), p.x(), p.y());
+        int i = static_cast<int>(id);
+        if (best < 0 || d2 < bestD2 || (d2 == bestD2 && i < best)) {
+          best = i;
+          bestD2 = d2;
+        }
+      }
+    );
+
+    return (best < 0 ? nullptr : m_blocks[best].get());
+  }
+
+  Mob*
+  Locator::nearestMob(const utils::Point2f& p,
+                      float r,
+                      const world::Filter* filter) const noexcept
+  {
+    int best = -1;
+    float bestD2 = std::numeric_limits<float>::infinity();
+    float r2 = r * r;
+    float lim = (r > 0.0f ? r : std::numeric_limits<float>::infinity());
+
+    visitRings(m_mobsIndex, m_mobs.size(), p, lim, bestD2,
+      [this, &p, r, r2, filter, &best, &bestD2](unsigned id) {
+        const utils::Point2f& mp = m_store.pos(id);
+
+        float d2 = utils::d2(mp.x(), mp.y(), p.x(), p.y());
+        if (r > 0.0f && d2 > r2) {
+          return;
+        }
+
+        if (!accepts(m_mobs[id]->getOwner(), filter)) {
+          return;
+        }
+
+        // See `nearestBlock` for details.
+        int i = static_cast<int>(id);
+        if (best < 0 || d2 < bestD2 || (d2 == bestD2 && i < best)) {
+          best = i;
+          bestD2 = d2;
+        }
+      }
+    );
+
+    return (best < 0 ? nullptr : m_mobs[best].get());
+  }
+
+  void
+  Locator::nearestMobs(const utils::Point2f& p,
+                       unsigned k,
+                       std::vector<Mob*>& out,
+                       float r,
+                       const world::Filter* filter) const noexcept
+  {
+    out.clear();
+
+    if (k == 0u) {
+      return;
+    }
+
+    float bound = std::numeric_limits<float>::infinity();
+    float r2 = r * r;
+    float lim = (r > 0.0f ? r : std::numeric_limits<float>::infinity());
+
+    // The heap holds the indices of the closest mobs found
+    // so far with the furthest one at the top. Ties are
+    // resolved by picking the mob registered first.
+    auto closer = [this, &p](unsigned lhs, unsigned rhs) {
+      const utils::Point2f& lp = m_store.pos(lhs);
+      const utils::Point2f& rp = m_store.pos(rhs);
+
+      float ld2 = utils::d2(lp.x(), lp.y(), p.x(), p.y());
+      float rd2 = utils::d2(rp.x(), rp.y(), p.x(), p.y());
+
+      return ld2 < rd2 || (ld2 == rd2 && lhs < rhs);
+    };
+
+    Scratch s;
+    std::vector<unsigned>& heap = s.ids;
+
+    visitRings(m_mobsIndex, m_mobs.size(), p, lim, bound,
+      [this, &p, k, r, r2, filter, &bound, &heap, &closer](unsigned id) {
+        const utils::Point2f& mp = m_store.pos(id);
+
+        if (r > 0.0f && utils::d2(mp.x(), mp.y(), p.x(), p.y()) > r2) {
+          return;
+        }
+
+        if (!accepts(m_mobs[id]->getOwner(), filter)) {
+          return;
+        }
+
+        if (heap.size() < k) {
+          heap.push_back(id);
+          std::push_heap(heap.begin(), heap.end(), closer);
+        }
+        else if (closer(id, heap.front())) {
+          std::pop_heap(heap.begin(), heap.end(), closer);
+          heap.back() = id;
+          std::push_heap(heap.begin(), heap.end(), closer);
+        }
+        else {
+          return;
+        }
+
+        // Once the heap is full only the mobs closer than
+        // the furthest one are relevant.
+        if (heap.size() == k) {
+          const utils::Point2f& fp = m_store.pos(heap.front());
+          bound = utils::d2(fp.x(), fp.y(), p.x(), p.y());
+        }
+      }
+    );
+
+    std::sort_heap(heap.begin(), heap.end(), closer);
+
+    for (unsigned id = 0u ; id < heap.size() ; ++id) {
+      out.push_back(m_mobs[heap[id]].get());
+    }
+  }
+
+  void
+  Locator::rebuildOccupancy() noexcept {
+    Occupancy& o = m_occupancy;
+    CellIndex& ci = o.blocks;
+
+    o.states.clear();
+    o.masks.clear();
+    ci.offsets.clear();
+    ci.items.clear();
+
+    o.xMin = 0;
+    o.yMin = 0;
+    o.w = 0;
+    o.h = 0;
+
+    if (m_blocks.empty()) {
+      ci.xMin = ci.yMin = ci.w = ci.h = 0;
+      ci.offsets.push_back(0u);
+      return;
+    }
+
+    // Compute the range of cells overlapped by a block.
+    // A position belongs to the cell obtained with the
+    // integer part of its coordinates. As the box of a
+    // block is closed, a block whose edge lies exactly
+    // on the boundary of a cell overlaps it.
+    auto range = [this](unsigned id, int& xMin, int& yMin, int& xMax, int& yMax) {
+      const utils::Point2f& p = m_blocks[id]->getPos();
+      float hr = m_blocks[id]->getRadius() / 2.0f;
+
+      xMin = static_cast<int>(std::floor(p.x() - hr));
+      yMin = static_cast<int>(std::floor(p.y() - hr));
+      xMax = static_cast<int>(std::floor(p.x() + hr));
+      yMax = static_cast<int>(std::floor(p.y() + hr));
+    };
+
+    int xMin = 0, yMin = 0, xMax = 0, yMax = 0;
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      int bxMin, byMin, bxMax, byMax;
+      range(id, bxMin, byMin, bxMax, byMax);
+
+      xMin = (id == 0u ? bxMin : std::min(xMin, bxMin));
+      yMin = (id == 0u ? byMin : std::min(yMin, byMin));
+      xMax = (id == 0u ? bxMax : std::max(xMax, bxMax));
+      yMax = (id == 0u ? byMax : std::max(yMax, byMax));
+    }
+
+    // Add a border of one cell so that cells outside
+    // of the area have only free neighbors.
+    o.xMin = xMin - 1;
+    o.yMin = yMin - 1;
+    o.w = xMax - xMin + 3;
+    o.h = yMax - yMin + 3;
+
+    ci.xMin = o.xMin;
+    ci.yMin = o.yMin;
+    ci.w = o.w;
+    ci.h = o.h;
+
+    std::size_t count = static_cast<std::size_t>(o.w) * o.h;
+    o.states.resize(count, 0u);
+    o.masks.resize(count, 0u);
+    ci.offsets.resize(count + 1u, 0u);
+
+    // Register blocks in the cells they overlap: this
+    // uses the same approach as for spatial indices.
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      int bxMin, byMin, bxMax, byMax;
+      range(id, bxMin, byMin, bxMax, byMax);
+
+      for (int y = byMin ; y <= byMax ; ++y) {
+        for (int x = bxMin ; x <= bxMax ; ++x) {
+          ++ci.offsets[(y - o.yMin) * o.w + x - o.xMin + 1];
+        }
+      }
+    }
+
+    for (unsigned c = 1u ; c < ci.offsets.size() ; ++c) {
+      ci.offsets[c] += ci.offsets[c - 1u];
+    }
+
+    ci.items.resize(ci.offsets.back());
+
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      const utils::Point2f& p = m_blocks[id]->getPos();
+      float hr = m_blocks[id]->getRadius() / 2.0f;
+
+      int bxMin, byMin, bxMax, byMax;
+      range(id, bxMin, byMin, bxMax, byMax);
+
+      for (int y = byMin ; y <= byMax ; ++y) {
+        for (int x = bxMin ; x <= bxMax ; ++x) {
+          int c = (y - o.yMin) * o.w + x - o.xMin;
+
+          ci.items[ci.offsets[c]] = id;
+          ++ci.offsets[c];
+
+          // Update the state of the cell: we use the
+          // same test as in `itemAt`.
+          float cx = x + 0.5f;
+          float cy = y + 0.5f;
+
+          std::uint8_t& s = o.states[c];
+          s |= sk_touched;
+
+          if (cx >= p.x() - hr && cx <= p.x() + hr &&
+              cy >= p.y() - hr && cy <= p.y() + hr)
+          {
+            s |= sk_centerBlocked;
+          }
+
+          if (x >= p.x() - hr && x + 1.0f <= p.x() + hr &&
+              y >= p.y() - hr && y + 1.0f <= p.y() + hr)
+          {
+            s |= sk_covered;
+          }
+        }
+      }
+    }
+
+    for (unsigned c = ci.offsets.size() - 1u ; c > 0u ; --c) {
+      ci.offsets[c] = ci.offsets[c - 1u];
+    }
+    ci.offsets[0] = 0u;
+
+    // Compute the passability of each cell from the
+    // state of its neighbors. The order of neighbors
+    // is described in `passability`.
+    static const int dx[8] = { 0, 1, 1,  1,  0, -1, -1, -1};
+    static const int dy[8] = { 1, 1, 0, -1, -1, -1,  0,  1};
+
+    for (int y = 0 ; y < o.h ; ++y) {
+      for (int x = 0 ; x < o.w ; ++x) {
+        std::uint8_t mask = 0u;
+
+        for (unsigned n = 0u ; n < 8u ; ++n) {
+          int nx = x + dx[n];
+          int ny = y + dy[n];
+
+          bool free = (
+            nx < 0 || nx >= o.w || ny < 0 || ny >= o.h ||
+            (o.states[ny * o.w + nx] & sk_centerBlocked) == 0u
+          );
+
+          if (free) {
+            mask |= (1u << n);
+          }
+        }
+
+        o.masks[y * o.w + x] = mask;
+      }
+    }
+  }
+
+  template <typename Position>
+  void
+  Locator::rebuild(unsigned count,
+                   const Position& position,
+                   CellIndex& index) noexcept
+  {
+    index.items.clear();
+    index.offsets.clear();
+
+    index.xMin = 0;
+    index.yMin = 0;
+    index.w = 0;
+    index.h = 0;
+
+    if (count == 0u) {
+      index.offsets.push_back(0u);
+      return;
+    }
+
+    // Compute the area spanned by the elements.
+    int xMax = 0, yMax = 0;
+    for (unsigned id = 0u ; id < count ; ++id) {
+      const utils::Point2f& p = position(id);
+      int x = cellCoord(p.x(), sk_cellSize);
+      int y = cellCoord(p.y(), sk_cellSize);
+
+      if (id == 0u || x < index.xMin) {
+        index.xMin = x;
+      }
+      if (id == 0u || y < index.yMin) {
+        index.yMin = y;
+      }
+      if (id == 0u || x > xMax) {
+        xMax = x;
+      }
+      if (id == 0u || y > yMax) {
+        yMax = y;
+      }
+    }
+
+    index.w = xMax - index.xMin + 1;
+    index.h = yMax - index.yMin + 1;
+
+    // Count the elements in each cell: we register
+    // the count of the cell `c` at `c + 1` so that
+    // the prefix sum yields the starting offset of
+    // each cell.
+    index.offsets.resize(index.w * index.h + 1, 0u);
+    index.items.resize(count);
+
+    auto cellOf = [&index](const utils::Point2f& p) {
+      int x = cellCoord(p.x(), sk_cellSize) - index.xMin;
+      int y = cellCoord(p.y(), sk_cellSize) - index.yMin;
+
+      return y * index.w + x;
+    };
+
+    for (unsigned id = 0u ; id < count ; ++id) {
+      ++index.offsets[cellOf(position(id)) + 1];
+    }
+
+    for (unsigned c = 1u ; c < index.offsets.size() ; ++c) {
+      index.offsets[c] += index.offsets[c - 1u];
+    }
+
+    // Register each element in its cell. We use the
+    // offsets as insertion cursors: it shifts them
+    // by one cell which we restore afterwards.
+    for (unsigned id = 0u ; id < count ; ++id) {
+      int c = cellOf(position(id));
+      index.items[index.offsets[c]] = id;
+      ++index.offsets[c];
+    }
+
+    for (unsigned c = index.offsets.size() - 1u ; c > 0u ; --c) {
+      index.offsets[c] = index.offsets[c - 1u];
+    }
+    index.offsets[0] = 0u;
+  }
+
+  template <typename Visitor>
+  void
+  Locator::visitRings(const CellIndex& index,
+                      unsigned count,
+                      const utils::Point2f& p,
+                      float lim,
+                      const float& bound,
+                      Visitor&& visitor) noexcept
+  {
+    if (index.w <= 0 || index.h <= 0) {
+      return;
+    }
+
+    int xMax = index.xMin + index.w - 1;
+    int yMax = index.yMin + index.h - 1;
+
+    // Elements far away are registered in the cells at the
+    // border of the index (see `cellCoord`): this does not
+    // break the bounds computed below unless the position
+    // is itself in such a cell. In this case we don't stop
+    // the traversal early.
+    float fx = std::floor(p.x() / sk_cellSize);
+    float fy = std::floor(p.y() / sk_cellSize);
+    bool bounded = (std::abs(fx) < max_cell_coord && std::abs(fy) < max_cell_coord);
+
+    int cx = cellCoord(p.x(), sk_cellSize);
+    int cy = cellCoord(p.y(), sk_cellSize);
+
+    int kMax = std::max(
+      std::max(std::abs(cx - index.xMin), std::abs(cx - xMax)),
+      std::max(std::abs(cy - index.yMin), std::abs(cy - yMax))
+    );
+
+    auto row = [&index, count, &visitor](int y, int xFrom, int xTo) {
+      int off = (y - index.yMin) * index.w - index.xMin;
+
+      for (int x = xFrom ; x <= xTo ; ++x) {
+        int c = off + x;
+
+        for (unsigned id = index.offsets[c] ; id < index.offsets[c + 1] ; ++id) {
+          // Prevent stale indices to be visited in case
+          // the index was not refreshed.
+          if (index.items[id] < count) {
+            visitor(index.items[id]);
+          }
+        }
+      }
+    };
+
+    for (int k = 0 ; k <= kMax ; ++k) {
+      // Visit the cells of the ring restricted to the area
+      // covered by the index: first the top and bottom rows
+      // and then the remaining cells of the columns.
+      int xFrom = std::max(cx - k, index.xMin);
+      int xTo = std::min(cx + k, xMax);
+
+      if (cy - k >= index.yMin && cy - k <= yMax) {
+        row(cy - k, xFrom, xTo);
+      }
+      if (k > 0 && cy + k >= index.yMin && cy + k <= yMax) {
+        row(cy + k, xFrom, xTo);
+      }
+
+      if (k > 0) {
+        int yFrom = std::max(cy - k + 1, index.yMin);
+        int yTo = std::min(cy + k - 1, yMax);
+
+        for (int y = yFrom ; y <= yTo ; ++y) {
+          if (cx - k >= index.xMin && cx - k <= xMax) {
+            row(y, cx - k, cx - k);
+          }
+          if (cx + k >= index.xMin && cx + k <= xMax) {
+            row(y, cx + k, cx + k);
+          }
+        }
+      }
+
+      if (!bounded) {
+        continue;
+      }
+
+      // All the elements that were not visited yet lie out
+      // of the square covered by the rings so far.
+      float d = std::min(
+        std::min(p.x() - (cx - k) * sk_cellSize, (cx + k + 1) * sk_cellSize - p.x()),
+        std::min(p.y() - (cy - k) * sk_cellSize, (cy + k + 1) * sk_cellSize - p.y())
+      );
+
+      if (d > lim || d * d > bound) {
+        return;
+      }
+    }
+  }
+
+  Locator::Scratch::Scratch() noexcept:
+    ids(acquireScratch())
+  {}
+
+  Locator::Scratch::~Scratch() {
+    --g_scratchDepth;
+  }
+
+  void
+  Locator::candidates(const CellIndex& index,
+                      unsigned count,
+                      float xMin,
+                      float yMin,
+                      float xMax,
+                      float yMax,
+                      std::vector<unsigned>& ids) noexcept
+  {
+    if (index.w <= 0 || index.h <= 0 || xMin > xMax || yMin > yMax) {
+      return;
+    }
+
+    // Restrict the area to the cells covered by
+    // the index.
+    int cxMin = std::max(cellCoord(xMin, sk_cellSize), index.xMin);
+    int cyMin = std::max(cellCoord(yMin, sk_cellSize), index.yMin);
+    int cxMax = std::min(cellCoord(xMax, sk_cellSize), index.xMin + index.w - 1);
+    int cyMax = std::min(cellCoord(yMax, sk_cellSize), index.yMin + index.h - 1);
+
+    if (cxMin > cxMax || cyMin > cyMax) {
+      return;
+    }
+
+    // In case the area covers the whole index we
+    // can directly return all the elements.
+    if (cxMin == index.xMin && cxMax == index.xMin + index.w - 1 &&
+        cyMin == index.yMin && cyMax == index.yMin + index.h - 1)
+    {
+      for (unsigned id = 0u ; id < index.items.size() && id < count ; ++id) {
+        ids.push_back(id);
+      }
+
+      return;
+    }
+
+    for (int y = cyMin ; y <= cyMax ; ++y) {
+      int row = (y - index.yMin) * index.w;
+
+      for (int x = cxMin ; x <= cxMax ; ++x) {
+        int c = row + x - index.xMin;
+
+        for (unsigned id = index.offsets[c] ; id < index.offsets[c + 1] ; ++id) {
+          // Prevent stale indices to be returned in
+          // case the index was not refreshed.
+          if (index.items[id] < count) {
+            ids.push_back(index.items[id]);
+          }
+        }
+      }
+    }
+
+    // Preserve the ordering of a linear traversal
+    // of the elements.
+    std::sort(ids.begin(), ids.end());
+  }
+
+  bool
+  Locator::crosses(int x,
+                   int y,
+                   const utils::Point2f& p,
+                   float dx,
+                   float dy,
+                   float tIn,
+                   float tOut,
+                   float& t,
+                   float& tEnd) const noexcept
+  {
+    const Occupancy& o = m_occupancy;
+
+    int cx = x - o.xMin;
+    int cy = y - o.yMin;
+
+    // Cells outside of the occupancy are not close to
+    // any block.
+    if (cx < 0 || cx >= o.w || cy < 0 || cy >= o.h) {
+      return false;
+    }
+
+    int c = cy * o.w + cx;
+    std::uint8_t s = o.states[c];
+
+    if ((s & sk_touched) == 0u) {
+      return false;
+    }
+    if ((s & sk_covered) != 0u) {
+      t = tIn;
+      tEnd = tOut;
+
+      return true;
+    }
+
+    // Intersect the segment with the box of each block
+    // overlapping the cell using the slab method and
+    // keep the first intersection.
+    const CellIndex& ci = o.blocks;
+    bool found = false;
+
+    for (unsigned i = ci.offsets[c] ; i < ci.offsets[c + 1] ; ++i) {
+      unsigned id = ci.items[i];
+
+      const utils::Point2f& bp = m_blocks[id]->getPos();
+      float hr = m_blocks[id]->getRadius() / 2.0f;
+
+      float t0 = tIn;
+      float t1 = 1.0f;
+
+      auto clip = [&t0, &t1](float s, float d, float lo, float hi) {
+        if (d == 0.0f) {
+          return s >= lo && s <= hi;
+        }
+
+        float ta = (lo - s) / d;
+        float tb = (hi - s) / d;
+        if (ta > tb) {
+          std::swap(ta, tb);
+        }
+
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+
+        return t0 <= t1;
+      };
+
+      if (!clip(p.x(), dx, bp.x() - hr, bp.x() + hr) ||
+          !clip(p.y(), dy, bp.y() - hr, bp.y() + hr) ||
+          t0 > tOut)
+      {
+        continue;
+      }
+
+      if (!found || t0 < t) {
+        t = t0;
+        tEnd = t1;
+        found = true;
+      }
+    }
+
+    return found;
   }
 
 }
@@ -2,11 +2,14 @@
 # define   LOCATOR_HH
 
 # include <memory>
+# include <vector>
+# include <cstdint>
 # include <unordered_set>
 # include <core_utils/CoreObject.hh>
 # include "Block.hh"
 # include "Mob.hh"
 # include "Projectile.hh"
+# include "CellSpan.hh"
 
 namespace tdef {
   namespace world {
@@ -32,17 +35,6 @@ namespace tdef {
       Projectile
     };
 
-    /**
-     * @brief - Defines the possible types for a block
-     *          in the world.
-     */
-    enum class BlockType {
-      Spawner,
-      Wall,
-      Portal,
-      Tower,
-    };
-
     /**
      * @brief - Convenience wrapper allowing to access the
      *          properties of a block.
@@ -83,6 +75,10 @@ namespace tdef {
       // Position of the mob.
       utils::Point2f p;
 
+      // Position of the mob at the beginning of the last
+      // simulation step.
+      utils::Point2f prev;
+
       // The radius of the mob.
       float radius;
 
@@ -113,6 +109,7 @@ namespace tdef {
      */
     struct Projectile {
       utils::Point2f p;
+      utils::Point2f prev;
     };
 
     /**
@@ -144,10 +141,19 @@ namespace tdef {
   using WorldElementShPtr = std::shared_ptr<WorldElement>;
   class Block;
   class Wall;
+  using WallShPtr = std::shared_ptr<Wall>;
   class Spawner;
+  using SpawnerShPtr = std::shared_ptr<Spawner>;
   class Portal;
+  using PortalShPtr = std::shared_ptr<Portal>;
+  class Tower;
+  using TowerShPtr = std::shared_ptr<Tower>;
   class Mob;
   class Projectile;
+  class FlowField;
+  using FlowFieldShPtr = std::shared_ptr<FlowField>;
+  class PathCache;
+  using PathCacheShPtr = std::shared_ptr<PathCache>;
 
   class Locator: public utils::CoreObject {
     public:
@@ -163,12 +169,84 @@ namespace tdef {
        *          elements through the dedicated interface.
        * @param blocks - the list of tiles registered in the
        *                 world.
+       * @param towers - the towers among the blocks.
+       * @param walls - the walls among the blocks.
+       * @param portals - the portals among the blocks.
+       * @param spawners - the spawners among the blocks.
        * @param mobs - the list of mobs of the world.
+       * @param store - the store holding the state of the mobs,
+       *                where the slot of each mob is its index
+       *                in the list of mobs.
        * @param projectiles - the projectiles of the world.
+       * @param field - the flow field leading to the portals
+       *                of the world.
+       * @param cache - the cache of paths computed in the world.
        */
       Locator(const std::vector<BlockShPtr>& blocks,
+              const std::vector<TowerShPtr>& towers,
+              const std::vector<WallShPtr>& walls,
+              const std::vector<PortalShPtr>& portals,
+              const std::vector<SpawnerShPtr>& spawners,
               const std::vector<MobShPtr>& mobs,
-              const std::vector<ProjectileShPtr>& projectiles);
+              const MobStore& store,
+              const std::vector<ProjectileShPtr>& projectiles,
+              FlowFieldShPtr field,
+              PathCacheShPtr cache);
+
+      /**
+       * @brief - Return the flow field describing the distance
+       *          to the closest portal from any cell.
+       * @return - the flow field of the world.
+       */
+      FlowFieldShPtr
+      flowField() const noexcept;
+
+      /**
+       * @brief - Return the cache allowing to reuse paths which
+       *          have already been computed.
+       * @return - the path cache of the world.
+       */
+      PathCacheShPtr
+      pathCache() const noexcept;
+
+      /**
+       * @brief - Return a counter incremented each time the
+       *          blocks of the world change. Any information
+       *          derived from the layout of the world can be
+       *          tagged with this value to detect when it is
+       *          outdated.
+       * @return - the current obstacle epoch.
+       */
+      unsigned
+      obstaclesEpoch() const noexcept;
+
+      /**
+       * @brief - Return the towers registered in the world.
+       * @return - the list of towers.
+       */
+      const std::vector<TowerShPtr>&
+      towers() const noexcept;
+
+      /**
+       * @brief - Return the walls registered in the world.
+       * @return - the list of walls.
+       */
+      const std::vector<WallShPtr>&
+      walls() const noexcept;
+
+      /**
+       * @brief - Return the portals registered in the world.
+       * @return - the list of portals.
+       */
+      const std::vector<PortalShPtr>&
+      portals() const noexcept;
+
+      /**
+       * @brief - Return the spawners registered in the world.
+       * @return - the list of spawners.
+       */
+      const std::vector<SpawnerShPtr>&
+      spawners() const noexcept;
 
       /**
        * @brief - Retrieve the tile at the specified index. Note
@@ -257,6 +335,23 @@ namespace tdef {
       bool
       obstructed(const utils::Point2f& p) const noexcept;
 
+      /**
+       * @brief - Return a mask describing which of the eight
+       *          neighbors of the cell containing the input
+       *          position are free. A neighbor is free when
+       *          its center is not obstructed by a block.
+       *          The bit `i` of the mask describes the `i`-th
+       *          neighbor where neighbors are listed starting
+       *          from the north (increasing ordinates) and in
+       *          clockwise order: `N, NE, E, SE, S, SW, W, NW`.
+       *          This method runs in constant time.
+       * @param p - the position for which the neighbors of the
+       *            containing cell should be checked.
+       * @return - the passability mask of the cell.
+       */
+      std::uint8_t
+      passability(const utils::Point2f& p) const noexcept;
+
       /**
        * @brief - Determine whether the path defined by the
        *          input coordinate and the direction has any
@@ -320,6 +415,48 @@ namespace tdef {
                  float sample = 0.05f,
                  bool allowLog = false) const noexcept;
 
+      /**
+       * @brief - Determine whether the segment joining `p` and
+       *          `e` can be traversed without crossing a block.
+       *          Unlike the `obstructed` method, the segment is
+       *          not sampled: each cell crossed by the segment
+       *          is visited exactly once and only the cells that
+       *          are partially covered by a block require an
+       *          exact intersection test. When the segment goes
+       *          exactly through the corner of a cell, both of
+       *          the cells sharing this corner are visited.
+       *          Similarly to `obstructed`, the boxes of blocks
+       *          are considered closed.
+       * @param p - the starting point of the segment.
+       * @param e - the end point of the segment.
+       * @return - `true` if the segment is not obstructed.
+       */
+      bool
+      lineOfSight(const utils::Point2f& p, const utils::Point2f& e) const noexcept;
+
+      /**
+       * @brief - Similar to the `lineOfSight` method but also
+       *          returns the cell containing the first point of
+       *          the segment which is obstructed. This point is
+       *          assigned to a cell by moving it slightly inside
+       *          the obstructing block so that an obstruction
+       *          starting on the edge of a cell is attributed to
+       *          the cell of the block.
+       * @param p - the starting point of the segment.
+       * @param e - the end point of the segment.
+       * @param cell - output argument receiving the first cell
+       *               obstructed along the segment. Only relevant
+       *               if the return value is `true`.
+       * @param obs - if not `null` will output the position of
+       *              the first obstruction.
+       * @return - `true` if the segment is obstructed.
+       */
+      bool
+      firstObstruction(const utils::Point2f& p,
+                       const utils::Point2f& e,
+                       world::Cell& cell,
+                       utils::Point2f* obs = nullptr) const noexcept;
+
       /**
        * @brief - Return the list of items that are visible
        *          in the view frustum defined by the AABB
@@ -410,7 +547,8 @@ namespace tdef {
       /**
        * @brief - Specialization of the `getVisible` method
        *          to fetch visible blocks in a certain area
-       *          and return this as a list of blocks.
+       *          and return this as a list of blocks. Only
+       *          the blocks of the requested type are walked.
        * @param p - the position of the center of the area to
        *            consider.
        * @param r - the radius of the area to consider.
@@ -450,66 +588,625 @@ namespace tdef {
                      world::Sort sort = world::Sort::None) const noexcept;
 
       /**
-       * @brief - Similar to the `getVisible` but only returns
-       *          the closest block from the total visible list.
-       * @param p - the position of the center of the area to
-       *            consider.
+       * @brief - Return the closest block of the input type from
+       *          the position. The distance is computed from the
+       *          position of the blocks and ties are resolved by
+       *          picking the block registered first in the world.
+       *          In case only a few blocks have the input type
+       *          they are all checked, otherwise the cells of the
+       *          spatial index are walked ring by ring around the
+       *          position until no closer block can exist.
+       * @param p - the position from which the distance should be
+       *            computed.
        * @param type - the type of block to fetch.
-       * @param r - a limit for the radius for entities to be
-       *            considered.
-       * @param filters - include a description of a uuid and
-       *                  whether or not it should be used
-       *                  and considered when fetching items.
-       * @return - the list of blocks.
+       * @param r - a limit for the radius for blocks to be
+       *            considered, measured from their center, or a
+       *            negative value if there's no limit.
+       * @param filter - the filter on the owner of the blocks.
+       * @return - the closest block or `null` if none is in the
+       *           area.
        */
-      BlockShPtr
-      getClosestBlock(const utils::Point2f& p,
-                      const world::BlockType& type,
-                      float r = -1.0f,
-                      const world::Filter* filter = nullptr) const noexcept;
+      Block*
+      nearestBlock(const utils::Point2f& p,
+                   const world::BlockType& type,
+                   float r = -1.0f,
+                   const world::Filter* filter = nullptr) const noexcept;
 
       /**
-       * @brief - Similar to the `getVisible` but only returns
-       *          the closest entity from the total visible list.
-       * @param p - the position of the center of the area to
-       *            consider.
-       * @param r - a limit for the radius for entities to be
-       *            considered.
-       * @param filters - include a description of a uuid and
-       *                  whether or not it should be used
-       *                  and considered when fetching items.
-       * @return - the list of entities.
+       * @brief - Return the closest mob from the position. Ties
+       *          are resolved by picking the mob registered first
+       *          in the world. The cells of the spatial index are
+       *          walked ring by ring around the position and the
+       *          search stops as soon as no closer mob can exist.
+       * @param p - the position from which the distance should be
+       *            computed.
+       * @param r - a limit for the radius for mobs to be considered
+       *            or a negative value if there's no limit.
+       * @param filter - the filter on the owner of the mobs.
+       * @return - the closest mob or `null` if none is in the area.
        */
-      MobShPtr
-      getClosestMob(const utils::Point2f& p,
-                    float r = -1.0f,
-                    const world::Filter* filter = nullptr) const noexcept;
+      Mob*
+      nearestMob(const utils::Point2f& p,
+                 float r = -1.0f,
+                 const world::Filter* filter = nullptr) const noexcept;
+
+      /**
+       * @brief - Similar to `nearestMob` but returns the `k` mobs
+       *          closest to the position, sorted by ascending
+       *          distance. The mobs found so far are kept in a
+       *          heap bounded to `k` elements so that the search
+       *          can stop once the `k`-th distance is certain.
+       * @param p - the position from which the distance should be
+       *            computed.
+       * @param k - the maximum number of mobs to return.
+       * @param out - output list receiving the mobs. It is cleared
+       *              beforehand.
+       * @param r - a limit for the radius for mobs to be considered
+       *            or a negative value if there's no limit.
+       * @param filter - the filter on the owner of the mobs.
+       */
+      void
+      nearestMobs(const utils::Point2f& p,
+                  unsigned k,
+                  std::vector<Mob*>& out,
+                  float r = -1.0f,
+                  const world::Filter* filter = nullptr) const noexcept;
+
+      /**
+       * @brief - Similar to the `getVisible` method but writes
+       *          the items in the input list rather than in a
+       *          new one. The list is cleared beforehand: this
+       *          allows the caller to reuse it across queries
+       *          so that no allocation happens once it is large
+       *          enough. The order of the items is the same as
+       *          the one of the `getVisible` method.
+       * @param xMin - the abscissa of the top left corner of the
+       *               view frustum.
+       * @param yMin - the ordinate of the top left corner of the
+       *               view frustum.
+       * @param xMax - the abscissa of the bottom right corner of
+       *               the view frustum.
+       * @param yMax - the ordinate of the bottom right corner of
+       *               the view frustum.
+       * @param out - output list receiving the visible items.
+       * @param type - the type of elements to consider or `null`
+       *               to include all of them.
+       * @param filter - the filter on the owner of the items.
+       * @param sort - the algorithm to use to sort the items.
+       */
+      void
+      getVisible(float xMin,
+                 float yMin,
+                 float xMax,
+                 float yMax,
+                 std::vector<world::ItemEntry>& out,
+                 const world::ItemType* type = nullptr,
+                 const world::Filter* filter = nullptr,
+                 world::Sort sort = world::Sort::None) const noexcept;
+
+      /**
+       * @brief - Similar to the `getVisible` method for a circle
+       *          but writes the items in the input list which is
+       *          cleared beforehand.
+       * @param p - the center of the area.
+       * @param r - the radius of the area or a negative value if
+       *            there's no limit to the distance.
+       * @param out - output list receiving the visible items.
+       * @param type - the type of elements to consider or `null`
+       *               to include all of them.
+       * @param filter - the filter on the owner of the items.
+       * @param sort - the algorithm to use to sort the items.
+       */
+      void
+      getVisible(const utils::Point2f& p,
+                 float r,
+                 std::vector<world::ItemEntry>& out,
+                 const world::ItemType* type = nullptr,
+                 const world::Filter* filter = nullptr,
+                 world::Sort sort = world::Sort::None) const noexcept;
+
+      /**
+       * @brief - Similar to the `getVisibleMobs` method but writes
+       *          the mobs in the input list which is cleared first.
+       *          The mobs are referenced through raw pointers so
+       *          that no reference counting happens: they remain
+       *          valid until the mobs are removed from the world.
+       * @param p - the center of the area.
+       * @param r - the radius of the area or a negative value if
+       *            there's no limit to the distance.
+       * @param out - output list receiving the visible mobs.
+       * @param filter - the filter on the owner of the mobs.
+       * @param sort - the algorithm to use to sort the mobs.
+       */
+      void
+      getVisibleMobs(const utils::Point2f& p,
+                     float r,
+                     std::vector<Mob*>& out,
+                     const world::Filter* filter = nullptr,
+                     world::Sort sort = world::Sort::None) const noexcept;
+
+      /**
+       * @brief - Call the input visitor on each mob lying within
+       *          the input radius of the position. Mobs are given
+       *          by ascending index, which is the order in which
+       *          `getVisibleMobs` returns them when they are not
+       *          sorted. No list is built in the process.
+       *          The visitor receives the mob and returns `false`
+       *          to stop the traversal early. It is allowed to
+       *          modify the mob but not to add or remove mobs of
+       *          the world.
+       * @param p - the center of the area.
+       * @param r - the radius of the area or a negative value if
+       *            there's no limit to the distance.
+       * @param filter - the filter on the owner of the mobs.
+       * @param visitor - the callable to invoke on each mob.
+       */
+      template <typename Visitor>
+      void
+      forEachMobInRadius(const utils::Point2f& p,
+                         float r,
+                         const world::Filter* filter,
+                         Visitor&& visitor) const noexcept;
+
+      /**
+       * @brief - Similar to `forEachMobInRadius` but visits the
+       *          blocks whose position lies in the input area.
+       *          This is the same criterion as the one used by
+       *          the `getVisible` method.
+       * @param xMin - the minimum abscissa of the area.
+       * @param yMin - the minimum ordinate of the area.
+       * @param xMax - the maximum abscissa of the area.
+       * @param yMax - the maximum ordinate of the area.
+       * @param filter - the filter on the owner of the blocks.
+       * @param visitor - the callable to invoke on each block.
+       */
+      template <typename Visitor>
+      void
+      forEachBlockInRect(float xMin,
+                         float yMin,
+                         float xMax,
+                         float yMax,
+                         const world::Filter* filter,
+                         Visitor&& visitor) const noexcept;
+
+      /**
+       * @brief - Used to rebuild the spatial index of blocks.
+       *          It should be called whenever a block is added
+       *          or removed from the world, as blocks do not
+       *          move otherwise.
+       */
+      void
+      refreshBlocks() noexcept;
+
+      /**
+       * @brief - Used to rebuild the spatial index of mobs and
+       *          projectiles. It should be called whenever the
+       *          entities have moved or whenever some of them
+       *          have been added or removed from the world.
+       */
+      void
+      refreshEntities() noexcept;
+
+      /**
+       * @brief - Used to compute the cells of the spatial indices
+       *          overlapping the disk of radius `r` centered at
+       *          the input position. The cells of each row are
+       *          described by a single span.
+       * @param p - the center of the disk.
+       * @param r - the radius of the disk.
+       * @param spans - output list holding the spans covering
+       *                the disk. It is cleared first.
+       */
+      static
+      void
+      coverage(const utils::Point2f& p,
+               float r,
+               std::vector<world::CellSpan>& spans) noexcept;
+
+      /**
+       * @brief - Used to determine whether at least one mob lies
+       *          in the input cells as of the last refresh of the
+       *          entities. The number of mobs in each span is read
+       *          from the offsets of the index in constant time.
+       * @param spans - the cells to check.
+       * @return - `true` if at least one mob lies in the cells.
+       */
+      bool
+      occupied(const std::vector<world::CellSpan>& spans) const noexcept;
 
     private:
 
       /**
-       * @brief - Define a convenience structure to perform the
-       *          sorting of tiles and entities.
+       * @brief - Convenience structure describing a uniform grid
+       *          where each cell references the indices of the
+       *          elements whose position lies in it.
+       *          The indices are stored in a single array with
+       *          the elements of a cell being contiguous: the
+       *          `offsets` array describes where each cell is
+       *          starting in the `items` array. The elements in
+       *          a cell are sorted by ascending index.
        */
-      struct SortEntry {
-        utils::Point2f p;
-        unsigned id;
+      struct CellIndex {
+        // The coordinates of the cell at the top left corner
+        // of the area covered by the index.
+        int xMin;
+        int yMin;
+
+        // The dimensions of the area covered by the index in
+        // cells.
+        int w;
+        int h;
+
+        // Defines the starting position of each cell in the
+        // `items` array. Contains `w * h + 1` entries.
+        std::vector<unsigned> offsets;
+
+        // The indices of the elements registered in each cell.
+        std::vector<unsigned> items;
+      };
+
+      /**
+       * @brief - Convenience structure describing the cells that
+       *          are occupied by blocks. It covers all the cells
+       *          overlapped by blocks and an additional border
+       *          of one cell around them so that passability of
+       *          cells outside of it is trivial.
+       *          Cells have a size of `1` and are indexed by the
+       *          integer part of the coordinates.
+       */
+      struct Occupancy {
+        // The coordinates of the top left cell of the area.
+        int xMin;
+        int yMin;
+
+        // The dimensions of the area in cells.
+        int w;
+        int h;
+
+        // The state of each cell as a combination of the flags
+        // defined in the locator.
+        std::vector<std::uint8_t> states;
+
+        // The passability mask of each cell.
+        std::vector<std::uint8_t> masks;
+
+        // The blocks overlapping each cell, in a similar way to
+        // what is done for the spatial indices.
+        CellIndex blocks;
+      };
+
+      /**
+       * @brief - Used to rebuild the occupancy of cells from the
+       *          blocks registered in the world.
+       */
+      void
+      rebuildOccupancy() noexcept;
+
+      /**
+       * @brief - Used to fetch the index in the occupancy of the
+       *          cell containing the input coordinates or `-1`
+       *          in case it is outside of the area.
+       * @param x - the abscissa of the position.
+       * @param y - the ordinate of the position.
+       * @return - the index of the cell in the occupancy.
+       */
+      int
+      occupancyCell(float x, float y) const noexcept;
+
+      /**
+       * @brief - Used to determine whether the segment starting
+       *          at `p` and going along `dx` and `dy` intersects
+       *          one of the blocks overlapping the input cell
+       *          for a parameter in the range `[tIn, tOut]`.
+       * @param x - the abscissa of the cell.
+       * @param y - the ordinate of the cell.
+       * @param p - the starting point of the segment.
+       * @param dx - the extent of the segment along the `x` axis.
+       * @param dy - the extent of the segment along the `y` axis.
+       * @param tIn - the parameter at which the segment enters
+       *              the cell.
+       * @param tOut - the parameter at which the segment leaves
+       *               the cell.
+       * @param t - output argument receiving the parameter of the
+       *            first obstructed point in the cell.
+       * @param tEnd - output argument receiving the parameter at
+       *               which the segment leaves the obstructing
+       *               block.
+       * @return - `true` if the segment is obstructed in the cell.
+       */
+      bool
+      crosses(int x,
+              int y,
+              const utils::Point2f& p,
+              float dx,
+              float dy,
+              float tIn,
+              float tOut,
+              float& t,
+              float& tEnd) const noexcept;
+
+      /**
+       * @brief - Used to rebuild the input index from a list of
+       *          elements. Each element is registered in the cell
+       *          that contains its position.
+       * @param count - the number of elements to index.
+       * @param position - a function returning the position of
+       *                   the element at the input index.
+       * @param index - the index to rebuild.
+       */
+      template <typename Position>
+      static
+      void
+      rebuild(unsigned count,
+              const Position& position,
+              CellIndex& index) noexcept;
+
+      /**
+       * @brief - Used to fetch the indices of the elements that
+       *          are registered in cells overlapping the input
+       *          area. Note that it does not mean that all the
+       *          elements are actually in the area: the caller
+       *          should refine the selection. The output list
+       *          is sorted by ascending index.
+       * @param index - the index to query.
+       * @param count - the total number of elements in the index.
+       * @param xMin - the minimum abscissa of the area.
+       * @param yMin - the minimum ordinate of the area.
+       * @param xMax - the maximum abscissa of the area.
+       * @param yMax - the maximum ordinate of the area.
+       * @param ids - output vector where indices are registered.
+       */
+      static
+      void
+      candidates(const CellIndex& index,
+                 unsigned count,
+                 float xMin,
+                 float yMin,
+                 float xMax,
+                 float yMax,
+                 std::vector<unsigned>& ids) noexcept;
+
+      /**
+       * @brief - Convenience class providing a list to hold the
+       *          candidates of a query. The lists are kept from
+       *          one query to the next one on each thread so
+       *          that they don't need to be allocated again.
+       *          Each nested query (for example from a visitor)
+       *          uses its own list.
+       */
+      class Scratch {
+        public:
+
+          Scratch() noexcept;
+
+          ~Scratch();
+
+          /**
+           * @brief - The list of candidates, initially empty.
+           */
+          std::vector<unsigned>& ids;
       };
 
+      /**
+       * @brief - Used to determine whether an element owned by
+       *          the input uuid passes the filter. The filter
+       *          rejects an element if:
+       *            - it says to include the specified id and the
+       *              element's one is different.
+       *            - it says to exclude the specified id and the
+       *              element's one is identical.
+       * @param uuid - the owner of the element.
+       * @param filter - the filter or `null` if none is defined.
+       * @return - `true` if the element should be kept.
+       */
+      static
+      bool
+      accepts(const utils::Uuid& uuid, const world::Filter* filter) noexcept;
+
+      /**
+       * @brief - Used to determine whether the element at `lhs`
+       *          should come before the one at `rhs` for the input
+       *          sort algorithm.
+       * @param sort - the sort algorithm.
+       * @param p - the reference position for the distance.
+       * @param lhs - the position of the first element.
+       * @param rhs - the position of the second element.
+       * @return - `true` if `lhs` comes first.
+       */
+      static
+      bool
+      before(world::Sort sort,
+             const utils::Point2f& p,
+             const utils::Point2f& lhs,
+             const utils::Point2f& rhs) noexcept;
+
+      /**
+       * @brief - Used to fetch the position of the item described
+       *          by the input entry.
+       * @param ie - the entry of the item.
+       * @return - the position of the item.
+       */
+      const utils::Point2f&
+      position(const world::ItemEntry& ie) const noexcept;
+
+      /**
+       * @brief - Used to collect the blocks of the input list
+       *          that are visible from the input position. The
+       *          blocks are appended to the output list.
+       * @param blocks - the blocks to traverse, all of them with
+       *                 the same type.
+       * @param p - the position of the center of the area.
+       * @param r - the radius of the area or a negative value
+       *            if there's no limit.
+       * @param filter - the filter on the owner of the blocks.
+       * @param sort - the sort algorithm to use.
+       * @param out - the output list of blocks.
+       */
+      template <typename Element>
+      static
+      void
+      visibleBlocks(const std::vector<std::shared_ptr<Element>>& blocks,
+                    const utils::Point2f& p,
+                    float r,
+                    const world::Filter* filter,
+                    world::Sort sort,
+                    std::vector<BlockShPtr>& out) noexcept;
+
+      /**
+       * @brief - Used to find the closest block of the input
+       *          list from the input position by checking all
+       *          of them.
+       * @param blocks - the blocks to traverse, all of them with
+       *                 the same type.
+       * @param p - the position from which the distance should
+       *            be computed.
+       * @param r - the maximum distance or a negative value if
+       *            there's no limit.
+       * @param filter - the filter on the owner of the blocks.
+       * @return - the closest block or `null` if none is in the
+       *           area.
+       */
+      template <typename Element>
+      static
+      Block*
+      closestBlock(const std::vector<std::shared_ptr<Element>>& blocks,
+                   const utils::Point2f& p,
+                   float r,
+                   const world::Filter* filter) noexcept;
+
+      /**
+       * @brief - Used to call the input visitor on the indices of
+       *          the elements registered in the cells of the index
+       *          by rings of increasing size around the position.
+       *          After each ring the traversal stops in case all
+       *          the elements that were not visited yet are more
+       *          than `lim` away or have a squared distance larger
+       *          than `bound`. The visitor is expected to update
+       *          the bound as it finds elements.
+       *          Elements are not visited by ascending index.
+       * @param index - the index to traverse.
+       * @param count - the total number of elements in the index.
+       * @param p - the position around which the rings are built.
+       * @param lim - the distance beyond which elements are not
+       *              relevant.
+       * @param bound - the squared distance that elements should
+       *                be under to be relevant.
+       * @param visitor - the callable invoked on each index.
+       */
+      template <typename Visitor>
+      static
+      void
+      visitRings(const CellIndex& index,
+                 unsigned count,
+                 const utils::Point2f& p,
+                 float lim,
+                 const float& bound,
+                 Visitor&& visitor) noexcept;
+
       /**
        * @brief - The blocks registered in the world.
        */
       const std::vector<BlockShPtr>& m_blocks;
 
+      /**
+       * @brief - The blocks of the world split by type. Each list
+       *          keeps the relative order of the blocks.
+       */
+      const std::vector<TowerShPtr>& m_towers;
+      const std::vector<WallShPtr>& m_walls;
+      const std::vector<PortalShPtr>& m_portals;
+      const std::vector<SpawnerShPtr>& m_spawners;
+
       /**
        * @brief - The mobs registered in the world.
        */
       const std::vector<MobShPtr>& m_mobs;
 
+      /**
+       * @brief - The store holding the state of the mobs. The
+       *          positions of the mobs are read from there so
+       *          that the queries don't need to go through each
+       *          mob.
+       */
+      const MobStore& m_store;
+
       /**
        * @brief - The projectiles registered in the world.
        */
       const std::vector<ProjectileShPtr>& m_projectiles;
+
+      /**
+       * @brief - The flow field leading to the portals. It is
+       *          maintained by the world.
+       */
+      FlowFieldShPtr m_field;
+
+      /**
+       * @brief - The cache of paths computed in the world.
+       */
+      PathCacheShPtr m_cache;
+
+      /**
+       * @brief - The obstacle epoch, incremented each time the
+       *          blocks are refreshed.
+       */
+      unsigned m_epoch;
+
+      /**
+       * @brief - The dimensions of a cell of the spatial indices
+       *          in world units. It should be large enough so
+       *          that a typical range query only spans a few
+       *          cells.
+       */
+      static constexpr float sk_cellSize = 2.0f;
+
+      /**
+       * @brief - The number of blocks of a type below which the
+       *          closest one is found by checking all of them
+       *          rather than walking the spatial index.
+       */
+      static constexpr unsigned sk_linearScan = 16u;
+
+      /**
+       * @brief - Flag indicating that the center of a cell is
+       *          obstructed by a block.
+       */
+      static constexpr std::uint8_t sk_centerBlocked = 1u;
+
+      /**
+       * @brief - Flag indicating that a cell is entirely covered
+       *          by a block.
+       */
+      static constexpr std::uint8_t sk_covered = 2u;
+
+      /**
+       * @brief - Flag indicating that a cell is at least partially
+       *          covered by a block.
+       */
+      static constexpr std::uint8_t sk_touched = 4u;
+
+      /**
+       * @brief - The occupancy of cells by blocks. It is rebuilt
+       *          along with the spatial index of blocks.
+       */
+      Occupancy m_occupancy;
+
+      /**
+       * @brief - The spatial index for blocks. It is only rebuilt
+       *          when blocks are added or removed.
+       */
+      CellIndex m_blocksIndex;
+
+      /**
+       * @brief - The spatial index for mobs. It is rebuilt each
+       *          time the mobs move.
+       */
+      CellIndex m_mobsIndex;
+
+      /**
+       * @brief - The spatial index for projectiles.
+       */
+      CellIndex m_projectilesIndex;
   };
 
   using LocatorShPtr = std::shared_ptr<Locator>;
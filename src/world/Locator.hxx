@@ -3,76 +3,73 @@
 
 # include "Locator.hh"
 # include <algorithm>
+# include <cmath>
+# include <limits>
 # include "Mob.hh"
 # include "Wall.hh"
 # include "Spawner.hh"
 # include "Portal.hh"
 # include "Tower.hh"
+# include "Snapshot.hh"
 # include <maths_utils/LocationUtils.hh>
 
 namespace tdef {
 
+  inline
+  FlowFieldShPtr
+  Locator::flowField() const noexcept {
+    return m_field;
+  }
+
+  inline
+  PathCacheShPtr
+  Locator::pathCache() const noexcept {
+    return m_cache;
+  }
+
+  inline
+  unsigned
+  Locator::obstaclesEpoch() const noexcept {
+    return m_epoch;
+  }
+
+  inline
+  const std::vector<TowerShPtr>&
+  Locator::towers() const noexcept {
+    return m_towers;
+  }
+
+  inline
+  const std::vector<WallShPtr>&
+  Locator::walls() const noexcept {
+    return m_walls;
+  }
+
+  inline
+  const std::vector<PortalShPtr>&
+  Locator::portals() const noexcept {
+    return m_portals;
+  }
+
+  inline
+  const std::vector<SpawnerShPtr>&
+  Locator::spawners() const noexcept {
+    return m_spawners;
+  }
+
   inline
   world::Block
   Locator::block(int id) const noexcept {
-    BlockShPtr b = m_blocks[id];
+    const Block* b = m_blocks[id].get();
 
-    world::BlockType bt = world::BlockType::Wall;
+    world::BlockType bt = b->getBlockType();
     int var = 0;
 
     float cone = 0.0f;
 
-    if (std::dynamic_pointer_cast<Spawner>(b) != nullptr) {
-      bt = world::BlockType::Spawner;
-    }
-    else if (std::dynamic_pointer_cast<Portal>(b) != nullptr) {
-      bt = world::BlockType::Portal;
-    }
-    else if (std::dynamic_pointer_cast<Tower>(b) != nullptr) {
-      bt = world::BlockType::Tower;
-
-      TowerShPtr t = std::dynamic_pointer_cast<Tower>(b);
-      switch (t->getType()) {
-        case towers::Type::Sniper:
-          var = 1;
-          break;
-        case towers::Type::Cannon:
-          var = 2;
-          break;
-        case towers::Type::Freezing:
-          var = 3;
-          break;
-        case towers::Type::Venom:
-          var = 4;
-          break;
-        case towers::Type::Splash:
-          var = 5;
-          break;
-        case towers::Type::Blast:
-          var = 6;
-          break;
-        case towers::Type::Multishot:
-          var = 7;
-          break;
-        case towers::Type::Minigun:
-          var = 8;
-          break;
-        case towers::Type::Antiair:
-          var = 9;
-          break;
-        case towers::Type::Tesla:
-          var = 10;
-          break;
-        case towers::Type::Missile:
-          var = 11;
-          break;
-        case towers::Type::Basic:
-        default:
-          // Assume regular type.
-          var = 0;
-          break;
-      }
-
+    if (bt == world::BlockType::Tower) {
+      const Tower* t = static_cast<const Tower*>(b);
+      var = world::spriteOf(t->getType());
       cone = t->getAimingCone();
     }
 
@@ -98,6 +95,7 @@ namespace tdef {
 
     world::Mob md;
     md.p = m->getPos();
+    md.prev = m->getPreviousPos();
     md.radius = m->getRadius();
     md.health = m->getHealthRatio();
 
@@ -108,43 +106,7 @@ namespace tdef {
     md.poisoned = e.poisoned;
     md.stunned = e.stunned;
 
-    switch (m->getType()) {
-      case mobs::Type::Fast:
-        md.id = 1;
-        break;
-      case mobs::Type::Strong:
-        md.id = 2;
-        break;
-      case mobs::Type::Heli:
-        md.id = 3;
-        break;
-      case mobs::Type::Jet:
-        md.id = 4;
-        break;
-      case mobs::Type::Armored:
-        md.id = 5;
-        break;
-      case mobs::Type::Healer:
-        md.id = 6;
-        break;
-      case mobs::Type::Toxic:
-        md.id = 7;
-        break;
-      case mobs::Type::Icy:
-        md.id = 8;
-        break;
-      case mobs::Type::Fighter:
-        md.id = 9;
-        break;
-      case mobs::Type::Light:
-        md.id = 10;
-        break;
-      case mobs::Type::Regular:
-      default:
-        // Assume regular type.
-        md.id = 0;
-        break;
-    }
+    md.id = world::spriteOf(m->getType());
 
     return md;
   }
@@ -156,6 +118,7 @@ namespace tdef {
 
     world::Projectile pd;
     pd.p = p->getPos();
+    pd.prev = p->getPreviousPos();
 
     return pd;
   }
@@ -169,7 +132,55 @@ namespace tdef {
   inline
   bool
   Locator::obstructed(float x, float y, bool includeMobs) const noexcept {
-    return itemAt(x, y, includeMobs) != nullptr;
+    // Mobs are not part of the occupancy: we need
+    // to rely on the general case.
+    if (includeMobs) {
+      return itemAt(x, y, includeMobs) != nullptr;
+    }
+
+    int c = occupancyCell(x, y);
+    if (c < 0) {
+      return false;
+    }
+
+    // Only inspect the blocks overlapping the cell
+    // in case it is partially covered.
+    std::uint8_t s = m_occupancy.states[c];
+    if ((s & sk_covered) != 0u) {
+      return true;
+    }
+    if ((s & sk_touched) == 0u) {
+      return false;
+    }
+
+    return itemAt(x, y, false) != nullptr;
+  }
+
+  inline
+  std::uint8_t
+  Locator::passability(const utils::Point2f& p) const noexcept {
+    int c = occupancyCell(p.x(), p.y());
+
+    // Cells outside of the occupancy area are not
+    // close to any block.
+    if (c < 0) {
+      return 0xFFu;
+    }
+
+    return m_occupancy.masks[c];
+  }
+
+  inline
+  int
+  Locator::occupancyCell(float x, float y) const noexcept {
+    float cx = std::floor(x) - m_occupancy.xMin;
+    float cy = std::floor(y) - m_occupancy.yMin;
+
+    if (!(cx >= 0.0f && cx < m_occupancy.w && cy >= 0.0f && cy < m_occupancy.h)) {
+      return -1;
+    }
+
+    return static_cast<int>(cy) * m_occupancy.w + static_cast<int>(cx);
   }
 
   inline
@@ -196,6 +207,13 @@ namespace tdef {
     return obstructed(p, xD, yD, d, cPoints, obs, sample, allowLog);
   }
 
+  inline
+  bool
+  Locator::lineOfSight(const utils::Point2f& p, const utils::Point2f& e) const noexcept {
+    world::Cell c;
+    return !firstObstruction(p, e, c);
+  }
+
   inline
   world::ItemEntry
   Locator::getClosest(const utils::Point2f& p,
@@ -224,36 +242,22 @@ namespace tdef {
                             const world::Filter* filter,
                             world::Sort sort) const noexcept
   {
-    // Fetch visible blocks descriptions.
-    world::ItemType t = world::ItemType::Block;
-    std::vector<world::ItemEntry> bds = getVisible(p, r, &t, filter, sort);
-
+    // Only traverse the blocks with the desired type.
     std::vector<BlockShPtr> bs;
-    for (unsigned i = 0u ; i < bds.size() ; ++i) {
-      BlockShPtr b = m_blocks[bds[i].index];
-
-      // Check whether the type matches what is desired.
-      bool valid = false;
-      switch (type) {
-        case world::BlockType::Spawner:
-          valid = (std::dynamic_pointer_cast<Spawner>(b) != nullptr);
-          break;
-        case world::BlockType::Wall:
-          valid = (std::dynamic_pointer_cast<Wall>(b) != nullptr);
-          break;
-        case world::BlockType::Portal:
-          valid = (std::dynamic_pointer_cast<Portal>(b) != nullptr);
-          break;
-        case world::BlockType::Tower:
-          valid = (std::dynamic_pointer_cast<Tower>(b) != nullptr);
-          break;
-      }
-
-      if (!valid) {
-        continue;
-      }
 
-      bs.push_back(b);
+    switch (type) {
+      case world::BlockType::Spawner:
+        visibleBlocks(m_spawners, p, r, filter, sort, bs);
+        break;
+      case world::BlockType::Wall:
+        visibleBlocks(m_walls, p, r, filter, sort, bs);
+        break;
+      case world::BlockType::Portal:
+        visibleBlocks(m_portals, p, r, filter, sort, bs);
+        break;
+      case world::BlockType::Tower:
+        visibleBlocks(m_towers, p, r, filter, sort, bs);
+        break;
     }
 
     return bs;
@@ -279,35 +283,185 @@ namespace tdef {
     return ms;
   }
 
+  template <typename Visitor>
   inline
-  BlockShPtr
-  Locator::getClosestBlock(const utils::Point2f& p,
-                           const world::BlockType& type,
-                           float r,
-                           const world::Filter* filter) const noexcept
+  void
+  Locator::forEachMobInRadius(const utils::Point2f& p,
+                              float r,
+                              const world::Filter* filter,
+                              Visitor&& visitor) const noexcept
   {
-    std::vector<BlockShPtr> bs = getVisibleBlocks(p, r, type, filter, world::Sort::Distance);
+    float r2 = r * r;
+    float lim = (r > 0.0f ? r : std::numeric_limits<float>::infinity());
+
+    Scratch s;
+    candidates(m_mobsIndex, m_mobs.size(), p.x() - lim, p.y() - lim, p.x() + lim, p.y() + lim, s.ids);
+
+    for (unsigned i = 0u ; i < s.ids.size() ; ++i) {
+      unsigned id = s.ids[i];
+      const utils::Point2f& mp = m_store.pos(id);
+
+      if (r > 0.0f && utils::d2(mp.x(), mp.y(), p.x(), p.y()) > r2) {
+        continue;
+      }
+
+      Mob& m = *m_mobs[id];
+      if (!accepts(m.getOwner(), filter)) {
+        continue;
+      }
+
+      if (!visitor(m)) {
+        return;
+      }
+    }
+  }
+
+  template <typename Visitor>
+  inline
+  void
+  Locator::forEachBlockInRect(float xMin,
+                              float yMin,
+                              float xMax,
+                              float yMax,
+                              const world::Filter* filter,
+                              Visitor&& visitor) const noexcept
+  {
+    Scratch s;
+    candidates(m_blocksIndex, m_blocks.size(), xMin, yMin, xMax, yMax, s.ids);
+
+    for (unsigned i = 0u ; i < s.ids.size() ; ++i) {
+      Block& b = *m_blocks[s.ids[i]];
+      const utils::Point2f& bp = b.getPos();
 
-    if (bs.empty()) {
-      return nullptr;
+      if (bp.x() < xMin || bp.x() > xMax || bp.y() < yMin || bp.y() > yMax) {
+        continue;
+      }
+
+      if (!accepts(b.getOwner(), filter)) {
+        continue;
+      }
+
+      if (!visitor(b)) {
+        return;
+      }
     }
+  }
 
-    return bs.front();
+  inline
+  bool
+  Locator::accepts(const utils::Uuid& uuid, const world::Filter* filter) noexcept {
+    if (filter == nullptr) {
+      return true;
+    }
+
+    return (filter->include ? uuid == filter->id : uuid != filter->id);
   }
 
   inline
-  MobShPtr
-  Locator::getClosestMob(const utils::Point2f& p,
+  bool
+  Locator::before(world::Sort sort,
+                  const utils::Point2f& p,
+                  const utils::Point2f& lhs,
+                  const utils::Point2f& rhs) noexcept
+  {
+    if (sort == world::Sort::Distance) {
+      return utils::d(p, lhs) < utils::d(p, rhs);
+    }
+
+    // Use `z` order as default sorting alg in case
+    // the input is unknown.
+    return lhs.x() < rhs.x() || (lhs.x() == rhs.x() && lhs.y() < rhs.y());
+  }
+
+  inline
+  const utils::Point2f&
+  Locator::position(const world::ItemEntry& ie) const noexcept {
+    if (ie.type == world::ItemType::Block) {
+      return m_blocks[ie.index]->getPos();
+    }
+    if (ie.type == world::ItemType::Mob) {
+      return m_store.pos(ie.index);
+    }
+
+    return m_projectiles[ie.index]->getPos();
+  }
+
+  template <typename Element>
+  inline
+  void
+  Locator::visibleBlocks(const std::vector<std::shared_ptr<Element>>& blocks,
+                         const utils::Point2f& p,
                          float r,
-                         const world::Filter* filter) const noexcept
+                         const world::Filter* filter,
+                         world::Sort sort,
+                         std::vector<BlockShPtr>& out) noexcept
   {
-    std::vector<MobShPtr> ms = getVisibleMobs(p, r, filter, world::Sort::Distance);
+    std::size_t first = out.size();
+    float r2 = r * r;
+
+    for (unsigned id = 0u ; id < blocks.size() ; ++id) {
+      const utils::Point2f& bp = blocks[id]->getPos();
+
+      // Similarly to `getVisible`, the distance is computed
+      // from the center of the block.
+      if (r > 0.0f && utils::d2(bp.x() + 0.5f, bp.y() + 0.5f, p.x(), p.y()) > r2) {
+        continue;
+      }
+
+      if (!accepts(blocks[id]->getOwner(), filter)) {
+        continue;
+      }
+
+      out.push_back(blocks[id]);
+    }
 
-    if (ms.empty()) {
-      return nullptr;
+    if (sort == world::Sort::None) {
+      return;
+    }
+
+    // Blocks at the same distance keep the order in which
+    // they are registered so that the result is stable.
+    auto cmp = [&sort, &p](const BlockShPtr& lhs, const BlockShPtr& rhs) {
+      return before(sort, p, lhs->getPos(), rhs->getPos());
+    };
+
+    std::stable_sort(out.begin() + first, out.end(), cmp);
+  }
+
+  template <typename Element>
+  inline
+  Block*
+  Locator::closestBlock(const std::vector<std::shared_ptr<Element>>& blocks,
+                        const utils::Point2f& p,
+                        float r,
+                        const world::Filter* filter) noexcept
+  {
+    Block* best = nullptr;
+    float bestD2 = 0.0f;
+    float r2 = r * r;
+
+    for (unsigned id = 0u ; id < blocks.size() ; ++id) {
+      const utils::Point2f& bp = blocks[id]->getPos();
+
+      if (r > 0.0f && utils::d2(bp.x() + 0.5f, bp.y() + 0.5f, p.x(), p.y()) > r2) {
+        continue;
+      }
+
+      if (!accepts(blocks[id]->getOwner(), filter)) {
+        continue;
+      }
+
+      // Blocks are traversed in the order in which they
+      // are registered: keeping the first one at a given
+      // distance resolves ties.
+      float d2 = utils::d2(bp.x(), bp.y(), p.x(), p.y());
+      if (best == nullptr || d2 < bestD2) {
+        best = blocks[id].get();
+        bestD2 = d2;
+      }
     }
 
-    return ms.front();
+    return best;
   }
 
 }
@@ -4,7 +4,7 @@
 namespace tdef {
 
   Portal::Portal(const PProps& props):
-    Block(props, "portal"),
+    Block(props, world::BlockType::Portal, "portal"),
 
     m_lives(props.lives)
   {
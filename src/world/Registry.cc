@@ -0,0 +1,150 @@
+
+# include "Registry.hh"
+
+namespace tdef {
+
+  Registry::Registry() noexcept:
+    utils::CoreObject("registry"),
+
+    m_elements(),
+    m_generations(),
+    m_free(),
+    m_pending()
+  {
+    setService("world");
+  }
+
+  world::Handle
+  Registry::add(WorldElement& e) {
+    unsigned id = m_elements.size();
+
+    if (m_free.empty()) {
+      m_elements.push_back(nullptr);
+      m_generations.push_back(0u);
+    }
+    else {
+      id = m_free.back();
+      m_free.pop_back();
+    }
+
+    m_elements[id] = &e;
+
+    world::Handle h{id, m_generations[id]};
+    e.setHandle(h);
+
+    return h;
+  }
+
+  void
+  Registry::remove(WorldElement& e) noexcept {
+    world::Handle h = e.getHandle();
+    if (get(h) != &e) {
+      return;
+    }
+
+    // Bumping the generation invalidates all the copies
+    // of the handle.
+    m_elements[h.index] = nullptr;
+    ++m_generations[h.index];
+    m_free.push_back(h.index);
+
+    e.setHandle(world::Handle::invalid());
+  }
+
+  void
+  Registry::restore(WorldElement& e) {
+    world::Handle h = e.getHandle();
+
+    if (h.index >= m_elements.size() ||
+        m_generations[h.index] != h.generation ||
+        m_elements[h.index] != nullptr)
+    {
+      warn(
+        "Failed to restore element with handle " + std::to_string(h.index) +
+        " (generation: " + std::to_string(h.generation) + "), assigning a new one"
+      );
+
+      e.setHandle(world::Handle::invalid());
+      m_pending.push_back(&e);
+
+      return;
+    }
+
+    m_elements[h.index] = &e;
+  }
+
+  void
+  Registry::rebuild() {
+    m_free.clear();
+
+    // Slots are listed in reverse order so that the
+    // lowest indices are reused first.
+    for (unsigned id = m_elements.size() ; id > 0u ; --id) {
+      if (m_elements[id - 1u] == nullptr) {
+        m_free.push_back(id - 1u);
+      }
+    }
+
+    // The elements which could not be restored are now
+    // given a free slot. Its generation is bumped so that
+    // the handles saved for the slot do not resolve to
+    // them.
+    for (unsigned id = 0u ; id < m_pending.size() ; ++id) {
+      if (!m_free.empty()) {
+        ++m_generations[m_free.back()];
+      }
+
+      add(*m_pending[id]);
+    }
+
+    m_pending.clear();
+  }
+
+  void
+  Registry::clear() noexcept {
+    for (unsigned id = 0u ; id < m_elements.size() ; ++id) {
+      if (m_elements[id] != nullptr) {
+        m_elements[id]->setHandle(world::Handle::invalid());
+        m_elements[id] = nullptr;
+        ++m_generations[id];
+      }
+    }
+
+    m_pending.clear();
+    rebuild();
+  }
+
+  std::ostream&
+  Registry::operator<<(std::ostream& out) const {
+    // Only the generations are saved: the elements will
+    // be restored from their own handles.
+    out << m_generations.size() << " ";
+    for (unsigned id = 0u ; id < m_generations.size() ; ++id) {
+      out << m_generations[id] << " ";
+    }
+
+    verbose("Saved registry with " + std::to_string(m_generations.size()) + " slot(s)");
+
+    return out;
+  }
+
+  std::istream&
+  Registry::operator>>(std::istream& in) {
+    unsigned count = 0u;
+    in >> count;
+
+    m_generations.resize(count);
+    for (unsigned id = 0u ; id < count ; ++id) {
+      in >> m_generations[id];
+    }
+
+    m_elements.assign(count, nullptr);
+    m_free.clear();
+    m_pending.clear();
+
+    verbose("Restored registry with " + std::to_string(count) + " slot(s)");
+
+    return in;
+  }
+
+}
@@ -0,0 +1,139 @@
+#ifndef    REGISTRY_HH
+# define   REGISTRY_HH
+
+# include <vector>
+# include <memory>
+# include <istream>
+# include <ostream>
+# include <core_utils/CoreObject.hh>
+# include "Handle.hh"
+# include "WorldElement.hh"
+
+namespace tdef {
+
+  class Registry: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new empty registry. The registry is
+       *          used to assign handles to the elements of the
+       *          world and to resolve them back to the elements
+       *          in constant time. The registry does not own the
+       *          elements: they are registered when entering the
+       *          world and removed when leaving it.
+       */
+      Registry() noexcept;
+
+      /**
+       * @brief - Return the number of slots of the registry,
+       *          including the ones not in use.
+       * @return - the number of slots.
+       */
+      unsigned
+      size() const noexcept;
+
+      /**
+       * @brief - Register the input element and assign it a
+       *          new handle.
+       * @param e - the element to register.
+       * @return - the handle assigned to the element.
+       */
+      world::Handle
+      add(WorldElement& e);
+
+      /**
+       * @brief - Remove the input element from the registry:
+       *          its handle and all the copies of it will not
+       *          resolve anymore.
+       * @param e - the element to remove.
+       */
+      void
+      remove(WorldElement& e) noexcept;
+
+      /**
+       * @brief - Register the input element with the handle it
+       *          already has. This is used when elements are
+       *          restored from a save so that the handles they
+       *          reference are still valid. In case the handle
+       *          can't be used a new one is assigned when the
+       *          registry is rebuilt: this avoids taking a slot
+       *          of an element not restored yet.
+       * @param e - the element to restore.
+       */
+      void
+      restore(WorldElement& e);
+
+      /**
+       * @brief - Rebuild the list of free slots from the slots
+       *          that were not restored and assign a new handle
+       *          to the elements which could not be restored.
+       *          Should be called once all the elements have
+       *          been restored.
+       */
+      void
+      rebuild();
+
+      /**
+       * @brief - Remove all the elements from the registry. The
+       *          handles assigned so far will not resolve anymore.
+       */
+      void
+      clear() noexcept;
+
+      /**
+       * @brief - Resolve the input handle to the element it was
+       *          assigned to. The caller is responsible for the
+       *          requested type to match the one of the element.
+       * @param h - the handle to resolve.
+       * @return - the element or `null` in case the element has
+       *           been removed from the world.
+       */
+      template <typename Element = WorldElement>
+      Element*
+      get(const world::Handle& h) const noexcept;
+
+      std::ostream&
+      operator<<(std::ostream& out) const;
+
+      std::istream&
+      operator>>(std::istream& in);
+
+    private:
+
+      /**
+       * @brief - The element registered in each slot or `null`
+       *          if the slot is not in use.
+       */
+      std::vector<WorldElement*> m_elements;
+
+      /**
+       * @brief - The generation of each slot: it is increased
+       *          each time the element of the slot is removed.
+       */
+      std::vector<unsigned> m_generations;
+
+      /**
+       * @brief - The indices of the slots not in use.
+       */
+      std::vector<unsigned> m_free;
+
+      /**
+       * @brief - The elements which could not be restored with
+       *          their handle and are waiting for the registry
+       *          to be rebuilt to get a new one.
+       */
+      std::vector<WorldElement*> m_pending;
+  };
+
+  using RegistryShPtr = std::shared_ptr<Registry>;
+}
+
+std::ostream&
+operator<<(std::ostream& out, const tdef::Registry& r) noexcept;
+
+std::istream&
+operator>>(std::istream& in, tdef::Registry& r) noexcept;
+
+# include "Registry.hxx"
+
+#endif    /* REGISTRY_HH */
@@ -0,0 +1,41 @@
+#ifndef    REGISTRY_HXX
+# define   REGISTRY_HXX
+
+# include "Registry.hh"
+
+namespace tdef {
+
+  inline
+  unsigned
+  Registry::size() const noexcept {
+    return m_elements.size();
+  }
+
+  template <typename Element>
+  inline
+  Element*
+  Registry::get(const world::Handle& h) const noexcept {
+    if (h.index >= m_elements.size() || m_generations[h.index] != h.generation) {
+      return nullptr;
+    }
+
+    return static_cast<Element*>(m_elements[h.index]);
+  }
+
+}
+
+inline
+std::ostream&
+operator<<(std::ostream& out, const tdef::Registry& r) noexcept {
+  r << out;
+  return out;
+}
+
+inline
+std::istream&
+operator>>(std::istream& in, tdef::Registry& r) noexcept {
+  r >> in;
+  return in;
+}
+
+#endif    /* REGISTRY_HXX */
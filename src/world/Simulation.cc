@@ -0,0 +1,97 @@
+
+# include "Simulation.hh"
+# include <chrono>
+
+namespace tdef {
+
+  Simulation::Simulation(WorldShPtr world,
+                         unsigned capacity):
+    utils::CoreObject("simulation"),
+
+    m_world(world),
+    m_commands(capacity),
+
+    m_thread(),
+    m_running(false)
+  {
+    setService("world");
+
+    if (m_world == nullptr) {
+      error(
+        "Failed to create simulation",
+        "Invalid null world"
+      );
+    }
+  }
+
+  void
+  Simulation::start() {
+    if (running()) {
+      return;
+    }
+
+    m_running.store(true, std::memory_order_release);
+    m_thread = std::thread(&Simulation::loop, this);
+
+    verbose("Started simulation thread");
+  }
+
+  void
+  Simulation::stop() {
+    if (!running()) {
+      return;
+    }
+
+    m_running.store(false, std::memory_order_release);
+    m_thread.join();
+
+    verbose("Stopped simulation thread");
+  }
+
+  bool
+  Simulation::push(const world::Command& cmd) {
+    if (!m_commands.push(cmd)) {
+      warn(
+        "Discarding command as " + std::to_string(m_commands.capacity()) +
+        " command(s) are already waiting"
+      );
+
+      return false;
+    }
+
+    return true;
+  }
+
+  void
+  Simulation::loop() {
+    std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+
+    while (m_running.load(std::memory_order_acquire)) {
+      drain();
+
+      std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+      std::chrono::duration<float> elapsed = now - last;
+      last = now;
+
+      m_world->step(elapsed.count());
+
+      // Wait for the next tick to be due: commands are
+      // thus applied at most one tick late.
+      float wait = m_world->getTickDuration() * (1.0f - m_world->getInterpolation());
+      std::this_thread::sleep_for(std::chrono::duration<float>(wait));
+    }
+
+    // Make sure the commands sent before stopping are
+    // not lost.
+    drain();
+  }
+
+  void
+  Simulation::drain() {
+    world::Command cmd;
+    while (m_commands.pop(cmd)) {
+      m_world->apply(cmd);
+    }
+  }
+
+}
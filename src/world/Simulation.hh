@@ -0,0 +1,118 @@
+#ifndef    SIMULATION_HH
+# define   SIMULATION_HH
+
+# include <memory>
+# include <atomic>
+# include <thread>
+# include <core_utils/CoreObject.hh>
+# include "World.hh"
+# include "Command.hh"
+# include "SpscQueue.hh"
+
+namespace tdef {
+
+  class Simulation: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new simulation stepping the input world
+       *          on a dedicated thread. The thread is not started
+       *          until `start` is called.
+       *          While the thread runs it is the only one allowed
+       *          to modify the world: other threads should read
+       *          the snapshots published by the world and send
+       *          commands to modify it.
+       * @param world - the world to simulate.
+       * @param capacity - the number of commands which can wait
+       *                   to be applied.
+       */
+      Simulation(WorldShPtr world,
+                 unsigned capacity = sk_defaultCapacity);
+
+      /**
+       * @brief - Stops the thread if needed.
+       */
+      ~Simulation();
+
+      /**
+       * @brief - Whether the thread stepping the world is running.
+       * @return - `true` if the simulation runs.
+       */
+      bool
+      running() const noexcept;
+
+      /**
+       * @brief - Start the thread stepping the world. Nothing
+       *          happens in case it is already running.
+       */
+      void
+      start();
+
+      /**
+       * @brief - Stop the thread stepping the world and wait for
+       *          it to finish. All the commands sent before are
+       *          applied to the world. The world can then safely
+       *          be accessed by the calling thread.
+       */
+      void
+      stop();
+
+      /**
+       * @brief - Send a command to be applied to the world before
+       *          the next step. Should always be called from the
+       *          same thread.
+       * @param cmd - the command to send.
+       * @return - `false` if too many commands are waiting, in
+       *           which case the command is discarded.
+       */
+      bool
+      push(const world::Command& cmd);
+
+    private:
+
+      /**
+       * @brief - The main loop of the thread: it applies the
+       *          commands and steps the world with the actual
+       *          time elapsed, then waits for the next tick.
+       */
+      void
+      loop();
+
+      /**
+       * @brief - Apply all the commands waiting in the queue.
+       */
+      void
+      drain();
+
+    private:
+
+      /**
+       * @brief - The default number of commands which can wait
+       *          to be applied.
+       */
+      static constexpr unsigned sk_defaultCapacity = 256u;
+
+      /**
+       * @brief - The world being simulated.
+       */
+      WorldShPtr m_world;
+
+      /**
+       * @brief - The commands waiting to be applied to the world.
+       */
+      SpscQueue<world::Command> m_commands;
+
+      /**
+       * @brief - The thread stepping the world and whether it
+       *          should keep running.
+       */
+      std::thread m_thread;
+      std::atomic<bool> m_running;
+  };
+
+  using SimulationShPtr = std::shared_ptr<Simulation>;
+}
+
+# include "Simulation.hxx"
+
+#endif    /* SIMULATION_HH */
@@ -0,0 +1,21 @@
+#ifndef    SIMULATION_HXX
+# define   SIMULATION_HXX
+
+# include "Simulation.hh"
+
+namespace tdef {
+
+  inline
+  Simulation::~Simulation() {
+    stop();
+  }
+
+  inline
+  bool
+  Simulation::running() const noexcept {
+    return m_thread.joinable();
+  }
+
+}
+
+#endif    /* SIMULATION_HXX */
@@ -0,0 +1,72 @@
+
+# include "Snapshot.hh"
+# include "Tower.hh"
+# include "Mob.hh"
+
+namespace tdef {
+  namespace world {
+
+    int
+    spriteOf(const towers::Type& type) noexcept {
+      switch (type) {
+        case towers::Type::Sniper:
+          return 1;
+        case towers::Type::Cannon:
+          return 2;
+        case towers::Type::Freezing:
+          return 3;
+        case towers::Type::Venom:
+          return 4;
+        case towers::Type::Splash:
+          return 5;
+        case towers::Type::Blast:
+          return 6;
+        case towers::Type::Multishot:
+          return 7;
+        case towers::Type::Minigun:
+          return 8;
+        case towers::Type::Antiair:
+          return 9;
+        case towers::Type::Tesla:
+          return 10;
+        case towers::Type::Missile:
+          return 11;
+        case towers::Type::Basic:
+        default:
+          // Assume regular type.
+          return 0;
+      }
+    }
+
+    int
+    spriteOf(const mobs::Type& type) noexcept {
+      switch (type) {
+        case mobs::Type::Fast:
+          return 1;
+        case mobs::Type::Strong:
+          return 2;
+        case mobs::Type::Heli:
+          return 3;
+        case mobs::Type::Jet:
+          return 4;
+        case mobs::Type::Armored:
+          return 5;
+        case mobs::Type::Healer:
+          return 6;
+        case mobs::Type::Toxic:
+          return 7;
+        case mobs::Type::Icy:
+          return 8;
+        case mobs::Type::Fighter:
+          return 9;
+        case mobs::Type::Light:
+          return 10;
+        case mobs::Type::Regular:
+        default:
+          // Assume regular type.
+          return 0;
+      }
+    }
+
+  }
+}
@@ -0,0 +1,251 @@
+#ifndef    SNAPSHOT_HH
+# define   SNAPSHOT_HH
+
+# include <array>
+# include <vector>
+# include <cstdint>
+# include "Block.hh"
+# include "Handle.hh"
+
+namespace tdef {
+
+  // Forward declaration of the types of the elements
+  // which are represented with a sprite and of the
+  // properties of the towers.
+  namespace towers {
+    enum class Type;
+    enum class Upgrade;
+    enum class Targetting;
+  }
+
+  namespace mobs {
+    enum class Type;
+  }
+
+  namespace world {
+
+    /**
+     * @brief - Describes how a block should be rendered. All
+     *          the properties are copied from the block when
+     *          the snapshot is published.
+     */
+    struct RenderBlock {
+      // The handle of the block in the world.
+      Handle handle;
+
+      // The position of the block.
+      float x;
+      float y;
+
+      // The radius of the block.
+      float radius;
+
+      // The health ratio of the block in the range `[0; 1]`.
+      float health;
+
+      // The orientation of the block in radians or `0` if
+      // not applicable.
+      float orientation;
+
+      // The width in radians of the aiming cone for towers.
+      // Set to `0` for other blocks.
+      float cone;
+
+      // The type of the block.
+      BlockType type;
+
+      // The sprite used to represent the block, interpreted
+      // from its type.
+      int sprite;
+    };
+
+    /**
+     * @brief - Describes how a mob should be rendered. Both the
+     *          position at the last tick and the one before it
+     *          are kept so that it can be interpolated.
+     */
+    struct RenderMob {
+      // The handle of the mob in the world.
+      Handle handle;
+
+      // The position of the mob.
+      float x;
+      float y;
+
+      // The position of the mob at the previous tick.
+      float xPrev;
+      float yPrev;
+
+      // The radius of the mob.
+      float radius;
+
+      // The health ratio of the mob in the range `[0; 1]`.
+      float health;
+
+      // The sprite used to represent the mob.
+      int sprite;
+
+      // The effects applied to the mob as a combination of
+      // the flags defined in the snapshot.
+      std::uint8_t effects;
+
+      // The index of the first point of the path of the mob
+      // in the snapshot and the number of points. Only set
+      // when paths are included in the snapshot.
+      unsigned path;
+      unsigned points;
+    };
+
+    /**
+     * @brief - Describes how a projectile should be rendered.
+     */
+    struct RenderProjectile {
+      // The position of the projectile.
+      float x;
+      float y;
+
+      // The position of the projectile at the previous tick.
+      float xPrev;
+      float yPrev;
+    };
+
+    /**
+     * @brief - A passage point of the path of a mob.
+     */
+    struct RenderPoint {
+      float x;
+      float y;
+    };
+
+    /**
+     * @brief - The kind of element selected in the world.
+     */
+    enum class SelectionType {
+      None,
+      Tower,
+      Mob,
+      Spawner,
+      Wall
+    };
+
+    /**
+     * @brief - Describes the state of an upgrade of a tower.
+     */
+    struct SelectedUpgrade {
+      // The upgrade.
+      towers::Upgrade upgrade;
+
+      // The current level of the upgrade.
+      int level;
+
+      // The value of the property of the tower improved by
+      // the upgrade, in the unit used by the tower.
+      float value;
+    };
+
+    /**
+     * @brief - Describes the properties of the element selected
+     *          in the world, so that they can be displayed. Only
+     *          the fields relevant to the type of the element
+     *          are set.
+     */
+    struct Selection {
+      // The maximum number of upgrades of a tower.
+      static constexpr unsigned sk_maxUpgrades = 11u;
+
+      // The handle of the selected element. The type is set
+      // to `None` in case this handle does not resolve to an
+      // element anymore.
+      Handle handle;
+      SelectionType type;
+
+      // The health of the element.
+      float health;
+
+      // The properties of a mob.
+      mobs::Type mob;
+      float speed;
+      float bounty;
+
+      // The properties of a tower: its type, the way it
+      // picks its targets, the gold spent on it and the
+      // state of its upgrades.
+      towers::Type tower;
+      towers::Targetting mode;
+      float cost;
+      unsigned count;
+      std::array<SelectedUpgrade, sk_maxUpgrades> upgrades;
+    };
+
+    /**
+     * @brief - Convenience structure describing the elements of
+     *          the world as they should be rendered. It is made
+     *          of plain values only so that it can be read by a
+     *          renderer without touching the elements themselves,
+     *          possibly from another thread than the one which
+     *          steps the world.
+     *          The lists are kept from one snapshot to the next
+     *          so that publishing does not allocate memory once
+     *          their capacity is large enough.
+     */
+    struct Snapshot {
+      // Flags describing the effects applied to a mob.
+      static constexpr std::uint8_t sk_freezed = 1u;
+      static constexpr std::uint8_t sk_poisoned = 2u;
+      static constexpr std::uint8_t sk_stunned = 4u;
+
+      // The index of the snapshot, increased each time a new
+      // one is published.
+      unsigned long id;
+
+      // The moment at which the last tick was simulated, in
+      // seconds on the steady clock, and the duration of a
+      // tick. This allows to interpolate the position of the
+      // entities while waiting for the next snapshot.
+      double moment;
+      float tick;
+
+      // Whether the paths of the mobs are included.
+      bool paths;
+
+      // The remaining lives in all the portals of the world
+      // and the gold available to the player.
+      float lives;
+      float gold;
+
+      // The properties of the element selected in the world.
+      Selection selection;
+
+      // The elements of the world. Mobs are sorted in the
+      // same way as with the `ZOrder` sort of the locator.
+      std::vector<RenderBlock> blocks;
+      std::vector<RenderMob> mobs;
+      std::vector<RenderProjectile> projectiles;
+
+      // The passage points of the paths of all the mobs. Each
+      // mob references a contiguous range of points.
+      std::vector<RenderPoint> points;
+    };
+
+    /**
+     * @brief - Return the sprite used to represent a tower of
+     *          the specified type.
+     * @param type - the type of the tower.
+     * @return - the index of the sprite.
+     */
+    int
+    spriteOf(const towers::Type& type) noexcept;
+
+    /**
+     * @brief - Return the sprite used to represent a mob of
+     *          the specified type.
+     * @param type - the type of the mob.
+     * @return - the index of the sprite.
+     */
+    int
+    spriteOf(const mobs::Type& type) noexcept;
+
+  }
+}
+
+#endif    /* SNAPSHOT_HH */
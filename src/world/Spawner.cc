@@ -6,7 +6,7 @@
 namespace tdef {
 
   Spawner::Spawner(const SProps& props):
-    Block(props, "spawner"),
+    Block(props, world::BlockType::Spawner, "spawner"),
 
     m_distribution(props.mobs),
 
@@ -16,7 +16,7 @@ namespace tdef {
     m_threshold(props.threshold),
     m_refill(props.refill),
 
-    m_exp(0),
+    m_exp(std::max(props.wave, 0)),
     m_difficulty(props.difficulty),
     m_processes(spawners::generateData(m_difficulty))
   {
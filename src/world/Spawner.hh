@@ -115,6 +115,11 @@ namespace tdef {
         // The difficulty of the spawner. Allows to generate
         // the correct processes from this difficulty.
         spawners::Level difficulty;
+
+        // The number of waves already generated by the spawner.
+        // Allows to create a spawner directly at a later stage
+        // of the game.
+        int wave;
       };
 
       static
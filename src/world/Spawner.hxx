@@ -41,6 +41,7 @@ namespace tdef {
     pp.mobs = dist;
 
     pp.difficulty = spawners::Level::Normal;
+    pp.wave = 0;
 
     return pp;
   }
@@ -0,0 +1,91 @@
+#ifndef    SPSC_QUEUE_HH
+# define   SPSC_QUEUE_HH
+
+# include <vector>
+# include <atomic>
+# include <cstddef>
+
+namespace tdef {
+
+  /**
+   * @brief - A lock-free queue of bounded capacity allowing a
+   *          single producer to send values to a single consumer.
+   *          Values are stored in a ring buffer allocated once:
+   *          pushing to a full queue fails rather than waiting
+   *          for the consumer.
+   */
+  template <typename T>
+  class SpscQueue {
+    public:
+
+      /**
+       * @brief - Create a new queue able to hold at least the
+       *          specified number of values. The capacity is
+       *          rounded up to a power of two.
+       * @param capacity - the minimum capacity of the queue.
+       */
+      explicit
+      SpscQueue(unsigned capacity);
+
+      /**
+       * @brief - Return the maximum number of values that can
+       *          be waiting in the queue.
+       * @return - the capacity of the queue.
+       */
+      unsigned
+      capacity() const noexcept;
+
+      /**
+       * @brief - Append a value to the queue. Should only be
+       *          called by the producer.
+       * @param value - the value to append.
+       * @return - `false` if the queue is full, in which case
+       *           the value is not appended.
+       */
+      bool
+      push(const T& value) noexcept;
+
+      /**
+       * @brief - Fetch the oldest value of the queue. Should only
+       *          be called by the consumer.
+       * @param value - output argument receiving the value.
+       * @return - `false` if the queue is empty, in which case
+       *           the output argument is not modified.
+       */
+      bool
+      pop(T& value) noexcept;
+
+    private:
+
+      /**
+       * @brief - The size of a cache line: the indices modified
+       *          by the producer and the consumer are kept apart
+       *          so that they don't invalidate each other.
+       */
+      static constexpr std::size_t sk_cacheLine = 64u;
+
+      /**
+       * @brief - The storage for the values and the mask to get
+       *          the slot of an index.
+       */
+      std::vector<T> m_items;
+      unsigned m_mask;
+
+      /**
+       * @brief - The index of the next value to pop, written by
+       *          the consumer only.
+       */
+      alignas(sk_cacheLine) std::atomic<unsigned> m_head;
+
+      /**
+       * @brief - The index of the next value to push, written by
+       *          the producer only.
+       */
+      alignas(sk_cacheLine) std::atomic<unsigned> m_tail;
+  };
+
+}
+
+# include "SpscQueue.hxx"
+
+#endif    /* SPSC_QUEUE_HH */
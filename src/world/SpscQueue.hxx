@@ -0,0 +1,67 @@
+#ifndef    SPSC_QUEUE_HXX
+# define   SPSC_QUEUE_HXX
+
+# include "SpscQueue.hh"
+
+namespace tdef {
+
+  template <typename T>
+  inline
+  SpscQueue<T>::SpscQueue(unsigned capacity):
+    m_items(),
+    m_mask(0u),
+
+    m_head(0u),
+    m_tail(0u)
+  {
+    unsigned size = 1u;
+    while (size < capacity) {
+      size <<= 1u;
+    }
+
+    m_items.resize(size);
+    m_mask = size - 1u;
+  }
+
+  template <typename T>
+  inline
+  unsigned
+  SpscQueue<T>::capacity() const noexcept {
+    return m_items.size();
+  }
+
+  template <typename T>
+  inline
+  bool
+  SpscQueue<T>::push(const T& value) noexcept {
+    // Indices are never wrapped: the difference between
+    // them is the number of values in the queue.
+    unsigned tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) >= m_items.size()) {
+      return false;
+    }
+
+    m_items[tail & m_mask] = value;
+    m_tail.store(tail + 1u, std::memory_order_release);
+
+    return true;
+  }
+
+  template <typename T>
+  inline
+  bool
+  SpscQueue<T>::pop(T& value) noexcept {
+    unsigned head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    value = m_items[head & m_mask];
+    m_head.store(head + 1u, std::memory_order_release);
+
+    return true;
+  }
+
+}
+
+#endif    /* SPSC_QUEUE_HXX */
@@ -1,5 +1,6 @@
 
 # include "StepInfo.hh"
+# include "ProjectilePool.hh"
 
 namespace tdef {
 
@@ -8,9 +9,9 @@ namespace tdef {
     mSpawned.push_back(m);
   }
 
-  void
-  StepInfo::spawnProjectile(ProjectileShPtr p) {
-    pSpawned.push_back(p);
+  Projectile&
+  StepInfo::spawnProjectile() {
+    return pSpawned.spawn();
   }
 
 }
@@ -17,6 +17,12 @@ namespace tdef {
   class Locator;
   using LocatorShPtr = std::shared_ptr<Locator>;
 
+  class ProjectilePool;
+
+  class Registry;
+
+  class PathService;
+
   /**
    * @enum  - Convenience structure regrouping all variables
    *          needed to perform the advancement of one step
@@ -31,16 +37,20 @@ namespace tdef {
 
     LocatorShPtr frustum;
 
+    const Registry& registry;
+
+    PathService& paths;
+
     std::vector<MobShPtr> mSpawned;
-    std::vector<ProjectileShPtr> pSpawned;
+    ProjectilePool& pSpawned;
 
     float gold;
 
     void
     spawnMob(MobShPtr m);
 
-    void
-    spawnProjectile(ProjectileShPtr p);
+    Projectile&
+    spawnProjectile();
   };
 
 }
@@ -0,0 +1,104 @@
+#ifndef    TRIPLE_BUFFER_HH
+# define   TRIPLE_BUFFER_HH
+
+# include <array>
+# include <atomic>
+
+namespace tdef {
+
+  /**
+   * @brief - A lock-free triple buffer allowing a single writer
+   *          to publish values to a single reader. The writer
+   *          fills the back buffer and exchanges it with the
+   *          middle one when it is complete, while the reader
+   *          exchanges its front buffer with the middle one
+   *          when a new value is available. Neither of them
+   *          ever waits for the other, and the reader always
+   *          sees the last complete value.
+   *          Buffers are reused so that a value holding some
+   *          memory does not need to reallocate it.
+   */
+  template <typename T>
+  class TripleBuffer {
+    public:
+
+      /**
+       * @brief - Create a new triple buffer where all the buffers
+       *          are initialized with the input value.
+       * @param value - the initial value of the buffers.
+       */
+      explicit
+      TripleBuffer(const T& value);
+
+      /**
+       * @brief - Return the buffer which can be filled by the
+       *          writer. It is not seen by the reader until it
+       *          is published. Its content is the one of some
+       *          buffer published earlier.
+       * @return - the back buffer.
+       */
+      T&
+      back() noexcept;
+
+      /**
+       * @brief - Publish the back buffer so that it is picked
+       *          up by the next call to `acquire`. A new back
+       *          buffer is made available to the writer.
+       */
+      void
+      publish() noexcept;
+
+      /**
+       * @brief - Make the last buffer published by the writer
+       *          the front buffer, if any was published since
+       *          the last call.
+       * @return - `true` if the front buffer changed.
+       */
+      bool
+      acquire() noexcept;
+
+      /**
+       * @brief - Return the buffer which can be read by the
+       *          reader. It stays the same until `acquire` is
+       *          called.
+       * @return - the front buffer.
+       */
+      const T&
+      front() const noexcept;
+
+    private:
+
+      /**
+       * @brief - The flag set on the index of the middle buffer
+       *          when it was published and not yet acquired.
+       */
+      static constexpr unsigned sk_fresh = 4u;
+
+      /**
+       * @brief - The buffers.
+       */
+      std::array<T, 3u> m_buffers;
+
+      /**
+       * @brief - The index of the buffer owned by the writer.
+       */
+      unsigned m_back;
+
+      /**
+       * @brief - The index of the buffer exchanged between the
+       *          writer and the reader, along with the flag to
+       *          indicate that it is fresh.
+       */
+      std::atomic<unsigned> m_middle;
+
+      /**
+       * @brief - The index of the buffer owned by the reader.
+       */
+      unsigned m_front;
+  };
+
+}
+
+# include "TripleBuffer.hxx"
+
+#endif    /* TRIPLE_BUFFER_HH */
@@ -0,0 +1,59 @@
+#ifndef    TRIPLE_BUFFER_HXX
+# define   TRIPLE_BUFFER_HXX
+
+# include "TripleBuffer.hh"
+
+namespace tdef {
+
+  template <typename T>
+  inline
+  TripleBuffer<T>::TripleBuffer(const T& value):
+    m_buffers{{value, value, value}},
+
+    m_back(0u),
+    m_middle(1u),
+    m_front(2u)
+  {}
+
+  template <typename T>
+  inline
+  T&
+  TripleBuffer<T>::back() noexcept {
+    return m_buffers[m_back];
+  }
+
+  template <typename T>
+  inline
+  void
+  TripleBuffer<T>::publish() noexcept {
+    // The release makes the content of the back buffer
+    // visible to the reader, the acquire makes sure the
+    // reader is done with the buffer we get back.
+    unsigned prev = m_middle.exchange(m_back | sk_fresh, std::memory_order_acq_rel);
+    m_back = (prev & ~sk_fresh);
+  }
+
+  template <typename T>
+  inline
+  bool
+  TripleBuffer<T>::acquire() noexcept {
+    if ((m_middle.load(std::memory_order_relaxed) & sk_fresh) == 0u) {
+      return false;
+    }
+
+    unsigned prev = m_middle.exchange(m_front, std::memory_order_acq_rel);
+    m_front = (prev & ~sk_fresh);
+
+    return true;
+  }
+
+  template <typename T>
+  inline
+  const T&
+  TripleBuffer<T>::front() const noexcept {
+    return m_buffers[m_front];
+  }
+
+}
+
+#endif    /* TRIPLE_BUFFER_HXX */
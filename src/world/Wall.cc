@@ -4,7 +4,7 @@
 namespace tdef {
 
   Wall::Wall(const WProps& props):
-    Block(props, "wall"),
+    Block(props, world::BlockType::Wall, "wall"),
 
     m_height(props.height)
   {
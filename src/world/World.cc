@@ -1,7 +1,10 @@
 
 # include "World.hh"
+# include <cmath>
 # include <algorithm>
 # include <unordered_set>
+# include <cstring>
+# include <chrono>
 # include <core_utils/TimeUtils.hh>
 # include "Spawner.hh"
 # include "Wall.hh"
@@ -11,6 +14,178 @@
 # include "MobFactory.hh"
 # include "SpawnerFactory.hh"
 
+namespace {
+
+  /**
+   * @brief - Register the cells overlapped by the input
+   *          block in the output vector. We consider the
+   *          same boundaries as the locator.
+   * @param b - the block for which cells should be added.
+   * @param cells - the output vector.
+   */
+  void
+  registerCells(const tdef::Block& b, std::vector<tdef::world::Cell>& cells) {
+    const utils::Point2f& p = b.getPos();
+    float hr = b.getRadius() / 2.0f;
+
+    int xMin = static_cast<int>(std::floor(p.x() - hr));
+    int yMin = static_cast<int>(std::floor(p.y() - hr));
+    int xMax = static_cast<int>(std::floor(p.x() + hr));
+    int yMax = static_cast<int>(std::floor(p.y() + hr));
+
+    for (int y = yMin ; y <= yMax ; ++y) {
+      for (int x = xMin ; x <= xMax ; ++x) {
+        cells.push_back(tdef::world::Cell{x, y});
+      }
+    }
+  }
+
+  /**
+   * @brief - Remove the elements marked for deletion from
+   *          the input list, keeping the order of the rest.
+   * @param elements - the list to prune.
+   */
+  template <typename Element>
+  void
+  prune(std::vector<std::shared_ptr<Element>>& elements) noexcept {
+    elements.erase(
+      std::remove_if(
+        elements.begin(),
+        elements.end(),
+        [](const std::shared_ptr<Element>& e){
+          return e->isDeleted();
+        }
+      ),
+      elements.end()
+    );
+  }
+
+  /**
+   * @brief - Return the time elapsed since the input moment
+   *          in milliseconds. The wall clock is used as this
+   *          is only meant to profile the simulation.
+   * @param start - the starting moment.
+   * @return - the elapsed time in milliseconds.
+   */
+  double
+  elapsedSince(const std::chrono::steady_clock::time_point& start) noexcept {
+    std::chrono::duration<double, std::milli> d = std::chrono::steady_clock::now() - start;
+    return d.count();
+  }
+
+  /**
+   * @brief - Combine the input value into the hash using
+   *          the FNV-1a scheme. The value is hashed using
+   *          its binary representation.
+   * @param h - the hash to update.
+   * @param v - the value to combine.
+   */
+  void
+  combine(std::uint64_t& h, float v) noexcept {
+    std::uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+
+    for (unsigned id = 0u ; id < sizeof(bits) ; ++id) {
+      h ^= (bits >> (8u * id)) & 0xFFu;
+      h *= 1099511628211ull;
+    }
+  }
+
+  /**
+   * @brief - Combine the state of the input element into
+   *          the hash. The type of the element is kept so
+   *          that the accessors of mobs read their state
+   *          from the store.
+   * @param h - the hash to update.
+   * @param e - the element to hash.
+   */
+  template <typename Element>
+  void
+  combine(std::uint64_t& h, const Element& e) noexcept {
+    combine(h, e.getPos().x());
+    combine(h, e.getPos().y());
+    combine(h, e.getHealth());
+  }
+
+  /**
+   * @brief - Create a snapshot with no elements and nothing
+   *          selected.
+   * @return - the empty snapshot.
+   */
+  tdef::world::Snapshot
+  emptySnapshot() noexcept {
+    tdef::world::Snapshot snap{};
+    snap.selection.handle = tdef::world::Handle::invalid();
+    snap.selection.type = tdef::world::SelectionType::None;
+
+    return snap;
+  }
+
+  /**
+   * @brief - Return the value of the property of the tower
+   *          improved by the input upgrade.
+   * @param t - the tower.
+   * @param upgrade - the upgrade.
+   * @return - the value of the property or `-1` in case the
+   *           upgrade is not known.
+   */
+  float
+  upgradeValue(const tdef::Tower& t, const tdef::towers::Upgrade& upgrade) noexcept {
+    switch (upgrade) {
+      case tdef::towers::Upgrade::Range:
+        return t.getRange();
+      case tdef::towers::Upgrade::Damage:
+        return t.getAttack();
+      case tdef::towers::Upgrade::RotationSpeed:
+        return t.getRotationSpeed();
+      case tdef::towers::Upgrade::AttackSpeed:
+        return t.getAttackSpeed();
+      case tdef::towers::Upgrade::AimSpeed:
+        return t.getAimingSpeed();
+      case tdef::towers::Upgrade::Accuracy:
+        return t.getAccuracy();
+      case tdef::towers::Upgrade::ProjectileSpeed:
+        return t.getProjectileSpeed();
+      case tdef::towers::Upgrade::FreezingPower:
+        return t.getFreezingPower();
+      case tdef::towers::Upgrade::FreezingSpeed:
+        return t.getFreezingSpeed();
+      case tdef::towers::Upgrade::StunChance:
+        return t.getStunChance();
+      case tdef::towers::Upgrade::StunDuration:
+        return t.getStunDuration();
+      default:
+        // Unhandled for now.
+        return -1.0f;
+    }
+  }
+
+  /**
+   * @brief - Return the target mode following the input one
+   *          when the player cycles through them.
+   * @param mode - the current target mode.
+   * @return - the next target mode.
+   */
+  tdef::towers::Targetting
+  nextTargetMode(const tdef::towers::Targetting& mode) noexcept {
+    switch (mode) {
+      case tdef::towers::Targetting::First:
+        return tdef::towers::Targetting::Last;
+      case tdef::towers::Targetting::Last:
+        return tdef::towers::Targetting::Strongest;
+      case tdef::towers::Targetting::Strongest:
+        return tdef::towers::Targetting::Weak;
+      case tdef::towers::Targetting::Weak:
+        return tdef::towers::Targetting::Closest;
+      case tdef::towers::Targetting::Closest:
+      default:
+        // Make sure to come back to a known value.
+        return tdef::towers::Targetting::First;
+    }
+  }
+
+}
+
 namespace tdef {
 
   World::World(int seed):
@@ -19,12 +194,47 @@ namespace tdef {
     m_rng(seed),
 
     m_blocks(),
+    m_towers(),
+    m_walls(),
+    m_portals(),
+    m_spawners(),
+    m_grouped(),
+    m_batches(),
+    m_regroup(false),
     m_mobs(),
+    m_store(),
     m_projectiles(),
+    m_pool(),
+    m_registry(),
+    m_jobs(),
+    m_commands(),
+    m_merged(),
+    m_paths(),
 
     m_paused(true),
 
+    m_tick(1.0f / sk_defaultTickRate),
+    m_maxCatchUp(sk_maxCatchUpTicks),
+    m_accumulator(0.0f),
+    m_origin(),
+    m_ticks(0ul),
+    m_clock(),
+
+    m_profile{0ul, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+
     m_loc(nullptr),
+    m_field(nullptr),
+    m_cache(nullptr),
+
+    m_gold(0.0f),
+    m_selected(world::Handle::invalid()),
+    m_selectedType(world::SelectionType::None),
+
+    m_publish(false),
+    m_publishPaths(false),
+    m_published(0ul),
+    m_lastTick(std::chrono::steady_clock::now()),
+    m_snapshots(emptySnapshot()),
 
     onGoldEarned()
   {
@@ -40,45 +250,166 @@ namespace tdef {
       return;
     }
 
+    // Consume the accumulated time by fixed ticks so that
+    // the outcome of the simulation does not depend on the
+    // frame rate.
+    m_accumulator += std::max(tDelta, 0.0f);
+
+    unsigned count = 0u;
+    while (m_accumulator >= m_tick && count < m_maxCatchUp) {
+      tick();
+
+      m_accumulator -= m_tick;
+      ++count;
+    }
+
+    // In case the simulation can't keep up (typically
+    // after a hitch) we drop the remaining time rather
+    // than trying to catch up in the next frames.
+    if (m_accumulator >= m_tick) {
+      verbose(
+        "Dropping " + std::to_string(m_accumulator) + "s of simulation after " +
+        std::to_string(count) + " tick(s)"
+      );
+
+      m_accumulator = std::fmod(m_accumulator, m_tick);
+    }
+  }
+
+  void
+  World::setTickRate(float hz, unsigned maxCatchUp) noexcept {
+    if (hz <= 0.0f) {
+      warn("Ignoring invalid tick rate " + std::to_string(hz));
+      return;
+    }
+
+    m_tick = 1.0f / hz;
+    m_maxCatchUp = std::max(maxCatchUp, 1u);
+    m_accumulator = 0.0f;
+
+    // The clock now advances from the current moment.
+    m_origin = m_clock;
+    m_ticks = 0ul;
+  }
+
+  void
+  World::tick() {
+    // Advance the simulation clock: it is computed from
+    // the number of ticks so that rounding errors are not
+    // accumulated.
+    ++m_ticks;
+    m_clock = m_origin + utils::toMilliseconds(
+      static_cast<int>(std::round(1000.0 * m_tick * m_ticks))
+    );
+
     StepInfo si{
       m_rng,                          // rng
 
-      utils::now(),                   // moment
-      tDelta,                         // elapsed
+      m_clock,                        // moment
+      m_tick,                         // elapsed
 
       m_loc,                          // frustum
 
+      m_registry,                     // registry
+
+      m_paths,                        // paths
+
       std::vector<MobShPtr>(),        // mSpawned
-      std::vector<ProjectileShPtr>(), // pSpawned
+      m_pool,                         // pSpawned
 
       0.0f,                           // gold
     };
 
     // Make elements evolve.
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Towers are prepared concurrently: this is where they
+    // acquire their targets, which only reads the world.
+    // They are processed in batches of the same type so
+    // that each batch runs the kernel specialized for it.
+    // No other block needs to be prepared. The steps are
+    // then run in order so that the result does not depend
+    // on the number of threads.
+    groupTowers();
+
+    m_jobs.run(
+      m_batches.size(),
+      [this, &si](unsigned id, unsigned /*thread*/) {
+        const TowerBatch& b = m_batches[id];
+        Tower::prepareBatch(b.type, &m_grouped[b.first], b.count, si);
+      }
+    );
+
     for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
       m_blocks[id]->step(si);
     }
 
-    for (unsigned id = 0u ; id < m_mobs.size() ; ++id) {
-      m_mobs[id]->step(si);
-    }
+    m_profile.blocks += elapsedSince(start);
+    start = std::chrono::steady_clock::now();
+
+    // Update the state of all mobs at once before letting
+    // each of them take decisions.
+    m_store.step(m_tick);
+    stepMobs(si);
+
+    // Mobs have moved: update the locator so that
+    // projectiles can find them.
+    m_loc->refreshEntities();
+
+    m_profile.mobs += elapsedSince(start);
+    start = std::chrono::steady_clock::now();
+
+    // Compute the paths requested by the mobs, within the
+    // limit of the budget of the service.
+    m_paths.process(m_registry, m_loc, m_jobs);
+
+    m_profile.paths += elapsedSince(start);
+    start = std::chrono::steady_clock::now();
 
     for (unsigned id = 0u ; id < m_projectiles.size() ; ++id) {
       m_projectiles[id]->step(si);
     }
 
+    m_profile.projectiles += elapsedSince(start);
+    start = std::chrono::steady_clock::now();
+    double update = m_profile.update;
+
     // Process influences.
     for (unsigned id = 0u ; id < si.mSpawned.size() ; ++id) {
+      si.mSpawned[id]->attach(m_store);
+      m_registry.add(*si.mSpawned[id]);
       m_mobs.push_back(si.mSpawned[id]);
     }
 
-    for (unsigned id = 0u ; id < si.pSpawned.size() ; ++id) {
-      m_projectiles.push_back(si.pSpawned[id]);
+    unsigned fired = m_pool.flush(m_projectiles);
+    for (unsigned id = m_projectiles.size() - fired ; id < m_projectiles.size() ; ++id) {
+      m_registry.add(*m_projectiles[id]);
     }
 
-    // Remove elements marked for deletion.
+    // Credit the gold earned and record the end of the
+    // tick before the snapshot is published when the
+    // deleted elements are removed.
+    m_gold += si.gold;
+    m_lastTick = std::chrono::steady_clock::now();
+
+    // Remove elements marked for deletion. In case
+    // nothing was removed we still need to register
+    // the new entities in the locator.
+    std::size_t ms = m_mobs.size();
+    std::size_t ps = m_projectiles.size();
+
     forceDelete();
 
+    bool spawned = (!si.mSpawned.empty() || fired > 0u);
+    if (spawned && ms == m_mobs.size() && ps == m_projectiles.size()) {
+      m_loc->refreshEntities();
+    }
+
+    // The notification of the elements is accounted for
+    // in its own phase.
+    m_profile.deletion += elapsedSince(start) - (m_profile.update - update);
+    ++m_profile.ticks;
+
     // Handle cases where some gold was earned.
     if (si.gold > 0.0f) {
       onGoldEarned.safeEmit("gold earned signal", si.gold);
@@ -92,7 +423,7 @@ namespace tdef {
       return;
     }
 
-    utils::TimeStamp t = utils::now();
+    utils::TimeStamp t = m_clock;
 
     for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
       m_blocks[id]->pause(t);
@@ -116,7 +447,7 @@ namespace tdef {
       return;
     }
 
-    utils::TimeStamp t = utils::now();
+    utils::TimeStamp t = m_clock;
 
     for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
       m_blocks[id]->resume(t);
@@ -133,6 +464,110 @@ namespace tdef {
     m_paused = false;
   }
 
+  void
+  World::apply(const world::Command& cmd) {
+    if (cmd.type == world::CommandType::Pause) {
+      pause();
+      return;
+    }
+
+    if (cmd.type == world::CommandType::Resume) {
+      resume();
+      return;
+    }
+
+    if (cmd.type == world::CommandType::Paths) {
+      setSnapshot(m_publish, cmd.paths);
+      return;
+    }
+
+    if (cmd.type == world::CommandType::Select) {
+      m_selected = cmd.handle;
+      m_selectedType = cmd.selection;
+
+      publish();
+      return;
+    }
+
+    if (cmd.type == world::CommandType::Tower || cmd.type == world::CommandType::Wall) {
+      // The position may have been occupied since the
+      // command was issued.
+      utils::Point2f p(cmd.x, cmd.y);
+      if (m_loc->itemAt(p, true) != nullptr) {
+        warn("Failed to build at " + p.toString() + " as it is obstructed");
+        return;
+      }
+
+      if (m_gold < cmd.cost) {
+        warn(
+          "Can't afford building costing " + std::to_string(cmd.cost) +
+          " with only " + std::to_string(m_gold) + " gold available"
+        );
+
+        return;
+      }
+
+      m_gold -= cmd.cost;
+
+      if (cmd.type == world::CommandType::Wall) {
+        debug("Generated wall at " + p.toString());
+        spawn(std::make_shared<Wall>(Wall::newProps(p)));
+
+        return;
+      }
+
+      info("Generated tower " + towers::toString(cmd.tower) + " at " + p.toString());
+      spawn(std::make_shared<Tower>(towers::generateProps(cmd.tower, p)));
+
+      return;
+    }
+
+    // The remaining commands apply to a tower.
+    Tower* t = m_registry.get<Tower>(cmd.handle);
+    if (t == nullptr || t->isDeleted()) {
+      warn("Ignoring command for tower " + std::to_string(cmd.handle.index) + " not in the world");
+      return;
+    }
+
+    if (cmd.type == world::CommandType::Upgrade) {
+      int level = t->getUpgradeLevel(cmd.upgrade);
+      float cost = towers::getUpgradeCost(t->getType(), cmd.upgrade, level);
+      if (m_gold < cost) {
+        warn(
+          "Upgrading " + towers::toString(cmd.upgrade) + " costs " + std::to_string(cost) +
+          " but only " + std::to_string(m_gold) + " available, aborting"
+        );
+
+        return;
+      }
+
+      t->upgrade(cmd.upgrade, level + 1);
+      m_gold -= cost;
+      debug("Gold is now " + std::to_string(m_gold) + " due to cost " + std::to_string(cost));
+    }
+
+    if (cmd.type == world::CommandType::TargetMode) {
+      t->setTargetMode(nextTargetMode(t->getTargetMode()));
+    }
+
+    if (cmd.type == world::CommandType::Sell) {
+      m_gold += t->getTotalCost();
+
+      debug(
+        "Selling tower " + towers::toString(t->getType()) +
+        " for " + std::to_string(t->getTotalCost()) +
+        ", " + std::to_string(m_gold) + " now available"
+      );
+
+      t->markForDeletion(true);
+      forceDelete();
+
+      return;
+    }
+
+    publish();
+  }
+
   void
   World::spawn(BlockShPtr block) {
     if (block == nullptr) {
@@ -140,10 +575,33 @@ namespace tdef {
       return;
     }
 
-    m_blocks.push_back(block);
+    m_registry.add(*block);
+    insert(block);
+    m_loc->refreshBlocks();
 
     // Update elements.
-    onWorldUpdate();
+    world::Update wu{false, {}, {}};
+    registerCells(*block, wu.blocked);
+
+    m_field->update(*m_loc, wu);
+    onWorldUpdate(wu);
+
+    publish();
+  }
+
+  void
+  World::spawn(MobShPtr mob) {
+    if (mob == nullptr) {
+      warn("Failed to spawn null mob");
+      return;
+    }
+
+    mob->attach(m_store);
+    m_registry.add(*mob);
+    m_mobs.push_back(mob);
+    m_loc->refreshEntities();
+
+    publish();
   }
 
   void
@@ -153,49 +611,96 @@ namespace tdef {
     std::size_t ms = m_mobs.size();
     std::size_t ps = m_projectiles.size();
 
+    // Keep track of the cells freed by the deleted
+    // blocks so that elements can react to it.
+    world::Update wu{false, {}, {}};
+
     m_blocks.erase(
       std::remove_if(
         m_blocks.begin(),
         m_blocks.end(),
-        [](BlockShPtr block){
-          return block->isDeleted();
+        [this, &wu](BlockShPtr block){
+          if (!block->isDeleted()) {
+            return false;
+          }
+
+          registerCells(*block, wu.freed);
+          m_registry.remove(*block);
+          return true;
         }
       ),
       m_blocks.end()
     );
 
+    std::size_t ts = m_towers.size();
+
+    prune(m_towers);
+    prune(m_walls);
+    prune(m_portals);
+    prune(m_spawners);
+
+    if (ts != m_towers.size()) {
+      m_regroup = true;
+    }
+
     // Then remove mobs.
     m_mobs.erase(
       std::remove_if(
         m_mobs.begin(),
         m_mobs.end(),
-        [](MobShPtr mob){
-          return mob->isDeleted();
+        [this](MobShPtr mob){
+          if (!mob->isDeleted()) {
+            return false;
+          }
+
+          mob->detach();
+          m_registry.remove(*mob);
+          return true;
         }
       ),
       m_mobs.end()
     );
+    m_store.compact();
 
     // And finish with projectiles.
     m_projectiles.erase(
       std::remove_if(
         m_projectiles.begin(),
         m_projectiles.end(),
-        [](ProjectileShPtr proj){
-          return proj->isDeleted();
+        [this](const ProjectileShPtr& proj){
+          if (!proj->isDeleted()) {
+            return false;
+          }
+
+          m_registry.remove(*proj);
+          m_pool.release(proj);
+          return true;
         }
       ),
       m_projectiles.end()
     );
 
-    // Update remaining elements if anything has
-    // been removed.
-    if (bs != m_blocks.size() ||
-        ms != m_mobs.size() ||
-        ps != m_projectiles.size())
-    {
-      onWorldUpdate();
+    // Update the locator and the remaining elements
+    // if anything has been removed.
+    bool blocks = (bs != m_blocks.size());
+    bool entities = (ms != m_mobs.size() || ps != m_projectiles.size());
+
+    if (blocks) {
+      m_loc->refreshBlocks();
+      m_field->update(*m_loc, wu);
+    }
+    if (entities) {
+      m_loc->refreshEntities();
     }
+
+    // In case only mobs or projectiles were removed
+    // the layout of the world is not modified.
+    if (blocks || entities) {
+      wu.entitiesOnly = !blocks;
+      onWorldUpdate(wu);
+    }
+
+    publish();
   }
 
   void
@@ -203,10 +708,23 @@ namespace tdef {
                const std::string& file,
                const world::Difficulty& difficulty)
   {
-    // Clear all registered elements.
+    // Clear all registered elements. The registry is
+    // cleared first as it updates the elements.
+    m_registry.clear();
     m_blocks.clear();
+    m_towers.clear();
+    m_walls.clear();
+    m_portals.clear();
+    m_spawners.clear();
+    m_regroup = true;
+    m_store.clear();
     m_mobs.clear();
     m_projectiles.clear();
+    m_pool.clear();
+    m_paths.clear();
+
+    m_selected = world::Handle::invalid();
+    m_selectedType = world::SelectionType::None;
 
     // Regenerate the world.
     if (file.empty()) {
@@ -216,7 +734,27 @@ namespace tdef {
       loadFromFile(file, metadataSize);
     }
 
+    m_loc->refreshBlocks();
+    m_loc->refreshEntities();
+    m_field->rebuild(*m_loc);
+
     m_paused = true;
+
+    publish();
+  }
+
+  void
+  World::setSnapshot(bool enabled, bool paths) {
+    if (m_publish == enabled && m_publishPaths == paths) {
+      return;
+    }
+
+    m_publish = enabled;
+    m_publishPaths = paths;
+
+    // Make the snapshot reflect the new settings right
+    // away rather than waiting for the next tick.
+    publish();
   }
 
   void
@@ -242,70 +780,41 @@ namespace tdef {
     out << true << " ";
     out << m_rng << " ";
 
-    int count = 0;
+    // Save the registry so that the handles used by
+    // the elements to refer to each other can be
+    // restored.
+    out << m_registry;
 
     // Save towers.
-    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
-      if (std::dynamic_pointer_cast<Tower>(m_blocks[id]) != nullptr) {
-        ++count;
-      }
-    }
-    out << count << " ";
-
-    verbose("Saving " + std::to_string(count) + " tower(s)");
+    out << m_towers.size() << " ";
+    verbose("Saving " + std::to_string(m_towers.size()) + " tower(s)");
 
-    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
-      if (std::dynamic_pointer_cast<Tower>(m_blocks[id]) != nullptr) {
-        out << *m_blocks[id];
-      }
+    for (unsigned id = 0u ; id < m_towers.size() ; ++id) {
+      out << *m_towers[id];
     }
 
     // Save portals.
-    count = 0;
-    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
-      if (std::dynamic_pointer_cast<Portal>(m_blocks[id]) != nullptr) {
-        ++count;
-      }
-    }
-    out << count << " ";
-    verbose("Saving " + std::to_string(count) + " portal(s)");
+    out << m_portals.size() << " ";
+    verbose("Saving " + std::to_string(m_portals.size()) + " portal(s)");
 
-    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
-      if (std::dynamic_pointer_cast<Portal>(m_blocks[id]) != nullptr) {
-        out << *m_blocks[id];
-      }
+    for (unsigned id = 0u ; id < m_portals.size() ; ++id) {
+      out << *m_portals[id];
     }
 
     // Save spawners.
-    count = 0;
-    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
-      if (std::dynamic_pointer_cast<Spawner>(m_blocks[id]) != nullptr) {
-        ++count;
-      }
-    }
-    out << count << " ";
-    verbose("Saving " + std::to_string(count) + " spawner(s)");
+    out << m_spawners.size() << " ";
+    verbose("Saving " + std::to_string(m_spawners.size()) + " spawner(s)");
 
-    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
-      if (std::dynamic_pointer_cast<Spawner>(m_blocks[id]) != nullptr) {
-        out << *m_blocks[id];
-      }
+    for (unsigned id = 0u ; id < m_spawners.size() ; ++id) {
+      out << *m_spawners[id];
     }
 
     // Save walls.
-    count = 0;
-    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
-      if (std::dynamic_pointer_cast<Wall>(m_blocks[id]) != nullptr) {
-        ++count;
-      }
-    }
-    out << count << " ";
-    verbose("Saving " + std::to_string(count) + " wall(s)");
+    out << m_walls.size() << " ";
+    verbose("Saving " + std::to_string(m_walls.size()) + " wall(s)");
 
-    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
-      if (std::dynamic_pointer_cast<Wall>(m_blocks[id]) != nullptr) {
-        out << *m_blocks[id];
-      }
+    for (unsigned id = 0u ; id < m_walls.size() ; ++id) {
+      out << *m_walls[id];
     }
 
     // Save mobs.
@@ -325,6 +834,23 @@ namespace tdef {
     }
   }
 
+  std::uint64_t
+  World::hash() const noexcept {
+    std::uint64_t h = 14695981039346656037ull;
+
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      combine(h, *m_blocks[id]);
+    }
+    for (unsigned id = 0u ; id < m_mobs.size() ; ++id) {
+      combine(h, *m_mobs[id]);
+    }
+    for (unsigned id = 0u ; id < m_projectiles.size() ; ++id) {
+      combine(h, *m_projectiles[id]);
+    }
+
+    return h;
+  }
+
   void
   World::generate(const world::Difficulty& difficulty) {
     // We want to generate spawners, walls and a single portal
@@ -348,7 +874,8 @@ namespace tdef {
       std::to_string(b->getLives()) + " live(s)"
     );
 
-    m_blocks.push_back(b);
+    m_registry.add(*b);
+    insert(b);
     used.insert(keyGen(p));
 
     // Determine how many spawners and walls we need.
@@ -395,7 +922,8 @@ namespace tdef {
 
       if (used.count(key) == 0) {
         SpawnerShPtr b = std::make_shared<Spawner>(spawners::generateProps(p, lvl));
-        m_blocks.push_back(b);
+        m_registry.add(*b);
+        insert(b);
         used.insert(key);
 
         debug("Generated " + spawners::toString(lvl) + " spawner at " + p.toString());
@@ -414,7 +942,8 @@ namespace tdef {
 
       if (used.count(key) == 0) {
         WallShPtr b = std::make_shared<Wall>(Wall::newProps(p));
-        m_blocks.push_back(b);
+        m_registry.add(*b);
+        insert(b);
         used.insert(key);
 
         verbose("Generated wall at " + p.toString());
@@ -426,7 +955,22 @@ namespace tdef {
 
   void
   World::initialize() {
-    m_loc = std::make_shared<Locator>(m_blocks, m_mobs, m_projectiles);
+    m_field = std::make_shared<FlowField>();
+    m_cache = std::make_shared<PathCache>();
+    m_loc = std::make_shared<Locator>(
+      m_blocks,
+      m_towers,
+      m_walls,
+      m_portals,
+      m_spawners,
+      m_mobs,
+      m_store,
+      m_projectiles,
+      m_field,
+      m_cache
+    );
+
+    m_field->rebuild(*m_loc);
   }
 
   void
@@ -459,6 +1003,10 @@ namespace tdef {
       in >> m_rng;
     }
 
+    // Each element is restored with its handle in
+    // the registry.
+    in >> m_registry;
+
     int count = 0;
 
     // Load towers if any.
@@ -470,7 +1018,8 @@ namespace tdef {
       TowerShPtr e = std::make_shared<Tower>(Tower::newProps(utils::Point2f()));
       in >> *e;
 
-      m_blocks.push_back(e);
+      m_registry.restore(*e);
+      insert(e);
     }
 
     // Load portals.
@@ -482,7 +1031,8 @@ namespace tdef {
       PortalShPtr e = std::make_shared<Portal>(Portal::newProps(utils::Point2f()));
       in >> *e;
 
-      m_blocks.push_back(e);
+      m_registry.restore(*e);
+      insert(e);
     }
 
     // Load spawners.
@@ -494,7 +1044,8 @@ namespace tdef {
       SpawnerShPtr e = std::make_shared<Spawner>(Spawner::newProps(utils::Point2f()));
       in >> *e;
 
-      m_blocks.push_back(e);
+      m_registry.restore(*e);
+      insert(e);
     }
 
     // Load walls.
@@ -506,7 +1057,8 @@ namespace tdef {
       WallShPtr e = std::make_shared<Wall>(Wall::newProps(utils::Point2f()));
       in >> *e;
 
-      m_blocks.push_back(e);
+      m_registry.restore(*e);
+      insert(e);
     }
 
     // Load mobs if any.
@@ -518,6 +1070,8 @@ namespace tdef {
       MobShPtr e = std::make_shared<Mob>(Mob::newProps(utils::Point2f()));
       in >> *e;
 
+      e->attach(m_store);
+      m_registry.restore(*e);
       m_mobs.push_back(e);
     }
 
@@ -529,27 +1083,300 @@ namespace tdef {
     for (int id = 0 ; id < count ; ++id) {
       ProjectileShPtr e = std::make_shared<Projectile>(
         Projectile::newProps(utils::Point2f()),
-        nullptr,
-        nullptr
+        world::Handle::invalid(),
+        world::Handle::invalid()
       );
       in >> *e;
 
+      m_registry.restore(*e);
       m_projectiles.push_back(e);
     }
+
+    m_registry.rebuild();
+  }
+
+  void
+  World::insert(BlockShPtr block) {
+    m_blocks.push_back(block);
+
+    switch (block->getBlockType()) {
+      case world::BlockType::Tower:
+        m_towers.push_back(std::static_pointer_cast<Tower>(block));
+        m_regroup = true;
+        break;
+      case world::BlockType::Wall:
+        m_walls.push_back(std::static_pointer_cast<Wall>(block));
+        break;
+      case world::BlockType::Portal:
+        m_portals.push_back(std::static_pointer_cast<Portal>(block));
+        break;
+      case world::BlockType::Spawner:
+        m_spawners.push_back(std::static_pointer_cast<Spawner>(block));
+        break;
+    }
+  }
+
+  void
+  World::groupTowers() {
+    if (!m_regroup) {
+      return;
+    }
+
+    m_grouped.resize(m_towers.size());
+    for (unsigned id = 0u ; id < m_towers.size() ; ++id) {
+      m_grouped[id] = m_towers[id].get();
+    }
+
+    std::stable_sort(
+      m_grouped.begin(),
+      m_grouped.end(),
+      [](const Tower* lhs, const Tower* rhs) {
+        return lhs->getType() < rhs->getType();
+      }
+    );
+
+    // Split the towers of each type in batches of at most
+    // the number of blocks handled by a job.
+    m_batches.clear();
+    unsigned id = 0u;
+    while (id < m_grouped.size()) {
+      TowerBatch b{m_grouped[id]->getType(), id, 0u};
+
+      while (id < m_grouped.size() && m_grouped[id]->getType() == b.type && b.count < sk_blocksPerJob) {
+        ++b.count;
+        ++id;
+      }
+
+      m_batches.push_back(b);
+    }
+
+    m_regroup = false;
   }
 
   void
-  World::onWorldUpdate() {
+  World::publish() {
+    if (!m_publish) {
+      return;
+    }
+
+    // Fill the back buffer: it holds a snapshot published
+    // earlier so its lists are already allocated.
+    world::Snapshot& snap = m_snapshots.back();
+
+    snap.id = ++m_published;
+    snap.moment = std::chrono::duration<double>(m_lastTick.time_since_epoch()).count();
+    snap.tick = m_tick;
+    snap.paths = m_publishPaths;
+    snap.gold = m_gold;
+
+    snap.lives = 0.0f;
+    for (unsigned id = 0u ; id < m_portals.size() ; ++id) {
+      snap.lives += m_portals[id]->getLives();
+    }
+
+    publishSelection(snap);
+
+    snap.blocks.clear();
     for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
-      m_blocks[id]->worldUpdate(m_loc);
+      const Block& b = *m_blocks[id];
+
+      world::RenderBlock rb;
+      rb.handle = b.getHandle();
+      rb.x = b.getPos().x();
+      rb.y = b.getPos().y();
+      rb.radius = b.getRadius();
+      rb.health = b.getHealthRatio();
+      rb.orientation = b.getOrientation();
+      rb.cone = 0.0f;
+      rb.type = b.getBlockType();
+      rb.sprite = 0;
+
+      if (rb.type == world::BlockType::Tower) {
+        const Tower& t = static_cast<const Tower&>(b);
+        rb.cone = t.getAimingCone();
+        rb.sprite = world::spriteOf(t.getType());
+      }
+
+      snap.blocks.push_back(rb);
     }
 
+    snap.mobs.clear();
+    snap.points.clear();
     for (unsigned id = 0u ; id < m_mobs.size() ; ++id) {
-      m_mobs[id]->worldUpdate(m_loc);
+      const Mob& m = *m_mobs[id];
+
+      world::RenderMob rm;
+      rm.handle = m.getHandle();
+      rm.x = m.getPos().x();
+      rm.y = m.getPos().y();
+      rm.xPrev = m.getPreviousPos().x();
+      rm.yPrev = m.getPreviousPos().y();
+      rm.radius = m.getRadius();
+      rm.health = m.getHealthRatio();
+      rm.sprite = world::spriteOf(m.getType());
+
+      mobs::Effects e = m.getEffects();
+      rm.effects = 0u;
+      rm.effects |= (e.freezed ? world::Snapshot::sk_freezed : 0u);
+      rm.effects |= (e.poisoned ? world::Snapshot::sk_poisoned : 0u);
+      rm.effects |= (e.stunned ? world::Snapshot::sk_stunned : 0u);
+
+      rm.path = snap.points.size();
+      rm.points = 0u;
+
+      if (snap.paths && m.getPath().valid()) {
+        const std::vector<utils::Point2f>& cPoints = m.getPath().getPassagePoints();
+        for (unsigned p = 0u ; p < cPoints.size() ; ++p) {
+          snap.points.push_back(world::RenderPoint{cPoints[p].x(), cPoints[p].y()});
+        }
+
+        rm.points = cPoints.size();
+      }
+
+      snap.mobs.push_back(rm);
     }
 
+    // Sort the mobs in `z` order so that overlapping mobs
+    // are always drawn in the same order.
+    std::sort(
+      snap.mobs.begin(),
+      snap.mobs.end(),
+      [](const world::RenderMob& lhs, const world::RenderMob& rhs) {
+        return lhs.x < rhs.x || (lhs.x == rhs.x && lhs.y < rhs.y);
+      }
+    );
+
+    snap.projectiles.clear();
     for (unsigned id = 0u ; id < m_projectiles.size() ; ++id) {
-      m_projectiles[id]->worldUpdate(m_loc);
+      const Projectile& p = *m_projectiles[id];
+
+      snap.projectiles.push_back(
+        world::RenderProjectile{
+          p.getPos().x(),
+          p.getPos().y(),
+          p.getPreviousPos().x(),
+          p.getPreviousPos().y()
+        }
+      );
+    }
+
+    m_snapshots.publish();
+  }
+
+  void
+  World::publishSelection(world::Snapshot& snap) const {
+    world::Selection& s = snap.selection;
+    s.handle = m_selected;
+    s.type = world::SelectionType::None;
+
+    if (m_selectedType == world::SelectionType::Mob) {
+      const Mob* m = m_registry.get<Mob>(m_selected);
+      if (m == nullptr || m->isDeleted()) {
+        return;
+      }
+
+      s.health = m->getHealth();
+      s.mob = m->getType();
+      s.speed = m->getSpeed();
+      s.bounty = m->getBounty();
+    }
+
+    if (m_selectedType == world::SelectionType::Spawner ||
+        m_selectedType == world::SelectionType::Wall)
+    {
+      const Block* b = m_registry.get<Block>(m_selected);
+      if (b == nullptr || b->isDeleted()) {
+        return;
+      }
+
+      s.health = b->getHealth();
+    }
+
+    if (m_selectedType == world::SelectionType::Tower) {
+      const Tower* t = m_registry.get<Tower>(m_selected);
+      if (t == nullptr || t->isDeleted()) {
+        return;
+      }
+
+      s.health = t->getHealth();
+      s.tower = t->getType();
+      s.mode = t->getTargetMode();
+      s.cost = t->getTotalCost();
+
+      towers::Upgrades ug = t->getUpgrades();
+
+      s.count = 0u;
+      for (towers::Upgrades::const_iterator it = ug.cbegin() ;
+           it != ug.cend() && s.count < s.upgrades.size() ;
+           ++it)
+      {
+        s.upgrades[s.count] = world::SelectedUpgrade{it->first, it->second, upgradeValue(*t, it->first)};
+        ++s.count;
+      }
+    }
+
+    s.type = m_selectedType;
+  }
+
+  void
+  World::onWorldUpdate(const world::Update& update) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    for (unsigned id = 0u ; id < m_blocks.size() ; ++id) {
+      m_blocks[id]->worldUpdate(m_loc, update);
+    }
+
+    for (unsigned id = 0u ; id < m_mobs.size() ; ++id) {
+      m_mobs[id]->worldUpdate(m_loc, update);
+    }
+
+    for (unsigned id = 0u ; id < m_projectiles.size() ; ++id) {
+      m_projectiles[id]->worldUpdate(m_loc, update);
+    }
+
+    m_profile.update += elapsedSince(start);
+  }
+
+  void
+  World::stepMobs(StepInfo& info) {
+    m_commands.resize(m_jobs.size());
+    for (unsigned id = 0u ; id < m_commands.size() ; ++id) {
+      m_commands[id].clear();
+    }
+
+    m_jobs.run(
+      m_mobs.size(),
+      [this, &info](unsigned id, unsigned thread) {
+        mobs::Command cmd;
+        if (m_mobs[id]->advance(info, cmd)) {
+          m_commands[thread].push_back(MobCommand{id, cmd});
+        }
+      },
+      sk_mobsPerJob
+    );
+
+    // Move the mobs which are still following their path
+    // all at once.
+    m_store.move(info.elapsed);
+
+    // Each buffer holds the commands of the chunks processed
+    // by a thread which depend on the scheduling: sorting
+    // them by mob gives the same order in all cases.
+    m_merged.clear();
+    for (unsigned id = 0u ; id < m_commands.size() ; ++id) {
+      m_merged.insert(m_merged.end(), m_commands[id].begin(), m_commands[id].end());
+    }
+
+    std::sort(
+      m_merged.begin(),
+      m_merged.end(),
+      [](const MobCommand& lhs, const MobCommand& rhs) {
+        return lhs.mob < rhs.mob;
+      }
+    );
+
+    for (unsigned id = 0u ; id < m_merged.size() ; ++id) {
+      m_mobs[m_merged[id].mob]->apply(info, m_merged[id].cmd);
     }
   }
 
@@ -3,16 +3,32 @@
 
 # include <vector>
 # include <memory>
+# include <chrono>
 # include <fstream>
+# include <cstdint>
 # include <core_utils/CoreObject.hh>
 # include <core_utils/Signal.hh>
 # include <core_utils/RNG.hh>
+# include <core_utils/TimeUtils.hh>
 # include <maths_utils/Point2.hh>
 # include "Mob.hh"
 # include "Tower.hh"
+# include "Wall.hh"
+# include "Portal.hh"
+# include "Spawner.hh"
 # include "Projectile.hh"
+# include "ProjectilePool.hh"
 # include "Block.hh"
 # include "Locator.hh"
+# include "FlowField.hh"
+# include "PathCache.hh"
+# include "PathService.hh"
+# include "MobStore.hh"
+# include "Registry.hh"
+# include "JobPool.hh"
+# include "Snapshot.hh"
+# include "Command.hh"
+# include "TripleBuffer.hh"
 
 namespace tdef {
 
@@ -43,6 +59,39 @@ namespace tdef {
       Hard
     };
 
+    /**
+     * @brief - Convenience structure holding the time spent in
+     *          each phase of the simulation. Durations are in
+     *          milliseconds and accumulated over the ticks run
+     *          since the last reset of the profile.
+     */
+    struct Profile {
+      // The number of ticks accounted for.
+      unsigned long ticks;
+
+      // Time spent stepping blocks.
+      double blocks;
+
+      // Time spent stepping mobs, including the refresh
+      // of the locator after they moved.
+      double mobs;
+
+      // Time spent computing the paths requested by the
+      // mobs.
+      double paths;
+
+      // Time spent stepping projectiles.
+      double projectiles;
+
+      // Time spent registering spawned entities and
+      // removing the dead ones.
+      double deletion;
+
+      // Time spent notifying elements of changes in the
+      // world.
+      double update;
+    };
+
   }
 
   class World: public utils::CoreObject {
@@ -69,17 +118,73 @@ namespace tdef {
       locator() const noexcept;
 
       /**
-       * @brief - Used to move one step ahead in time in this
-       *          world, given that `tDelta` represents the
-       *          duration of the last frame in seconds. The
-       *          method is also given the controls as input
-       *          so that it can be made available to entities.
+       * @brief - Used to move ahead in time in this world,
+       *          given that `tDelta` represents the duration
+       *          of the last frame in seconds. The simulation
+       *          is advanced by ticks of a fixed duration: the
+       *          frame duration is accumulated and as many
+       *          ticks as possible are consumed, up to a limit
+       *          so that a long frame does not trigger a large
+       *          number of ticks. The remaining time is kept
+       *          for the next frame.
        * @param tDelta - the duration of the last frame in
        *                 seconds.
        */
       void
       step(float tDelta);
 
+      /**
+       * @brief - Define the rate at which the simulation is
+       *          advanced. Lowering the rate reduces the cost
+       *          of the simulation without changing the speed
+       *          at which the game evolves.
+       * @param hz - the number of ticks per second.
+       * @param maxCatchUp - the maximum number of ticks that
+       *                     can be processed in a single call
+       *                     to `step`.
+       */
+      void
+      setTickRate(float hz, unsigned maxCatchUp = sk_maxCatchUpTicks) noexcept;
+
+      /**
+       * @brief - Return the duration of a simulation tick.
+       * @return - the duration of a tick in seconds.
+       */
+      float
+      getTickDuration() const noexcept;
+
+      /**
+       * @brief - Define the number of threads used to prepare
+       *          the step of the blocks. The result of the
+       *          simulation does not depend on it: forcing a
+       *          single thread is mostly useful to debug.
+       * @param threads - the number of threads, `0` meaning
+       *                  as many as the machine has.
+       */
+      void
+      setThreads(unsigned threads);
+
+      /**
+       * @brief - Return the number of threads used to prepare
+       *          the step of the blocks.
+       * @return - the number of threads.
+       */
+      unsigned
+      getThreads() const noexcept;
+
+      /**
+       * @brief - Return the fraction of a tick that has been
+       *          accumulated but not simulated yet. Renderers
+       *          can use it to interpolate the position of the
+       *          entities between their previous and current
+       *          positions. Only meaningful on the thread which
+       *          steps the world: other threads should rely on
+       *          the snapshots.
+       * @return - a value in the range `[0; 1]`.
+       */
+      float
+      getInterpolation() const noexcept;
+
       /**
        * @brief - Used to indicate that the world should be
        *          paused. Time based entities and actions
@@ -98,6 +203,34 @@ namespace tdef {
       void
       resume();
 
+      /**
+       * @brief - Apply the command requested by the player. The
+       *          command is checked against the current state of
+       *          the world: building on an occupied position or
+       *          without enough gold, or targeting an element no
+       *          longer in the world, is ignored.
+       * @param cmd - the command to apply.
+       */
+      void
+      apply(const world::Command& cmd);
+
+      /**
+       * @brief - Return the gold available to the player. It is
+       *          increased by the bounty of the mobs killed and
+       *          spent by the commands.
+       * @return - the gold available.
+       */
+      float
+      getGold() const noexcept;
+
+      /**
+       * @brief - Define the gold available to the player, for
+       *          example when starting a new game.
+       * @param gold - the gold available.
+       */
+      void
+      setGold(float gold) noexcept;
+
       /**
        * @brief - Used to perform the registration of this
        *          block assuming it is valid. No checks are
@@ -108,9 +241,20 @@ namespace tdef {
       void
       spawn(BlockShPtr block);
 
+      /**
+       * @brief - Used to register the input mob in the world.
+       *          Just like for blocks no checks are performed
+       *          on the validity of its position.
+       * @param mob - the mob to spawn.
+       */
+      void
+      spawn(MobShPtr mob);
+
       /**
        * @brief - Used to force the update of elements to
-       *          be deleted and delete them right away.
+       *          be deleted and delete them right away. As it
+       *          is the last phase of a tick, the snapshot of
+       *          the world is published afterwards.
        */
       void
       forceDelete();
@@ -150,6 +294,102 @@ namespace tdef {
       void
       save(const std::string& file) const;
 
+      /**
+       * @brief - Return the number of blocks currently registered
+       *          in the world.
+       * @return - the number of blocks.
+       */
+      unsigned
+      getBlocksCount() const noexcept;
+
+      /**
+       * @brief - Return the number of mobs currently alive in the
+       *          world.
+       * @return - the number of mobs.
+       */
+      unsigned
+      getMobsCount() const noexcept;
+
+      /**
+       * @brief - Return the number of projectiles currently alive
+       *          in the world.
+       * @return - the number of projectiles.
+       */
+      unsigned
+      getProjectilesCount() const noexcept;
+
+      /**
+       * @brief - Return the pool used to create projectiles. It
+       *          can be used to query how many projectiles were
+       *          created or reused.
+       * @return - the pool of projectiles.
+       */
+      const ProjectilePool&
+      getProjectilePool() const noexcept;
+
+      /**
+       * @brief - Compute a digest of the state of the world: it
+       *          accounts for the position and health of all the
+       *          elements in the order in which they're stored.
+       *          Two simulations starting from the same world and
+       *          advanced by the same number of ticks should give
+       *          the same digest.
+       * @return - a hash of the state of the world.
+       */
+      std::uint64_t
+      hash() const noexcept;
+
+      /**
+       * @brief - Return the time spent in each phase of the
+       *          simulation since the last reset.
+       * @return - the profile of the simulation.
+       */
+      const world::Profile&
+      getProfile() const noexcept;
+
+      /**
+       * @brief - Reset the profiling information gathered so
+       *          far.
+       */
+      void
+      resetProfile() noexcept;
+
+      /**
+       * @brief - Define whether the world should publish a
+       *          snapshot of its elements to be rendered. It
+       *          is published after each tick and each time
+       *          the elements change outside of a tick. This
+       *          is disabled by default as headless runs do
+       *          not need it.
+       * @param enabled - `true` to publish the snapshots.
+       * @param paths - `true` if the paths of the mobs should
+       *                be included in the snapshots.
+       */
+      void
+      setSnapshot(bool enabled, bool paths = false);
+
+      /**
+       * @brief - Make the last snapshot published by the world
+       *          the one returned by `getSnapshot`. Snapshots are
+       *          exchanged through a triple buffer: this can be
+       *          called from another thread than the one which
+       *          steps the world, as long as it is always the
+       *          same one.
+       * @return - `true` if a new snapshot was acquired.
+       */
+      bool
+      acquireSnapshot() noexcept;
+
+      /**
+       * @brief - Return the last snapshot acquired from the world.
+       *          It stays the same until the next call to the
+       *          `acquireSnapshot` method. It is empty in case
+       *          publishing the snapshots is disabled.
+       * @return - the last acquired snapshot of the world.
+       */
+      const world::Snapshot&
+      getSnapshot() const noexcept;
+
     private:
 
       /**
@@ -172,6 +412,15 @@ namespace tdef {
       void
       initialize();
 
+      /**
+       * @brief - Used to advance the simulation of a single tick
+       *          of fixed duration. This includes stepping each
+       *          element of the world, registering the spawned
+       *          elements and removing the ones that are dead.
+       */
+      void
+      tick();
+
       /**
        * @brief - Attempt to load a world from the file as
        *          specified in input.
@@ -187,16 +436,83 @@ namespace tdef {
       loadFromFile(const std::string& file,
                    unsigned metadataSize);
 
+      /**
+       * @brief - Used to add the block to the list of blocks of
+       *          the world and to the list matching its type. It
+       *          does not register the block in the registry.
+       * @param block - the block to add.
+       */
+      void
+      insert(BlockShPtr block);
+
+      /**
+       * @brief - Used to sort the towers by type and to split
+       *          them in batches prepared by a single job each.
+       *          Nothing happens in case the towers did not
+       *          change since the last call.
+       */
+      void
+      groupTowers();
+
+      /**
+       * @brief - Used to copy the elements of the world to the
+       *          snapshot if it is enabled. The lists of the
+       *          snapshot are reused so that no memory should be
+       *          allocated once the world reached its size.
+       */
+      void
+      publish();
+
+      /**
+       * @brief - Used to copy the properties of the selected
+       *          element to the input snapshot.
+       * @param snap - the snapshot to fill.
+       */
+      void
+      publishSelection(world::Snapshot& snap) const;
+
       /**
        * @brief - Used to perform an update of all elements
        *          still existing in the world in response to
        *          a world change.
+       * @param update - the description of the change.
+       */
+      void
+      onWorldUpdate(const world::Update& update);
+
+      /**
+       * @brief - Step all the mobs of the world. Mobs advance in
+       *          parallel and record the actions they want to
+       *          perform on the rest of the world in the buffer
+       *          of the thread processing them. The actions are
+       *          then applied in the order of the mobs.
+       * @param info - information about the current step.
        */
       void
-      onWorldUpdate();
+      stepMobs(StepInfo& info);
 
     private:
 
+      /**
+       * @brief - Convenience structure associating a command to
+       *          the index of the mob which issued it.
+       */
+      struct MobCommand {
+        unsigned mob;
+        mobs::Command cmd;
+      };
+
+      /**
+       * @brief - Convenience structure describing a range of
+       *          towers of the same type in the list of the
+       *          grouped towers.
+       */
+      struct TowerBatch {
+        towers::Type type;
+        unsigned first;
+        unsigned count;
+      };
+
       /**
        * @brief - Convenience define to handle the dimension of a newly
        *          generated world.
@@ -210,6 +526,31 @@ namespace tdef {
        */
       static constexpr float sk_spawnerRingWidth = 0.05f;
 
+      /**
+       * @brief - The default number of simulation ticks per
+       *          second.
+       */
+      static constexpr float sk_defaultTickRate = 30.0f;
+
+      /**
+       * @brief - The default maximum number of ticks that can
+       *          be processed in a single step. Any time left
+       *          after this is discarded.
+       */
+      static constexpr unsigned sk_maxCatchUpTicks = 5u;
+
+      /**
+       * @brief - The number of blocks prepared by each job of
+       *          the pool.
+       */
+      static constexpr unsigned sk_blocksPerJob = 8u;
+
+      /**
+       * @brief - The number of mobs advanced by each job of the
+       *          pool.
+       */
+      static constexpr unsigned sk_mobsPerJob = 64u;
+
       /**
        * @brief - The random number engine for this world: allows to
        *          make the simulation deterministic by gathering all
@@ -222,16 +563,80 @@ namespace tdef {
        */
       std::vector<BlockShPtr> m_blocks;
 
+      /**
+       * @brief - The blocks of the world split by type. Each of
+       *          them is also part of the list of blocks and is
+       *          kept in the same relative order.
+       */
+      std::vector<TowerShPtr> m_towers;
+      std::vector<WallShPtr> m_walls;
+      std::vector<PortalShPtr> m_portals;
+      std::vector<SpawnerShPtr> m_spawners;
+
+      /**
+       * @brief - The towers sorted by type, the batches in which
+       *          they are split to be prepared and whether they
+       *          should be grouped again as towers were added or
+       *          removed.
+       */
+      std::vector<Tower*> m_grouped;
+      std::vector<TowerBatch> m_batches;
+      bool m_regroup;
+
       /**
        * @brief - The list of mobs available in this world.
        */
       std::vector<MobShPtr> m_mobs;
 
+      /**
+       * @brief - The store holding the state of the mobs that
+       *          evolves at each step. Each mob of the world is
+       *          registered in it, in the same order as in the
+       *          list of mobs.
+       */
+      MobStore m_store;
+
       /**
        * @brief - The list of projectiles waiting to do damage.
        */
       std::vector<ProjectileShPtr> m_projectiles;
 
+      /**
+       * @brief - The pool from which the projectiles fired by
+       *          the towers are taken. Deleted projectiles are
+       *          returned to it.
+       */
+      ProjectilePool m_pool;
+
+      /**
+       * @brief - The registry assigning a handle to each of the
+       *          elements of the world. Elements use it to refer
+       *          to each other.
+       */
+      Registry m_registry;
+
+      /**
+       * @brief - The pool used to prepare the step of the blocks
+       *          and to advance the mobs in parallel.
+       */
+      JobPool m_jobs;
+
+      /**
+       * @brief - The commands issued by the mobs during a step,
+       *          one buffer per thread of the pool, and all of
+       *          them merged in the order of the mobs. Kept from
+       *          one step to the next to reuse the memory.
+       */
+      std::vector<std::vector<MobCommand>> m_commands;
+      std::vector<MobCommand> m_merged;
+
+      /**
+       * @brief - The service computing the paths requested by
+       *          the mobs. A limited number of requests are
+       *          handled at each step.
+       */
+      PathService m_paths;
+
       /**
        * @brief - Defines whether this world is paused (i.e.
        *          internal attributes of the mobs/blocks/etc
@@ -242,18 +647,105 @@ namespace tdef {
        */
       bool m_paused;
 
+      /**
+       * @brief - The duration of a simulation tick in seconds.
+       */
+      float m_tick;
+
+      /**
+       * @brief - The maximum number of ticks to process in a
+       *          single step.
+       */
+      unsigned m_maxCatchUp;
+
+      /**
+       * @brief - The duration accumulated from the frames and
+       *          not yet simulated, in seconds.
+       */
+      float m_accumulator;
+
+      /**
+       * @brief - The moment from which the ticks are counted and
+       *          the number of ticks simulated since then. This
+       *          is used to compute the simulation clock without
+       *          accumulating rounding errors.
+       */
+      utils::TimeStamp m_origin;
+      unsigned long m_ticks;
+
+      /**
+       * @brief - The simulation clock: it only advances when
+       *          ticks are processed and is used instead of the
+       *          wall clock for all time based effects.
+       */
+      utils::TimeStamp m_clock;
+
+      /**
+       * @brief - The time spent in each phase of the ticks.
+       */
+      world::Profile m_profile;
+
       /**
        * @brief - The locator to use to organize objects and
        *          mobs based on their position.
        */
       LocatorShPtr m_loc;
 
+      /**
+       * @brief - The flow field allowing mobs to reach the
+       *          portals. It is updated whenever the blocks
+       *          of the world change.
+       */
+      FlowFieldShPtr m_field;
+
+      /**
+       * @brief - The cache of paths computed by mobs. Paths are
+       *          discarded whenever the blocks of the world
+       *          change.
+       */
+      PathCacheShPtr m_cache;
+
+      /**
+       * @brief - The gold available to the player.
+       */
+      float m_gold;
+
+      /**
+       * @brief - The element selected by the player and its type.
+       *          Its properties are included in the snapshots.
+       */
+      world::Handle m_selected;
+      world::SelectionType m_selectedType;
+
+      /**
+       * @brief - Whether the snapshot of the world should be
+       *          published and whether it includes the paths of
+       *          the mobs.
+       */
+      bool m_publish;
+      bool m_publishPaths;
+
+      /**
+       * @brief - The number of snapshots published so far and
+       *          the moment at which the last tick was simulated.
+       */
+      unsigned long m_published;
+      std::chrono::steady_clock::time_point m_lastTick;
+
+      /**
+       * @brief - The snapshots of the world: the simulation fills
+       *          the back buffer while the renderer reads the front
+       *          one.
+       */
+      TripleBuffer<world::Snapshot> m_snapshots;
+
     public:
 
       /**
        * @brief - Signal emitted whenever gold is earned during
        *          a simulation step for the world. The parameter
-       *          corresponds to the amount of gold earned.
+       *          corresponds to the amount of gold earned. It is
+       *          emitted by the thread stepping the world.
        */
       utils::Signal<float> onGoldEarned;
   };
@@ -2,6 +2,7 @@
 # define   WORLD_HXX
 
 # include "World.hh"
+# include <algorithm>
 
 namespace tdef {
 
@@ -14,6 +15,90 @@ namespace tdef {
     return m_loc;
   }
 
+  inline
+  float
+  World::getTickDuration() const noexcept {
+    return m_tick;
+  }
+
+  inline
+  void
+  World::setThreads(unsigned threads) {
+    m_jobs.resize(threads);
+  }
+
+  inline
+  unsigned
+  World::getThreads() const noexcept {
+    return m_jobs.size();
+  }
+
+  inline
+  float
+  World::getInterpolation() const noexcept {
+    return std::min(m_accumulator / m_tick, 1.0f);
+  }
+
+  inline
+  const world::Profile&
+  World::getProfile() const noexcept {
+    return m_profile;
+  }
+
+  inline
+  void
+  World::resetProfile() noexcept {
+    m_profile = world::Profile{0ul, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+  }
+
+  inline
+  float
+  World::getGold() const noexcept {
+    return m_gold;
+  }
+
+  inline
+  void
+  World::setGold(float gold) noexcept {
+    m_gold = gold;
+  }
+
+  inline
+  bool
+  World::acquireSnapshot() noexcept {
+    return m_snapshots.acquire();
+  }
+
+  inline
+  const world::Snapshot&
+  World::getSnapshot() const noexcept {
+    return m_snapshots.front();
+  }
+
+  inline
+  unsigned
+  World::getBlocksCount() const noexcept {
+    return m_blocks.size();
+  }
+
+  inline
+  unsigned
+  World::getMobsCount() const noexcept {
+    return m_mobs.size();
+  }
+
+  inline
+  unsigned
+  World::getProjectilesCount() const noexcept {
+    return m_projectiles.size();
+  }
+
+  inline
+  const ProjectilePool&
+  World::getProjectilePool() const noexcept {
+    return m_pool;
+  }
+
 }
 
 #endif    /* WORLD_HXX */
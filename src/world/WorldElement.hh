@@ -9,6 +9,8 @@
 # include <core_utils/Uuid.hh>
 # include <maths_utils/Point2.hh>
 # include "StepInfo.hh"
+# include "WorldUpdate.hh"
+# include "Handle.hh"
 
 namespace tdef {
 
@@ -22,6 +24,34 @@ namespace tdef {
       const utils::Point2f&
       getPos() const noexcept;
 
+      /**
+       * @brief - Retrieve the position of this element at the
+       *          beginning of the last simulation step. It can
+       *          be used to interpolate the position between two
+       *          steps.
+       * @return - the previous position for this element.
+       */
+      const utils::Point2f&
+      getPreviousPos() const noexcept;
+
+      /**
+       * @brief - Return the handle assigned to this element by
+       *          the registry of the world. It is invalid while
+       *          the element is not part of a world.
+       * @return - the handle of this element.
+       */
+      const world::Handle&
+      getHandle() const noexcept;
+
+      /**
+       * @brief - Define the handle of this element. This is
+       *          only meant to be used by the registry of the
+       *          world.
+       * @param h - the new handle of this element.
+       */
+      void
+      setHandle(const world::Handle& h) noexcept;
+
       /**
        * @brief - Interrogate the internal identifier for the
        *          owner of this entity and return `true` if
@@ -203,9 +233,11 @@ namespace tdef {
        *          (which might change the pathes).
        * @param loc - information about the current step of
        *               the game.
+       * @param update - a description of what changed in the
+       *                 world.
        */
       virtual void
-      worldUpdate(LocatorShPtr loc) = 0;
+      worldUpdate(LocatorShPtr loc, const world::Update& update) = 0;
 
     protected:
 
@@ -256,6 +288,30 @@ namespace tdef {
       void
       setOwner(const utils::Uuid& uuid);
 
+      /**
+       * @brief - Reinitialize this element from the specified
+       *          properties as if it was just created. It is
+       *          used to reuse elements rather than creating
+       *          new ones.
+       * @param props - the properties to use to define this
+       *                world element.
+       */
+      void
+      assign(const Props& props) noexcept;
+
+      /**
+       * @brief - Serialize the properties of this element to the
+       *          stream using the input position and health. It
+       *          allows elements which keep this data elsewhere
+       *          to be saved in the same format.
+       * @param out - the stream to serialize into.
+       * @param p - the position of the element.
+       * @param health - the current health of the element.
+       * @return - the modified stream.
+       */
+      std::ostream&
+      serialize(std::ostream& out, const utils::Point2f& p, float health) const;
+
     protected:
 
       /**
@@ -266,12 +322,26 @@ namespace tdef {
        */
       utils::Uuid m_owner;
 
+      /**
+       * @brief - The handle of this element in the registry of
+       *          the world. Other elements use it to refer to
+       *          this one without keeping it alive.
+       */
+      world::Handle m_handle;
+
       /**
        * @brief - The home position of this mob. Used when the
        *          entity needs to come back home.
        */
       utils::Point2f m_pos;
 
+      /**
+       * @brief - The position of the element at the beginning
+       *          of the last simulation step. Elements that are
+       *          moving are responsible for updating it.
+       */
+      utils::Point2f m_prevPos;
+
       /**
        * @brief - Define the size of the entity expressed in
        *          blocks. This value is guaranteed to be at
@@ -14,6 +14,24 @@ namespace tdef {
     return m_pos;
   }
 
+  inline
+  const utils::Point2f&
+  WorldElement::getPreviousPos() const noexcept {
+    return m_prevPos;
+  }
+
+  inline
+  const world::Handle&
+  WorldElement::getHandle() const noexcept {
+    return m_handle;
+  }
+
+  inline
+  void
+  WorldElement::setHandle(const world::Handle& h) noexcept {
+    m_handle = h;
+  }
+
   inline
   bool
   WorldElement::isOwned() const noexcept {
@@ -95,21 +113,7 @@ namespace tdef {
   inline
   std::ostream&
   WorldElement::operator<<(std::ostream& out) const {
-    // Save props in order.
-    out << m_owner << " ";
-
-    out << m_pos.x() << " ";
-    out << m_pos.y() << " ";
-    out << m_radius << " ";
-
-    out << m_totalHealth << " ";
-    out << m_health << " ";
-
-    out << m_deleted << " ";
-
-    verbose("Saved world element at " + m_pos.toString());
-
-    return out;
+    return serialize(out, m_pos, m_health);
   }
 
   inline
@@ -120,12 +124,14 @@ namespace tdef {
 
     in >> m_pos.x();
     in >> m_pos.y();
+    m_prevPos = m_pos;
     in >> m_radius;
 
     in >> m_totalHealth;
     in >> m_health;
 
     in >> m_deleted;
+    in >> m_handle;
 
     verbose("Restored world element at " + m_pos.toString());
 
@@ -146,13 +152,36 @@ namespace tdef {
     pp.owner = owner;
   }
 
+  inline
+  std::ostream&
+  WorldElement::serialize(std::ostream& out, const utils::Point2f& p, float health) const {
+    // Save props in order.
+    out << m_owner << " ";
+
+    out << p.x() << " ";
+    out << p.y() << " ";
+    out << m_radius << " ";
+
+    out << m_totalHealth << " ";
+    out << health << " ";
+
+    out << m_deleted << " ";
+    out << m_handle;
+
+    verbose("Saved world element at " + p.toString());
+
+    return out;
+  }
+
   inline
   WorldElement::WorldElement(const Props& props,
                              const std::string& name):
     utils::CoreObject(name),
 
     m_owner(props.owner),
+    m_handle(world::Handle::invalid()),
     m_pos(props.pos),
+    m_prevPos(props.pos),
 
     m_radius(props.radius <= 0.0f ? 1.0f : props.radius),
 
@@ -170,6 +199,21 @@ namespace tdef {
     m_owner = uuid;
   }
 
+  inline
+  void
+  WorldElement::assign(const Props& props) noexcept {
+    m_owner = props.owner;
+    m_pos = props.pos;
+    m_prevPos = props.pos;
+
+    m_radius = (props.radius <= 0.0f ? 1.0f : props.radius);
+
+    m_totalHealth = std::max(props.health, 0.0f);
+    m_health = m_totalHealth;
+
+    m_deleted = false;
+  }
+
 }
 
 inline
@@ -0,0 +1,40 @@
+#ifndef    WORLD_UPDATE_HH
+# define   WORLD_UPDATE_HH
+
+# include <vector>
+
+namespace tdef {
+  namespace world {
+
+    /**
+     * @brief - Describe a cell of the world. A cell has a size
+     *          of `1` and contains all the positions with the
+     *          same integer part as its coordinates.
+     */
+    struct Cell {
+      int x;
+      int y;
+    };
+
+    /**
+     * @brief - Convenience structure describing a change in the
+     *          world that was notified to its elements. It allows
+     *          elements to only react to the changes that might
+     *          impact them.
+     */
+    struct Update {
+      // Whether the change only concerns mobs or projectiles:
+      // in this case the layout of the world did not change.
+      bool entitiesOnly;
+
+      // The cells which became obstructed by a new block.
+      std::vector<Cell> blocked;
+
+      // The cells which were obstructed by a deleted block.
+      std::vector<Cell> freed;
+    };
+
+  }
+}
+
+#endif    /* WORLD_UPDATE_HH */
@@ -1,7 +1,9 @@
 
 # include "AStar.hh"
-# include <deque>
-# include <iterator>
+# include <cmath>
+# include <cstdint>
+# include <algorithm>
+# include <unordered_map>
 
 namespace {
 
@@ -22,216 +24,250 @@ namespace {
   };
 
   /**
-   * @brief - Convenience structure to define an opened node.
+   * @brief - Defines for each neighbor the mask of the cells
+   *          that should be free for it to be reachable from
+   *          the center cell. Only diagonal neighbors have a
+   *          non trivial value.
+   */
+  constexpr std::uint8_t corners[Count] = {
+    0u,                               // North
+    (1u << North) | (1u << East),     // NorthEast
+    0u,                               // East
+    (1u << South) | (1u << East),     // SouthEast
+    0u,                               // South
+    (1u << South) | (1u << West),     // SouthWest
+    0u,                               // West
+    (1u << North) | (1u << West),     // NorthWest
+  };
+
+  /**
+   * @brief - The offsets of each neighbor of a cell along
+   *          the `x` and `y` axis, in the order defined by
+   *          the `Neighbor` enumeration.
+   */
+  constexpr int dx[Count] = {0, 1, 1,  1,  0, -1, -1, -1};
+  constexpr int dy[Count] = {1, 1, 0, -1, -1, -1,  0,  1};
+
+  /**
+   * @brief - Used to pack the coordinates of a cell into
+   *          a single integer value. This allows to use a
+   *          cheap key when looking for the node attached
+   *          to a cell, no matter the size of the world.
+   * @param x - the abscissa of the cell.
+   * @param y - the ordinate of the cell.
+   * @return - the identifier of the cell.
+   */
+  inline
+  std::uint64_t
+  pack(int x, int y) noexcept {
+    return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) |
+           static_cast<std::uint64_t>(static_cast<std::uint32_t>(y));
+  }
+
+  /**
+   * @brief - Return the identifier of the cell containing
+   *          the input position. Cells are defined so that
+   *          a position belongs to the cell obtained by
+   *          flooring its coordinates, which works both for
+   *          positive and negative values.
+   * @param p - the position.
+   * @return - the identifier of the cell.
+   */
+  inline
+  std::uint64_t
+  cellOf(const utils::Point2f& p) noexcept {
+    return pack(
+      static_cast<int>(std::floor(p.x())),
+      static_cast<int>(std::floor(p.y()))
+    );
+  }
+
+  /**
+   * @brief - Compute the octile distance between two cells:
+   *          this corresponds to the length of the shortest
+   *          path between them when moving along the eight
+   *          directions and assuming no obstacles. It is an
+   *          admissible and consistent heuristic for the A*.
+   * @param x1 - the abscissa of the first cell.
+   * @param y1 - the ordinate of the first cell.
+   * @param x2 - the abscissa of the second cell.
+   * @param y2 - the ordinate of the second cell.
+   * @return - the octile distance between both cells.
+   */
+  inline
+  float
+  octile(int x1, int y1, int x2, int y2) noexcept {
+    int ax = std::abs(x2 - x1);
+    int ay = std::abs(y2 - y1);
+
+    return 1.0f * std::max(ax, ay) + 0.41421356f * std::min(ax, ay);
+  }
+
+  /**
+   * @brief - Convenience structure to define a node of the
+   *          search. The `heap` index is negative for nodes
+   *          that are not in the open list, and `closed` is
+   *          set once the node has been expanded.
    */
   struct Node {
+    int x;
+    int y;
     utils::Point2f p;
     float c;
     float h;
+    int parent;
+    int heap;
+    bool closed;
+  };
+
+  /**
+   * @brief - Scratch memory used by the algorithm. It holds
+   *          all the nodes created during a search along
+   *          with the open list, organized as a binary heap
+   *          of node indices. Each node keeps its position
+   *          in the heap so that its cost can be decreased
+   *          without searching for it.
+   *          A single instance is kept for each thread so
+   *          that the memory is reused across searches.
+   */
+  struct Scratch {
+    std::vector<Node> nodes;
+    std::vector<int> heap;
+    std::unordered_map<std::uint64_t, int> ids;
+
+    void
+    reset() noexcept;
 
     bool
-    contains(const utils::Point2f& p) const noexcept;
-
-    std::vector<Node>
-    generateNeighbors(const utils::Point2f& target) const noexcept;
-
-    /**
-     * @brief - Use a basic string transformation to do
-     *          a conversion of the coordinates for this
-     *          node to a single string.
-     * @return - the mapped string for this node.
-     */
-    std::string
-    hash() const noexcept;
-
-    /**
-     * @brief - Used to invert the hash provided as input
-     *          to a set of coordinates. As we hash any
-     *          non integer coordinates to the same value
-     *          we will consider that the point lies at
-     *          the center of the cell.
-     * @param hash - the value to invert.
-     * @return - the normalized coordinates computed from
-     *           the hash.
-     */
-    static
-    utils::Point2f
-    invertHash(const std::string& hash) noexcept;
+    less(int lhs, int rhs) const noexcept;
+
+    void
+    swap(int i, int j) noexcept;
+
+    void
+    up(int i) noexcept;
+
+    void
+    down(int i) noexcept;
+
+    void
+    push(int node) noexcept;
+
+    int
+    pop() noexcept;
   };
 
+  inline
+  void
+  Scratch::reset() noexcept {
+    // Clearing the containers keeps the memory they
+    // allocated so that it can be reused.
+    nodes.clear();
+    heap.clear();
+    ids.clear();
+  }
+
   inline
   bool
-  Node::contains(const utils::Point2f& m) const noexcept {
-    // We want to compare the floating point values
-    // by considering that they belong to the cell
-    // right before the one it is in.
-    // So for example:
-    // `(1.2, 2.7)` -> `(1, 2)`.
-    // `(1.7, 2.2)` -> `(1, 2)`.
-    // But also:
-    // `(-0.2, -0.7)` -> `(-1, -1)`
-    // `(-0.9, -1.1)` -> `(-1, -2)`.
-    //
-    // At first, we thought about just casting the
-    // values to `int`. But it fails for negative
-    // values (as `-0.9` would get converted to a
-    // `-0`).
-    // The `round` approach also does not work for
-    // positive values (as `2.7` will be converted
-    // to `3`).
-    // What should work is to subtract `1` in the
-    // negative case so that the conversion moves
-    // the cell to the current one *away* from `0`
-    // and not *towards* `0`.
-    float px = p.x();
-    float py = p.y();
-
-    if (px < 0.0f) {
-      px -= 1.0f;
+  Scratch::less(int lhs, int rhs) const noexcept {
+    // Nodes are ordered by increasing `c + h` value.
+    // Ties are broken by preferring nodes closer to
+    // the target, and then nodes created first so
+    // that the search is deterministic.
+    const Node& nlhs = nodes[heap[lhs]];
+    const Node& nrhs = nodes[heap[rhs]];
+
+    float flhs = nlhs.c + nlhs.h;
+    float frhs = nrhs.c + nrhs.h;
+
+    if (flhs != frhs) {
+      return flhs < frhs;
     }
-    if (py < 0.0f) {
-      py -= 1.0f;
+    if (nlhs.h != nrhs.h) {
+      return nlhs.h < nrhs.h;
     }
 
-    float mx = m.x();
-    float my = m.y();
-
-    if (mx < 0.0f) {
-      mx -= 1.0f;
-    }
-    if (my < 0.0f) {
-      my -= 1.0f;
-    }
+    return heap[lhs] < heap[rhs];
+  }
 
-    // Now convert the cell values and compare
-    // them to check for inclusion.
-    int iPX = static_cast<int>(px);
-    int iPY = static_cast<int>(py);
+  inline
+  void
+  Scratch::swap(int i, int j) noexcept {
+    std::swap(heap[i], heap[j]);
+    nodes[heap[i]].heap = i;
+    nodes[heap[j]].heap = j;
+  }
 
-    int iMX = static_cast<int>(mx);
-    int iMY = static_cast<int>(my);
+  inline
+  void
+  Scratch::up(int i) noexcept {
+    while (i > 0) {
+      int parent = (i - 1) / 2;
+      if (!less(i, parent)) {
+        return;
+      }
 
-    return iPX == iMX && iPY == iMY;
+      swap(i, parent);
+      i = parent;
+    }
   }
 
   inline
-  std::vector<Node>
-  Node::generateNeighbors(const utils::Point2f& target) const noexcept {
-    std::vector<Node> neighbors(Count);
-
-    utils::Point2f np;
-
-    float bx = std::floor(p.x()) + 0.5f;
-    float by = std::floor(p.y()) + 0.5f;
-
-    // Right neighbor.
-    np.x() = bx + 1.0f; np.y() = by;
-    neighbors[East] = Node{
-      np,
-      c + utils::d(p, np),
-      utils::d(np, target)
-    };
-
-    // Top right neighbor.
-    np.x() = bx + 1.0f; np.y() = by + 1.0f;
-    neighbors[NorthEast] = Node{
-      np,
-      c + utils::d(p, np),
-      utils::d(np, target)
-    };
-
-    // Up neighbor.
-    np.x() = bx; np.y() = by + 1.0f;
-    neighbors[North] = Node{
-      np,
-      c + utils::d(p, np),
-      utils::d(np, target)
-    };
-
-    // Top left neighbor.
-    np.x() = bx - 1.0f; np.y() = by + 1.0f;
-    neighbors[NorthWest] = Node{
-      np,
-      c + utils::d(p, np),
-      utils::d(np, target)
-    };
-
-    // Left neighbor.
-    np.x() = bx - 1.0f; np.y() = by;
-    neighbors[West] = Node{
-      np,
-      c + utils::d(p, np),
-      utils::d(np, target)
-    };
-
-    // Bottom left neighbor.
-    np.x() = bx - 1.0f; np.y() = by - 1.0f;
-    neighbors[SouthWest] = Node{
-      np,
-      c + utils::d(p, np),
-      utils::d(np, target)
-    };
-
-    // Down neighbor.
-    np.x() = bx; np.y() = by - 1.0f;
-    neighbors[South] = Node{
-      np,
-      c + utils::d(p, np),
-      utils::d(np, target)
-    };
-
-    // Bottom right neighbor.
-    np.x() = bx + 1.0f; np.y() = by - 1.0f;
-    neighbors[SouthEast] = Node{
-      np,
-      c + utils::d(p, np),
-      utils::d(np, target)
-    };
-
-    return neighbors;
+  void
+  Scratch::down(int i) noexcept {
+    int count = static_cast<int>(heap.size());
+
+    while (true) {
+      int best = i;
+      int l = 2 * i + 1;
+      int r = l + 1;
+
+      if (l < count && less(l, best)) {
+        best = l;
+      }
+      if (r < count && less(r, best)) {
+        best = r;
+      }
+
+      if (best == i) {
+        return;
+      }
+
+      swap(i, best);
+      i = best;
+    }
   }
 
   inline
-  std::string
-  Node::hash() const noexcept {
-    // We first tried to use the Cantor pairing
-    // function but as usual the fact that the
-    // generated keys are usually quite large
-    // was not really suited to our needs: as
-    // we can have large coordinates in large
-    // worlds the hashing should stay bounded.
-    // The string approach (by basically just
-    // concatenating the two coordinates) has
-    // the advantage to work no matter the
-    // dimensions of the world.
-    int k1 = static_cast<int>(std::floor(p.x()));
-    int k2 = static_cast<int>(std::floor(p.y()));
-
-    return std::to_string(k1) + "#" + std::to_string(k2);
+  void
+  Scratch::push(int node) noexcept {
+    heap.push_back(node);
+    nodes[node].heap = static_cast<int>(heap.size()) - 1;
+    up(nodes[node].heap);
   }
 
   inline
-  utils::Point2f
-  Node::invertHash(const std::string& hash) noexcept {
-    // Deconcatenate the input hash and offset
-    // with half a cell the produced coords.
-    std::size_t id = hash.find('#');
-
-    if (id == std::string::npos) {
-      // This is very weird, assume a default
-      // node.
-      return utils::Point2f(0.5f, 0.5f);
-    }
+  int
+  Scratch::pop() noexcept {
+    int node = heap.front();
 
-    std::string xStr = hash.substr(0, id);
-    std::string yStr = hash.substr(id + 1);
+    swap(0, static_cast<int>(heap.size()) - 1);
+    heap.pop_back();
+    nodes[node].heap = -1;
 
-    float x = 0.5f + std::stof(xStr);
-    float y = 0.5f + std::stof(yStr);
+    if (!heap.empty()) {
+      down(0);
+    }
 
-    return utils::Point2f(x, y);
+    return node;
   }
 
+  /**
+   * @brief - The scratch memory used by searches run on
+   *          the current thread.
+   */
+  thread_local Scratch scratch;
+
 }
 
 namespace tdef {
@@ -244,7 +280,9 @@ namespace tdef {
     m_start(s),
     m_end(e),
 
-    m_loc(loc)
+    m_loc(loc),
+
+    m_expanded(0u)
   {
     setService("astar");
   }
@@ -260,12 +298,17 @@ namespace tdef {
     std::vector<utils::Point2f> out;
     path.clear();
 
-    // The list of nodes that are currently being explored.
-    std::vector<Node> nodes;
-    std::deque<int> openNodes;
-    Node init{m_start, 0.0f, utils::d(m_start, m_end)};
-    nodes.push_back(init);
-    openNodes.push_back(0);
+    // Reuse the memory of previous searches.
+    scratch.reset();
+
+    int sx = static_cast<int>(std::floor(m_start.x()));
+    int sy = static_cast<int>(std::floor(m_start.y()));
+    int ex = static_cast<int>(std::floor(m_end.x()));
+    int ey = static_cast<int>(std::floor(m_end.y()));
+
+    scratch.nodes.push_back(Node{sx, sy, m_start, 0.0f, octile(sx, sy, ex, ey), -1, -1, false});
+    scratch.ids[pack(sx, sy)] = 0;
+    scratch.push(0);
 
     if (allowLog) {
       verbose(
@@ -274,51 +317,39 @@ namespace tdef {
       );
     }
 
-    using AssociationMap = std::unordered_map<std::string, int>;
-
-    // The `cameFrom[i]` defines the index of its parent
-    // node, i.e. the node we were traversing when this
-    // node was encountered.
-    std::unordered_map<std::string, std::string> cameFrom;
-    AssociationMap associations;
+    m_expanded = 0u;
 
-    associations[init.hash()] = 0;
+    while (!scratch.heap.empty()) {
+      // Fetch the node with the smallest `c + h` value.
+      int cur = scratch.pop();
+      scratch.nodes[cur].closed = true;
+      ++m_expanded;
 
-    // Common lambdas to handle sorting and distance
-    // computation from a point to another.
-    auto cmp = [&nodes](int lhs, int rhs) {
-      const Node& nlhs = nodes[lhs];
-      const Node& nrhs = nodes[rhs];
-      return nlhs.c + nlhs.h < nrhs.c + nrhs.h;
-    };
-
-    while (!openNodes.empty()) {
-      // Sort the open list to fetch nodes with smallest
-      // `c + h` value.
-      std::sort(openNodes.begin(), openNodes.end(), cmp);
-      Node current = nodes[openNodes.front()];
-      openNodes.pop_front();
+      // Copy the node as the storage might be reallocated
+      // when registering neighbors.
+      Node current = scratch.nodes[cur];
 
       if (allowLog) {
         verbose(
           "Picked node " + std::to_string(current.p.x()) + "x" + std::to_string(current.p.y()) +
           " with c " + std::to_string(current.c) +
           " h is " + std::to_string(current.h) +
-          " (nodes: " + std::to_string(openNodes.size()) + ")"
+          " (nodes: " + std::to_string(scratch.heap.size()) + ")"
         );
       }
 
       // In case we reached the goal, stop there.
-      if (current.contains(m_end)) {
+      if (current.x == ex && current.y == ey) {
         if (allowLog) {
           verbose(
             "Found path to " + std::to_string(m_end.x()) + "x" + std::to_string(m_end.y()) +
-            " with c " + std::to_string(current.c) + ", h " + std::to_string(current.h)
+            " with c " + std::to_string(current.c) + ", h " + std::to_string(current.h) +
+            " after expanding " + std::to_string(m_expanded) + " node(s)"
           );
         }
 
         // Attempt to reconstruct the path.
-        if (!reconstructPath(cameFrom, out, allowLog)) {
+        if (!reconstructPath(cur, out, allowLog)) {
           return false;
         }
 
@@ -392,179 +423,183 @@ namespace tdef {
       // the `Ob` so we will just not allow it.
       // We will first determine before processing the
       // neighbors and check the status for each one.
-      std::vector<Node> neighbors = current.generateNeighbors(m_end);
-
-      float bx = std::floor(current.p.x()) + 0.5f;
-      float by = std::floor(current.p.y()) + 0.5f;
+      // The locator provides the status of all the
+      // neighbors of the current cell at once so we
+      // can determine it with simple bit tests.
+      std::uint8_t free = m_loc->passability(current.p);
 
-      bool obsE = m_loc->obstructed(utils::Point2f(bx + 1.0f, by));
-      bool obsN = m_loc->obstructed(utils::Point2f(bx, by + 1.0f));
-      bool obsW = m_loc->obstructed(utils::Point2f(bx - 1.0f, by));
-      bool obsS = m_loc->obstructed(utils::Point2f(bx, by - 1.0f));
-
-      bool validNE = (!obsN && !obsE);
-      bool validNW = (!obsN && !obsW);
-      bool validSW = (!obsS && !obsW);
-      bool validSE = (!obsS && !obsE);
-
-      for (unsigned id = 0u ; id < neighbors.size() ; ++id) {
-        Node& neighbor = neighbors[id];
+      for (unsigned id = 0u ; id < Count ; ++id) {
+        int nx = current.x + dx[id];
+        int ny = current.y + dy[id];
+        bool target = (nx == ex && ny == ey);
 
         // Only consider the node if it is not obstructed.
-        if (m_loc->obstructed(neighbor.p) && !neighbor.contains(m_end)) {
+        if ((free & (1u << id)) == 0u && !target) {
           continue;
         }
 
-        // Use the pre-computed diagonal neighbors status
-        // and prevent the registration of the node if it
-        // is not valid in the sense defined in the above
-        // section.
-        if ((id == NorthEast && !validNE) ||
-            (id == SouthEast && !validSE) ||
-            (id == SouthWest && !validSW) ||
-            (id == NorthWest && !validNW))
-        {
+        // Prevent the registration of diagonal nodes if
+        // any of the corners is obstructed as defined in
+        // the above section.
+        if ((free & corners[id]) != corners[id]) {
           continue;
         }
 
+        utils::Point2f np(nx + 0.5f, ny + 0.5f);
+
         // Make sure that we don't consider nodes farther
         // away from the source as defined by the user.
-        if (radius > 0.0f && utils::d(m_start, neighbor.p) >= radius) {
+        if (radius > 0.0f && utils::d(m_start, np) >= radius) {
           continue;
         }
 
-        AssociationMap::iterator it = associations.find(neighbor.hash());
-
-        if (it == associations.end() || neighbor.c < nodes[it->second].c) {
-          // This path to neighbor is better than any previous one.
-          cameFrom[neighbor.hash()] = current.hash();
-
-          if (it != associations.end()) {
-            if (allowLog) {
-              verbose(
-                "Updating " + std::to_string(neighbor.p.x()) + "x" + std::to_string(neighbor.p.y()) +
-                " from c " + std::to_string(nodes[it->second].c) + ", " + std::to_string(nodes[it->second].h) +
-                " (f: " + std::to_string(nodes[it->second].c + nodes[it->second].h) + "," +
-                " parent: " + cameFrom[nodes[it->second].hash()] + ")" +
-                " to c: " + std::to_string(neighbor.c) + " h: " + std::to_string(neighbor.h) +
-                " (f: " + std::to_string(neighbor.c + neighbor.h) + "," +
-                " parent is " + current.hash() + ")"
-              );
-            }
+        float c = current.c + utils::d(current.p, np);
 
-            nodes[it->second].c = neighbor.c;
-          }
-          else {
-            if (allowLog) {
-              verbose(
-                "Registering " + std::to_string(neighbor.p.x()) + "x" + std::to_string(neighbor.p.y()) +
-                " with c: " + std::to_string(neighbor.c) + " h: " + std::to_string(neighbor.h) +
-                " (f: " + std::to_string(neighbor.c + neighbor.h) + "," +
-                " parent is " + current.hash() + ")"
-              );
-            }
+        std::pair<std::unordered_map<std::uint64_t, int>::iterator, bool> it =
+          scratch.ids.emplace(pack(nx, ny), static_cast<int>(scratch.nodes.size()));
 
-            openNodes.push_back(nodes.size());
-            associations[neighbor.hash()] = nodes.size();
-            nodes.push_back(neighbor);
+        if (it.second) {
+          // This is the first time we encounter the node.
+          if (allowLog) {
+            verbose(
+              "Registering " + std::to_string(np.x()) + "x" + std::to_string(np.y()) +
+              " with c: " + std::to_string(c) + " h: " + std::to_string(octile(nx, ny, ex, ey)) +
+              " (parent is " + std::to_string(current.x) + "#" + std::to_string(current.y) + ")"
+            );
           }
+
+          scratch.nodes.push_back(Node{nx, ny, np, c, octile(nx, ny, ex, ey), cur, -1, false});
+          scratch.push(it.first->second);
+
+          continue;
         }
+
+        // Nodes already expanded are not considered again
+        // and the path to this neighbor is only updated
+        // if it is better than the existing one.
+        Node& n = scratch.nodes[it.first->second];
+        if (n.closed || c >= n.c) {
+          continue;
+        }
+
+        if (allowLog) {
+          verbose(
+            "Updating " + std::to_string(np.x()) + "x" + std::to_string(np.y()) +
+            " from c " + std::to_string(n.c) + " to c: " + std::to_string(c) +
+            " h: " + std::to_string(n.h) +
+            " (parent is " + std::to_string(current.x) + "#" + std::to_string(current.y) + ")"
+          );
+        }
+
+        n.c = c;
+        n.parent = cur;
+        scratch.up(n.heap);
       }
     }
 
+    if (allowLog) {
+      verbose(
+        "Failed to find path to " + std::to_string(m_end.x()) + "x" + std::to_string(m_end.y()) +
+        " after expanding " + std::to_string(m_expanded) + " node(s)"
+      );
+    }
+
     // We couldn't reach the goal, the algorithm failed.
     return false;
   }
 
+  unsigned
+  AStar::getExpandedNodes() const noexcept {
+    return m_expanded;
+  }
+
   bool
-  AStar::reconstructPath(const std::unordered_map<std::string, std::string>& parents,
+  AStar::reconstructPath(int node,
                          std::vector<utils::Point2f>& path,
                          bool allowLog) const noexcept
   {
     std::vector<utils::Point2f> out;
 
-    Node n{m_end, 0.0f, 0.0f};
-    std::string h = n.hash();
-    std::unordered_map<std::string, std::string>::const_iterator it = parents.find(h);
+    // Walk up the parents of the node until we reach
+    // the starting point, which is not part of the
+    // path. The target cell is replaced by the exact
+    // position of the end point.
+    std::uint64_t end = cellOf(m_end);
 
-    while (it != parents.cend()) {
-      n.p = Node::invertHash(h);
+    while (node >= 0 && scratch.nodes[node].parent >= 0) {
+      const Node& n = scratch.nodes[node];
 
       if (allowLog) {
         verbose(
           "Registering point " + std::to_string(n.p.x()) + "x" + std::to_string(n.p.y()) +
-          " with hash " + h +
-          ", parent is " + it->second
+          ", parent is " + std::to_string(n.parent)
         );
       }
 
-      if (n.contains(m_end)) {
+      if (pack(n.x, n.y) == end) {
         out.push_back(m_end);
       }
       else {
         out.push_back(n.p);
       }
-      h = it->second;
-      it = parents.find(h);
+
+      node = n.parent;
     }
 
     // Make sure that we reached the starting point.
     // If this is the case we can copy the path we
     // just built to the output argument.
-    n.p = m_start;
-    std::string sh = n.hash();
-
-    if (sh == h) {
-      // We need to reverse the path as we've built
-      // it from the end.
-      for (std::vector<utils::Point2f>::const_reverse_iterator it = out.crbegin() ;
-           it != out.crend() ;
-           ++it)
-      {
-        path.push_back(*it);
-      }
+    if (node != 0) {
+      return false;
+    }
 
-      // We also need to straighten the first segment
-      // of the path: indeed we never check that the
-      // path between the starting location and the
-      // first cell is unobstructed: if this is the
-      // case, we need to add the center of the cell
-      // containing the starting location as an
-      // intermediate position as we know the path
-      // from there to the first segment will be
-      // valid.
-      utils::Point2f pObs(-1.0f, -1.0f);
-      std::vector<utils::Point2f> dummy;
+    // We need to reverse the path as we've built it
+    // from the end.
+    path.insert(path.end(), out.crbegin(), out.crend());
+
+    // In case the starting point and the end point are
+    // in the same cell there's nothing more to do.
+    if (path.empty()) {
+      return true;
+    }
+
+    // We also need to straighten the first segment
+    // of the path: indeed we never check that the
+    // path between the starting location and the
+    // first cell is unobstructed: if this is the
+    // case, we need to add the center of the cell
+    // containing the starting location as an
+    // intermediate position as we know the path
+    // from there to the first segment will be
+    // valid.
+    if (allowLog) {
+      verbose(
+        "Checking obstruction between " +
+        std::to_string(m_start.x()) + "x" + std::to_string(m_start.y()) +
+        " and " +
+        std::to_string(path[0].x()) + "x" + std::to_string(path[0].y())
+      );
+    }
+
+    if (!m_loc->lineOfSight(m_start, path[0])) {
+      utils::Point2f ip(
+        0.5f + static_cast<int>(std::floor(m_start.x())),
+        0.5f + static_cast<int>(std::floor(m_start.y()))
+      );
 
       if (allowLog) {
         verbose(
-          "Checking obstruction between " +
-          std::to_string(m_start.x()) + "x" + std::to_string(m_start.y()) +
-          " and " +
-          std::to_string(path[0].x()) + "x" + std::to_string(path[0].y())
+          "Registering point " + std::to_string(ip.x()) + "x" + std::to_string(ip.y()) +
+          " as path from " + std::to_string(m_start.x()) + "x" + std::to_string(m_start.y()) +
+          " to " + std::to_string(path[0].x()) + "x" + std::to_string(path[0].y()) +
+          " is obstructed"
         );
       }
 
-      if (m_loc->obstructed(m_start, path[0], dummy, &pObs, 0.005f)) {
-        utils::Point2f ip(
-          0.5f + static_cast<int>(std::floor(m_start.x())),
-          0.5f + static_cast<int>(std::floor(m_start.y()))
-        );
-
-        if (allowLog) {
-          verbose(
-            "Registering point " + std::to_string(ip.x()) + "x" + std::to_string(ip.y()) +
-            " as path from " + std::to_string(m_start.x()) + "x" + std::to_string(m_start.y()) +
-            " to " + std::to_string(path[0].x()) + "x" + std::to_string(path[0].y()) +
-            " is obstructed"
-          );
-        }
-
-        path.insert(path.begin(), ip);
-      }
+      path.insert(path.begin(), ip);
     }
 
-    return sh == h;
+    return true;
   }
 
   void
@@ -588,10 +623,9 @@ namespace tdef {
 
     std::vector<utils::Point2f> out;
     utils::Point2f p = m_start;
-    Node end{m_end, 0.0f, 0.0f};
+    std::uint64_t end = cellOf(m_end);
 
     unsigned id = 0u;
-    std::vector<utils::Point2f> dummy;
 
     // Simplify the whole path.
     while (id < path.size() - 1u) {
@@ -601,9 +635,9 @@ namespace tdef {
       // current point can be joined by a straight
       // line without obstructions. Note that we will
       // ignore obstructions in the target.
-      utils::Point2f o;
-      bool obs = m_loc->obstructed(p, c, dummy, &o, 0.005f, allowLog);
-      if (!obs || end.contains(o)) {
+      world::Cell o;
+      bool obs = m_loc->firstObstruction(p, c, o);
+      if (!obs || pack(o.x, o.y) == end) {
         // The path can be reached in a straight line,
         // we can remove the current point.
         if (allowLog) {
@@ -611,7 +645,7 @@ namespace tdef {
             "Simplified point " + std::to_string(path[id].x()) + "x" + std::to_string(path[id].y()) +
             " as path from " + std::to_string(p.x()) + "x" + std::to_string(p.y()) +
             " to " + std::to_string(c.x()) + "x" + std::to_string(c.y()) +
-            " is unobstructed (obs: " + std::to_string(obs) + ", cont: " + std::to_string(end.contains(o)) + ")"
+            " is unobstructed (obs: " + std::to_string(obs) + ", cont: " + std::to_string(obs && pack(o.x, o.y) == end) + ")"
           );
         }
 
@@ -2,7 +2,7 @@
 # define   ASTAR_HH
 
 # include <core_utils/CoreObject.hh>
-# include <unordered_map>
+# include <vector>
 # include <maths_utils/Point2.hh>
 # include "Locator.hh"
 
@@ -48,15 +48,41 @@ namespace tdef {
                float radius = -1.0f,
                bool allowLog = false) const noexcept;
 
+      /**
+       * @brief - Used to perform a smoothing of the input path
+       *          to reduce the amount of sharp turns that it
+       *          contains. The path is assumed to start
+       *          from the starting point of this object and
+       *          to end at its end point: the starting point
+       *          should not be included in the path.
+       * @param path - the path to smooth out. Note that the
+       *               smoothened path will be returned directly
+       *               in this output argument.
+       * @param allowLog - `true` if the process should be
+       *                   logged.
+       */
+      void
+      smoothPath(std::vector<utils::Point2f>& path, bool allowLog) const noexcept;
+
+      /**
+       * @brief - Return the number of nodes expanded by the last
+       *          call to `findPath`. This is mostly useful to
+       *          measure the performance of the search.
+       * @return - the number of expanded nodes.
+       */
+      unsigned
+      getExpandedNodes() const noexcept;
+
     private:
 
       /**
        * @brief - Used to reconstruct the path stored in
        *          the object assuming that we found a valid
        *          path from the ending point.
-       * @param parents - a description of the explored nodes
-       *                  with their `parent` (i.e. the node
-       *                  that was explored just before).
+       * @param node - the index of the node reached by the
+       *               search in the scratch memory. Parents
+       *               of this node are traversed until the
+       *               starting point is found.
        * @param path - output vector which will contain the
        *               reconstructed path.
        * @param allowLog - `true` if the process should be
@@ -64,23 +90,10 @@ namespace tdef {
        * @return - `true` if the path could be reconstructed.
        */
       bool
-      reconstructPath(const std::unordered_map<std::string, std::string>& parents,
+      reconstructPath(int node,
                       std::vector<utils::Point2f>& path,
                       bool allowLog) const noexcept;
 
-      /**
-       * @brief - Used to perform a smoothing of the input path
-       *          to reduce the amount of sharp turns that it
-       *          contains.
-       * @param path - the path to smooth out. Note that the
-       *               smoothened path will be returned directly
-       *               in this output argument.
-       * @param allowLog - `true` if the process should be
-       *                   logged.
-       */
-      void
-      smoothPath(std::vector<utils::Point2f>& path, bool allowLog) const noexcept;
-
     private:
 
       /**
@@ -98,6 +111,11 @@ namespace tdef {
        *          whether a location is obstructed.
        */
       LocatorShPtr m_loc;
+
+      /**
+       * @brief - The number of nodes expanded by the last search.
+       */
+      mutable unsigned m_expanded;
   };
 
 }
@@ -0,0 +1,428 @@
+
+# include "FlowField.hh"
+# include <algorithm>
+# include <functional>
+# include "Locator.hh"
+
+namespace {
+
+  /**
+   * @brief - The offsets of each neighbor of a cell, in the
+   *          order used by the `Locator::passability` method.
+   */
+  constexpr int dx[8] = {0, 1, 1,  1,  0, -1, -1, -1};
+  constexpr int dy[8] = {1, 1, 0, -1, -1, -1,  0,  1};
+
+  /**
+   * @brief - The cost to move to the `n`-th neighbor of a cell.
+   *          Odd neighbors are diagonal ones.
+   * @param n - the index of the neighbor.
+   * @return - the cost to move to this neighbor.
+   */
+  inline
+  float
+  cost(unsigned n) noexcept {
+    return (n % 2u == 0u ? 1.0f : 1.41421356f);
+  }
+
+}
+
+namespace tdef {
+
+  FlowField::FlowField() noexcept:
+    utils::CoreObject("field"),
+
+    m_xMin(0),
+    m_yMin(0),
+    m_w(0),
+    m_h(0),
+
+    m_states(),
+    m_distances(),
+    m_next(),
+
+    m_sources()
+  {
+    setService("flow");
+  }
+
+  void
+  FlowField::rebuild(const Locator& loc) {
+    m_sources.clear();
+    m_states.clear();
+    m_distances.clear();
+    m_next.clear();
+
+    m_xMin = 0;
+    m_yMin = 0;
+    m_w = 0;
+    m_h = 0;
+
+    world::ItemType bt = world::ItemType::Block;
+    std::vector<world::ItemEntry> blocks = loc.getVisible(utils::Point2f(), -1.0f, &bt);
+
+    if (blocks.empty()) {
+      return;
+    }
+
+    // Compute the area spanned by the blocks.
+    int xMin = 0, yMin = 0, xMax = 0, yMax = 0;
+    for (unsigned id = 0u ; id < blocks.size() ; ++id) {
+      world::Block b = loc.block(blocks[id].index);
+      float hr = b.radius / 2.0f;
+
+      int bxMin = static_cast<int>(std::floor(b.p.x() - hr));
+      int byMin = static_cast<int>(std::floor(b.p.y() - hr));
+      int bxMax = static_cast<int>(std::floor(b.p.x() + hr));
+      int byMax = static_cast<int>(std::floor(b.p.y() + hr));
+
+      xMin = (id == 0u ? bxMin : std::min(xMin, bxMin));
+      yMin = (id == 0u ? byMin : std::min(yMin, byMin));
+      xMax = (id == 0u ? bxMax : std::max(xMax, bxMax));
+      yMax = (id == 0u ? byMax : std::max(yMax, byMax));
+    }
+
+    m_xMin = xMin - sk_margin;
+    m_yMin = yMin - sk_margin;
+    m_w = xMax - xMin + 1 + 2 * sk_margin;
+    m_h = yMax - yMin + 1 + 2 * sk_margin;
+
+    std::size_t count = static_cast<std::size_t>(m_w) * m_h;
+    m_states.resize(count, 0u);
+    m_distances.resize(count, -1.0f);
+    m_next.resize(count, -1);
+
+    for (int c = 0 ; c < static_cast<int>(count) ; ++c) {
+      refresh(loc, c);
+    }
+
+    // Register portals as sources of the field.
+    std::vector<Entry> queue;
+
+    const std::vector<PortalShPtr>& portals = loc.portals();
+
+    for (unsigned id = 0u ; id < portals.size() ; ++id) {
+      const utils::Point2f& p = portals[id]->getPos();
+
+      int c = cellOf(p);
+      if (c < 0 || (m_states[c] & sk_source) != 0u) {
+        continue;
+      }
+
+      m_states[c] |= sk_source;
+      m_distances[c] = 0.0f;
+      m_sources.push_back(Source{c, p});
+
+      queue.push_back(Entry{0.0f, c});
+    }
+
+    std::make_heap(queue.begin(), queue.end(), std::greater<Entry>());
+    propagate(queue);
+
+    debug(
+      "Built flow field of " + std::to_string(m_w) + "x" + std::to_string(m_h) +
+      " cell(s) from " + std::to_string(m_sources.size()) + " portal(s)"
+    );
+  }
+
+  void
+  FlowField::update(const Locator& loc, const world::Update& update) {
+    // In case the update concerns cells at the border
+    // of the field (or if the field is empty) we need
+    // to recompute the area it covers.
+    auto inside = [this](const world::Cell& c) {
+      return c.x > m_xMin && c.x < m_xMin + m_w - 1 &&
+             c.y > m_yMin && c.y < m_yMin + m_h - 1;
+    };
+
+    bool rebuildNeeded = (m_w <= 0 || m_h <= 0);
+    for (unsigned id = 0u ; id < update.blocked.size() && !rebuildNeeded ; ++id) {
+      rebuildNeeded = !inside(update.blocked[id]);
+    }
+    for (unsigned id = 0u ; id < update.freed.size() && !rebuildNeeded ; ++id) {
+      rebuildNeeded = !inside(update.freed[id]);
+    }
+
+    if (rebuildNeeded) {
+      rebuild(loc);
+      return;
+    }
+
+    std::vector<Entry> queue;
+
+    // Handle cells that became obstructed: the distance
+    // of every cell which reached a portal through them
+    // has to be recomputed. We also consider neighbors
+    // of these cells as they might have been used as a
+    // corner when moving diagonally.
+    std::vector<int> affected;
+    std::vector<bool> marked(m_states.size(), false);
+
+    auto mark = [&affected, &marked, this](int c) {
+      if (c >= 0 && !marked[c] && (m_states[c] & sk_source) == 0u) {
+        marked[c] = true;
+        affected.push_back(c);
+      }
+    };
+
+    for (unsigned id = 0u ; id < update.blocked.size() ; ++id) {
+      const world::Cell& wc = update.blocked[id];
+      int c = cellAt(wc.x, wc.y);
+
+      if (!refresh(loc, c)) {
+        continue;
+      }
+
+      mark(c);
+      for (unsigned n = 0u ; n < 8u ; ++n) {
+        mark(cellAt(wc.x + dx[n], wc.y + dy[n]));
+      }
+    }
+
+    // Propagate to all the cells that depend on the
+    // affected ones.
+    for (unsigned id = 0u ; id < affected.size() ; ++id) {
+      int a = affected[id];
+      int ax = m_xMin + a % m_w;
+      int ay = m_yMin + a / m_w;
+
+      for (unsigned n = 0u ; n < 8u ; ++n) {
+        int nx = ax + dx[n];
+        int ny = ay + dy[n];
+        int nc = cellAt(nx, ny);
+
+        if (nc < 0 || m_next[nc] < 0) {
+          continue;
+        }
+
+        if (cellAt(nx + dx[m_next[nc]], ny + dy[m_next[nc]]) == a) {
+          mark(nc);
+        }
+      }
+    }
+
+    for (unsigned id = 0u ; id < affected.size() ; ++id) {
+      m_distances[affected[id]] = -1.0f;
+      m_next[affected[id]] = -1;
+    }
+
+    // Compute the distance of affected cells from the
+    // ones which were not impacted and propagate it.
+    for (unsigned id = 0u ; id < affected.size() ; ++id) {
+      int a = affected[id];
+      if ((m_states[a] & sk_free) == 0u) {
+        continue;
+      }
+
+      for (unsigned n = 0u ; n < 8u ; ++n) {
+        int nc = neighbor(a, n);
+        if (nc < 0 || marked[nc] || m_distances[nc] < 0.0f) {
+          continue;
+        }
+
+        float d = m_distances[nc] + cost(n);
+        if (m_distances[a] < 0.0f || d < m_distances[a]) {
+          m_distances[a] = d;
+          m_next[a] = static_cast<std::int8_t>(n);
+        }
+      }
+
+      if (m_distances[a] >= 0.0f) {
+        queue.push_back(Entry{m_distances[a], a});
+      }
+    }
+
+    std::make_heap(queue.begin(), queue.end(), std::greater<Entry>());
+    propagate(queue);
+
+    // Handle cells that were freed: we restart the
+    // propagation from their neighbors as it might
+    // now be possible to go through them.
+    queue.clear();
+
+    for (unsigned id = 0u ; id < update.freed.size() ; ++id) {
+      const world::Cell& wc = update.freed[id];
+      int c = cellAt(wc.x, wc.y);
+
+      if (!refresh(loc, c)) {
+        continue;
+      }
+
+      for (unsigned n = 0u ; n < 8u ; ++n) {
+        int nc = cellAt(wc.x + dx[n], wc.y + dy[n]);
+        if (nc >= 0 && m_distances[nc] >= 0.0f) {
+          queue.push_back(Entry{m_distances[nc], nc});
+        }
+      }
+    }
+
+    std::make_heap(queue.begin(), queue.end(), std::greater<Entry>());
+    propagate(queue);
+
+    verbose(
+      "Updated flow field with " + std::to_string(update.blocked.size()) + " blocked and " +
+      std::to_string(update.freed.size()) + " freed cell(s), " +
+      std::to_string(affected.size()) + " cell(s) affected"
+    );
+  }
+
+  bool
+  FlowField::trace(const utils::Point2f& p,
+                   std::vector<utils::Point2f>& points) const noexcept
+  {
+    points.clear();
+
+    auto position = [this](int c) {
+      if ((m_states[c] & sk_source) == 0u) {
+        return center(c);
+      }
+
+      for (unsigned id = 0u ; id < m_sources.size() ; ++id) {
+        if (m_sources[id].cell == c) {
+          return m_sources[id].p;
+        }
+      }
+
+      return center(c);
+    };
+
+    int c = cellOf(p);
+    if (c < 0) {
+      return false;
+    }
+
+    // In case the starting cell can't reach a portal
+    // it might be because it is obstructed: in this
+    // case we try to move to the best neighbor.
+    if (m_distances[c] < 0.0f) {
+      int best = -1;
+      float bd = -1.0f;
+
+      for (unsigned n = 0u ; n < 8u ; ++n) {
+        int nc = neighbor(c, n);
+        if (nc < 0 || m_distances[nc] < 0.0f) {
+          continue;
+        }
+
+        float d = m_distances[nc] + cost(n);
+        if (best < 0 || d < bd) {
+          best = nc;
+          bd = d;
+        }
+      }
+
+      if (best < 0) {
+        return false;
+      }
+
+      c = best;
+      points.push_back(position(c));
+    }
+
+    // Follow the gradient down to a portal. We use
+    // the number of cells as a safety net.
+    std::size_t count = 0u;
+    while ((m_states[c] & sk_source) == 0u && count < m_states.size()) {
+      int n = m_next[c];
+      if (n < 0) {
+        return false;
+      }
+
+      c = cellAt(m_xMin + c % m_w + dx[n], m_yMin + c / m_w + dy[n]);
+      if (c < 0) {
+        return false;
+      }
+
+      points.push_back(position(c));
+      ++count;
+    }
+
+    // Handle the case where the starting position is
+    // already in a portal.
+    if (points.empty()) {
+      points.push_back(position(c));
+    }
+
+    return (m_states[c] & sk_source) != 0u;
+  }
+
+  int
+  FlowField::neighbor(int c, unsigned n) const noexcept {
+    int x = m_xMin + c % m_w;
+    int y = m_yMin + c / m_w;
+
+    int nc = cellAt(x + dx[n], y + dy[n]);
+    if (nc < 0) {
+      return -1;
+    }
+
+    // Diagonal moves require both corners to be free
+    // similarly to what happens in the A* algorithm.
+    if (n % 2u == 1u) {
+      int c1 = cellAt(x + dx[n], y);
+      int c2 = cellAt(x, y + dy[n]);
+
+      if (c1 < 0 || c2 < 0 ||
+          (m_states[c1] & sk_free) == 0u ||
+          (m_states[c2] & sk_free) == 0u)
+      {
+        return -1;
+      }
+    }
+
+    return nc;
+  }
+
+  bool
+  FlowField::refresh(const Locator& loc, int c) noexcept {
+    if (c < 0) {
+      return false;
+    }
+
+    std::uint8_t s = m_states[c];
+    std::uint8_t free = (loc.obstructed(center(c)) ? 0u : sk_free);
+
+    m_states[c] = (s & ~sk_free) | free;
+
+    return m_states[c] != s;
+  }
+
+  void
+  FlowField::propagate(std::vector<Entry>& queue) noexcept {
+    std::greater<Entry> cmp;
+
+    while (!queue.empty()) {
+      std::pop_heap(queue.begin(), queue.end(), cmp);
+      Entry e = queue.back();
+      queue.pop_back();
+
+      // Discard outdated entries.
+      if (e.d > m_distances[e.cell]) {
+        continue;
+      }
+
+      // Mobs can only move to free cells, and the
+      // sources are already at the best distance.
+      for (unsigned n = 0u ; n < 8u ; ++n) {
+        int nc = neighbor(e.cell, n);
+        if (nc < 0 || (m_states[nc] & sk_free) == 0u || (m_states[nc] & sk_source) != 0u) {
+          continue;
+        }
+
+        float d = e.d + cost(n);
+        if (m_distances[nc] >= 0.0f && d >= m_distances[nc]) {
+          continue;
+        }
+
+        // Moving from the neighbor to the current cell
+        // corresponds to the opposite direction.
+        m_distances[nc] = d;
+        m_next[nc] = static_cast<std::int8_t>((n + 4u) % 8u);
+
+        queue.push_back(Entry{d, nc});
+        std::push_heap(queue.begin(), queue.end(), cmp);
+      }
+    }
+  }
+
+}
@@ -0,0 +1,242 @@
+#ifndef    FLOW_FIELD_HH
+# define   FLOW_FIELD_HH
+
+# include <vector>
+# include <memory>
+# include <cstdint>
+# include <core_utils/CoreObject.hh>
+# include <maths_utils/Point2.hh>
+# include "WorldUpdate.hh"
+
+namespace tdef {
+
+  // Forward declaration of the `Locator` class.
+  class Locator;
+
+  class FlowField: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new empty flow field. Such a field
+       *          does not cover any position: it should be
+       *          built with `rebuild` before being used.
+       */
+      FlowField() noexcept;
+
+      /**
+       * @brief - Used to compute the distance from each cell
+       *          of the world to the closest portal. This is
+       *          performed through a multi-source Dijkstra
+       *          algorithm seeded with the cells containing a
+       *          portal. The area covered by the field spans
+       *          all the blocks of the world with an extra
+       *          border so that mobs spawned around spawners
+       *          are included.
+       * @param loc - the locator describing the world.
+       */
+      void
+      rebuild(const Locator& loc);
+
+      /**
+       * @brief - Used to update the field in response to a change
+       *          in the layout of the world. Only the cells whose
+       *          distance is affected by the change are updated.
+       *          In case the change involves cells outside of the
+       *          area covered by the field it is rebuilt.
+       * @param loc - the locator describing the world.
+       * @param update - the description of the change.
+       */
+      void
+      update(const Locator& loc, const world::Update& update);
+
+      /**
+       * @brief - Whether the input position is in the area
+       *          covered by the field.
+       * @param p - the position to check.
+       * @return - `true` if the position is covered.
+       */
+      bool
+      covers(const utils::Point2f& p) const noexcept;
+
+      /**
+       * @brief - Return the distance from the cell containing the
+       *          input position to the closest portal. In case no
+       *          portal can be reached or if the position is not
+       *          covered by the field, a negative value is
+       *          returned.
+       * @param p - the position to evaluate.
+       * @return - the distance to the closest portal.
+       */
+      float
+      distance(const utils::Point2f& p) const noexcept;
+
+      /**
+       * @brief - Used to follow the gradient of the field from
+       *          the input position down to the closest portal.
+       *          The output vector contains the centers of the
+       *          cells traversed (excluding the starting one),
+       *          the last one being replaced by the position of
+       *          the portal.
+       * @param p - the starting position.
+       * @param points - output vector receiving the points to
+       *                 traverse.
+       * @return - `true` if a portal can be reached from the
+       *           input position.
+       */
+      bool
+      trace(const utils::Point2f& p,
+            std::vector<utils::Point2f>& points) const noexcept;
+
+    private:
+
+      /**
+       * @brief - Convenience structure defining a source of the
+       *          field (i.e. a portal).
+       */
+      struct Source {
+        int cell;
+        utils::Point2f p;
+      };
+
+      /**
+       * @brief - Convenience structure defining an entry in the
+       *          priority queue used to propagate distances.
+       */
+      struct Entry {
+        float d;
+        int cell;
+
+        bool
+        operator>(const Entry& rhs) const noexcept;
+      };
+
+      /**
+       * @brief - Return the index of the cell at the specified
+       *          coordinates or `-1` if it is outside the area
+       *          covered by the field.
+       * @param x - the abscissa of the cell.
+       * @param y - the ordinate of the cell.
+       * @return - the index of the cell.
+       */
+      int
+      cellAt(int x, int y) const noexcept;
+
+      /**
+       * @brief - Return the index of the cell containing the
+       *          input position or `-1` if it is outside of the
+       *          area covered by the field.
+       * @param p - the position.
+       * @return - the index of the cell.
+       */
+      int
+      cellOf(const utils::Point2f& p) const noexcept;
+
+      /**
+       * @brief - Return the center of the cell at the specified
+       *          index.
+       * @param c - the index of the cell.
+       * @return - the center of the cell.
+       */
+      utils::Point2f
+      center(int c) const noexcept;
+
+      /**
+       * @brief - Return the index of the `n`-th neighbor of the
+       *          input cell if it is possible to travel between
+       *          both cells. Moving diagonally requires the two
+       *          cells sharing an edge with both cells to be
+       *          free. The neighbors are ordered as in the
+       *          `Locator::passability` method.
+       * @param c - the index of the cell.
+       * @param n - the index of the neighbor.
+       * @return - the index of the neighbor or `-1` if it can't
+       *           be reached.
+       */
+      int
+      neighbor(int c, unsigned n) const noexcept;
+
+      /**
+       * @brief - Used to update the state of the input cell from
+       *          the locator.
+       * @param loc - the locator describing the world.
+       * @param c - the index of the cell.
+       * @return - `true` if the state of the cell changed.
+       */
+      bool
+      refresh(const Locator& loc, int c) noexcept;
+
+      /**
+       * @brief - Used to run the Dijkstra algorithm from the
+       *          cells registered in the input queue until no
+       *          distance can be improved.
+       * @param queue - the initial cells to process. Assumed
+       *                to be organized as a heap.
+       */
+      void
+      propagate(std::vector<Entry>& queue) noexcept;
+
+    private:
+
+      /**
+       * @brief - Flag indicating that the center of a cell is
+       *          not obstructed.
+       */
+      static constexpr std::uint8_t sk_free = 1u;
+
+      /**
+       * @brief - Flag indicating that a cell contains a portal.
+       */
+      static constexpr std::uint8_t sk_source = 2u;
+
+      /**
+       * @brief - Defines the number of cells added around the
+       *          blocks of the world to define the area of the
+       *          field.
+       */
+      static constexpr int sk_margin = 8;
+
+      /**
+       * @brief - The coordinates of the top left cell covered
+       *          by the field.
+       */
+      int m_xMin;
+      int m_yMin;
+
+      /**
+       * @brief - The dimensions of the field in cells.
+       */
+      int m_w;
+      int m_h;
+
+      /**
+       * @brief - The state of each cell as a combination of the
+       *          flags defined above.
+       */
+      std::vector<std::uint8_t> m_states;
+
+      /**
+       * @brief - The distance from each cell to the closest
+       *          portal or a negative value if no portal can
+       *          be reached.
+       */
+      std::vector<float> m_distances;
+
+      /**
+       * @brief - The index of the neighbor to move to in order
+       *          to get closer to a portal for each cell or `-1`
+       *          if no neighbor is closer.
+       */
+      std::vector<std::int8_t> m_next;
+
+      /**
+       * @brief - The list of portals used as sources.
+       */
+      std::vector<Source> m_sources;
+  };
+
+  using FlowFieldShPtr = std::shared_ptr<FlowField>;
+}
+
+# include "FlowField.hxx"
+
+#endif    /* FLOW_FIELD_HH */
@@ -0,0 +1,69 @@
+#ifndef    FLOW_FIELD_HXX
+# define   FLOW_FIELD_HXX
+
+# include "FlowField.hh"
+# include <cmath>
+
+namespace tdef {
+
+  inline
+  bool
+  FlowField::covers(const utils::Point2f& p) const noexcept {
+    return cellOf(p) >= 0;
+  }
+
+  inline
+  float
+  FlowField::distance(const utils::Point2f& p) const noexcept {
+    int c = cellOf(p);
+    if (c < 0) {
+      return -1.0f;
+    }
+
+    return m_distances[c];
+  }
+
+  inline
+  bool
+  FlowField::Entry::operator>(const Entry& rhs) const noexcept {
+    return d > rhs.d || (d == rhs.d && cell > rhs.cell);
+  }
+
+  inline
+  int
+  FlowField::cellAt(int x, int y) const noexcept {
+    int cx = x - m_xMin;
+    int cy = y - m_yMin;
+
+    if (cx < 0 || cx >= m_w || cy < 0 || cy >= m_h) {
+      return -1;
+    }
+
+    return cy * m_w + cx;
+  }
+
+  inline
+  int
+  FlowField::cellOf(const utils::Point2f& p) const noexcept {
+    float cx = std::floor(p.x()) - m_xMin;
+    float cy = std::floor(p.y()) - m_yMin;
+
+    if (!(cx >= 0.0f && cx < m_w && cy >= 0.0f && cy < m_h)) {
+      return -1;
+    }
+
+    return static_cast<int>(cy) * m_w + static_cast<int>(cx);
+  }
+
+  inline
+  utils::Point2f
+  FlowField::center(int c) const noexcept {
+    return utils::Point2f(
+      m_xMin + c % m_w + 0.5f,
+      m_yMin + c / m_w + 0.5f
+    );
+  }
+
+}
+
+#endif    /* FLOW_FIELD_HXX */
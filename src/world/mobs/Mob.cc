@@ -4,6 +4,8 @@
 # include "Block.hh"
 # include "Portal.hh"
 # include "Locator.hh"
+# include "Registry.hh"
+# include "FlowField.hh"
 
 namespace tdef {
 
@@ -12,16 +14,9 @@ namespace tdef {
 
     m_type(props.type),
 
-    m_energy(props.energy),
-    m_maxEnergy(props.maxEnergy),
-    m_energyRefill(props.refill),
-
-    m_behavior(Behavior::None),
-
     m_attackCost(props.attackCost),
     m_attack(props.attack),
 
-    m_rArrival(props.arrival),
     m_path(m_pos),
 
     m_bounty(props.bounty),
@@ -30,29 +25,76 @@ namespace tdef {
 
     m_defense(fromProps(props)),
 
-    m_speed({
-      props.speed,
-      props.speed,
-      utils::now(),
-      utils::Duration::zero(),
-      1.0f,
-      0.0f,
-      props.acceleration,
-      utils::now(),
-      utils::Duration::zero()
-    }),
-    m_poison({
-      0.0f,
-      0,
-      utils::now(),
-      utils::Duration::zero()
+    m_state({
+      props.energy,       // energy
+      props.maxEnergy,    // maxEnergy
+      props.refill,       // refill
+
+      props.speed,        // speed
+      props.speed,        // bSpeed
+      1.0f,               // fSpeed
+      0.0f,               // sDecrease
+      props.acceleration, // sIncrease
+
+      0.0f,               // fRemaining
+      0.0f,               // fDuration
+      0.0f,               // sRemaining
+
+      0.0f,               // poison
+      0,                  // stack
+      0.0f,               // pRemaining
+
+      m_pos,              // pos
+      m_pos,              // prev
+
+      m_health,           // health
+
+      mobs::Behavior::None, // behavior
+
+      -1,                 // segment
+      0.0f,               // offset
+      props.arrival       // arrival
     }),
+    m_store(nullptr),
+    m_slot(0u),
+
+    m_target(world::Handle::invalid()),
+
+    m_planning(false),
+    m_replan(false),
 
-    m_target(nullptr)
+    m_attempts(0u),
+    m_retry(0.0f),
+    m_epoch(0u)
   {
     setService("mob");
   }
 
+  Mob::~Mob() {
+    detach();
+  }
+
+  void
+  Mob::attach(MobStore& store) {
+    detach();
+
+    m_slot = store.add(this, m_path, m_state);
+    m_store = &store;
+  }
+
+  void
+  Mob::detach() noexcept {
+    if (m_store == nullptr) {
+      return;
+    }
+
+    m_state = m_store->get(m_slot);
+    m_store->release(m_slot);
+
+    m_store = nullptr;
+    m_slot = 0u;
+  }
+
   bool
   Mob::hit(StepInfo& info,
            const mobs::Damage& d)
@@ -67,9 +109,12 @@ namespace tdef {
 
     // Handle each type of damage.
     applyDamage(info, d);
-    applyFreezing(info, d);
-    applyStunning(info, d);
-    applyPoison(info, d);
+
+    mobs::State s = state();
+    applyFreezing(d, s);
+    applyStunning(info, d, s);
+    applyPoison(d, s);
+    setState(s);
 
     // Register this mob for deletion in case it
     // is not alive anymore.
@@ -81,20 +126,31 @@ namespace tdef {
 
   void
   Mob::step(StepInfo& info) {
-    // Refilll the energy.
-    m_energy = std::min(m_energy + info.elapsed * m_energyRefill, m_maxEnergy);
+    mobs::Command cmd;
+    if (advance(info, cmd)) {
+      apply(info, cmd);
+    }
+  }
 
-    // Handle the speed and poisoning effect.
-    updateSpeed(info);
-    updateHealth(info);
+  bool
+  Mob::advance(StepInfo& info,
+               mobs::Command& cmd)
+  {
+    // The energy, speed, effects and health are updated for
+    // all mobs at once by the store. The motion on the path
+    // is also handled there.
+    if (m_store == nullptr) {
+      warn("Mob is not registered in any store, skipping step");
+      return false;
+    }
 
     // Note that in case the mob is now dead (due to
-    // the damage applied in the above method) we do
-    // not want to pursue the process (and possibly
-    // lose a life).
+    // the damage of the poison applied by the store)
+    // we do not want to pursue the process (and
+    // possibly lose a life).
     if (isDead()) {
       markForDeletion(true);
-      return;
+      return false;
     }
 
     // In case we're already following a path, go
@@ -106,67 +162,132 @@ namespace tdef {
       // Adjust the target and check whether it has
       // been deleted. If this is the case we want
       // to try to find a new one asap.
-      if (m_target != nullptr && !m_target->isDeleted()) {
-        m_path.advance(m_speed.speed, info.elapsed, m_rArrival);
-        m_pos = m_path.cur();
+      Block* target = info.registry.get<Block>(m_target);
+      if (target != nullptr && !target->isDeleted()) {
+        m_store->schedule(m_slot);
+
+        // Keep following the current path while a new one
+        // is computed in case the world has changed.
+        if (!m_replan) {
+          return false;
+        }
 
-        return;
+        m_replan = false;
+        cmd = mobs::Command{mobs::Action::Replan, world::Handle::invalid(), 0.0f};
+        return true;
       }
 
-      verbose(
-        "Current target at " + m_target->getPos().toString() +
-        " does not exist anymore"
-      );
-
       // The target is either null (weird) or has
       // been deleted (probably by another mob).
-      m_behavior = Behavior::None;
-      m_target = nullptr;
-      m_path.clear(m_pos);
+      cmd = mobs::Command{mobs::Action::Retarget, world::Handle::invalid(), 0.0f};
+      return true;
     }
 
     // We arrived at the target: check what we need
     // to do now. It can also happen that we didn't
     // had a target in the first place in which case
-    // we need to find one.
-    if (m_behavior == Behavior::None) {
-      Path np(m_pos);
-
-      // First, attempt to locate a portal: if this
-      // succeeds, use this target.
-      if (locatePortal(info.frustum, np)) {
-        std::swap(m_path, np);
-        return;
+    // we need to find one, unless a path is already
+    // being computed for this mob.
+    mobs::Behavior b = m_store->behavior(m_slot);
+    const utils::Point2f& pos = m_store->pos(m_slot);
+    float arrival = m_store->arrival(m_slot);
+
+    if (b == mobs::Behavior::None) {
+      if (m_planning) {
+        return false;
       }
 
-      verbose("Failed to find portal, trying to find defense");
+      // In case no target could be found previously, wait
+      // a bit before trying again unless the world changed.
+      if (info.frustum->obstaclesEpoch() != m_epoch) {
+        m_attempts = 0u;
+        m_retry = 0.0f;
+      }
 
-      if (destroyDefenses(info.frustum, np)) {
-        std::swap(m_path, np);
-        return;
+      if (m_retry > 0.0f) {
+        m_retry -= info.elapsed;
+        return false;
       }
 
-      // Failed to locate a portal or a tower or
-      // a wall to break. We don't really know
-      // what to to here.
-      warn("Failed to find a valid target, mob is now stuck");
-      return;
+      cmd = mobs::Command{mobs::Action::Retarget, world::Handle::invalid(), 0.0f};
+      return true;
     }
-    if (m_behavior == Behavior::PortalSeeker) {
-      BlockShPtr b = info.frustum->getClosestBlock(m_pos, world::BlockType::Portal, -1.0f, nullptr);
-      PortalShPtr p = std::dynamic_pointer_cast<Portal>(b);
+    if (b == mobs::Behavior::PortalSeeker) {
+      Block* p = info.frustum->nearestBlock(pos, world::BlockType::Portal);
 
-      if (p == nullptr || utils::d(p->getPos(), m_pos) > m_rArrival) {
+      if (p == nullptr || utils::d(p->getPos(), pos) > arrival) {
         warn("Target portal is either missing or too far");
-        m_behavior = Behavior::None;
-        m_path.clear(m_pos);
-        return;
+        setBehavior(mobs::Behavior::None);
+        clearPath();
+        return false;
       }
 
-      // Breach the portal and mark the mob for deletion.
-      p->breach(m_cost);
+      // The mob goes through the portal: this is the end
+      // of its journey.
       markForDeletion(true);
 
+      cmd = mobs::Command{mobs::Action::Breach, p->getHandle(), m_cost};
+      return true;
+    }
+    if (b == mobs::Behavior::WallBreaker) {
+      // The target might have been destroyed by another
+      // mob: in this case we need to find a new one.
+      Block* target = info.registry.get<Block>(m_target);
+      if (target == nullptr) {
+        verbose("Target was destroyed, looking for a new one");
+        setBehavior(mobs::Behavior::None);
+        clearPath();
+        m_target = world::Handle::invalid();
+
+        return false;
+      }
+
+      if (target->getBlockType() != world::BlockType::Wall &&
+          target->getBlockType() != world::BlockType::Tower)
+      {
+        // Failed to interpret target either as a wall or
+        // a tower. This is weird.
+        warn("Target element could not be interpreted");
+        setBehavior(mobs::Behavior::None);
+        clearPath();
+        m_target = world::Handle::invalid();
+
+        return false;
+      }
+
+      float d = utils::d(target->getPos(), pos);
+      if (d > arrival) {
+        warn("Target defense is too far (d: " + std::to_string(d) + ")");
+        setBehavior(mobs::Behavior::None);
+        clearPath();
+        return false;
+      }
+
+      // Perform the attack if possible.
+      if (!m_store->consume(m_slot, m_attackCost)) {
+        return false;
+      }
+
+      cmd = mobs::Command{mobs::Action::Attack, m_target, m_attack};
+      return true;
+    }
+
+    return false;
+  }
+
+  void
+  Mob::apply(StepInfo& info,
+             const mobs::Command& cmd)
+  {
+    if (cmd.action == mobs::Action::Breach) {
+      Portal* p = info.registry.get<Portal>(cmd.target);
+      if (p == nullptr) {
+        warn("Breached portal does not exist anymore");
+        return;
+      }
+
+      p->breach(cmd.amount);
+
       this->info(
         "Mob made it through (health: " +
         std::to_string(getHealth()) + "/" + std::to_string(getTotalHealth()) + ")" +
@@ -175,198 +296,139 @@ namespace tdef {
 
       return;
     }
-    if (m_behavior == Behavior::WallBreaker) {
-      WallShPtr w = std::dynamic_pointer_cast<Wall>(m_target);
-      if (w != nullptr) {
-        float d = utils::d(w->getPos(), m_pos);
-        if (d > m_rArrival) {
-          warn("Target wall is too far (d: " + std::to_string(d) + ")");
-          m_behavior = Behavior::None;
-          m_path.clear(m_pos);
-          return;
-        }
-
-        // Perform the attack if possible.
-        if (m_energy < m_attackCost) {
-          return;
-        }
-
-        m_energy -= m_attackCost;
-        if (!w->damage(info, m_attack)) {
-          // Mark the wall for deletion, reset the behavior
-          // so that we get a new chance to evaluate whether
-          // a portal is reachable and reset the target.
-          w->markForDeletion(true);
-          m_behavior = Behavior::None;
-          m_target = nullptr;
-
-          debug("Killed wall at " + w->getPos().toString());
-        }
-
+    if (cmd.action == mobs::Action::Attack) {
+      Block* b = info.registry.get<Block>(cmd.target);
+      if (b == nullptr) {
         return;
       }
 
-      TowerShPtr t = std::dynamic_pointer_cast<Tower>(m_target);
-      if (t != nullptr) {
-        float d = utils::d(t->getPos(), m_pos);
-        if (d > m_rArrival) {
-          warn("Target tower is too far (d: " + std::to_string(d) + ")");
-          m_behavior = Behavior::None;
-          m_path.clear(m_pos);
-          return;
-        }
-
-        // Perform the attack if possible.
-        if (m_energy < m_attackCost) {
-          return;
-        }
+      // A defense destroyed earlier in this step is still
+      // registered: hitting it again simply notifies the
+      // mob that it needs a new target.
+      if (!b->damage(info, cmd.amount)) {
+        // Mark the defense for deletion, reset the behavior
+        // so that we get a new chance to evaluate whether
+        // a portal is reachable and reset the target.
+        b->markForDeletion(true);
+        setBehavior(mobs::Behavior::None);
+        m_target = world::Handle::invalid();
+
+        debug("Killed defense at " + b->getPos().toString());
+      }
 
-        m_energy -= m_attackCost;
-        if (!t->damage(info, m_attack)) {
-          // Mark the wall for deletion, reset the behavior
-          // so that we get a new chance to evaluate whether
-          // a portal is reachable and reset the target.
-          t->markForDeletion(true);
-          m_behavior = Behavior::None;
-          m_target = nullptr;
+      return;
+    }
 
-          debug("Killed tower " + towers::toString(t->getType()) + " at " + t->getPos().toString());
-        }
+    // The mob needs a new target: in case it was still
+    // moving towards the previous one, stop there. When
+    // the world changed the mob keeps its current path
+    // until a new one is found.
+    if (cmd.action == mobs::Action::Retarget && isEnRoute()) {
+      verbose("Current target does not exist anymore");
 
-        return;
-      }
+      setBehavior(mobs::Behavior::None);
+      m_target = world::Handle::invalid();
+      clearPath();
+    }
 
-      // Failed to interpret target either as a wall or
-      // a tower. This is weird.
-      warn("Target element could not be interpreted");
-      m_behavior = Behavior::None;
-      m_path.clear(m_pos);
-      m_target = nullptr;
+    requestPath(info.paths);
+  }
 
+  void
+  Mob::plan(LocatorShPtr loc,
+            const path::Goal& goal,
+            path::Result& res) const
+  {
+    if (goal == path::Goal::Portal) {
+      res.found = locatePortal(loc, res.path, res.target);
       return;
     }
+
+    res.found = destroyDefenses(loc, res.path, res.target);
   }
 
   void
-  Mob::pause(const utils::TimeStamp& t) {
-    // The `pause` method should prepare the call to
-    // `resume` by shifting the origin of time-based
-    // effects so that they correspond to the moment
-    // where the pause was triggered.
-    // This is indeed the last moment where we know
-    // that the timestamps correspond to meaningful
-    // values.
-    // It will make the resume operation very easy
-    // as we only have to shift again the origin
-    // timestamps (given that the duration for each
-    // effect is consistent).
-
-    // Each timestamp will be updated so that the
-    // remaining duration corresponds to the value
-    // currently remaining and the time stamp is
-    // equivalent to the start of the pause moment.
-    if (m_speed.fDuration != utils::Duration::zero()) {
-      utils::Duration elapsed = t - m_speed.tFreeze;
+  Mob::follow(PathService& paths,
+              const path::Goal& goal,
+              path::Result& res)
+  {
+    if (res.found) {
+      std::swap(m_path, res.path);
+      restart();
+      setBehavior(goal == path::Goal::Portal ? mobs::Behavior::PortalSeeker : mobs::Behavior::WallBreaker);
+      m_target = res.target;
+      m_planning = false;
 
-      verbose(
-        "Freeze started at " + utils::timeToString(m_speed.tFreeze) +
-        " for " + utils::durationToMsString(m_speed.fDuration) +
-        ", " + utils::durationToMsString(elapsed) + " elapsed, " +
-        utils::durationToMsString(m_speed.fDuration - elapsed) + " remaining"
-      );
+      m_attempts = 0u;
+      m_retry = 0.0f;
 
-      m_speed.tFreeze = t;
-      m_speed.fDuration = m_speed.fDuration - elapsed;
+      return;
     }
 
-    if (m_speed.sDuration != utils::Duration::zero()) {
-      utils::Duration elapsed = t - m_speed.tStun;
-
-      verbose(
-        "Stun started at " + utils::timeToString(m_speed.tStun) +
-        " for " + utils::durationToMsString(m_speed.sDuration) +
-        ", " + utils::durationToMsString(elapsed) + " elapsed, " +
-        utils::durationToMsString(m_speed.sDuration - elapsed) + " remaining"
-      );
+    // Even in case the mob is currently trying to
+    // reach a defense, we will assume that the main
+    // objective is to reach a portal. So we will
+    // first try to reach one, and if this fails we
+    // will try to locate a tower or a wall.
+    if (goal == path::Goal::Portal) {
+      verbose("Failed to find portal, trying to find defense");
+      paths.request(getHandle(), path::Goal::Defense);
 
-      m_speed.tStun = t;
-      m_speed.sDuration = m_speed.sDuration - elapsed;
+      return;
     }
 
-    if (m_poison.pDuration != utils::Duration::zero()) {
-      utils::Duration elapsed = t - m_poison.tPoison;
+    // Failed to locate a portal or a tower or
+    // a wall to break. We don't really know
+    // what to to here so wait a bit before
+    // trying again.
+    m_retry = std::min(sk_minRetryDelay * std::pow(2.0f, 1.0f * m_attempts), sk_maxRetryDelay);
+    m_epoch = res.epoch;
+    m_planning = false;
 
+    if (m_attempts == 0u) {
+      warn("Failed to find a valid target, mob is now stuck");
+    }
+    else {
       verbose(
-        "Poison started at " + utils::timeToString(m_poison.tPoison) +
-        " for " + utils::durationToMsString(m_poison.pDuration) +
-        ", " + utils::durationToMsString(elapsed) + " elapsed, " +
-        utils::durationToMsString(m_poison.pDuration - elapsed) + " remaining"
+        "Still no valid target after " + std::to_string(m_attempts + 1u) +
+        " attempt(s), retrying in " + std::to_string(m_retry) + "s"
       );
-
-      m_poison.tPoison = t;
-      m_poison.pDuration = m_poison.pDuration - elapsed;
     }
-  }
 
-  void
-  Mob::resume(const utils::TimeStamp& t) {
-    // As the pause method handled the duration so
-    // that it really reflects how long the effects
-    // should be going on, we just have to offset
-    // the timestamps to the current one.
-    verbose(
-      "Moved speed to start from " + utils::timeToString(m_speed.tFreeze) +
-      " to " + utils::timeToString(t) +
-      ", end in " + utils::durationToMsString(m_speed.fDuration) +
-      " at " + utils::timeToString(t + m_speed.fDuration)
-    );
-    verbose(
-      "Moved stun to start from " + utils::timeToString(m_speed.tStun) +
-      " to " + utils::timeToString(t) +
-      ", end in " + utils::durationToMsString(m_speed.sDuration) +
-      " at " + utils::timeToString(t + m_speed.sDuration)
-    );
-    verbose(
-      "Moved poison to start from " + utils::timeToString(m_poison.tPoison) +
-      " to " + utils::timeToString(t) +
-      ", end in " + utils::durationToMsString(m_poison.pDuration) +
-      " at " + utils::timeToString(t + m_poison.pDuration)
-    );
-
-    m_speed.tFreeze = t;
-    m_speed.tStun = t;
-
-    m_poison.tPoison = t;
+    ++m_attempts;
   }
 
   void
-  Mob::worldUpdate(LocatorShPtr loc) {
+  Mob::worldUpdate(LocatorShPtr /*loc*/, const world::Update& update) {
     // We need to recompute the path to the target if
-    // a valid path is assigned.
-    if (!isEnRoute()) {
+    // a valid path is assigned. Changes concerning
+    // only mobs or projectiles do not modify the
+    // layout of the world so they can't impact it.
+    if (update.entitiesOnly || !isEnRoute()) {
       return;
     }
 
-    // Even in case the mob is currently trying to
-    // reach a defense, we will assume that the main
-    // objective is to reach a portal. So we will
-    // first try to reach one, and if this fails we
-    // will try to locate a tower or a wall.
-    Path np(m_pos);
-
-    if (locatePortal(loc, np)) {
-      std::swap(m_path, np);
-      return;
+    // The path only needs to be recomputed if it is
+    // now going through an obstructed cell. In case
+    // some cells were freed, mobs which could not
+    // reach a portal might now be able to.
+    bool obstructed = false;
+    if (m_store != nullptr) {
+      obstructed = m_path.crosses(update.blocked, m_store->pos(m_slot), m_store->segment(m_slot));
+    }
+    else {
+      obstructed = m_path.crosses(update.blocked, m_state.pos, m_state.segment);
     }
 
-    verbose("Failed to find portal, trying to find defense");
+    bool fallback = (!update.freed.empty() && behavior() != mobs::Behavior::PortalSeeker);
 
-    if (destroyDefenses(loc, np)) {
-      std::swap(m_path, np);
+    if (!obstructed && !fallback) {
       return;
     }
 
-    warn("Failed to find a valid target, mob is now stuck");
+    // The new path is computed by the path service at
+    // the next step: until then the mob keeps going.
+    m_replan = true;
   }
 
   void
@@ -398,13 +460,13 @@ namespace tdef {
 
     // Handle the remaining damage if needed.
     if (hit > 0.0f) {
-      WorldElement::damage(info, hit);
+      damage(info, hit);
     }
   }
 
   void
-  Mob::applyFreezing(StepInfo& info,
-                     const mobs::Damage& d)
+  Mob::applyFreezing(const mobs::Damage& d,
+                     mobs::State& s)
   {
     // Mob is not slowable, abort.
     if (!m_defense.slowable) {
@@ -417,26 +479,27 @@ namespace tdef {
     }
 
     // Refresh the slowing effect if any.
-    m_speed.tFreeze = info.moment;
+    s.fRemaining = s.fDuration;
 
     // Update freezed speed and refresh slowing effect.
     // In case the new freeze speed is bigger than the
     // current freeze speed we will wait for the freeze
     // effect to wear off so that we benefit better
     // from the current (stronger) applied effect.
-    if (m_speed.fSpeed >= d.speed) {
+    if (s.fSpeed >= d.speed) {
       // The new speed would make the mob even slower.
-      m_speed.tFreeze = info.moment;
-      m_speed.fSpeed = d.speed;
+      s.fSpeed = d.speed;
 
-      m_speed.fDuration = d.fDuration;
-      m_speed.sDecrease = d.sDecraseSpeed;
+      s.fDuration = toSeconds(d.fDuration);
+      s.fRemaining = s.fDuration;
+      s.sDecrease = d.sDecraseSpeed;
     }
   }
 
   void
   Mob::applyStunning(StepInfo& info,
-                     const mobs::Damage& d)
+                     const mobs::Damage& d,
+                     mobs::State& s)
   {
     // Mob is not stunnable, abort.
     if (!m_defense.stunnable) {
@@ -457,19 +520,17 @@ namespace tdef {
     // the effect in case the new stun effect is
     // lasting longer than the currently applied
     // one.
-    utils::TimeStamp cur = m_speed.tStun + m_speed.sDuration;
-    utils::TimeStamp better = info.moment + d.sDuration;
-    if (cur > better) {
+    float better = toSeconds(d.sDuration);
+    if (s.sRemaining > better) {
       return;
     }
 
-    m_speed.tStun = info.moment;
-    m_speed.sDuration = d.sDuration;
+    s.sRemaining = better;
   }
 
   void
-  Mob::applyPoison(StepInfo& info,
-                   const mobs::Damage& d)
+  Mob::applyPoison(const mobs::Damage& d,
+                   mobs::State& s)
   {
     // Mob is not poisonable, abort.
     if (!m_defense.poisonable) {
@@ -487,132 +548,65 @@ namespace tdef {
     // one applied. We only register the effect in
     // case the expected duration of the poison will
     // last longer than the one currently applied.
-    utils::TimeStamp cur = m_poison.tPoison + m_poison.pDuration;
-    utils::TimeStamp better = info.moment + d.pDuration;
-    if (cur < better) {
-      m_poison.tPoison = info.moment;
-      m_poison.pDuration = d.pDuration;
-    }
+    s.pRemaining = std::max(s.pRemaining, toSeconds(d.pDuration));
 
     debug(
       "Poisoning mob for " + utils::durationToMsString(d.pDuration) +
       " and for " + std::to_string(d.hit) +
-      " after " + std::to_string(m_poison.stack) + " stacks(s)" +
-      " already " + std::to_string(m_poison.damage) + " registered"
+      " after " + std::to_string(s.stack) + " stacks(s)" +
+      " already " + std::to_string(s.poison) + " registered"
     );
 
     // The damage applied per stack is 100% for the
     // first stack, then 50% for the second, 25% for
     // the third etc. Note that we clamp the number
     // of poison stacks to a maximum amount.
-    if (m_poison.stack < sk_poisonStacksLimit) {
-      m_poison.damage += d.hit * std::pow(2.0f, -1.0f * m_poison.stack);
-      ++m_poison.stack;
+    if (s.stack < sk_poisonStacksLimit) {
+      s.poison += d.hit * std::pow(2.0f, -1.0f * s.stack);
+      ++s.stack;
     }
   }
 
   void
-  Mob::updateSpeed(StepInfo& info) {
-    // First, handle stun effect.
-    if (m_speed.tStun + m_speed.sDuration >= info.moment) {
-      m_speed.speed = 0.0f;
-
+  Mob::requestPath(PathService& paths) {
+    if (m_planning) {
       return;
     }
 
-    // Handle defreezing of mob.
-    if (m_speed.tFreeze + m_speed.fDuration < info.moment) {
-      // Mob is not freezed anymore
-      m_speed.fSpeed = 1.0f;
-      m_speed.sDecrease = 0.0f;
-    }
-
-    // Update the current speed of the mob based
-    // on the desired speed and the acceleration
-    // factor.
-    float target = m_speed.bSpeed * m_speed.fSpeed;
-
-    // Compute the modifier that will be applied
-    // to the speed of this mob. This will either
-    // be equal tot he `sDecrease` in case the
-    // current speed is larger than the desired
-    // speed and `sIncrease` in case the current
-    // speed is smaller.
-    float mod = m_speed.sIncrease;
-    if (m_speed.speed > target) {
-      mod = -m_speed.sDecrease;
-    }
-
-    // The modifier is a duration expressed in
-    // seconds so let's compute the delta. Note
-    // though that in case the speed is very
-    // small it would also mean that the rate
-    // of acceleration/deceleration would be
-    // also very slow.
-    // So we take the max between the current
-    // speed and the target speed so that we
-    // always vary the quickest.
-    float delta = std::max(m_speed.speed, target) * mod * info.elapsed;
-
-    // Don't forget to clamp the final speed to be
-    // consistent with what we desire.
-    // We can't really use a min/max approach as
-    // the only real bounds would be `0` and the
-    // `base speed` but this tells nothing as to a
-    // freezed speed for example (typically this
-    // is *not* a lower bound as if the mob was
-    // stunned we will have a lower speed than the
-    // target).
-    // So we follow an approach where we clamp in
-    // accordance to the speed modifier (so whether
-    // or not we're accelerating).
-    if (mod > 0) {
-      m_speed.speed = utils::clamp(m_speed.speed + delta, 0.0f, target);
-    }
-    else {
-      m_speed.speed = std::max(m_speed.speed + delta, target);
-    }
-  }
-
-  void
-  Mob::updateHealth(StepInfo& info) {
-    // Deactivate the poisoning in case the effect
-    // has finished.
-    if (m_poison.tPoison + m_poison.pDuration < info.moment) {
-      m_poison.damage = 0.0f;
-
-      // Also reset the stacks: the next application
-      // of poinson will start from scratch.
-      m_poison.stack = 0;
-
-      return;
-    }
-
-    if (m_poison.damage == 0.0f) {
-      return;
-    }
-
-    // Apply the damage per second.
-    damage(info, m_poison.damage * info.elapsed);
+    paths.request(getHandle(), path::Goal::Portal);
+    m_planning = true;
   }
 
   bool
   Mob::locatePortal(LocatorShPtr loc,
-                    Path& path)
+                    Path& path,
+                    world::Handle& target) const
   {
     // Clear the path.
-    path.clear(m_pos);
+    const utils::Point2f& pos = getPos();
+    path.clear(pos);
 
     // Attempt to find a portal to reach.
-    BlockShPtr b = loc->getClosestBlock(m_pos, world::BlockType::Portal, -1.0f, nullptr);
-    PortalShPtr p = std::dynamic_pointer_cast<Portal>(b);
+    Block* b = loc->nearestBlock(pos, world::BlockType::Portal);
+
+    if (b != nullptr) {
+      // Use the flow field shared by all mobs in case it
+      // covers the position of the mob: this avoids to
+      // run an A* for each mob. Otherwise we fall back
+      // to the regular path finding.
+      FlowFieldShPtr ff = loc->flowField();
+      bool valid = false;
+
+      if (ff != nullptr && ff->covers(pos)) {
+        valid = path.followField(loc, *ff, sk_maxPathFindingDistance);
+      }
+      else {
+        valid = path.generatePathTo(loc, b->getPos(), true, sk_maxPathFindingDistance);
+      }
 
-    if (p != nullptr) {
-      bool valid = path.generatePathTo(loc, p->getPos(), true, sk_maxPathFindingDistance);
       if (valid) {
-        verbose("Found portal at " + p->getPos().toString());
-        m_behavior = Behavior::PortalSeeker;
-        m_target = b;
+        verbose("Found portal at " + b->getPos().toString());
+        target = b->getHandle();
 
         return true;
       }
@@ -625,36 +619,34 @@ namespace tdef {
 
   bool
   Mob::destroyDefenses(LocatorShPtr loc,
-                       Path& path)
+                       Path& path,
+                       world::Handle& target) const
   {
     // Clear the path.
-    path.clear(m_pos);
+    const utils::Point2f& pos = getPos();
+    path.clear(pos);
 
     // Attempt to find a wall to break.
-    BlockShPtr b = loc->getClosestBlock(m_pos, world::BlockType::Wall, -1.0f, nullptr);
-    WallShPtr w = std::dynamic_pointer_cast<Wall>(b);
+    Block* b = loc->nearestBlock(pos, world::BlockType::Wall);
 
-    if (w != nullptr) {
-      bool valid = path.generatePathTo(loc, w->getPos(), true, sk_maxPathFindingDistance);
+    if (b != nullptr) {
+      bool valid = path.generatePathTo(loc, b->getPos(), true, sk_maxPathFindingDistance);
       if (valid) {
-        verbose("Found wall at " + w->getPos().toString());
-        m_behavior = Behavior::WallBreaker;
-        m_target = b;
+        verbose("Found wall at " + b->getPos().toString());
+        target = b->getHandle();
 
         return true;
       }
     }
 
     // Attempt to find a tower to break.
-    b = loc->getClosestBlock(m_pos, world::BlockType::Tower, -1.0f, nullptr);
-    TowerShPtr t = std::dynamic_pointer_cast<Tower>(b);
+    b = loc->nearestBlock(pos, world::BlockType::Tower);
 
-    if (t != nullptr) {
-      bool valid = path.generatePathTo(loc, t->getPos(), true, sk_maxPathFindingDistance);
+    if (b != nullptr) {
+      bool valid = path.generatePathTo(loc, b->getPos(), true, sk_maxPathFindingDistance);
       if (valid) {
-        verbose("Found tower at " + t->getPos().toString());
-        m_behavior = Behavior::WallBreaker;
-        m_target = b;
+        verbose("Found tower at " + b->getPos().toString());
+        target = b->getHandle();
 
         return true;
       }
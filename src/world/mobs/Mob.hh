@@ -5,6 +5,8 @@
 # include <maths_utils/Point2.hh>
 # include "WorldElement.hh"
 # include "Path.hh"
+# include "MobStore.hh"
+# include "PathService.hh"
 
 namespace tdef {
   namespace mobs {
@@ -122,6 +124,37 @@ namespace tdef {
       bool stunned;
     };
 
+    /**
+     * @brief - The possible interactions of a mob with the
+     *          rest of the world during a step.
+     */
+    enum class Action {
+      Breach,
+      Attack,
+      Retarget,
+      Replan
+    };
+
+    /**
+     * @brief - Convenience structure describing an action
+     *          that a mob wants to perform on the rest of the
+     *          world. It is recorded while the mobs advance in
+     *          parallel and applied later on in a serial way.
+     */
+    struct Command {
+      // The kind of interaction.
+      Action action;
+
+      // The block affected by the action: the portal to go
+      // through or the defense to attack. Not used when the
+      // mob needs a new target or a new path.
+      world::Handle target;
+
+      // The number of lives lost by the portal or the damage
+      // inflicted to the defense.
+      float amount;
+    };
+
   }
 
   // Forward declaration of the block class to be able
@@ -217,6 +250,92 @@ namespace tdef {
        */
       Mob(const MProps& props);
 
+      /**
+       * @brief - Destruction of the object: the mob is detached
+       *          from its store if needed.
+       */
+      ~Mob();
+
+      /**
+       * @brief - Used to register this mob in the input store.
+       *          The part of its state that evolves at each step
+       *          is moved to the store and updated from there.
+       *          Note that a mob should be attached to a store
+       *          in order to be stepped.
+       * @param store - the store in which the mob should be
+       *                registered.
+       */
+      void
+      attach(MobStore& store);
+
+      /**
+       * @brief - Used to remove this mob from the store it is
+       *          registered in, if any. The state of the mob is
+       *          copied back so that it is still available.
+       */
+      void
+      detach() noexcept;
+
+      /**
+       * @brief - Used by the store to notify that the slot used
+       *          by this mob has moved.
+       * @param slot - the new index of the slot.
+       */
+      void
+      relocate(unsigned slot) noexcept;
+
+      /**
+       * @brief - Retrieve the position of this mob. When the mob
+       *          is registered in a store it is read from there.
+       *          It hides the accessor defined by the base class.
+       * @return - the position of the mob.
+       */
+      const utils::Point2f&
+      getPos() const noexcept;
+
+      /**
+       * @brief - Retrieve the position of this mob at the start
+       *          of the last simulation step.
+       * @return - the previous position of the mob.
+       */
+      const utils::Point2f&
+      getPreviousPos() const noexcept;
+
+      /**
+       * @brief - Fetch the current health of this mob.
+       * @return - the current health.
+       */
+      float
+      getHealth() const noexcept;
+
+      /**
+       * @brief - Retrieve the ratio of current health over the
+       *          total health for this mob.
+       * @return - a ratio measuring the health of the mob.
+       */
+      float
+      getHealthRatio() const noexcept;
+
+      /**
+       * @brief - Return `true` in case this mob has no health
+       *          left.
+       * @return - `true` if the mob is dead.
+       */
+      bool
+      isDead() const noexcept;
+
+      /**
+       * @brief - Similar to `WorldElement::damage` but updates
+       *          the health held by the store in case the mob is
+       *          registered in one.
+       * @param info - the information about the step.
+       * @param hit - the amount of damage to apply to the mob.
+       * @return - `true` if the mob is still alive.
+       */
+      bool
+      damage(StepInfo& info,
+             float hit);
+
       /**
        * @brief - Fetch the type for this mob.
        * @return - the type for this mob.
@@ -277,6 +396,67 @@ namespace tdef {
       hit(StepInfo& info,
           const mobs::Damage& d);
 
+      /**
+       * @brief - First part of the step of the mob: it checks
+       *          whether the mob is still alive and whether it
+       *          should keep moving on its path, in which case
+       *          the motion is performed by the store. This
+       *          only modifies the mob itself so that it can
+       *          run concurrently with the other mobs. Whenever the mob needs to interact with
+       *          the rest of the world the action is described
+       *          in the output command, to be applied later on
+       *          through `apply`.
+       * @param info - information about the current step.
+       * @param cmd - output command filled in case an action
+       *              is needed.
+       * @return - `true` if the command should be applied.
+       */
+      bool
+      advance(StepInfo& info,
+              mobs::Command& cmd);
+
+      /**
+       * @brief - Second part of the step of the mob: perform the
+       *          action requested during `advance`. Commands are
+       *          applied one after the other in the order of the
+       *          mobs so that the result is deterministic.
+       * @param info - information about the current step.
+       * @param cmd - the command to apply.
+       */
+      void
+      apply(StepInfo& info,
+            const mobs::Command& cmd);
+
+      /**
+       * @brief - Compute a path from the current position of the
+       *          mob to the closest target of the input kind. The
+       *          mob is not modified so that several paths can be
+       *          computed concurrently.
+       * @param loc - a locator allowing to search elements in
+       *              the world.
+       * @param goal - the kind of target to reach.
+       * @param res - output result receiving the path.
+       */
+      void
+      plan(LocatorShPtr loc,
+           const path::Goal& goal,
+           path::Result& res) const;
+
+      /**
+       * @brief - Used by the path service to provide the result
+       *          of a request issued by this mob. In case a path
+       *          was found it replaces the current one, if not a
+       *          new request might be issued.
+       * @param paths - the service which computed the path.
+       * @param goal - the kind of target of the request.
+       * @param res - the result of the request. The path might
+       *              be swapped with the current one.
+       */
+      void
+      follow(PathService& paths,
+             const path::Goal& goal,
+             path::Result& res);
+
       std::ostream&
       operator<<(std::ostream& out) const override;
 
@@ -299,7 +479,7 @@ namespace tdef {
       destroy(StepInfo& info) override;
 
       void
-      worldUpdate(LocatorShPtr loc) override;
+      worldUpdate(LocatorShPtr loc, const world::Update& update) override;
 
     private:
 
@@ -329,12 +509,12 @@ namespace tdef {
        * @brief - Used to apply the freezing damage described by the
        *          input structure to this mob. In case the mob can't
        *          be freezed nothing will happen.
-       * @param info - info about the damage to apply.
        * @param d - the description of the damage to apply.
+       * @param s - the state of the mob to update.
        */
       void
-      applyFreezing(StepInfo& info,
-                    const mobs::Damage& d);
+      applyFreezing(const mobs::Damage& d,
+                    mobs::State& s);
 
       /**
        * @brief - Used to apply the stunning damage described by the
@@ -342,173 +522,130 @@ namespace tdef {
        *          be stunned nothing will happend.
        * @param info - info about the damage to apply.
        * @param d - the description of the damage to apply.
+       * @param s - the state of the mob to update.
        */
       void
       applyStunning(StepInfo& info,
-                    const mobs::Damage& d);
+                    const mobs::Damage& d,
+                    mobs::State& s);
 
       /**
        * @brief - Used to apply the poison damage described by the
        *          input structure to this mob. In case the mob is
        *          not poisonable nothing will happen.
-       * @param info - info about the damage to apply.
        * @param d - the description of the damage to apply.
+       * @param s - the state of the mob to update.
        */
       void
-      applyPoison(StepInfo& info,
-                  const mobs::Damage& d);
+      applyPoison(const mobs::Damage& d,
+                  mobs::State& s);
+
+      /**
+       * @brief - Used to fetch the behavior of the mob, either
+       *          from the store or from the local copy.
+       * @return - the behavior of the mob.
+       */
+      mobs::Behavior
+      behavior() const noexcept;
+
+      /**
+       * @brief - Used to update the behavior of the mob, either
+       *          in the store or in the local copy.
+       * @param b - the new behavior of the mob.
+       */
+      void
+      setBehavior(const mobs::Behavior& b) noexcept;
+
+      /**
+       * @brief - Used to define the health of the mob, either in
+       *          the store or in the local copy.
+       * @param health - the new health of the mob.
+       */
+      void
+      setHealth(float health) noexcept;
+
+      /**
+       * @brief - Clear the path of the mob so that it starts from
+       *          its current position.
+       */
+      void
+      clearPath();
 
       /**
-       * @brief - Used every frame to update the speed of the mob
-       *          based on the current effects applied to it. The
-       *          aim of this method is to have a usable speed at
-       *          the end of the function.
-       * @param info - information about the elapsed step.
+       * @brief - Place the mob at the start of its path. It is
+       *          called whenever the path is modified.
        */
       void
-      updateSpeed(StepInfo& info);
+      restart() noexcept;
+
+      /**
+       * @brief - Used to fetch the state of the mob, either from
+       *          the store it is registered in or from the local
+       *          copy if it is not registered.
+       * @return - the state of the mob.
+       */
+      mobs::State
+      state() const noexcept;
 
       /**
-       * @brief - Used every frame to update the health of the
-       *          mob based on the damage it's taking from applied
-       *          effects.
-       * @param info - information about the elapsed step.
+       * @brief - Used to update the state of the mob, either in
+       *          the store it is registered in or in the local
+       *          copy if it is not registered.
+       * @param s - the new state of the mob.
        */
       void
-      updateHealth(StepInfo& info);
+      setState(const mobs::State& s) noexcept;
+
+      /**
+       * @brief - Convert the input duration to seconds.
+       * @param d - the duration to convert.
+       * @return - the equivalent duration in seconds.
+       */
+      static
+      float
+      toSeconds(const utils::Duration& d) noexcept;
 
       /**
        * @brief - Attemps to locate a portal and generate a path
-       *          to go there. If this works, the path will be
-       *          assigned and the behavior will be set to portal
-       *          seeking.
+       *          to go there.
        * @param loc - a locator allowing to search elements in
        *              the world.
        * @param path - the path to generate. Will be cleared
        *               before being used.
+       * @param target - output handle receiving the portal.
        * @return - `true` if a path could be generated.
        */
       bool
       locatePortal(LocatorShPtr loc,
-                   Path& path);
+                   Path& path,
+                   world::Handle& target) const;
 
       /**
-       * @brief - Used to trigger and apply the behavior which
-       *          consists in finding the closest wall or tower
-       *          and go to it to destroy it.
+       * @brief - Used to find the closest wall or tower and a
+       *          path to go to it to destroy it.
        *          This is usually used when the portal can not
        *          be located.
        * @param loc - a locator allowing to search elements in
        *              the world.
        * @param path - the path to generate. Will be cleared
        *               before being used.
+       * @param target - output handle receiving the defense.
        * @return - `true` if a path could be generated.
        */
       bool
       destroyDefenses(LocatorShPtr loc,
-                      Path& path);
-
-    private:
+                      Path& path,
+                      world::Handle& target) const;
 
       /**
-       * @brief - Convenience structure regrouping the props
-       *          needed to manage the speed of a mob. It is
-       *          mainly used to hold the freezing effect to
-       *          apply on top of the regular speed.
+       * @brief - Request a path to a portal from the service in
+       *          case the mob is not already waiting for one.
+       * @param paths - the path service.
        */
-      struct SpeedData {
-        // The base speed of the mob: this is the speed it
-        // will reach without any modifiers.
-        float bSpeed;
-
-        // The current speed of the mob. This includes the
-        // current modifiers (like freezing and stun) that
-        // might be applied.
-        float speed;
-
-        // Defines the timestamp at which the freezing has
-        // begun for this mob.
-        utils::TimeStamp tFreeze;
-
-        // Defines the duration of the freezing effect. The
-        // mob will start to accelerate after the timestamp
-        // reaches this value.
-        utils::Duration fDuration;
-
-        // Defines the speed to reach if the freezing effect
-        // lasts for long enough. If it were to last forever
-        // the `speed` would reach this value.
-        // Note that this is expressed in percentage of the
-        // base speed so it is in the range `[0; 1]`.
-        float fSpeed;
-
-        // Defines the speed at which the mob is slowed down
-        // during the duration of the freezing effect. Note
-        // that depending on the duration it might mean that
-        // the mob won't ever reach `fSpeed`. This is based
-        // on a percentage value, indicating how much of the
-        // current speed is lost each second.
-        // So a value of `0.12` indicates that each second
-        // the speed will be decreased by 12%. This value is
-        // in the range `[0; 1]`.
-        float sDecrease;
-
-        // Defines the speed at which the mob is accelerating
-        // when the speed is slower than the desired one. As
-        // for the `sDecrease` it is expressed as a percentage
-        // of the speed that is gained each second.
-        float sIncrease;
-
-        // Defines the timestamp when this mob was stunned.
-        utils::TimeStamp tStun;
-
-        // Defines the duration of the stun effect. When the
-        // current timestamp will reach this value the mob
-        // will start to accelerate back to the expected
-        // speed given the greezing effect.
-        utils::Duration sDuration;
-      };
-
-      /**
-       * @brief - Convenience structure regrouping the props
-       *          needed to manage the poisoning status for
-       *          this mob.
-       *          We handle stacking and poisoning duration.
-       */
-      struct PoisonData {
-        // The amount of damage per second that occur due to
-        // the poisoning effect.
-        float damage;
-
-        // Defines a counter indicating how many times this
-        // mob has been posioned. The more stack there are,
-        // the less efficient they will be (relatively, as
-        // in any new stack will always deal more damage but
-        // not as much as the first stack).
-        int stack;
-
-        // Defines the timestamp when this mob was first hit
-        // by a poison effect. The duration starts ticking
-        // from this point.
-        utils::TimeStamp tPoison;
-
-        // Defines the duration of the poisoning effect. If
-        // the current timestamp reaches this point the mob
-        // will no longer be poisoned.
-        utils::Duration pDuration;
-      };
+      void
+      requestPath(PathService& paths);
 
-      /**
-       * @brief - Convenience enumeration defining the modes
-       *          available for the mob: this describes the
-       *          possible behaviors that can be adopted by
-       *          the mob.
-       */
-      enum class Behavior {
-        None,
-        PortalSeeker,
-        WallBreaker
-      };
+    private:
 
       /**
        * @brief - A factor describing how the durability of
@@ -531,6 +668,15 @@ namespace tdef {
        */
       static constexpr float sk_maxPathFindingDistance = 25.0f;
 
+      /**
+       * @brief - The delay in seconds before a mob which could
+       *          not find any target tries again. It is doubled
+       *          after each failed attempt up until the maximum
+       *          value.
+       */
+      static constexpr float sk_minRetryDelay = 0.25f;
+      static constexpr float sk_maxRetryDelay = 8.0f;
+
       /**
        * @brief - The type of the mob. This is mostly used
        *          to quickly identify the mob but most of
@@ -540,32 +686,6 @@ namespace tdef {
        */
       mobs::Type m_type;
 
-      /**
-       * @brief - An indication of the energy left for this
-       *          mob to take actions.
-       */
-      float m_energy;
-
-      /**
-       * @brief - Measure the maximum energy that this mob can
-       *          have. Above this value the energy won't be
-       *          refilled anymore.
-       */
-      float m_maxEnergy;
-
-      /**
-       * @brief - Indication of how fast the energy pool of
-       *          this entity can be refilled over time. A
-       *          faster refill rate indicates an entity that
-       *          can take more decisions.
-       */
-      float m_energyRefill;
-
-      /**
-       * @brief - The behavior currently adopted by the mob.
-       */
-      Behavior m_behavior;
-
       /**
        * @brief - The energy cost of each attack for this mob.
        *          This value in combination with the energy is
@@ -580,13 +700,9 @@ namespace tdef {
       float m_attack;
 
       /**
-       * @brief - Defines the arrival radius for this mob when
-       *          approaching its destination.
-       */
-      float m_rArrival;
-
-      /**
-       * @brief - The current path followed by this mob.
+       * @brief - The current path followed by this mob. The
+       *          progress of the mob along it is part of its
+       *          state.
        */
       Path m_path;
 
@@ -613,25 +729,51 @@ namespace tdef {
       mobs::DefenseData m_defense;
 
       /**
-       * @brief - Defines the common handler to regroup all the
-       *          properties needed to manage the speed of this
-       *          mob.
+       * @brief - The part of the state of the mob that evolves
+       *          at each step. It is only relevant when the mob
+       *          is not registered in a store: otherwise the
+       *          data is held by the store. It includes the
+       *          position and the health of the mob: the ones
+       *          of the base class are only used to create and
+       *          to restore the mob.
        */
-      SpeedData m_speed;
+      mobs::State m_state;
 
       /**
-       * @brief - Defines the common handler to regroup all the
-       *          properties needed to manage the poisoning of
-       *          this mob.
+       * @brief - The store in which this mob is registered and
+       *          the index of the slot it uses. The store is
+       *          `null` if the mob is not registered.
        */
-      PoisonData m_poison;
+      MobStore* m_store;
+      unsigned m_slot;
 
       /**
        * @brief - The target for this mob. Until it is reached
        *          or somehow made unavailable we will try to
-                  reach it.
+                  reach it. It resolves to `null` in case the
+       *          block has been removed from the world.
+       */
+      world::Handle m_target;
+
+      /**
+       * @brief - Whether the mob is waiting for the result of a
+       *          path request, and whether it should request a
+       *          new path because the world has changed.
+       */
+      bool m_planning;
+      bool m_replan;
+
+      /**
+       * @brief - The number of consecutive attempts to find a
+       *          target which failed, the time left before the
+       *          next attempt and the obstacle epoch in which
+       *          the last attempt was made. A new attempt is
+       *          made right away in case the layout of the world
+       *          changes.
        */
-      BlockShPtr m_target;
+      unsigned m_attempts;
+      float m_retry;
+      unsigned m_epoch;
   };
 
   using MobShPtr = std::shared_ptr<Mob>;
@@ -74,6 +74,71 @@ namespace tdef {
     return pp;
   }
 
+  inline
+  const utils::Point2f&
+  Mob::getPos() const noexcept {
+    if (m_store != nullptr) {
+      return m_store->pos(m_slot);
+    }
+
+    return m_state.pos;
+  }
+
+  inline
+  const utils::Point2f&
+  Mob::getPreviousPos() const noexcept {
+    if (m_store != nullptr) {
+      return m_store->prev(m_slot);
+    }
+
+    return m_state.prev;
+  }
+
+  inline
+  float
+  Mob::getHealth() const noexcept {
+    if (m_store != nullptr) {
+      return m_store->health(m_slot);
+    }
+
+    return m_state.health;
+  }
+
+  inline
+  float
+  Mob::getHealthRatio() const noexcept {
+    if (m_totalHealth <= 0.0f) {
+      return 1.0f;
+    }
+
+    return getHealth() / m_totalHealth;
+  }
+
+  inline
+  bool
+  Mob::isDead() const noexcept {
+    return getHealthRatio() <= 0.0f;
+  }
+
+  inline
+  bool
+  Mob::damage(StepInfo& /*info*/,
+              float hit)
+  {
+    // Healing is done in the limit of the health pool
+    // of the mob, damage is clamped to a null health.
+    if (hit < 0.0f) {
+      setHealth(std::min(getHealth() - hit, m_totalHealth));
+
+      return true;
+    }
+
+    float health = std::max(getHealth() - hit, 0.0f);
+    setHealth(health);
+
+    return (health > 0.0f);
+  }
+
   inline
   const mobs::Type&
   Mob::getType() const noexcept {
@@ -101,18 +166,23 @@ namespace tdef {
   inline
   float
   Mob::getSpeed() const noexcept {
-    return m_speed.speed;
+    if (m_store != nullptr) {
+      return m_store->speed(m_slot);
+    }
+
+    return m_state.speed;
   }
 
   inline
   mobs::Effects
   Mob::getEffects() const noexcept {
+    mobs::State s = state();
     mobs::Effects e;
 
-    e.freezed = (m_speed.fSpeed != 1.0f);
-    e.poisoned = (m_poison.damage != 0.0f);
+    e.freezed = (s.fSpeed != 1.0f);
+    e.poisoned = (s.poison != 0.0f);
 
-    e.stunned = (m_speed.speed == 0.0f);
+    e.stunned = (s.speed == 0.0f);
 
     return e;
   }
@@ -120,19 +190,32 @@ namespace tdef {
   inline
   bool
   Mob::isEnRoute() const noexcept {
-    return m_path.enRoute(m_rArrival);
+    if (m_store != nullptr) {
+      return m_store->enRoute(m_slot);
+    }
+
+    return m_path.enRoute(m_state.segment, m_state.offset, m_state.arrival);
   }
 
+  inline
+  void
+  Mob::relocate(unsigned slot) noexcept {
+    m_slot = slot;
+  }
 
   inline
   std::ostream&
   Mob::operator<<(std::ostream& out) const {
-    WorldElement::operator<<(out);
+    // The position and the health of the mob are part of
+    // its state.
+    serialize(out, getPos(), getHealth());
+
+    mobs::State s = state();
 
     out << static_cast<int>(m_type) << " ";
-    out << m_energy << " ";
-    out << m_maxEnergy << " ";
-    out << m_energyRefill << " ";
+    out << s.energy << " ";
+    out << s.maxEnergy << " ";
+    out << s.refill << " ";
     // Note that we won't save the behavior nor the path:
     // indeed as we're not saving the target anyway it
     // would just need to confusing situation where the
@@ -142,7 +225,7 @@ namespace tdef {
     // new target.
     out << m_attackCost << " ";
     out << m_attack << " ";
-    out << m_rArrival << " ";
+    out << s.arrival << " ";
     // Skip path.
     out << m_bounty << " ";
     out << m_cost << " ";
@@ -156,36 +239,28 @@ namespace tdef {
     out << m_defense.slowable << " ";
     out << m_defense.stunnable << " ";
 
-    // Speed data.
-    out << m_speed.bSpeed << " ";
-    out << m_speed.speed << " ";
-    // In order to save the speed time and duration,
-    // we only save the duration. Indeed as we only
-    // allow a Mob to be saved when the game is in
-    // pause, we will have a duration corresponding
-    // to the remaining freeze time already. It is
-    // then valid to consider that when restoring
-    // this data, we will put the current timestamp
-    // in the freeze time and use the remaining
-    // duration for the freeze time.
-    // We apply a similar reasoning for the stun
-    // and poison duration.
-    out << utils::toMilliseconds(m_speed.fDuration) << " ";
-    out << m_speed.fSpeed << " ";
-    out << m_speed.sDecrease << " ";
-    out << m_speed.sIncrease << " ";
-    out << utils::toMilliseconds(m_speed.sDuration) << " ";
+    // Speed data. The durations of the effects are
+    // saved as the remaining time in milliseconds:
+    // when restoring the data the effects will last
+    // for this duration.
+    out << s.bSpeed << " ";
+    out << s.speed << " ";
+    out << s.fRemaining * 1000.0f << " ";
+    out << s.fSpeed << " ";
+    out << s.sDecrease << " ";
+    out << s.sIncrease << " ";
+    out << s.sRemaining * 1000.0f << " ";
 
     // Poison data.
-    out << m_poison.damage << " ";
-    out << m_poison.stack << " ";
-    out << utils::toMilliseconds(m_poison.pDuration) << " ";
+    out << s.poison << " ";
+    out << s.stack << " ";
+    out << s.pRemaining * 1000.0f << " ";
 
     // Ignore the mob's target as we will reset its
     // behavior and look for a new target when the
     // game is deserialized.
 
-    verbose("Saved mob at " + m_pos.toString());
+    verbose("Saved mob at " + s.pos.toString());
 
     return out;
   }
@@ -195,20 +270,30 @@ namespace tdef {
   Mob::operator>>(std::istream& in) {
     WorldElement::operator>>(in);
 
+    mobs::State s = state();
+    s.pos = m_pos;
+    s.prev = m_prevPos;
+    s.health = m_health;
+
     int i;
     in >> i;
     m_type = static_cast<mobs::Type>(i);
-    in >> m_energy;
-    in >> m_maxEnergy;
-    in >> m_energyRefill;
+    in >> s.energy;
+    in >> s.maxEnergy;
+    in >> s.refill;
     // Assume default behavior: this will trigger
     // the definition of a new target.
-    m_behavior = Behavior::None;
+    s.behavior = mobs::Behavior::None;
+    m_planning = false;
+    m_replan = false;
+    m_attempts = 0u;
+    m_retry = 0.0f;
     in >> m_attackCost;
     in >> m_attack;
-    in >> m_rArrival;
+    in >> s.arrival;
     // Reset path to the current position.
     m_path.clear(m_pos);
+    m_path.begin(s.segment, s.offset);
     in >> m_bounty;
     in >> m_cost;
     in >> m_exp;
@@ -221,29 +306,27 @@ namespace tdef {
     in >> m_defense.slowable;
     in >> m_defense.stunnable;
 
-    // Speed data.
-    in >> m_speed.bSpeed;
-    in >> m_speed.speed;
+    // Speed data: the durations are restored from
+    // the remaining time of each effect.
+    in >> s.bSpeed;
+    in >> s.speed;
     float d;
-    // Initialize freeze, stun and poison time to
-    // the current moment. It should be overriden
-    // when we actually resume the game.
-    m_speed.tFreeze = utils::now();
     in >> d;
-    m_speed.fDuration = utils::toMilliseconds(d);
-    in >> m_speed.fSpeed;
-    in >> m_speed.sDecrease;
-    in >> m_speed.sIncrease;
-    m_speed.tStun = utils::now();
+    s.fRemaining = d / 1000.0f;
+    s.fDuration = s.fRemaining;
+    in >> s.fSpeed;
+    in >> s.sDecrease;
+    in >> s.sIncrease;
     in >> d;
-    m_speed.sDuration = utils::toMilliseconds(d);
+    s.sRemaining = d / 1000.0f;
 
     // Poison data.
-    in >> m_poison.damage;
-    in >> m_poison.stack;
-    m_poison.tPoison = utils::now();
+    in >> s.poison;
+    in >> s.stack;
     in >> d;
-    m_poison.pDuration = utils::toMilliseconds(d);
+    s.pRemaining = d / 1000.0f;
+
+    setState(s);
 
     // Do not save the target of the mob: as discussed it would
     // require to somehow be able to link it back again when the
@@ -264,6 +347,94 @@ namespace tdef {
   void
   Mob::destroy(StepInfo& /*info*/) {}
 
+  inline
+  void
+  Mob::pause(const utils::TimeStamp& /*t*/) {
+    // The duration of the effects only decreases when the
+    // simulation advances so there's nothing to do here.
+  }
+
+  inline
+  void
+  Mob::resume(const utils::TimeStamp& /*t*/) {}
+
+  inline
+  mobs::Behavior
+  Mob::behavior() const noexcept {
+    if (m_store != nullptr) {
+      return m_store->behavior(m_slot);
+    }
+
+    return m_state.behavior;
+  }
+
+  inline
+  void
+  Mob::setBehavior(const mobs::Behavior& b) noexcept {
+    if (m_store != nullptr) {
+      m_store->setBehavior(m_slot, b);
+      return;
+    }
+
+    m_state.behavior = b;
+  }
+
+  inline
+  void
+  Mob::setHealth(float health) noexcept {
+    if (m_store != nullptr) {
+      m_store->setHealth(m_slot, health);
+      return;
+    }
+
+    m_state.health = health;
+  }
+
+  inline
+  void
+  Mob::clearPath() {
+    m_path.clear(getPos());
+    restart();
+  }
+
+  inline
+  void
+  Mob::restart() noexcept {
+    if (m_store != nullptr) {
+      m_store->restart(m_slot);
+      return;
+    }
+
+    m_path.begin(m_state.segment, m_state.offset);
+  }
+
+  inline
+  mobs::State
+  Mob::state() const noexcept {
+    if (m_store != nullptr) {
+      return m_store->get(m_slot);
+    }
+
+    return m_state;
+  }
+
+  inline
+  void
+  Mob::setState(const mobs::State& s) noexcept {
+    if (m_store != nullptr) {
+      m_store->set(m_slot, s);
+      return;
+    }
+
+    m_state = s;
+  }
+
+  inline
+  float
+  Mob::toSeconds(const utils::Duration& d) noexcept {
+    return utils::toMilliseconds(d) / 1000.0f;
+  }
+
   inline
   mobs::DefenseData
   Mob::fromProps(const MProps& props) noexcept {
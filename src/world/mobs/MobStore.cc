@@ -0,0 +1,352 @@
+
+# include "MobStore.hh"
+# include <algorithm>
+# include "Mob.hh"
+# include "Path.hh"
+
+namespace tdef {
+
+  MobStore::MobStore() noexcept:
+    utils::CoreObject("store"),
+
+    m_energy(),
+    m_maxEnergy(),
+    m_refill(),
+
+    m_speed(),
+    m_bSpeed(),
+    m_fSpeed(),
+    m_sDecrease(),
+    m_sIncrease(),
+
+    m_fRemaining(),
+    m_fDuration(),
+    m_sRemaining(),
+
+    m_poison(),
+    m_stack(),
+    m_pRemaining(),
+
+    m_pos(),
+    m_prev(),
+
+    m_health(),
+
+    m_behavior(),
+
+    m_segment(),
+    m_offset(),
+    m_arrival(),
+
+    m_damage(),
+    m_moving(),
+    m_paths(),
+
+    m_owners()
+  {
+    setService("mobs");
+  }
+
+  MobStore::~MobStore() {
+    clear();
+  }
+
+  unsigned
+  MobStore::add(Mob* owner, const Path& path, const mobs::State& s) {
+    m_energy.push_back(s.energy);
+    m_maxEnergy.push_back(s.maxEnergy);
+    m_refill.push_back(s.refill);
+
+    m_speed.push_back(s.speed);
+    m_bSpeed.push_back(s.bSpeed);
+    m_fSpeed.push_back(s.fSpeed);
+    m_sDecrease.push_back(s.sDecrease);
+    m_sIncrease.push_back(s.sIncrease);
+
+    m_fRemaining.push_back(s.fRemaining);
+    m_fDuration.push_back(s.fDuration);
+    m_sRemaining.push_back(s.sRemaining);
+
+    m_poison.push_back(s.poison);
+    m_stack.push_back(s.stack);
+    m_pRemaining.push_back(s.pRemaining);
+
+    m_pos.push_back(s.pos);
+    m_prev.push_back(s.prev);
+
+    m_health.push_back(s.health);
+
+    m_behavior.push_back(s.behavior);
+
+    m_segment.push_back(s.segment);
+    m_offset.push_back(s.offset);
+    m_arrival.push_back(s.arrival);
+
+    m_damage.push_back(0.0f);
+    m_moving.push_back(0u);
+    m_paths.push_back(&path);
+
+    m_owners.push_back(owner);
+
+    return m_owners.size() - 1u;
+  }
+
+  void
+  MobStore::compact() noexcept {
+    unsigned next = 0u;
+
+    for (unsigned id = 0u ; id < m_owners.size() ; ++id) {
+      if (m_owners[id] == nullptr) {
+        continue;
+      }
+
+      if (id != next) {
+        set(next, get(id));
+        m_damage[next] = m_damage[id];
+        m_moving[next] = m_moving[id];
+        m_paths[next] = m_paths[id];
+
+        m_owners[next] = m_owners[id];
+        m_owners[next]->relocate(next);
+      }
+
+      ++next;
+    }
+
+    if (next == m_owners.size()) {
+      return;
+    }
+
+    m_energy.resize(next);
+    m_maxEnergy.resize(next);
+    m_refill.resize(next);
+
+    m_speed.resize(next);
+    m_bSpeed.resize(next);
+    m_fSpeed.resize(next);
+    m_sDecrease.resize(next);
+    m_sIncrease.resize(next);
+
+    m_fRemaining.resize(next);
+    m_fDuration.resize(next);
+    m_sRemaining.resize(next);
+
+    m_poison.resize(next);
+    m_stack.resize(next);
+    m_pRemaining.resize(next);
+
+    m_pos.resize(next);
+    m_prev.resize(next);
+
+    m_health.resize(next);
+
+    m_behavior.resize(next);
+
+    m_segment.resize(next);
+    m_offset.resize(next);
+    m_arrival.resize(next);
+
+    m_damage.resize(next);
+    m_moving.resize(next);
+    m_paths.resize(next);
+
+    m_owners.resize(next);
+  }
+
+  void
+  MobStore::clear() noexcept {
+    // Detaching a mob releases its slot.
+    for (unsigned id = 0u ; id < m_owners.size() ; ++id) {
+      if (m_owners[id] != nullptr) {
+        m_owners[id]->detach();
+      }
+    }
+
+    compact();
+  }
+
+  mobs::State
+  MobStore::get(unsigned slot) const noexcept {
+    return mobs::State{
+      m_energy[slot],
+      m_maxEnergy[slot],
+      m_refill[slot],
+
+      m_speed[slot],
+      m_bSpeed[slot],
+      m_fSpeed[slot],
+      m_sDecrease[slot],
+      m_sIncrease[slot],
+
+      m_fRemaining[slot],
+      m_fDuration[slot],
+      m_sRemaining[slot],
+
+      m_poison[slot],
+      m_stack[slot],
+      m_pRemaining[slot],
+
+      m_pos[slot],
+      m_prev[slot],
+
+      m_health[slot],
+
+      m_behavior[slot],
+
+      m_segment[slot],
+      m_offset[slot],
+      m_arrival[slot]
+    };
+  }
+
+  void
+  MobStore::set(unsigned slot, const mobs::State& s) noexcept {
+    m_energy[slot] = s.energy;
+    m_maxEnergy[slot] = s.maxEnergy;
+    m_refill[slot] = s.refill;
+
+    m_speed[slot] = s.speed;
+    m_bSpeed[slot] = s.bSpeed;
+    m_fSpeed[slot] = s.fSpeed;
+    m_sDecrease[slot] = s.sDecrease;
+    m_sIncrease[slot] = s.sIncrease;
+
+    m_fRemaining[slot] = s.fRemaining;
+    m_fDuration[slot] = s.fDuration;
+    m_sRemaining[slot] = s.sRemaining;
+
+    m_poison[slot] = s.poison;
+    m_stack[slot] = s.stack;
+    m_pRemaining[slot] = s.pRemaining;
+
+    m_pos[slot] = s.pos;
+    m_prev[slot] = s.prev;
+
+    m_health[slot] = s.health;
+
+    m_behavior[slot] = s.behavior;
+
+    m_segment[slot] = s.segment;
+    m_offset[slot] = s.offset;
+    m_arrival[slot] = s.arrival;
+  }
+
+  bool
+  MobStore::enRoute(unsigned slot) const noexcept {
+    return m_paths[slot]->enRoute(m_segment[slot], m_offset[slot], m_arrival[slot]);
+  }
+
+  void
+  MobStore::restart(unsigned slot) noexcept {
+    m_paths[slot]->begin(m_segment[slot], m_offset[slot]);
+  }
+
+  void
+  MobStore::step(float elapsed) noexcept {
+    unsigned count = m_owners.size();
+
+    // Keep track of the position before moving and reset
+    // the motion requested during the last step.
+    for (unsigned id = 0u ; id < count ; ++id) {
+      m_prev[id] = m_pos[id];
+      m_moving[id] = 0u;
+    }
+
+    // Refill the energy.
+    for (unsigned id = 0u ; id < count ; ++id) {
+      m_energy[id] = std::min(m_energy[id] + elapsed * m_refill[id], m_maxEnergy[id]);
+    }
+
+    // Count down the duration of the effects.
+    for (unsigned id = 0u ; id < count ; ++id) {
+      m_fRemaining[id] = std::max(m_fRemaining[id] - elapsed, 0.0f);
+      m_sRemaining[id] = std::max(m_sRemaining[id] - elapsed, 0.0f);
+      m_pRemaining[id] = std::max(m_pRemaining[id] - elapsed, 0.0f);
+    }
+
+    // Reset the freezing for mobs where it wore off.
+    for (unsigned id = 0u ; id < count ; ++id) {
+      bool freezed = (m_fRemaining[id] > 0.0f);
+
+      m_fSpeed[id] = (freezed ? m_fSpeed[id] : 1.0f);
+      m_sDecrease[id] = (freezed ? m_sDecrease[id] : 0.0f);
+    }
+
+    // Update the speed based on the desired speed and the
+    // acceleration or deceleration factor. In case the mob
+    // is slower than the target speed it accelerates up to
+    // it, otherwise it decelerates but can't go below it.
+    // The variation is computed from the largest of both
+    // speeds so that we always vary the quickest. Stunned
+    // mobs don't move.
+    for (unsigned id = 0u ; id < count ; ++id) {
+      float target = m_bSpeed[id] * m_fSpeed[id];
+      float mod = (m_speed[id] > target ? -m_sDecrease[id] : m_sIncrease[id]);
+      float s = m_speed[id] + std::max(m_speed[id], target) * mod * elapsed;
+
+      s = (mod > 0.0f ? std::min(std::max(s, 0.0f), target) : std::max(s, target));
+
+      m_speed[id] = (m_sRemaining[id] > 0.0f ? 0.0f : s);
+    }
+
+    // Compute the damage of the poison and reset it for mobs
+    // where it wore off: the next application will start
+    // from scratch.
+    for (unsigned id = 0u ; id < count ; ++id) {
+      bool poisoned = (m_pRemaining[id] > 0.0f);
+
+      m_poison[id] = (poisoned ? m_poison[id] : 0.0f);
+      m_stack[id] = (poisoned ? m_stack[id] : 0);
+      m_damage[id] = m_poison[id] * elapsed;
+    }
+
+    // Apply the damage of the poison.
+    for (unsigned id = 0u ; id < count ; ++id) {
+      m_health[id] = std::max(m_health[id] - m_damage[id], 0.0f);
+    }
+  }
+
+  void
+  MobStore::move(float elapsed) noexcept {
+    unsigned count = m_owners.size();
+
+    for (unsigned id = 0u ; id < count ; ++id) {
+      if (m_moving[id] == 0u) {
+        continue;
+      }
+
+      const std::vector<path::Segment>& segs = m_paths[id]->getSegments();
+      int ss = static_cast<int>(segs.size());
+      int seg = m_segment[id];
+      float left = m_offset[id];
+
+      // Complete the current segment and the following
+      // ones until we either reach the end of the path
+      // or don't travel enough to do so.
+      float traveled = m_speed[id] * elapsed;
+
+      while (traveled > left && seg < ss) {
+        traveled -= left;
+        ++seg;
+
+        left = (seg < ss ? segs[seg].length() : 0.0f);
+      }
+
+      // In case the end of the path is reached there is
+      // nothing more to do: the mob is at its end.
+      if (seg == ss) {
+        m_pos[id] = segs[ss - 1].end;
+      }
+      else {
+        left -= traveled;
+
+        m_pos[id].x() = segs[seg].end.x() - left * segs[seg].xD;
+        m_pos[id].y() = segs[seg].end.y() - left * segs[seg].yD;
+      }
+
+      m_segment[id] = seg;
+      m_offset[id] = left;
+    }
+  }
+
+}
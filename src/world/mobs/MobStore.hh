@@ -0,0 +1,397 @@
+#ifndef    MOB_STORE_HH
+# define   MOB_STORE_HH
+
+# include <vector>
+# include <memory>
+# include <cstdint>
+# include <core_utils/CoreObject.hh>
+# include <maths_utils/Point2.hh>
+
+namespace tdef {
+  namespace mobs {
+
+    /**
+     * @brief - Convenience enumeration defining the modes
+     *          available for the mob: this describes the
+     *          possible behaviors that can be adopted by
+     *          the mob.
+     */
+    enum class Behavior {
+      None,
+      PortalSeeker,
+      WallBreaker
+    };
+
+    /**
+     * @brief - Convenience structure regrouping the part of
+     *          the state of a mob that evolves at each step
+     *          of the simulation. It is mostly used to move
+     *          the data of a mob in and out of the store and
+     *          for the rare operations that need to access
+     *          all of it at once (typically hitting a mob).
+     *          All durations are expressed in seconds and
+     *          count down to `0` as the simulation advances.
+     */
+    struct State {
+      // The energy available for the mob to take actions,
+      // the maximum energy it can have and the amount of
+      // energy refilled each second.
+      float energy;
+      float maxEnergy;
+      float refill;
+
+      // The current speed of the mob, including modifiers
+      // like freezing or stun.
+      float speed;
+
+      // The base speed of the mob: this is the speed it
+      // reaches without any modifiers.
+      float bSpeed;
+
+      // The speed to reach if the freezing effect lasts for
+      // long enough, expressed as a percentage of the base
+      // speed so it is in the range `[0; 1]`.
+      float fSpeed;
+
+      // The percentage of the current speed lost each second
+      // while the mob is freezed.
+      float sDecrease;
+
+      // The percentage of the speed gained each second when
+      // the speed is slower than the desired one.
+      float sIncrease;
+
+      // The time remaining before the freezing effect wears
+      // off and the full duration of this effect.
+      float fRemaining;
+      float fDuration;
+
+      // The time remaining before the stun wears off.
+      float sRemaining;
+
+      // The damage per second due to poisoning, the number
+      // of poison stacks applied and the time remaining for
+      // the poison to wear off.
+      float poison;
+      int stack;
+      float pRemaining;
+
+      // The position of the mob and its position at the
+      // beginning of the last step.
+      utils::Point2f pos;
+      utils::Point2f prev;
+
+      // The current health of the mob.
+      float health;
+
+      // The behavior currently adopted by the mob.
+      Behavior behavior;
+
+      // The cursor of the mob on its path: the index of the
+      // segment followed, `-1` if the path is empty, and the
+      // distance left to reach the end of this segment. The
+      // mob has arrived when it is closer to the end of the
+      // path than the arrival radius.
+      int segment;
+      float offset;
+      float arrival;
+    };
+
+  }
+
+  // Forward declaration of the `Mob` and `Path` classes.
+  class Mob;
+  class Path;
+
+  class MobStore: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new empty store for the state of the
+       *          mobs of a world. Each mob is assigned a slot in
+       *          the store and each part of its state is stored
+       *          in a contiguous array so that the per-step
+       *          updates can be performed as tight loops.
+       */
+      MobStore() noexcept;
+
+      /**
+       * @brief - Destruction of the object: all the mobs still
+       *          registered are detached so that they keep a
+       *          valid state.
+       */
+      ~MobStore();
+
+      /**
+       * @brief - Return the number of slots used in the store.
+       *          Note that it includes the slots released since
+       *          the last compaction.
+       * @return - the number of slots.
+       */
+      unsigned
+      size() const noexcept;
+
+      /**
+       * @brief - Register a new mob with the input state in the
+       *          store.
+       * @param owner - the mob owning the slot.
+       * @param path - the path followed by the mob. It should
+       *               stay valid as long as the slot is used.
+       * @param s - the initial state of the mob.
+       * @return - the index of the slot assigned to the mob.
+       */
+      unsigned
+      add(Mob* owner, const Path& path, const mobs::State& s);
+
+      /**
+       * @brief - Release the slot at the specified index: it
+       *          will be reclaimed at the next compaction.
+       * @param slot - the index of the slot.
+       */
+      void
+      release(unsigned slot) noexcept;
+
+      /**
+       * @brief - Remove the released slots from the store. The
+       *          relative order of the remaining slots is kept
+       *          and their owners are notified of their new
+       *          index.
+       */
+      void
+      compact() noexcept;
+
+      /**
+       * @brief - Detach all the mobs registered in the store and
+       *          remove all slots.
+       */
+      void
+      clear() noexcept;
+
+      /**
+       * @brief - Gather the state of the mob at the input slot.
+       * @param slot - the index of the slot.
+       * @return - the state of the mob.
+       */
+      mobs::State
+      get(unsigned slot) const noexcept;
+
+      /**
+       * @brief - Scatter the input state to the specified slot.
+       * @param slot - the index of the slot.
+       * @param s - the new state of the mob.
+       */
+      void
+      set(unsigned slot, const mobs::State& s) noexcept;
+
+      /**
+       * @brief - Return the current speed of the mob at the
+       *          input slot.
+       * @param slot - the index of the slot.
+       * @return - the speed of the mob.
+       */
+      float
+      speed(unsigned slot) const noexcept;
+
+      /**
+       * @brief - Return the damage that the mob at the input
+       *          slot took from poisoning during the last step.
+       * @param slot - the index of the slot.
+       * @return - the damage to apply to the mob.
+       */
+      float
+      damage(unsigned slot) const noexcept;
+
+      /**
+       * @brief - Return the position of the mob at the input
+       *          slot.
+       * @param slot - the index of the slot.
+       * @return - the position of the mob.
+       */
+      const utils::Point2f&
+      pos(unsigned slot) const noexcept;
+
+      /**
+       * @brief - Return the position of the mob at the input
+       *          slot at the beginning of the last step.
+       * @param slot - the index of the slot.
+       * @return - the previous position of the mob.
+       */
+      const utils::Point2f&
+      prev(unsigned slot) const noexcept;
+
+      /**
+       * @brief - Return the current health of the mob at the
+       *          input slot.
+       * @param slot - the index of the slot.
+       * @return - the health of the mob.
+       */
+      float
+      health(unsigned slot) const noexcept;
+
+      /**
+       * @brief - Define the health of the mob at the input slot.
+       * @param slot - the index of the slot.
+       * @param health - the new health of the mob.
+       */
+      void
+      setHealth(unsigned slot, float health) noexcept;
+
+      /**
+       * @brief - Return the behavior of the mob at the input
+       *          slot.
+       * @param slot - the index of the slot.
+       * @return - the behavior of the mob.
+       */
+      mobs::Behavior
+      behavior(unsigned slot) const noexcept;
+
+      /**
+       * @brief - Define the behavior of the mob at the input
+       *          slot.
+       * @param slot - the index of the slot.
+       * @param b - the new behavior of the mob.
+       */
+      void
+      setBehavior(unsigned slot, const mobs::Behavior& b) noexcept;
+
+      /**
+       * @brief - Return the arrival radius of the mob at the
+       *          input slot.
+       * @param slot - the index of the slot.
+       * @return - the arrival radius of the mob.
+       */
+      float
+      arrival(unsigned slot) const noexcept;
+
+      /**
+       * @brief - Return the index of the segment of its path
+       *          followed by the mob at the input slot.
+       * @param slot - the index of the slot.
+       * @return - the index of the segment.
+       */
+      int
+      segment(unsigned slot) const noexcept;
+
+      /**
+       * @brief - Determine whether the mob at the input slot
+       *          still has some way to go on its path.
+       * @param slot - the index of the slot.
+       * @return - `true` if the mob has not arrived yet.
+       */
+      bool
+      enRoute(unsigned slot) const noexcept;
+
+      /**
+       * @brief - Place the mob at the input slot at the start
+       *          of its path. It should be called whenever the
+       *          path is modified.
+       * @param slot - the index of the slot.
+       */
+      void
+      restart(unsigned slot) noexcept;
+
+      /**
+       * @brief - Request the mob at the input slot to move on
+       *          its path during the next call to `move`.
+       * @param slot - the index of the slot.
+       */
+      void
+      schedule(unsigned slot) noexcept;
+
+      /**
+       * @brief - Attempt to consume the specified amount of
+       *          energy for the mob at the input slot. Nothing
+       *          happens if not enough energy is available.
+       * @param slot - the index of the slot.
+       * @param cost - the amount of energy to consume.
+       * @return - `true` if the energy was consumed.
+       */
+      bool
+      consume(unsigned slot, float cost) noexcept;
+
+      /**
+       * @brief - Advance the state of all the mobs: refill the
+       *          energy, count down the duration of the effects
+       *          and update the speed and the poison damage of
+       *          each mob.
+       * @param elapsed - the duration of the step in seconds.
+       */
+      void
+      step(float elapsed) noexcept;
+
+      /**
+       * @brief - Move the mobs scheduled since the last step on
+       *          their path based on their current speed.
+       * @param elapsed - the duration of the step in seconds.
+       */
+      void
+      move(float elapsed) noexcept;
+
+    private:
+
+      /**
+       * @brief - The state of the mobs. Each vector holds one
+       *          field of the `mobs::State` structure for all
+       *          the slots.
+       */
+      std::vector<float> m_energy;
+      std::vector<float> m_maxEnergy;
+      std::vector<float> m_refill;
+
+      std::vector<float> m_speed;
+      std::vector<float> m_bSpeed;
+      std::vector<float> m_fSpeed;
+      std::vector<float> m_sDecrease;
+      std::vector<float> m_sIncrease;
+
+      std::vector<float> m_fRemaining;
+      std::vector<float> m_fDuration;
+      std::vector<float> m_sRemaining;
+
+      std::vector<float> m_poison;
+      std::vector<int> m_stack;
+      std::vector<float> m_pRemaining;
+
+      std::vector<utils::Point2f> m_pos;
+      std::vector<utils::Point2f> m_prev;
+
+      std::vector<float> m_health;
+
+      std::vector<mobs::Behavior> m_behavior;
+
+      std::vector<int> m_segment;
+      std::vector<float> m_offset;
+      std::vector<float> m_arrival;
+
+      /**
+       * @brief - The damage taken from poisoning by each mob
+       *          during the last step.
+       */
+      std::vector<float> m_damage;
+
+      /**
+       * @brief - Whether each mob should move on its path at
+       *          the next call to `move`. Reset at each step.
+       *          Bytes are used so that the mobs can request
+       *          to move concurrently.
+       */
+      std::vector<std::uint8_t> m_moving;
+
+      /**
+       * @brief - The path followed by the mob of each slot.
+       */
+      std::vector<const Path*> m_paths;
+
+      /**
+       * @brief - The mob owning each slot or `null` if the slot
+       *          has been released.
+       */
+      std::vector<Mob*> m_owners;
+  };
+
+  using MobStoreShPtr = std::shared_ptr<MobStore>;
+}
+
+# include "MobStore.hxx"
+
+#endif    /* MOB_STORE_HH */
@@ -0,0 +1,99 @@
+#ifndef    MOB_STORE_HXX
+# define   MOB_STORE_HXX
+
+# include "MobStore.hh"
+
+namespace tdef {
+
+  inline
+  unsigned
+  MobStore::size() const noexcept {
+    return m_owners.size();
+  }
+
+  inline
+  void
+  MobStore::release(unsigned slot) noexcept {
+    m_owners[slot] = nullptr;
+  }
+
+  inline
+  float
+  MobStore::speed(unsigned slot) const noexcept {
+    return m_speed[slot];
+  }
+
+  inline
+  float
+  MobStore::damage(unsigned slot) const noexcept {
+    return m_damage[slot];
+  }
+
+  inline
+  const utils::Point2f&
+  MobStore::pos(unsigned slot) const noexcept {
+    return m_pos[slot];
+  }
+
+  inline
+  const utils::Point2f&
+  MobStore::prev(unsigned slot) const noexcept {
+    return m_prev[slot];
+  }
+
+  inline
+  float
+  MobStore::health(unsigned slot) const noexcept {
+    return m_health[slot];
+  }
+
+  inline
+  void
+  MobStore::setHealth(unsigned slot, float health) noexcept {
+    m_health[slot] = health;
+  }
+
+  inline
+  mobs::Behavior
+  MobStore::behavior(unsigned slot) const noexcept {
+    return m_behavior[slot];
+  }
+
+  inline
+  void
+  MobStore::setBehavior(unsigned slot, const mobs::Behavior& b) noexcept {
+    m_behavior[slot] = b;
+  }
+
+  inline
+  float
+  MobStore::arrival(unsigned slot) const noexcept {
+    return m_arrival[slot];
+  }
+
+  inline
+  int
+  MobStore::segment(unsigned slot) const noexcept {
+    return m_segment[slot];
+  }
+
+  inline
+  void
+  MobStore::schedule(unsigned slot) noexcept {
+    m_moving[slot] = 1u;
+  }
+
+  inline
+  bool
+  MobStore::consume(unsigned slot, float cost) noexcept {
+    if (m_energy[slot] < cost) {
+      return false;
+    }
+
+    m_energy[slot] -= cost;
+    return true;
+  }
+
+}
+
+#endif    /* MOB_STORE_HXX */
@@ -3,6 +3,9 @@
 # include "StepInfo.hh"
 # include "Locator.hh"
 # include "AStar.hh"
+# include "FlowField.hh"
+# include "PathCache.hh"
+# include <algorithm>
 
 namespace tdef {
 
@@ -10,9 +13,7 @@ namespace tdef {
     utils::CoreObject("path"),
 
     m_home(),
-    m_cur(),
 
-    m_seg(-1),
     m_segments(),
     m_cPoints()
   {
@@ -23,9 +24,7 @@ namespace tdef {
     utils::CoreObject("path"),
 
     m_home(p),
-    m_cur(p),
 
-    m_seg(-1),
     m_segments(),
     m_cPoints()
   {
@@ -35,64 +34,66 @@ namespace tdef {
     addPassagePoint(p);
   }
 
-  void
-  Path::advance(float speed, float elapsed, float threshold) {
-    // In case we already arrived, do nothing.
-    if (!enRoute(threshold)) {
-      return;
+  bool
+  Path::crosses(const std::vector<world::Cell>& cells,
+                const utils::Point2f& p,
+                int segment) const noexcept
+  {
+    int ss = static_cast<int>(m_segments.size());
+    if (cells.empty() || segment < 0 || segment >= ss) {
+      return false;
     }
 
-    float traveled = speed * elapsed;
-    int ss = static_cast<int>(m_segments.size());
+    // Check each remaining segment against the box
+    // of each cell. We use a slab test: the segment
+    // is parameterized with `t` in `[0; 1]` and we
+    // restrict the range of `t` on each axis.
+    auto intersects = [](const utils::Point2f& s, const utils::Point2f& e, const world::Cell& c) {
+      float tMin = 0.0f, tMax = 1.0f;
+
+      float o[2] = {s.x(), s.y()};
+      float d[2] = {e.x() - s.x(), e.y() - s.y()};
+      float lo[2] = {1.0f * c.x, 1.0f * c.y};
+
+      for (unsigned a = 0u ; a < 2u ; ++a) {
+        if (std::abs(d[a]) < 0.0001f) {
+          // Parallel to the slab.
+          if (o[a] < lo[a] || o[a] > lo[a] + 1.0f) {
+            return false;
+          }
+
+          continue;
+        }
+
+        float t1 = (lo[a] - o[a]) / d[a];
+        float t2 = (lo[a] + 1.0f - o[a]) / d[a];
 
-    // Attempt to complete the current path
-    // segment until we either reach the end
-    // of the path or don't travel enough to
-    // do so.
-    float dToEofS = utils::d(m_cur, m_segments[m_seg].end);
-
-    while (traveled > dToEofS && m_seg < ss) {
-      // Move along the path segment: as we
-      // traveled far enough to complete the
-      // path segment we can directly go to
-      // the target point of the segment.
-      m_cur.x() = m_segments[m_seg].end.x();
-      m_cur.y() = m_segments[m_seg].end.y();
-
-      // Finish this path segment and move to
-      // the next one.
-      traveled -= dToEofS;
-      ++m_seg;
-
-      // In order to prepare for the advance of
-      // the segment, we will move to the start
-      // of the next segment (so the one pointed
-      // by `seg` now).
-      // This should usually correspond to the
-      // end of the previous segment but as it
-      // is not guaranteed, we will ensure it.
-      if (m_seg < ss) {
-        m_cur.x() = m_segments[m_seg].start.x();
-        m_cur.y() = m_segments[m_seg].start.y();
+        tMin = std::max(tMin, std::min(t1, t2));
+        tMax = std::min(tMax, std::max(t1, t2));
+
+        if (tMin > tMax) {
+          return false;
+        }
       }
 
-      // Initialize the distance to the end
-      // of the path segment.
-      dToEofS = utils::d(m_cur, m_segments[m_seg].end);
-    }
+      return true;
+    };
+
+    utils::Point2f s = p;
+
+    for (int id = segment ; id < ss ; ++id) {
+      const utils::Point2f& e = m_segments[id].end;
 
-    // See whether we reached the end of the
-    // path: if this is the case, the previous
-    // algo ensured we were already at the end
-    // of the path so we don't have nothing
-    // else to do.
-    if (m_seg == ss) {
-      return;
+      for (unsigned c = 0u ; c < cells.size() ; ++c) {
+        if (intersects(s, e, cells[c])) {
+          return true;
+        }
+      }
+
+      s = e;
     }
 
-    // Advance on the path of the amount left.
-    m_cur.x() += traveled * m_segments[m_seg].xD;
-    m_cur.y() += traveled * m_segments[m_seg].yD;
+    return false;
   }
 
   bool
@@ -108,7 +109,7 @@ namespace tdef {
     // can correspond to the home position in case
     // no segments are defined.
     utils::Point2f s = m_home;
-    if (m_seg >= 0) {
+    if (!m_segments.empty()) {
       s = m_segments[m_segments.size() - 1].end;
     }
 
@@ -166,11 +167,24 @@ namespace tdef {
     // desired (the A*) as it means that each mob
     // has indeed infinite vision for now but
     // that's it.
-    AStar alg(s, p, frustum);
+    // Paths computed for the same start and end cells
+    // are kept in a cache as long as the blocks of the
+    // world do not change: this is typically the case
+    // for mobs spawned close to each other.
+    PathCacheShPtr cache = frustum->pathCache();
+    unsigned epoch = frustum->obstaclesEpoch();
     std::vector<utils::Point2f> steps;
 
-    if (!alg.findPath(steps, maxDistanceFromStart, allowLog)) {
-      return false;
+    if (cache == nullptr || !cache->get(*frustum, s, p, maxDistanceFromStart, epoch, steps)) {
+      AStar alg(s, p, frustum);
+
+      if (!alg.findPath(steps, maxDistanceFromStart, allowLog)) {
+        return false;
+      }
+
+      if (cache != nullptr) {
+        cache->put(s, p, maxDistanceFromStart, epoch, steps);
+      }
     }
 
     // A path was found, register it.
@@ -181,6 +195,65 @@ namespace tdef {
     return true;
   }
 
+  bool
+  Path::followField(LocatorShPtr frustum,
+                    const FlowField& field,
+                    float maxDistanceFromStart,
+                    bool allowLog)
+  {
+    // Similarly to `generatePathTo` the path starts
+    // from the current end of the path.
+    utils::Point2f s = m_home;
+    if (!m_segments.empty()) {
+      s = m_segments[m_segments.size() - 1].end;
+    }
+
+    std::vector<utils::Point2f> steps;
+    if (!field.trace(s, steps)) {
+      return false;
+    }
+
+    utils::Point2f p = steps.back();
+
+    // In case the straight path to the first cell is
+    // obstructed, go through the center of the cell
+    // containing the starting position as the A* is
+    // doing.
+    if (!frustum->lineOfSight(s, steps.front())) {
+      steps.insert(
+        steps.begin(),
+        utils::Point2f(std::floor(s.x()) + 0.5f, std::floor(s.y()) + 0.5f)
+      );
+    }
+
+    // Remove unnecessary turns from the path.
+    AStar alg(s, p, frustum);
+    alg.smoothPath(steps, allowLog);
+
+    // Make sure that the path does not wander too
+    // far from the starting point.
+    if (maxDistanceFromStart >= 0.0f) {
+      for (unsigned id = 0u ; id < steps.size() ; ++id) {
+        if (utils::d(s, steps[id]) >= maxDistanceFromStart) {
+          if (allowLog) {
+            debug(
+              "Path to portal goes through " + steps[id].toString() +
+              " which is too far from " + s.toString()
+            );
+          }
+
+          return false;
+        }
+      }
+    }
+
+    for (unsigned id = 0u ; id < steps.size() ; ++id) {
+      add(steps[id]);
+    }
+
+    return true;
+  }
+
   std::ostream&
   Path::operator<<(std::ostream& out) const {
     // Save properties in order. The vectors will be
@@ -188,11 +261,6 @@ namespace tdef {
     out << m_home.x() << " ";
     out << m_home.y() << " ";
 
-    out << m_cur.x() << " ";
-    out << m_cur.y() << " ";
-
-    out << m_seg << " ";
-
     out << m_segments.size() << " ";
     for (unsigned id = 0u ; id < m_segments.size() ; ++id) {
       out << m_segments[id].start.x() << " ";
@@ -221,11 +289,6 @@ namespace tdef {
     in >> m_home.x();
     in >> m_home.y();
 
-    in >> m_cur.x();
-    in >> m_cur.y();
-
-    in >> m_seg;
-
     unsigned count;
     in >> count;
     for (unsigned id = 0u ; id < count ; ++id) {
@@ -5,12 +5,16 @@
 # include <memory>
 # include <maths_utils/Point2.hh>
 # include <core_utils/CoreObject.hh>
+# include "WorldUpdate.hh"
 
 namespace tdef {
   // Forward declaration of the `Locator` class.
   class Locator;
   using LocatorShPtr = std::shared_ptr<Locator>;
 
+  // Forward declaration of the `FlowField` class.
+  class FlowField;
+
   namespace path {
 
     /**
@@ -145,11 +149,25 @@ namespace tdef {
       add(const utils::Point2f& p);
 
       /**
-       * @brief - Determine whether the current position on
-       *          the path means that we arrived or not. It
-       *          is only precise if the user actually makes
-       *          the path-follower advance on the path by
-       *          calling `advance`.
+       * @brief - Initialize a cursor at the start of the path.
+       *          The cursor describes the progress of an entity
+       *          following the path: it is not stored here so
+       *          that it can be updated along with the rest of
+       *          the state of the entity.
+       * @param segment - output index of the segment to follow,
+       *                  `-1` in case the path is empty.
+       * @param offset - output distance left to reach the end
+       *                 of the segment.
+       */
+      void
+      begin(int& segment, float& offset) const noexcept;
+
+      /**
+       * @brief - Determine whether the input cursor means that
+       *          we arrived or not.
+       * @param segment - the index of the segment followed.
+       * @param offset - the distance left to reach the end of
+       *                 the segment.
        * @param threshold - define the threshold below which
        *                    the path-follower is considered
        *                    to have arrived.
@@ -157,24 +175,29 @@ namespace tdef {
        *           arrived yet.
        */
       bool
-      enRoute(float threshold) const noexcept;
+      enRoute(int segment, float offset, float threshold) const noexcept;
 
       /**
-       * @brief - The current position on the path given all
-       *          the advancement already made.
-       * @return - the current position on the path.
+       * @brief - Determine whether the remaining part of the path
+       *          (i.e. from the current position to the end) is
+       *          going through any of the input cells.
+       * @param cells - the list of cells to check.
+       * @param p - the current position on the path.
+       * @param segment - the index of the segment followed.
+       * @return - `true` if at least one of the cells is crossed
+       *           by the path.
        */
-      utils::Point2f
-      cur() const noexcept;
+      bool
+      crosses(const std::vector<world::Cell>& cells,
+              const utils::Point2f& p,
+              int segment) const noexcept;
 
       /**
-       * @brief - Used to retrieve the closest target on the
-       *          path: this refers to the endpoint of the
-       *          segment currently followed by the entity.
-       * @return - the next target on the path.
+       * @brief - Used to fetch the segments of the path.
+       * @return - the segments of the path.
        */
-      utils::Point2f
-      currentTarget() const noexcept;
+      const std::vector<path::Segment>&
+      getSegments() const noexcept;
 
       /**
        * @brief - Used to fetch the final target of the path
@@ -193,21 +216,6 @@ namespace tdef {
       const std::vector<utils::Point2f>&
       getPassagePoints() const noexcept;
 
-      /**
-       * @brief - Used to advance on this path assuming the
-       *          path follower is moving at `speed` along
-       *          the path and that `elapsed` seconds have
-       *          passed since the last actualization.
-       * @param speed - the speef of the entity following
-       *                the path.
-       * @param elapsed - the duration elapsed since the
-       *                  last actualization in seconds.
-       * @param threshold - a threshold to consider that a
-       *                    path segment is finished.
-       */
-      void
-      advance(float speed, float elapsed, float threshold);
-
       /**
        * @brief - Used to generate a path to the target specified
        *          by the `x` and `y` coordinates and add needed
@@ -240,6 +248,28 @@ namespace tdef {
                       float maxDistanceFromStart = -1.0f,
                       bool allowLog = false);
 
+      /**
+       * @brief - Similar to `generatePathTo` but uses the flow
+       *          field to reach the closest portal instead of
+       *          running an A* algorithm. The gradient of the
+       *          field is followed from the current end of the
+       *          path and then smoothed.
+       * @param frustum - allowing to detect obstruction when the
+       *                  path is smoothed.
+       * @param field - the flow field to follow.
+       * @param maxDistanceFromStart - the maximum distance to which
+       *                               the path can wander from the
+       *                               starting point.
+       * @param allowLog - `true` if the process should produce
+       *                   logs and information.
+       * @return - `true` if a portal can be reached.
+       */
+      bool
+      followField(LocatorShPtr frustum,
+                  const FlowField& field,
+                  float maxDistanceFromStart = -1.0f,
+                  bool allowLog = false);
+
 
       /**
        * @brief - Performs the serialization of this path to the
@@ -269,22 +299,6 @@ namespace tdef {
        */
       utils::Point2f m_home;
 
-      /**
-       * @brief - The current position on the path. Default is to
-       *          be the home position, unless the journey along
-       *          the path has already started.
-       */
-      utils::Point2f m_cur;
-
-      /**
-       * @brief - The current path segment onto which the `m_cur`
-       *          value is defined.
-       *          Set to `-1` in case no segments are defined or
-       *          to a larger values that `m_segments` in case
-       *          the entirety of the path has been traversed.
-       */
-      int m_seg;
-
       /**
        * @brief - The list of path segments available for this.
        *          path. If none are defined the path will not
@@ -76,12 +76,10 @@ namespace tdef {
   inline
   void
   Path::clear(const utils::Point2f& p) {
-    // Assign home and current position.
+    // Assign home position.
     m_home = p;
-    m_cur = p;
 
     // Reset segments.
-    m_seg = -1;
     m_segments.clear();
 
     // Reset temporary passage points.
@@ -101,11 +99,6 @@ namespace tdef {
     path::Segment s = path::newSegment(p, xD, yD, d);
     m_segments.push_back(s);
     addPassagePoint(s.end);
-
-    // Make the entity on the first segment.
-    if (m_seg < 0) {
-      m_seg = 0;
-    }
   }
 
   inline
@@ -114,17 +107,12 @@ namespace tdef {
     path::Segment se = path::newSegment(s, t);
     m_segments.push_back(se);
     addPassagePoint(se.end);
-
-    // Make the entity on the first segment.
-    if (m_seg < 0) {
-      m_seg = 0;
-    }
   }
 
   inline
   void
   Path::add(const utils::Point2f& p) {
-    if (m_seg < 0) {
+    if (m_segments.empty()) {
       // We want to make sure that we don't
       // register the home position once
       // again.
@@ -138,36 +126,35 @@ namespace tdef {
     }
   }
 
+  inline
+  void
+  Path::begin(int& segment, float& offset) const noexcept {
+    // In case no segments are registered the cursor is
+    // not on the path.
+    if (m_segments.empty()) {
+      segment = -1;
+      offset = 0.0f;
+
+      return;
+    }
+
+    segment = 0;
+    offset = m_segments[0].length();
+  }
+
   inline
   bool
-  Path::enRoute(float threshold) const noexcept {
+  Path::enRoute(int segment, float offset, float threshold) const noexcept {
     // In case the identifier does not describe a
     // valid path segment, assume we did arrive.
     // Similarly if no segments are registered we
     // consider that we already arrived.
     int ss = static_cast<int>(m_segments.size());
-    if (m_seg < 0 || m_seg >= ss) {
+    if (segment < 0 || segment >= ss) {
       return false;
     }
 
-    return (m_seg < ss - 1) || utils::d(m_segments[m_seg].end, m_cur) > threshold;
-  }
-
-  inline
-  utils::Point2f
-  Path::cur() const noexcept {
-    return m_cur;
-  }
-
-  inline
-  utils::Point2f
-  Path::currentTarget() const noexcept {
-    int ss = static_cast<int>(m_segments.size());
-    if (m_seg < 0 || m_seg >= ss) {
-      return utils::Point2f();
-    }
-
-    return m_segments[m_seg].end;
+    return (segment < ss - 1) || offset > threshold;
   }
 
   inline
@@ -186,6 +173,12 @@ namespace tdef {
     return m_cPoints;
   }
 
+  inline
+  const std::vector<path::Segment>&
+  Path::getSegments() const noexcept {
+    return m_segments;
+  }
+
 }
 
 inline
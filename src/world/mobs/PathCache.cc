@@ -0,0 +1,194 @@
+
+# include "PathCache.hh"
+# include <algorithm>
+# include <maths_utils/LocationUtils.hh>
+# include "Locator.hh"
+
+namespace tdef {
+
+  PathCache::PathCache(unsigned capacity) noexcept:
+    utils::CoreObject("cache"),
+
+    m_capacity(std::max(capacity, 1u)),
+    m_epoch(0u),
+
+    m_paths(),
+    m_uses(),
+
+    m_frozen(false),
+    m_lock(),
+    m_additions(),
+
+    m_hits(0u),
+    m_misses(0u)
+  {
+    setService("path");
+  }
+
+  bool
+  PathCache::get(const Locator& loc,
+                 const utils::Point2f& s,
+                 const utils::Point2f& e,
+                 float maxDistanceFromStart,
+                 unsigned epoch,
+                 std::vector<utils::Point2f>& path) noexcept
+  {
+    // The epoch can't be updated while the cache is frozen:
+    // in this case none of the paths are usable.
+    if (m_frozen && epoch != m_epoch) {
+      ++m_misses;
+      return false;
+    }
+
+    if (!m_frozen) {
+      synchronize(epoch);
+    }
+
+    std::unordered_map<Key, Entry, KeyHash>::iterator it = m_paths.find(keyOf(s, e, maxDistanceFromStart));
+    if (it == m_paths.end() || it->second.path.empty()) {
+      ++m_misses;
+      return false;
+    }
+
+    const std::vector<utils::Point2f>& cached = it->second.path;
+
+    // The path was computed from another position in
+    // the same cell: make sure that the first point
+    // can still be reached in a straight line, and
+    // that the path does not go too far from `s`.
+    if (!loc.lineOfSight(s, cached.front())) {
+      ++m_misses;
+      return false;
+    }
+
+    if (maxDistanceFromStart >= 0.0f) {
+      for (unsigned id = 0u ; id < cached.size() ; ++id) {
+        if (utils::d(s, cached[id]) >= maxDistanceFromStart) {
+          ++m_misses;
+          return false;
+        }
+      }
+    }
+
+    path = cached;
+    path.back() = e;
+
+    // Mark the path as recently used.
+    if (!m_frozen) {
+      m_uses.splice(m_uses.begin(), m_uses, it->second.use);
+    }
+    ++m_hits;
+
+    return true;
+  }
+
+  void
+  PathCache::put(const utils::Point2f& s,
+                 const utils::Point2f& e,
+                 float maxDistanceFromStart,
+                 unsigned epoch,
+                 const std::vector<utils::Point2f>& path) noexcept
+  {
+    Key k = keyOf(s, e, maxDistanceFromStart);
+
+    if (m_frozen) {
+      if (epoch == m_epoch) {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_additions.push_back(Addition{k, path});
+      }
+
+      return;
+    }
+
+    synchronize(epoch);
+    insert(k, path);
+  }
+
+  void
+  PathCache::insert(const Key& k,
+                    const std::vector<utils::Point2f>& path) noexcept
+  {
+    std::unordered_map<Key, Entry, KeyHash>::iterator it = m_paths.find(k);
+    if (it != m_paths.end()) {
+      it->second.path = path;
+      m_uses.splice(m_uses.begin(), m_uses, it->second.use);
+
+      return;
+    }
+
+    // Evict the least recently used path if needed.
+    if (m_paths.size() >= m_capacity) {
+      m_paths.erase(m_uses.back());
+      m_uses.pop_back();
+    }
+
+    m_uses.push_front(k);
+    m_paths.emplace(k, Entry{path, m_uses.begin()});
+  }
+
+  void
+  PathCache::freeze(unsigned epoch) noexcept {
+    synchronize(epoch);
+    m_frozen = true;
+  }
+
+  void
+  PathCache::thaw() noexcept {
+    m_frozen = false;
+
+    // Several paths might have been computed for the same
+    // key: the order defined here makes sure that the one
+    // kept does not depend on the scheduling.
+    std::sort(
+      m_additions.begin(),
+      m_additions.end(),
+      [](const Addition& lhs, const Addition& rhs) {
+        if (lhs.key.start != rhs.key.start) {
+          return lhs.key.start < rhs.key.start;
+        }
+        if (lhs.key.end != rhs.key.end) {
+          return lhs.key.end < rhs.key.end;
+        }
+        if (lhs.key.radius != rhs.key.radius) {
+          return lhs.key.radius < rhs.key.radius;
+        }
+
+        return std::lexicographical_compare(
+          lhs.path.begin(),
+          lhs.path.end(),
+          rhs.path.begin(),
+          rhs.path.end(),
+          [](const utils::Point2f& l, const utils::Point2f& r) {
+            return l.x() < r.x() || (l.x() == r.x() && l.y() < r.y());
+          }
+        );
+      }
+    );
+
+    for (unsigned id = 0u ; id < m_additions.size() ; ++id) {
+      insert(m_additions[id].key, m_additions[id].path);
+    }
+
+    m_additions.clear();
+  }
+
+  void
+  PathCache::synchronize(unsigned epoch) noexcept {
+    if (epoch == m_epoch) {
+      return;
+    }
+
+    if (!m_paths.empty()) {
+      debug(
+        "Discarding " + std::to_string(m_paths.size()) + " path(s) from epoch " +
+        std::to_string(m_epoch) + " (hits: " + std::to_string(m_hits.load()) +
+        ", misses: " + std::to_string(m_misses.load()) + ")"
+      );
+    }
+
+    m_paths.clear();
+    m_uses.clear();
+    m_epoch = epoch;
+  }
+
+}
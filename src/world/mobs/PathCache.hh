@@ -0,0 +1,254 @@
+#ifndef    PATH_CACHE_HH
+# define   PATH_CACHE_HH
+
+# include <list>
+# include <vector>
+# include <memory>
+# include <mutex>
+# include <atomic>
+# include <cstdint>
+# include <unordered_map>
+# include <core_utils/CoreObject.hh>
+# include <maths_utils/Point2.hh>
+
+namespace tdef {
+
+  // Forward declaration of the `Locator` class.
+  class Locator;
+
+  class PathCache: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new cache for paths computed by the
+       *          A* algorithm. Paths are keyed by the cells of
+       *          their start and end points along with the
+       *          maximum distance allowed from the start.
+       * @param capacity - the maximum number of paths kept in
+       *                   the cache. When it is full the least
+       *                   recently used path is evicted.
+       */
+      PathCache(unsigned capacity = sk_defaultCapacity) noexcept;
+
+      /**
+       * @brief - Used to fetch a path going from `s` to `e` if
+       *          one has been registered for the same cells in
+       *          the current obstacle epoch. As the path might
+       *          have been computed from a slightly different
+       *          start, we verify that it can be joined from
+       *          `s` and that it does not go too far from it.
+       *          The last point of the path is replaced by the
+       *          exact end point.
+       *          This method can be called concurrently while
+       *          the cache is frozen.
+       * @param loc - the locator describing the world.
+       * @param s - the starting point of the path.
+       * @param e - the end point of the path.
+       * @param maxDistanceFromStart - the maximum distance that
+       *                               the path can go from `s`.
+       * @param epoch - the current obstacle epoch.
+       * @param path - output vector receiving the path if it is
+       *               found in the cache.
+       * @return - `true` if the path could be found.
+       */
+      bool
+      get(const Locator& loc,
+          const utils::Point2f& s,
+          const utils::Point2f& e,
+          float maxDistanceFromStart,
+          unsigned epoch,
+          std::vector<utils::Point2f>& path) noexcept;
+
+      /**
+       * @brief - Register a path going from `s` to `e` computed
+       *          in the specified obstacle epoch. In case the
+       *          cache is frozen the path is only added when it
+       *          is thawed: this method can then be called from
+       *          several threads.
+       * @param s - the starting point of the path.
+       * @param e - the end point of the path.
+       * @param maxDistanceFromStart - the maximum distance that
+       *                               the path can go from `s`.
+       * @param epoch - the obstacle epoch.
+       * @param path - the path to register.
+       */
+      void
+      put(const utils::Point2f& s,
+          const utils::Point2f& e,
+          float maxDistanceFromStart,
+          unsigned epoch,
+          const std::vector<utils::Point2f>& path) noexcept;
+
+      /**
+       * @brief - Prevent the cache from being modified until the
+       *          next call to `thaw`, typically while paths are
+       *          computed concurrently. The cached paths can be
+       *          used but are not marked as recently used and
+       *          new paths are kept aside.
+       * @param epoch - the current obstacle epoch, which should
+       *                not change while the cache is frozen.
+       */
+      void
+      freeze(unsigned epoch) noexcept;
+
+      /**
+       * @brief - Allow modifications of the cache again and add
+       *          the paths registered while it was frozen. They
+       *          are sorted beforehand so that the content of
+       *          the cache does not depend on the order in which
+       *          they were computed.
+       */
+      void
+      thaw() noexcept;
+
+      /**
+       * @brief - Return the number of requests which could be
+       *          answered by the cache.
+       * @return - the number of hits.
+       */
+      unsigned
+      hits() const noexcept;
+
+      /**
+       * @brief - Return the number of requests which could not
+       *          be answered by the cache.
+       * @return - the number of misses.
+       */
+      unsigned
+      misses() const noexcept;
+
+      /**
+       * @brief - Return the number of paths currently stored.
+       * @return - the number of paths in the cache.
+       */
+      std::size_t
+      size() const noexcept;
+
+    private:
+
+      /**
+       * @brief - Convenience structure defining the key of a
+       *          path in the cache.
+       */
+      struct Key {
+        std::uint64_t start;
+        std::uint64_t end;
+        float radius;
+
+        bool
+        operator==(const Key& rhs) const noexcept;
+      };
+
+      /**
+       * @brief - Hash function for the keys of the cache.
+       */
+      struct KeyHash {
+        std::size_t
+        operator()(const Key& k) const noexcept;
+      };
+
+      /**
+       * @brief - Convenience structure defining a path stored
+       *          in the cache. The position of the entry in
+       *          the list of recently used keys is kept so
+       *          that it can be updated when accessed.
+       */
+      struct Entry {
+        std::vector<utils::Point2f> path;
+        std::list<Key>::iterator use;
+      };
+
+      /**
+       * @brief - Convenience structure defining a path which is
+       *          registered while the cache is frozen.
+       */
+      struct Addition {
+        Key key;
+        std::vector<utils::Point2f> path;
+      };
+
+      /**
+       * @brief - Build the key for the path from `s` to `e`.
+       * @param s - the starting point of the path.
+       * @param e - the end point of the path.
+       * @param maxDistanceFromStart - the maximum distance that
+       *                               the path can go from `s`.
+       * @return - the key of the path.
+       */
+      static
+      Key
+      keyOf(const utils::Point2f& s,
+            const utils::Point2f& e,
+            float maxDistanceFromStart) noexcept;
+
+      /**
+       * @brief - Register the path with the specified key in the
+       *          cache, evicting the least recently used path if
+       *          the cache is full.
+       * @param k - the key of the path.
+       * @param path - the path to register.
+       */
+      void
+      insert(const Key& k,
+             const std::vector<utils::Point2f>& path) noexcept;
+
+      /**
+       * @brief - Used to discard all the paths in case they were
+       *          computed in a different epoch than the input
+       *          one.
+       * @param epoch - the current obstacle epoch.
+       */
+      void
+      synchronize(unsigned epoch) noexcept;
+
+    private:
+
+      /**
+       * @brief - The default number of paths kept in the cache.
+       */
+      static constexpr unsigned sk_defaultCapacity = 256u;
+
+      /**
+       * @brief - The maximum number of paths kept in the cache.
+       */
+      unsigned m_capacity;
+
+      /**
+       * @brief - The obstacle epoch in which the paths of the
+       *          cache were computed.
+       */
+      unsigned m_epoch;
+
+      /**
+       * @brief - The paths registered in the cache.
+       */
+      std::unordered_map<Key, Entry, KeyHash> m_paths;
+
+      /**
+       * @brief - The keys of the cache ordered from the most
+       *          recently used to the least recently used.
+       */
+      std::list<Key> m_uses;
+
+      /**
+       * @brief - Whether the cache is currently frozen, and the
+       *          paths registered since it was frozen along with
+       *          a mutex protecting them.
+       */
+      bool m_frozen;
+      std::mutex m_lock;
+      std::vector<Addition> m_additions;
+
+      /**
+       * @brief - Statistics about the usage of the cache.
+       */
+      std::atomic<unsigned> m_hits;
+      std::atomic<unsigned> m_misses;
+  };
+
+  using PathCacheShPtr = std::shared_ptr<PathCache>;
+}
+
+# include "PathCache.hxx"
+
+#endif    /* PATH_CACHE_HH */
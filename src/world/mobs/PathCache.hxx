@@ -0,0 +1,67 @@
+#ifndef    PATH_CACHE_HXX
+# define   PATH_CACHE_HXX
+
+# include "PathCache.hh"
+# include <cmath>
+# include <cstring>
+# include <functional>
+
+namespace tdef {
+
+  inline
+  unsigned
+  PathCache::hits() const noexcept {
+    return m_hits.load();
+  }
+
+  inline
+  unsigned
+  PathCache::misses() const noexcept {
+    return m_misses.load();
+  }
+
+  inline
+  std::size_t
+  PathCache::size() const noexcept {
+    return m_paths.size();
+  }
+
+  inline
+  bool
+  PathCache::Key::operator==(const Key& rhs) const noexcept {
+    return start == rhs.start && end == rhs.end && radius == rhs.radius;
+  }
+
+  inline
+  std::size_t
+  PathCache::KeyHash::operator()(const Key& k) const noexcept {
+    std::uint32_t r;
+    std::memcpy(&r, &k.radius, sizeof(r));
+
+    std::size_t h = std::hash<std::uint64_t>()(k.start);
+    h ^= std::hash<std::uint64_t>()(k.end) + 0x9e3779b9u + (h << 6) + (h >> 2);
+    h ^= std::hash<std::uint32_t>()(r) + 0x9e3779b9u + (h << 6) + (h >> 2);
+
+    return h;
+  }
+
+  inline
+  PathCache::Key
+  PathCache::keyOf(const utils::Point2f& s,
+                   const utils::Point2f& e,
+                   float maxDistanceFromStart) noexcept
+  {
+    auto pack = [](const utils::Point2f& p) {
+      std::int32_t x = static_cast<std::int32_t>(std::floor(p.x()));
+      std::int32_t y = static_cast<std::int32_t>(std::floor(p.y()));
+
+      return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) |
+             static_cast<std::uint64_t>(static_cast<std::uint32_t>(y));
+    };
+
+    return Key{pack(s), pack(e), maxDistanceFromStart};
+  }
+
+}
+
+#endif    /* PATH_CACHE_HXX */
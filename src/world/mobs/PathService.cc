@@ -0,0 +1,139 @@
+
+# include "PathService.hh"
+# include <algorithm>
+# include "Mob.hh"
+# include "Locator.hh"
+# include "Registry.hh"
+# include "JobPool.hh"
+# include "PathCache.hh"
+
+namespace tdef {
+
+  PathService::PathService(unsigned budget) noexcept:
+    utils::CoreObject("service"),
+
+    m_budget(budget),
+
+    m_requests(),
+    m_pending(),
+
+    m_batch(),
+    m_results(),
+
+    m_failures(),
+    m_epoch(0u)
+  {
+    setService("path");
+  }
+
+  bool
+  PathService::request(const world::Handle& mob,
+                       const path::Goal& goal)
+  {
+    Request r{mob, goal};
+
+    if (!m_pending.insert(r).second) {
+      return false;
+    }
+
+    m_requests.push_back(r);
+
+    return true;
+  }
+
+  unsigned
+  PathService::process(const Registry& registry,
+                       LocatorShPtr loc,
+                       JobPool& jobs)
+  {
+    PathCacheShPtr cache = loc->pathCache();
+    unsigned epoch = loc->obstaclesEpoch();
+    unsigned processed = 0u;
+
+    // The unreachable goals are only valid as long as the
+    // layout of the world does not change.
+    if (epoch != m_epoch) {
+      m_failures.clear();
+      m_epoch = epoch;
+    }
+
+    while (!m_requests.empty() && (m_budget == 0u || processed < m_budget)) {
+      unsigned count = m_requests.size();
+      if (m_budget > 0u) {
+        count = std::min(count, m_budget - processed);
+      }
+
+      m_batch.clear();
+      for (unsigned id = 0u ; id < count ; ++id) {
+        m_batch.push_back(m_requests.front());
+        m_pending.erase(m_requests.front());
+        m_requests.pop_front();
+      }
+
+      if (m_results.size() < count) {
+        m_results.resize(count, path::Result{false, world::Handle::invalid(), Path(), 0u});
+      }
+
+      // Compute the paths: the world is not modified while
+      // doing so, only the cache which is frozen to make it
+      // safe to use from several threads.
+      if (cache != nullptr) {
+        cache->freeze(epoch);
+      }
+
+      jobs.run(
+        count,
+        [this, &registry, &loc](unsigned id, unsigned /*thread*/) {
+          path::Result& res = m_results[id];
+          res.found = false;
+          res.target = world::Handle::invalid();
+          res.epoch = m_epoch;
+
+          const Mob* m = registry.get<Mob>(m_batch[id].mob);
+          if (m == nullptr || m->isDeleted()) {
+            return;
+          }
+
+          // No need to search in case the goal is known to
+          // be out of reach.
+          if (m_failures.count(failureOf(m->getPos(), m_batch[id].goal)) > 0u) {
+            return;
+          }
+
+          m->plan(loc, m_batch[id].goal, res);
+        },
+        sk_requestsPerJob
+      );
+
+      if (cache != nullptr) {
+        cache->thaw();
+      }
+
+      // Hand over the results in the order of the requests.
+      for (unsigned id = 0u ; id < count ; ++id) {
+        Mob* m = registry.get<Mob>(m_batch[id].mob);
+        if (m == nullptr || m->isDeleted()) {
+          continue;
+        }
+
+        if (!m_results[id].found) {
+          m_failures.insert(failureOf(m->getPos(), m_batch[id].goal));
+        }
+
+        m->follow(*this, m_batch[id].goal, m_results[id]);
+      }
+
+      processed += count;
+    }
+
+    if (!m_requests.empty()) {
+      verbose(
+        "Processed " + std::to_string(processed) + " path request(s), " +
+        std::to_string(m_requests.size()) + " still pending"
+      );
+    }
+
+    return processed;
+  }
+
+}
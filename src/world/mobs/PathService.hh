@@ -0,0 +1,239 @@
+#ifndef    PATH_SERVICE_HH
+# define   PATH_SERVICE_HH
+
+# include <deque>
+# include <vector>
+# include <memory>
+# include <cstdint>
+# include <unordered_set>
+# include <core_utils/CoreObject.hh>
+# include "Handle.hh"
+# include "Path.hh"
+
+namespace tdef {
+
+  // Forward declaration of the classes used to process
+  // the requests.
+  class Registry;
+  class JobPool;
+
+  namespace path {
+
+    /**
+     * @brief - The kind of target that a mob is looking for
+     *          when requesting a path.
+     */
+    enum class Goal {
+      Portal,
+      Defense
+    };
+
+    /**
+     * @brief - Convenience structure describing the result of
+     *          a path request.
+     */
+    struct Result {
+      // Whether a path to the goal could be found.
+      bool found;
+
+      // The block reached by the path.
+      world::Handle target;
+
+      // The path leading to the target.
+      Path path;
+
+      // The obstacle epoch in which the request was handled.
+      unsigned epoch;
+    };
+
+  }
+
+  class PathService: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new service handling the requests of
+       *          the mobs to find a path. Requests are queued
+       *          and processed in batches at each step of the
+       *          simulation, up to a certain number.
+       * @param budget - the maximum number of requests handled
+       *                 in a single step.
+       */
+      PathService(unsigned budget = sk_defaultBudget) noexcept;
+
+      /**
+       * @brief - Return the maximum number of requests handled
+       *          in a single step.
+       * @return - the budget of the service.
+       */
+      unsigned
+      getBudget() const noexcept;
+
+      /**
+       * @brief - Define a new maximum number of requests to be
+       *          handled in a single step. A value of `0` means
+       *          that there is no limit.
+       * @param budget - the new budget.
+       */
+      void
+      setBudget(unsigned budget) noexcept;
+
+      /**
+       * @brief - Return the number of requests waiting to be
+       *          processed.
+       * @return - the number of pending requests.
+       */
+      unsigned
+      pending() const noexcept;
+
+      /**
+       * @brief - Queue a request for the mob to find a path to
+       *          the specified goal. Nothing happens in case the
+       *          same request is already waiting.
+       * @param mob - the handle of the mob.
+       * @param goal - the kind of target to reach.
+       * @return - `true` if the request was queued.
+       */
+      bool
+      request(const world::Handle& mob,
+              const path::Goal& goal);
+
+      /**
+       * @brief - Process the pending requests in the order they
+       *          were issued, within the limit of the budget.
+       *          The paths are computed in parallel and given
+       *          to the mobs in order once available. Requests
+       *          issued in response to a result are processed
+       *          in the same call as long as the budget allows
+       *          it.
+       *          Paths registered in the cache of the locator
+       *          while computing a batch are only made visible
+       *          to the next batch so that the result does not
+       *          depend on the number of threads.
+       *          The goals which could not be reached from a
+       *          cell are remembered until the layout of the
+       *          world changes: the requests issued from the
+       *          same cell fail right away.
+       * @param registry - used to fetch the mobs.
+       * @param loc - the locator describing the world.
+       * @param jobs - the pool used to compute the paths.
+       * @return - the number of requests processed.
+       */
+      unsigned
+      process(const Registry& registry,
+              LocatorShPtr loc,
+              JobPool& jobs);
+
+      /**
+       * @brief - Discard all the pending requests along with the
+       *          goals known to be unreachable.
+       */
+      void
+      clear() noexcept;
+
+    private:
+
+      /**
+       * @brief - Convenience structure defining a request: the
+       *          mob issuing it and the kind of target.
+       */
+      struct Request {
+        world::Handle mob;
+        path::Goal goal;
+
+        bool
+        operator==(const Request& rhs) const noexcept;
+      };
+
+      /**
+       * @brief - Hash function for the requests.
+       */
+      struct RequestHash {
+        std::size_t
+        operator()(const Request& r) const noexcept;
+      };
+
+      /**
+       * @brief - Convenience structure defining a goal which
+       *          could not be reached from a cell.
+       */
+      struct Failure {
+        std::uint64_t cell;
+        path::Goal goal;
+
+        bool
+        operator==(const Failure& rhs) const noexcept;
+      };
+
+      /**
+       * @brief - Hash function for the failures.
+       */
+      struct FailureHash {
+        std::size_t
+        operator()(const Failure& f) const noexcept;
+      };
+
+      /**
+       * @brief - Build the failure corresponding to the goal of
+       *          the input request not being reachable from the
+       *          specified position.
+       * @param p - the position of the mob.
+       * @param goal - the kind of target.
+       * @return - the failure.
+       */
+      static
+      Failure
+      failureOf(const utils::Point2f& p,
+                const path::Goal& goal) noexcept;
+
+    private:
+
+      /**
+       * @brief - The default number of requests processed in a
+       *          single step.
+       */
+      static constexpr unsigned sk_defaultBudget = 64u;
+
+      /**
+       * @brief - The number of requests processed by each job
+       *          of the pool.
+       */
+      static constexpr unsigned sk_requestsPerJob = 4u;
+
+      /**
+       * @brief - The maximum number of requests processed in a
+       *          single step.
+       */
+      unsigned m_budget;
+
+      /**
+       * @brief - The requests waiting to be processed, in the
+       *          order they were issued, and the same requests
+       *          in a set to detect duplicates.
+       */
+      std::deque<Request> m_requests;
+      std::unordered_set<Request, RequestHash> m_pending;
+
+      /**
+       * @brief - The requests of the batch being processed and
+       *          their results. Kept from one step to the next
+       *          to reuse the memory.
+       */
+      std::vector<Request> m_batch;
+      std::vector<path::Result> m_results;
+
+      /**
+       * @brief - The goals known to be unreachable from a cell
+       *          and the obstacle epoch in which they were found
+       *          to be so.
+       */
+      std::unordered_set<Failure, FailureHash> m_failures;
+      unsigned m_epoch;
+  };
+
+  using PathServiceShPtr = std::shared_ptr<PathService>;
+}
+
+# include "PathService.hxx"
+
+#endif    /* PATH_SERVICE_HH */
@@ -0,0 +1,83 @@
+#ifndef    PATH_SERVICE_HXX
+# define   PATH_SERVICE_HXX
+
+# include "PathService.hh"
+# include <cmath>
+# include <functional>
+
+namespace tdef {
+
+  inline
+  unsigned
+  PathService::getBudget() const noexcept {
+    return m_budget;
+  }
+
+  inline
+  void
+  PathService::setBudget(unsigned budget) noexcept {
+    m_budget = budget;
+  }
+
+  inline
+  unsigned
+  PathService::pending() const noexcept {
+    return m_requests.size();
+  }
+
+  inline
+  void
+  PathService::clear() noexcept {
+    m_requests.clear();
+    m_pending.clear();
+    m_failures.clear();
+  }
+
+  inline
+  bool
+  PathService::Request::operator==(const Request& rhs) const noexcept {
+    return mob == rhs.mob && goal == rhs.goal;
+  }
+
+  inline
+  std::size_t
+  PathService::RequestHash::operator()(const Request& r) const noexcept {
+    std::size_t h = std::hash<unsigned>()(r.mob.index);
+    h ^= std::hash<unsigned>()(r.mob.generation) + 0x9e3779b9u + (h << 6) + (h >> 2);
+    h ^= std::hash<int>()(static_cast<int>(r.goal)) + 0x9e3779b9u + (h << 6) + (h >> 2);
+
+    return h;
+  }
+
+  inline
+  bool
+  PathService::Failure::operator==(const Failure& rhs) const noexcept {
+    return cell == rhs.cell && goal == rhs.goal;
+  }
+
+  inline
+  std::size_t
+  PathService::FailureHash::operator()(const Failure& f) const noexcept {
+    std::size_t h = std::hash<std::uint64_t>()(f.cell);
+    h ^= std::hash<int>()(static_cast<int>(f.goal)) + 0x9e3779b9u + (h << 6) + (h >> 2);
+
+    return h;
+  }
+
+  inline
+  PathService::Failure
+  PathService::failureOf(const utils::Point2f& p,
+                         const path::Goal& goal) noexcept
+  {
+    std::int32_t x = static_cast<std::int32_t>(std::floor(p.x()));
+    std::int32_t y = static_cast<std::int32_t>(std::floor(p.y()));
+
+    std::uint64_t cell = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) << 32) |
+                         static_cast<std::uint64_t>(static_cast<std::uint32_t>(y));
+
+    return Failure{cell, goal};
+  }
+
+}
+
+#endif    /* PATH_SERVICE_HXX */
@@ -4,12 +4,13 @@
 # include <maths_utils/ComparisonUtils.hh>
 # include "Locator.hh"
 # include "Tower.hh"
+# include "Registry.hh"
 
 namespace tdef {
 
   Projectile::Projectile(const PProps& props,
-                         Tower* tower,
-                         MobShPtr mob):
+                         const world::Handle& tower,
+                         const world::Handle& mob):
     WorldElement(props, "projectile"),
 
     m_target(mob),
@@ -36,12 +37,51 @@ namespace tdef {
     setService("projectile");
   }
 
+  void
+  Projectile::assign(const PProps& props,
+                     const world::Handle& tower,
+                     const world::Handle& mob) noexcept
+  {
+    WorldElement::assign(props);
+
+    m_target = mob;
+    m_dest = utils::Point2f();
+    m_tower = tower;
+
+    m_speed = props.speed;
+
+    m_damage = props.damage;
+    m_aoeRadius = props.aoeRadius;
+    m_accuracy = props.accuracy;
+
+    m_freezePercent = props.freezePercent;
+    m_freezeSpeed = props.freezeSpeed;
+
+    m_stunProb = utils::clamp(props.stunProb, 0.0f, 1.0f);
+    m_critProb = utils::clamp(props.critProb, 0.0f, 1.0f);
+    m_critMultiplier = props.critMultiplier;
+
+    m_freezeDuration = props.freezeDuration;
+    m_stunDuration = props.stunDuration;
+    m_poisonDuration = props.poisonDuration;
+  }
+
+  void
+  Projectile::recycle() noexcept {
+    m_target = world::Handle::invalid();
+    m_tower = world::Handle::invalid();
+  }
+
   void
   Projectile::step(StepInfo& info) {
+    // Keep track of the position before moving.
+    m_prevPos = m_pos;
+
     // Check whether the projectile has arrived to its target.
     // Note that we will try to reach the target even in case
     // it is dead so that we can handle the aoe damage.
-    updateTrackedDestination();
+    Mob* target = info.registry.get<Mob>(m_target);
+    updateTrackedDestination(target);
     float dst = utils::d(getPos(), m_dest);
 
     if (dst > sk_arrived) {
@@ -69,26 +109,6 @@ namespace tdef {
       return;
     }
 
-    // Get all the mobs that are within the `aoe` radius
-    // at the moment of the hit.
-    std::vector<MobShPtr> wounded;
-    if (m_aoeRadius > 0.0f) {
-      // Note that we don't explicitely append the target
-      // to the wounded list as we assume it will also
-      // be found by this function anyway.
-      wounded = info.frustum->getVisibleMobs(m_dest, m_aoeRadius, nullptr);
-    }
-    else {
-      // In case there's no aoe, at least consider the
-      // target if it is defined.
-      if (m_target == nullptr) {
-        // No target and no aoe, nothing to do.
-        return;
-      }
-
-      wounded.push_back(m_target);
-    }
-
     // Give a chance to critical hits.
     float damage = m_damage;
     if (m_critProb > 0.0f && info.rng.rndFloat(0.0f, 1.0f) < m_critProb) {
@@ -109,17 +129,17 @@ namespace tdef {
     d.sDuration = m_stunDuration;
     d.pDuration = m_poisonDuration;
 
-    for (unsigned id = 0; id < wounded.size() ; ++id) {
+    auto wound = [this, &info, &d, damage, target](Mob& m) {
       // The damage depends on the distance to the
       // center of the projectile. For the case of
       // the target we will apply the maximum dmg
       // and for the other mob we will apply damage
       // based on the distance.
-      if (wounded[id] == m_target) {
+      if (&m == target) {
         d.hit = damage;
       }
       else {
-        float far = utils::d(m_dest, wounded[id]->getPos());
+        float far = utils::d(m_dest, m.getPos());
         d.hit = std::max(0.0f, damage * far / m_aoeRadius);
       }
 
@@ -127,37 +147,54 @@ namespace tdef {
       // process it. This can happen as we allow a
       // projectile to keep targetting a dead target
       // for the aoe.
-      if (wounded[id]->isDeleted()) {
-        debug("Mob " + mobs::toString(wounded[id]->getType()) + " is already deleted");
-        continue;
+      if (m.isDeleted()) {
+        debug("Mob " + mobs::toString(m.getType()) + " is already deleted");
+        return true;
       }
 
-      bool alive = wounded[id]->hit(info, d);
+      bool alive = m.hit(info, d);
       if (!alive) {
         debug(
-          "Killed " + mobs::toString(wounded[id]->getType()) +
-          " at " + wounded[id]->getPos().toString() +
-          ", earned " + std::to_string(wounded[id]->getBounty()) + " coin(s)" +
-          " (deleted: " + std::to_string(wounded[id]->isDead()) + ")"
+          "Killed " + mobs::toString(m.getType()) +
+          " at " + m.getPos().toString() +
+          ", earned " + std::to_string(m.getBounty()) + " coin(s)" +
+          " (deleted: " + std::to_string(m.isDead()) + ")"
         );
 
-        info.gold += wounded[id]->getBounty();
+        info.gold += m.getBounty();
 
         // Propagate the experience gain.
-        if (m_tower != nullptr && !m_tower->isDeleted()) {
-          m_tower->gainExp(wounded[id]->getExpReward());
+        Tower* tower = info.registry.get<Tower>(m_tower);
+        if (tower != nullptr && !tower->isDeleted()) {
+          tower->gainExp(m.getExpReward());
         }
 
-        continue;
+        return true;
       }
 
       debug(
-        "Damaging " + mobs::toString(wounded[id]->getType()) +
-        " at " + std::to_string(utils::d(m_dest, wounded[id]->getPos())) +
-        " (target: " + std::to_string(wounded[id] == m_target) + ")" +
+        "Damaging " + mobs::toString(m.getType()) +
+        " at " + std::to_string(utils::d(m_dest, m.getPos())) +
+        " (target: " + std::to_string(&m == target) + ")" +
         " with " + std::to_string(d.hit) + " damage" +
-        ", health: " + std::to_string(wounded[id]->getHealth())
+        ", health: " + std::to_string(m.getHealth())
       );
+
+      return true;
+    };
+
+    // Hit all the mobs that are within the `aoe` radius
+    // at the moment of the hit. They are visited in place
+    // so that no list needs to be built.
+    if (m_aoeRadius > 0.0f) {
+      // Note that we don't explicitely hit the target as
+      // we assume it will also be found by the query.
+      info.frustum->forEachMobInRadius(m_dest, m_aoeRadius, nullptr, wound);
+    }
+    else if (target != nullptr) {
+      // In case there's no aoe, at least consider the
+      // target if it is still part of the world.
+      wound(*target);
     }
 
     // The projectile is now obsolete.
@@ -9,9 +9,6 @@
 
 namespace tdef {
 
-  // Forward declaration of the Tower class.
-  class Tower;
-
   class Projectile: public WorldElement {
     public:
 
@@ -88,8 +85,29 @@ namespace tdef {
        * @param mob - the mob which is targeted by this projectile.
        */
       Projectile(const PProps& props,
-                 Tower* owner,
-                 MobShPtr mob);
+                 const world::Handle& owner,
+                 const world::Handle& mob);
+
+      /**
+       * @brief - Reinitialize this projectile with the input
+       *          properties as if it was just created. This is
+       *          used to reuse the projectiles removed from the
+       *          world.
+       * @param props - the properties defining this projectile.
+       * @param owner - the tower that fired this projectile.
+       * @param mob - the mob which is targeted by this projectile.
+       */
+      void
+      assign(const PProps& props,
+             const world::Handle& owner,
+             const world::Handle& mob) noexcept;
+
+      /**
+       * @brief - Reset the references held by this projectile
+       *          while it is waiting to be reused.
+       */
+      void
+      recycle() noexcept;
 
       std::ostream&
       operator<<(std::ostream& out) const override;
@@ -113,7 +131,7 @@ namespace tdef {
       destroy(StepInfo& info) override;
 
       void
-      worldUpdate(LocatorShPtr loc) override;
+      worldUpdate(LocatorShPtr loc, const world::Update& update) override;
 
     private:
 
@@ -122,9 +140,11 @@ namespace tdef {
        *          projectile from the target if any is defined.
        *          In case none is defined the destination is left
        *          unchanged.
+       * @param target - the target of the projectile or `null`
+       *                 if it is not available anymore.
        */
       void
-      updateTrackedDestination();
+      updateTrackedDestination(const Mob* target);
 
     private:
 
@@ -138,9 +158,10 @@ namespace tdef {
        * @brief - The target for this projectile. We will
        *          perform some position tracking so that
        *          the projectile follows its target until
-       *          it hits it.
+       *          it hits it or until it is removed from
+       *          the world.
        */
-      MobShPtr m_target;
+      world::Handle m_target;
 
       /**
        * @brief - The position followed by this projectile.
@@ -156,9 +177,10 @@ namespace tdef {
        * @brief - The parent tower of this projectile: it
        *          corresponds to the tower that fired the
        *          projectile and is used to propagate any
-       *          experience gain to it.
+       *          experience gain to it. It resolves to
+       *          `null` in case the tower was sold.
        */
-      Tower* m_tower;
+      world::Handle m_tower;
 
       /**
        * @brief - The travelling speed for this projectile.
@@ -39,21 +39,15 @@ namespace tdef {
   Projectile::operator<<(std::ostream& out) const {
     WorldElement::operator<<(out);
 
-    // Only save the destination and not the target:
-    // this will make the project only reach the last
-    // position of the target when it is restored but
-    // it is enough for our purposes.
+    // The target and the tower are saved as handles:
+    // the registry of the world restores the elements
+    // with the same handles so they are still valid
+    // when the projectile is loaded. The destination
+    // is kept in case the target is already gone.
+    out << m_target;
     out << m_dest.x() << " " << m_dest.y() << " ";
+    out << m_tower;
 
-    // We won't save the tower to the file: indeed it
-    // would require to be able to then relink in some
-    // way the re-loaded tower to this projectile. As
-    // of now we don't really have a way to do it. Not
-    // doing it means not being able to credit some XP
-    // to the tower if the projectile kills some mobs.
-    // We consider that it is a small price to pay for
-    // the convenience to not bother relinking towers
-    // and projectiles.
     out << m_speed << " ";
     out << m_damage << " ";
     out << m_aoeRadius << " ";
@@ -77,16 +71,11 @@ namespace tdef {
   Projectile::operator>>(std::istream& in) {
     WorldElement::operator>>(in);
 
-    // Restore only the destination as the target
-    // has not been saved.
-    m_target = nullptr;
+    in >> m_target;
     in >> m_dest.x();
     in >> m_dest.y();
+    in >> m_tower;
 
-    // As explained in the serialization operation
-    // we don't save the attached tower: so we will
-    // just assign a null tower.
-    m_tower = nullptr;
     in >> m_speed;
     in >> m_damage;
     in >> m_aoeRadius;
@@ -135,17 +124,17 @@ namespace tdef {
 
   inline
   void
-  Projectile::worldUpdate(LocatorShPtr /*loc*/) {
+  Projectile::worldUpdate(LocatorShPtr /*loc*/, const world::Update& /*update*/) {
     // Nothing to do.
   }
 
   inline
   void
-  Projectile::updateTrackedDestination() {
+  Projectile::updateTrackedDestination(const Mob* target) {
     // Update the destination from the position of the
     // target if any is dedined.
-    if (m_target != nullptr) {
-      m_dest = m_target->getPos();
+    if (target != nullptr) {
+      m_dest = target->getPos();
     }
   }
 
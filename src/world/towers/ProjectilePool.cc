@@ -0,0 +1,67 @@
+
+# include "ProjectilePool.hh"
+
+namespace tdef {
+
+  ProjectilePool::ProjectilePool() noexcept:
+    utils::CoreObject("pool"),
+
+    m_spawned(),
+    m_free(),
+
+    m_created(0ul),
+    m_reused(0ul)
+  {
+    setService("projectiles");
+  }
+
+  Projectile&
+  ProjectilePool::spawn() {
+    if (m_free.empty()) {
+      m_spawned.push_back(
+        std::make_shared<Projectile>(
+          Projectile::newProps(utils::Point2f()),
+          world::Handle::invalid(),
+          world::Handle::invalid()
+        )
+      );
+      ++m_created;
+    }
+    else {
+      m_spawned.push_back(m_free.back());
+      m_free.pop_back();
+      ++m_reused;
+    }
+
+    return *m_spawned.back();
+  }
+
+  unsigned
+  ProjectilePool::flush(std::vector<ProjectileShPtr>& out) {
+    unsigned count = m_spawned.size();
+
+    out.insert(out.end(), m_spawned.begin(), m_spawned.end());
+    m_spawned.clear();
+
+    return count;
+  }
+
+  void
+  ProjectilePool::release(const ProjectileShPtr& p) {
+    // Projectiles still referenced elsewhere can't be
+    // reused safely.
+    if (p == nullptr || p.use_count() > 1) {
+      return;
+    }
+
+    p->recycle();
+    m_free.push_back(p);
+  }
+
+  void
+  ProjectilePool::clear() noexcept {
+    m_spawned.clear();
+    m_free.clear();
+  }
+
+}
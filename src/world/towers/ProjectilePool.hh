@@ -0,0 +1,108 @@
+#ifndef    PROJECTILE_POOL_HH
+# define   PROJECTILE_POOL_HH
+
+# include <vector>
+# include <memory>
+# include <core_utils/CoreObject.hh>
+# include "Projectile.hh"
+
+namespace tdef {
+
+  class ProjectilePool: public utils::CoreObject {
+    public:
+
+      /**
+       * @brief - Create a new empty pool of projectiles. The
+       *          projectiles removed from the world are kept
+       *          in the pool and reused for the next shots so
+       *          that firing does not allocate memory once the
+       *          pool reached its steady state.
+       */
+      ProjectilePool() noexcept;
+
+      /**
+       * @brief - Return the number of projectiles that had to
+       *          be created because none was available.
+       * @return - the number of projectiles created.
+       */
+      unsigned long
+      created() const noexcept;
+
+      /**
+       * @brief - Return the number of projectiles that were
+       *          obtained by reusing a released one.
+       * @return - the number of projectiles reused.
+       */
+      unsigned long
+      reused() const noexcept;
+
+      /**
+       * @brief - Return the number of projectiles currently
+       *          available for reuse.
+       * @return - the size of the free list.
+       */
+      unsigned
+      available() const noexcept;
+
+      /**
+       * @brief - Return a projectile to use for a new shot. It
+       *          is registered as spawned and will be handed to
+       *          the world with the next `flush`. The caller is
+       *          responsible for assigning its properties.
+       * @return - the projectile to initialize.
+       */
+      Projectile&
+      spawn();
+
+      /**
+       * @brief - Append the projectiles spawned since the last
+       *          call to the input list.
+       * @param out - the list to append the projectiles to.
+       * @return - the number of projectiles appended.
+       */
+      unsigned
+      flush(std::vector<ProjectileShPtr>& out);
+
+      /**
+       * @brief - Give back a projectile removed from the world.
+       *          It is only reused in case no one else holds a
+       *          reference to it.
+       * @param p - the projectile to release.
+       */
+      void
+      release(const ProjectileShPtr& p);
+
+      /**
+       * @brief - Discard the projectiles spawned and the ones
+       *          available for reuse. The counters are kept.
+       */
+      void
+      clear() noexcept;
+
+    private:
+
+      /**
+       * @brief - The projectiles spawned and not yet handed to
+       *          the world.
+       */
+      std::vector<ProjectileShPtr> m_spawned;
+
+      /**
+       * @brief - The projectiles available for reuse.
+       */
+      std::vector<ProjectileShPtr> m_free;
+
+      /**
+       * @brief - The number of projectiles created and reused
+       *          since the creation of the pool.
+       */
+      unsigned long m_created;
+      unsigned long m_reused;
+  };
+
+  using ProjectilePoolShPtr = std::shared_ptr<ProjectilePool>;
+}
+
+# include "ProjectilePool.hxx"
+
+#endif    /* PROJECTILE_POOL_HH */
@@ -0,0 +1,28 @@
+#ifndef    PROJECTILE_POOL_HXX
+# define   PROJECTILE_POOL_HXX
+
+# include "ProjectilePool.hh"
+
+namespace tdef {
+
+  inline
+  unsigned long
+  ProjectilePool::created() const noexcept {
+    return m_created;
+  }
+
+  inline
+  unsigned long
+  ProjectilePool::reused() const noexcept {
+    return m_reused;
+  }
+
+  inline
+  unsigned
+  ProjectilePool::available() const noexcept {
+    return m_free.size();
+  }
+
+}
+
+#endif    /* PROJECTILE_POOL_HXX */
@@ -4,9 +4,11 @@
 # include <maths_utils/ComparisonUtils.hh>
 # include "Mob.hh"
 # include "Locator.hh"
+# include "Registry.hh"
 # include "Projectile.hh"
 # include "TowerData.hh"
 # include "TowerFactory.hh"
+# include "TowerTraits.hh"
 
 namespace {
 
@@ -55,7 +57,7 @@ namespace {
 namespace tdef {
 
   Tower::Tower(const TProps& props):
-    Block(props, towers::toString(props.type)),
+    Block(props, world::BlockType::Tower, towers::toString(props.type)),
 
     m_type(props.type),
     m_upgrades(),
@@ -81,17 +83,27 @@ namespace tdef {
         props.aimSpeed,
         props.acceleration,
         false,
-        utils::now(),
+        utils::TimeStamp(),
         0.0f,
-        utils::now()
+        utils::TimeStamp()
       }
     ),
 
     m_attack(fromProps(props)),
-    m_processes(towers::generateData(m_type)),
+    m_stats(),
+    m_coverage(),
 
     // No targets at first.
-    m_targets()
+    m_targets(),
+    m_acquisition(
+      AcquisitionData{
+        false,
+        false,
+        std::vector<world::Handle>(),
+        0.0f,
+        false
+      }
+    )
   {
     setService("tower");
 
@@ -103,6 +115,8 @@ namespace tdef {
 
       m_upgrades.push_back(ud);
     }
+
+    refreshStats();
   }
 
   float
@@ -132,7 +146,11 @@ namespace tdef {
     m_exp.exp += exp;
 
     // And update the level.
-    m_exp.level = levelFromExperience(m_exp.exp);
+    int level = levelFromExperience(m_exp.exp);
+    if (level != m_exp.level) {
+      m_exp.level = level;
+      refreshStats();
+    }
 
     verbose(
       "Tower gained " + std::to_string(exp) +
@@ -166,6 +184,48 @@ namespace tdef {
     // Handle the upgrade: this basically consists in
     // increasing the level of the property by `1`.
     m_upgrades[id].level = level;
+    refreshStats();
+  }
+
+  void
+  Tower::refreshStats() noexcept {
+    m_stats.refill = queryUpgradable(m_energyRefill, towers::Upgrade::AttackSpeed);
+    m_stats.minRange = queryUpgradable(m_minRange, towers::Upgrade::Range);
+    m_stats.maxRange = queryUpgradable(m_maxRange, towers::Upgrade::Range);
+    // No upgrade related to the aoe radius.
+    m_stats.aoeRadius = m_aoeRadius(0, m_exp.level);
+    m_stats.rotationSpeed = queryUpgradable(m_rotationSpeed, towers::Upgrade::RotationSpeed);
+
+    // No upgrade related to the shooting angle.
+    m_stats.shootAngle = m_shooting.shootAngle(0, m_exp.level);
+    m_stats.projectileSpeed = queryUpgradable(m_shooting.projectileSpeed, towers::Upgrade::ProjectileSpeed);
+    m_stats.aimSpeed = queryUpgradable(m_shooting.aimSpeed, towers::Upgrade::AimSpeed);
+
+    m_stats.damage = queryUpgradable(m_attack.damage, towers::Upgrade::Damage);
+    m_stats.accuracy = queryUpgradable(m_attack.accuracy, towers::Upgrade::Accuracy);
+    m_stats.speed = queryUpgradable(m_attack.speed, towers::Upgrade::FreezingPower);
+    m_stats.slowdown = queryUpgradable(m_attack.slowdown, towers::Upgrade::FreezingSpeed);
+    m_stats.stunProb = queryUpgradable(m_attack.stunProb, towers::Upgrade::StunChance);
+    // No upgrade type for crit hits.
+    m_stats.critProb = m_attack.critProb(0, m_exp.level);
+    m_stats.critMultiplier = m_attack.critMultiplier(0, m_exp.level);
+
+    // No upgrade related to freeze and poison durations.
+    m_stats.fDuration = m_attack.fDuration(0, m_exp.level);
+    m_stats.sDuration = queryUpgradable(m_attack.sDuration, towers::Upgrade::StunDuration);
+    m_stats.pDuration = m_attack.pDuration(0, m_exp.level);
+
+    // Convert durations from raw milliseconds to a
+    // usable time data.
+    m_stats.freeze = utils::toMilliseconds(static_cast<int>(std::round(m_stats.fDuration)));
+    m_stats.stun = utils::toMilliseconds(static_cast<int>(std::round(m_stats.sDuration)));
+    m_stats.poison = utils::toMilliseconds(static_cast<int>(std::round(m_stats.pDuration)));
+
+    m_stats.aim = aimDuration(m_stats.aimSpeed);
+
+    // The target picking does not account for the minimum
+    // range so the coverage spans the whole disk.
+    Locator::coverage(m_pos, m_stats.maxRange, m_coverage);
   }
 
   std::istream&
@@ -217,18 +277,19 @@ namespace tdef {
     m_shooting.aimSpeed = pp.aimSpeed;
     m_shooting.acceleration = pp.acceleration;
     m_shooting.aiming = false;
-    m_shooting.aimStart = utils::now();
+    m_shooting.aimStart = utils::TimeStamp();
     m_shooting.aimingCone = init_aiming_cone;
-    m_shooting.pauseTime = utils::now();
+    m_shooting.pauseTime = utils::TimeStamp();
 
     m_attack = fromProps(pp);
+    refreshStats();
 
-    m_processes = towers::generateData(m_type);
     // As discussed in the serialization function we won't
     // restore targets of this tower: we assume that the
     // application of the tower's behavior should result in
     // picking the same targets.
     m_targets.clear();
+    m_acquisition.prepared = false;
 
     verbose("Restored tower at " + m_pos.toString());
 
@@ -237,17 +298,75 @@ namespace tdef {
 
   void
   Tower::step(StepInfo& info) {
-    // Refilll the energy.
-    m_energy = std::min(m_energy + info.elapsed * getEnergyRefill(), m_maxEnergy);
+    towers::dispatch(
+      m_type,
+      [this, &info](auto traits) {
+        stepAs<decltype(traits)>(info);
+      }
+    );
+  }
+
+  void
+  Tower::prepare(const StepInfo& info) {
+    towers::dispatch(
+      m_type,
+      [this, &info](auto traits) {
+        prepareAs<decltype(traits)>(info);
+      }
+    );
+  }
+
+  void
+  Tower::prepareBatch(const towers::Type& type,
+                      Tower* const* batch,
+                      unsigned count,
+                      const StepInfo& info)
+  {
+    towers::dispatch(
+      type,
+      [batch, count, &info](auto traits) {
+        for (unsigned id = 0u ; id < count ; ++id) {
+          batch[id]->prepareAs<decltype(traits)>(info);
+        }
+      }
+    );
+  }
+
+  template <typename Traits>
+  void
+  Tower::stepAs(StepInfo& info) {
+    // Acquire the targets in case it was not done yet.
+    if (!m_acquisition.prepared) {
+      prepareAs<Traits>(info);
+    }
+    m_acquisition.prepared = false;
+
+    // The targets kept from the previous step might have
+    // been killed by another tower since the acquisition:
+    // in this case we replay it so that the result is the
+    // same as if the acquisition happened right now.
+    bool killed = false;
+    for (unsigned id = 0u ; id < m_targets.size() && !m_acquisition.targets.empty() && !killed ; ++id) {
+      Mob* m = info.registry.get<Mob>(m_targets[id]);
+      killed = (m == nullptr || m->isDead() || m->isDeleted());
+    }
+
+    if (killed) {
+      m_targets = m_acquisition.targets;
+      m_orientation = m_acquisition.orientation;
+      m_shooting.aiming = m_acquisition.aiming;
 
-    // Pick and align with the target.
-    if (!pickAndAlignWithTarget(info) || m_targets.empty()) {
+      m_acquisition.aligned = pickAndAlignWithTarget<Traits>(info);
+    }
+
+    // Check whether we are aligned with the target.
+    if (!m_acquisition.aligned || m_targets.empty()) {
       // Can't do anything: we didn't find a
       // target or we are not aligned with it
       // yet. The tower is not aiming anymore,
       // so reset the props.
       m_shooting.aiming = false;
-      if (!hasInfiniteAimingSpeed(getAimingSpeed())) {
+      if constexpr (!Traits::instantAim) {
         m_shooting.aimingCone = init_aiming_cone;
       }
 
@@ -263,7 +382,7 @@ namespace tdef {
     // Determine whether the aiming period is
     // over and adapt the aiming cone to show
     // the current progress.
-    utils::Duration d = aimDuration(getAimingSpeed());
+    const utils::Duration& d = m_stats.aim;
     if (m_shooting.aimStart + d > info.moment) {
       float e = utils::toMilliseconds(info.moment - m_shooting.aimStart);
       float t = utils::toMilliseconds(d);
@@ -280,13 +399,16 @@ namespace tdef {
 
     // Reset the aiming process as we fired a shot.
     m_shooting.aimStart = info.moment;
-    if (!hasInfiniteAimingSpeed(getAimingSpeed())) {
+    if constexpr (!Traits::instantAim) {
       m_shooting.aimingCone = init_aiming_cone;
     }
 
     // Fire a shot at each target.
     for (unsigned id = 0u ; id < m_targets.size() ; ++id) {
-      MobShPtr m = m_targets[id];
+      Mob* m = info.registry.get<Mob>(m_targets[id]);
+      if (m == nullptr) {
+        continue;
+      }
 
       if (getAttack() > 0.0f) {
         verbose(
@@ -305,7 +427,7 @@ namespace tdef {
       // is not already dead but we consider that we do
       // attack it even if it's dead.
       m_energy -= m_attackCost;
-      if (m->isDead() || m->isDeleted() || attack(info, m)) {
+      if (m->isDead() || m->isDeleted() || attack<Traits>(info, *m)) {
         continue;
       }
 
@@ -331,8 +453,9 @@ namespace tdef {
         std::remove_if(
           m_targets.begin(),
           m_targets.end(),
-          [](const MobShPtr m) -> bool {
-            return m->isDead() || m->isDeleted();
+          [&info](const world::Handle& h) -> bool {
+            Mob* m = info.registry.get<Mob>(h);
+            return m == nullptr || m->isDead() || m->isDeleted();
           }
         ),
         m_targets.end()
@@ -340,6 +463,34 @@ namespace tdef {
     }
   }
 
+  template <typename Traits>
+  void
+  Tower::prepareAs(const StepInfo& info) {
+    // Refilll the energy.
+    m_energy = std::min(m_energy + info.elapsed * getEnergyRefill(), m_maxEnergy);
+
+    // Keep track of the state before the acquisition so
+    // that it can be replayed if needed.
+    m_acquisition.targets = m_targets;
+    m_acquisition.orientation = m_orientation;
+    m_acquisition.aiming = m_shooting.aiming;
+
+    // In case the tower has no targets and no mob lies
+    // in the cells it covers the picking can't find one:
+    // the tower sleeps and only refills its energy. It
+    // ends up in the same state as after a failed pick.
+    if (m_targets.empty() && !info.frustum->occupied(m_coverage)) {
+      m_shooting.aiming = false;
+      m_acquisition.aligned = false;
+    }
+    else {
+      // Pick and align with the target.
+      m_acquisition.aligned = pickAndAlignWithTarget<Traits>(info);
+    }
+
+    m_acquisition.prepared = true;
+  }
+
   void
   Tower::pause(const utils::TimeStamp& t) {
     // Similarly to what happen for `Mob`, the goal
@@ -363,8 +514,9 @@ namespace tdef {
     m_shooting.aimStart = t - e;
   }
 
+  template <typename Traits>
   bool
-  Tower::pickAndAlignWithTarget(StepInfo& info) {
+  Tower::pickAndAlignWithTarget(const StepInfo& info) {
     // Check whether a target is already defined.
     // If this is the case we will make sure that
     // the distance is still less than the range
@@ -372,11 +524,18 @@ namespace tdef {
     // This process applies to all the targets
     // selected so far.
     if (!m_targets.empty()) {
-      std::vector<MobShPtr>::iterator toRm;
+      std::vector<world::Handle>::iterator toRm;
       toRm = std::remove_if(
         m_targets.begin(),
         m_targets.end(),
-        [this](const MobShPtr m) -> bool {
+        [this, &info](const world::Handle& h) -> bool {
+          // In case the target has been removed from
+          // the world we will try to find a new one.
+          Mob* m = info.registry.get<Mob>(h);
+          if (m == nullptr) {
+            return true;
+          }
+
           // In case the target is already dead we
           // will try to find a new one.
           if (m->isDead()) {
@@ -393,8 +552,7 @@ namespace tdef {
           // min range or farther than the max range
           // we will try to find a new one.
           float d = utils::d(m->getPos(), getPos());
-          if (d < m_minRange(fetchUpgradeLevel(towers::Upgrade::Range), m_exp.level) ||
-              d > m_maxRange(fetchUpgradeLevel(towers::Upgrade::Range), m_exp.level))
+          if (d < m_stats.minRange || d > m_stats.maxRange)
           {
             return true;
           }
@@ -421,11 +579,16 @@ namespace tdef {
       // Find the closest mob.
       towers::PickData pd;
       pd.pos = m_pos;
-      pd.minRange = queryUpgradable(m_minRange, towers::Upgrade::Range);
-      pd.maxRange = queryUpgradable(m_maxRange, towers::Upgrade::Range);
+      pd.minRange = m_stats.minRange;
+      pd.maxRange = m_stats.maxRange;
       pd.mode = m_targetMode;
 
-      m_targets = m_processes.pickMob(info, pd);
+      if constexpr (Traits::multiTarget) {
+        towers::multipleTargetPicking(info, pd, m_targets);
+      }
+      else {
+        towers::basicTargetPicking(info, pd, m_targets);
+      }
 
       if (m_targets.empty()) {
         // No mobs are visible, nothing to do.
@@ -441,7 +604,10 @@ namespace tdef {
     // target.
     // We will pick the first element of the targets'
     // list to perform the aiming.
-    MobShPtr tgt = m_targets.front();
+    Mob* tgt = info.registry.get<Mob>(m_targets.front());
+    if (tgt == nullptr) {
+      return false;
+    }
 
     float dx = tgt->getPos().x() - getPos().x();
     float dy = tgt->getPos().y() - getPos().y();
@@ -481,15 +647,13 @@ namespace tdef {
     // best as we can for this frame. In order to
     // shot at it we need to determine whether it
     // lies within the firing cone.
-    // Note that there isn't any upgrade for the
-    // shooting angle so we'll call the upgradable
-    // directly.
-    return std::abs(m_orientation - theta) <= m_shooting.shootAngle(0, m_exp.level);
+    return std::abs(m_orientation - theta) <= m_stats.shootAngle;
   }
 
+  template <typename Traits>
   bool
   Tower::attack(StepInfo& info,
-                MobShPtr mob)
+                Mob& mob)
   {
     // We have to distinguish between two main cases:
     //   - the tower has an infinite projectile speed.
@@ -499,68 +663,61 @@ namespace tdef {
     // overload the simulation with useless objects.
 
     // Case of an infinite projectile speed.
-    if (hasInfiniteProjectileSpeed(getProjectileSpeed())) {
+    if constexpr (Traits::hitscan) {
       // Convert to get the current damage values for
       // the tower given its level.
       towers::Damage dd;
-      dd.damage = getAttack();
-      // No related upgrade for accuracy.
-      dd.accuracy = getAccuracy();
-      dd.speed = queryUpgradable(m_attack.speed, towers::Upgrade::FreezingPower);
-      dd.slowdown = queryUpgradable(m_attack.slowdown, towers::Upgrade::FreezingSpeed);
-      dd.stunProb = queryUpgradable(m_attack.stunProb, towers::Upgrade::StunChance);
-      // No upgrade type for crit hits.
-      dd.critProb = m_attack.critProb(0, m_exp.level);
-      dd.critMultiplier = m_attack.critMultiplier(0, m_exp.level);
-
-      // Convert durations from raw milliseconds to a
-      // usable time data.
-      int ms = static_cast<int>(std::round(getFreezingDuration()));
-      dd.fDuration = utils::toMilliseconds(ms);
-      ms = static_cast<int>(std::round(getStunDuration()));
-      dd.sDuration = utils::toMilliseconds(ms);
-      ms = static_cast<int>(std::round(getPoisonDuration()));
-      dd.pDuration = utils::toMilliseconds(ms);
-
-      return m_processes.damage(info, mob, dd);
+      dd.damage = m_stats.damage;
+      dd.accuracy = m_stats.accuracy;
+      dd.speed = m_stats.speed;
+      dd.slowdown = m_stats.slowdown;
+      dd.stunProb = m_stats.stunProb;
+      dd.critProb = m_stats.critProb;
+      dd.critMultiplier = m_stats.critMultiplier;
+
+      dd.fDuration = m_stats.freeze;
+      dd.sDuration = m_stats.stun;
+      dd.pDuration = m_stats.poison;
+
+      return towers::basicDamaging(info, mob, dd);
     }
+    else {
+      // Otherwise we need to create a projectile.
+      Projectile::PProps pp = Projectile::newProps(getPos(), getOwner());
+      pp.speed = m_stats.projectileSpeed;
 
-    // Otherwise we need to create a projectile.
-    Projectile::PProps pp = Projectile::newProps(getPos(), getOwner());
-    pp.speed = queryUpgradable(m_shooting.projectileSpeed, towers::Upgrade::ProjectileSpeed);
-
-    pp.damage = getAttack();
-    pp.aoeRadius = m_aoeRadius(0, m_exp.level);
-
-    pp.accuracy = getAccuracy();
-
-    pp.freezePercent = queryUpgradable(m_attack.speed, towers::Upgrade::FreezingPower);
-    pp.freezeSpeed = queryUpgradable(m_attack.slowdown, towers::Upgrade::FreezingSpeed);
-
-    pp.stunProb = queryUpgradable(m_attack.stunProb, towers::Upgrade::StunChance);
-
-    int ms = static_cast<int>(std::round(getFreezingDuration()));
-    pp.freezeDuration = utils::toMilliseconds(ms);
-    ms = static_cast<int>(std::round(getStunDuration()));
-    pp.stunDuration = utils::toMilliseconds(ms);
-    ms = static_cast<int>(std::round(getPoisonDuration()));
-    pp.poisonDuration = utils::toMilliseconds(ms);
-
-    info.spawnProjectile(std::make_shared<Projectile>(pp, this, mob));
-
-    // Consider that the projectile won't kill
-    // the mob. This is probably false because
-    // it means that a tower would fire more
-    // projectiles that needed (as the mob's
-    // health does not reflect the health and
-    // the damage from flying projectiles) but
-    // handling this would require the mob to
-    // somehow provide a method to get the
-    // health where all projectiles directed
-    // towards a mob and all the ones that are
-    // exploding within the aoe. Quite hard
-    // to do right now.
-    return true;
+      pp.damage = m_stats.damage;
+      if constexpr (Traits::areaOfEffect) {
+        pp.aoeRadius = m_stats.aoeRadius;
+      }
+
+      pp.accuracy = m_stats.accuracy;
+
+      pp.freezePercent = m_stats.speed;
+      pp.freezeSpeed = m_stats.slowdown;
+
+      pp.stunProb = m_stats.stunProb;
+
+      pp.freezeDuration = m_stats.freeze;
+      pp.stunDuration = m_stats.stun;
+      pp.poisonDuration = m_stats.poison;
+
+      info.spawnProjectile().assign(pp, getHandle(), mob.getHandle());
+
+      // Consider that the projectile won't kill
+      // the mob. This is probably false because
+      // it means that a tower would fire more
+      // projectiles that needed (as the mob's
+      // health does not reflect the health and
+      // the damage from flying projectiles) but
+      // handling this would require the mob to
+      // somehow provide a method to get the
+      // health where all projectiles directed
+      // towards a mob and all the ones that are
+      // exploding within the aoe. Quite hard
+      // to do right now.
+      return true;
+    }
   }
 
 }
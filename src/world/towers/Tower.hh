@@ -6,6 +6,7 @@
 # include <maths_utils/Point2.hh>
 # include "Block.hh"
 # include "Mob.hh"
+# include "CellSpan.hh"
 
 namespace tdef {
   namespace towers {
@@ -135,13 +136,6 @@ namespace tdef {
       Targetting mode;
     };
 
-    /**
-     * @brief - Defines a generic function signature that
-     *          can be used by a tower to pick new mobs to
-     *          target.
-     */
-    using TargetPicker = std::function<std::vector<MobShPtr>(StepInfo&, PickData&)>;
-
     /**
      * @brief - Convenience structure defining all props
      *          defining the data performed by a tower.
@@ -195,31 +189,6 @@ namespace tdef {
       utils::Duration pDuration;
     };
 
-    /**
-     * @brief - Defines a generic function signature that
-     *          can be used by a tower to apply damage to
-     *          a mob.
-     *          The return value should indicates whether
-     *          the mob is still alive or has been damaged
-     *          enough that it should be killed.
-     */
-    using DoDamage = std::function<bool(StepInfo&, MobShPtr, Damage&)>;
-
-    /**
-     * @brief - Convenience structure defining the needed
-     *          information to represent the custom info
-     *          for a tower.
-     *          This allows to define various towers that
-     *          can specialize part of their behavior for
-     *          example the way a mob is picked when the
-     *          conditions are met to pick a new target
-     *          or the way a mob is affected by the tower.
-     */
-    struct Processes {
-      TargetPicker pickMob;
-      DoDamage damage;
-    };
-
   }
 
   class Tower: public Block {
@@ -581,6 +550,31 @@ namespace tdef {
       void
       step(StepInfo& info) override;
 
+      /**
+       * @brief - Refill the energy of the tower and acquire and
+       *          align with its targets. The actual shots are
+       *          fired by the `step` method.
+       * @param info - the information about the step.
+       */
+      void
+      prepare(const StepInfo& info) override;
+
+      /**
+       * @brief - Prepare a batch of towers sharing the same type.
+       *          The kernel specialized for the type is selected
+       *          once for the whole batch.
+       * @param type - the type of all the towers of the batch.
+       * @param batch - the towers to prepare.
+       * @param count - the number of towers in the batch.
+       * @param info - the information about the step.
+       */
+      static
+      void
+      prepareBatch(const towers::Type& type,
+                   Tower* const* batch,
+                   unsigned count,
+                   const StepInfo& info);
+
       void
       pause(const utils::TimeStamp& t) override;
 
@@ -658,28 +652,6 @@ namespace tdef {
       DamageData
       fromProps(const TProps& props) noexcept;
 
-      /**
-       * @brief - Convenience method to allow grouping the projectile
-       *          speed determination in a single method.
-       * @param speed - the projectile speed to analyze.
-       * @return - `true` if the input speed describes a projectile
-       *           with infinite speed.
-       */
-      static
-      bool
-      hasInfiniteProjectileSpeed(float speed) noexcept;
-
-      /**
-       * @brief - Convenience method to allow the determination of an
-       *          infinite aiming speed for a tower in a single func.
-       * @param speed - the aiming speed to analyze.
-       * @return - `true` if the input speed describes a tower with
-       *           infinite aiming speed.
-       */
-      static
-      bool
-      hasInfiniteAimingSpeed(float speed) noexcept;
-
       /**
        * @brief - This method is used to align the tower with the
        *          selected target. In case no target is defined
@@ -689,8 +661,9 @@ namespace tdef {
        *           are in such an orientation that a shot is
        *           possible.
        */
+      template <typename Traits>
       bool
-      pickAndAlignWithTarget(StepInfo& info);
+      pickAndAlignWithTarget(const StepInfo& info);
 
       /**
        * @brief - Convenience method allowing to perform the attack
@@ -705,9 +678,30 @@ namespace tdef {
        * @return - the `return` value indicates whether or not the
        *           mob is still alive after the shot.
        */
+      template <typename Traits>
       bool
       attack(StepInfo& info,
-             MobShPtr mob);
+             Mob& mob);
+
+      /**
+       * @brief - Kernel performing the step of the tower with
+       *          the behaviors of its type known at compile time
+       *          through the `Traits`.
+       * @param info - the information about the step.
+       */
+      template <typename Traits>
+      void
+      stepAs(StepInfo& info);
+
+      /**
+       * @brief - Kernel preparing the step of the tower with
+       *          the behaviors of its type known at compile time
+       *          through the `Traits`.
+       * @param info - the information about the step.
+       */
+      template <typename Traits>
+      void
+      prepareAs(const StepInfo& info);
 
       /**
        * @brief - Used to fetch the upgrade level for the specified
@@ -730,6 +724,16 @@ namespace tdef {
       queryUpgradable(const towers::Upgradable& ug,
                       const towers::Upgrade& type) const noexcept;
 
+      /**
+       * @brief - Used to evaluate the properties of the tower for
+       *          the current upgrade and experience levels. This
+       *          should be called whenever one of them changes so
+       *          that the properties can be read directly during
+       *          the simulation.
+       */
+      void
+      refreshStats() noexcept;
+
     private:
 
       /**
@@ -758,6 +762,28 @@ namespace tdef {
         int level;
       };
 
+      /**
+       * @brief - Convenience structure holding the result of the
+       *          acquisition of targets performed when preparing
+       *          the step and the state of the tower before it.
+       *          This state is used to replay the acquisition in
+       *          case a target has been killed by another tower
+       *          in between.
+       */
+      struct AcquisitionData {
+        // Whether the targets were acquired for this step.
+        bool prepared;
+
+        // Whether the tower is aligned with its targets.
+        bool aligned;
+
+        // The targets, the orientation and the aiming status
+        // of the tower before the acquisition.
+        std::vector<world::Handle> targets;
+        float orientation;
+        bool aiming;
+      };
+
       /**
        * @brief - Defines a convenience structure regrouping the
        *          propertis defining the shooting angle and time
@@ -816,6 +842,46 @@ namespace tdef {
         utils::TimeStamp pauseTime;
       };
 
+      /**
+       * @brief - Defines a convenience structure holding the values
+       *          of the properties of the tower for its current
+       *          upgrade and experience levels. The upgradables are
+       *          only evaluated when a level changes: the rest of
+       *          the time the values are read from here.
+       */
+      struct Stats {
+        float refill;
+        float minRange;
+        float maxRange;
+        float aoeRadius;
+        float rotationSpeed;
+
+        float shootAngle;
+        float projectileSpeed;
+        float aimSpeed;
+
+        float damage;
+        float accuracy;
+        float speed;
+        float slowdown;
+        float stunProb;
+        float critProb;
+        float critMultiplier;
+
+        // The durations of the effects expressed in milliseconds
+        // and converted to durations.
+        float fDuration;
+        float sDuration;
+        float pDuration;
+        utils::Duration freeze;
+        utils::Duration stun;
+        utils::Duration poison;
+
+        // The duration of the aiming process derived from the
+        // aiming speed.
+        utils::Duration aim;
+      };
+
       /**
        * @brief - The type of the tower. This is mostly used
        *          to quickly identify the tower but most of
@@ -910,10 +976,17 @@ namespace tdef {
       DamageData m_attack;
 
       /**
-       * @brief - Defines the custom processes attached to
-       *          this tower.
+       * @brief - The properties of the tower evaluated for its
+       *          current levels.
+       */
+      Stats m_stats;
+
+      /**
+       * @brief - The cells of the spatial indices covered by the
+       *          range of the tower. The tower only looks for new
+       *          targets when mobs lie in these cells.
        */
-      towers::Processes m_processes;
+      std::vector<world::CellSpan> m_coverage;
 
       /**
        * @brief - The targets for this tower. Most of the towers
@@ -923,8 +996,16 @@ namespace tdef {
        *          assigned more we will consider this list as some
        *          priority list where the first element will be
        *          attacked first (and then the others).
+       *          Targets are kept as handles so that they don't
+       *          keep the mobs alive once removed from the world.
+       */
+      std::vector<world::Handle> m_targets;
+
+      /**
+       * @brief - The result of the acquisition of targets for the
+       *          current step.
        */
-      std::vector<MobShPtr> m_targets;
+      AcquisitionData m_acquisition;
   };
 
   using TowerShPtr = std::shared_ptr<Tower>;
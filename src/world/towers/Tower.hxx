@@ -159,19 +159,19 @@ namespace tdef {
   inline
   float
   Tower::getRange() const noexcept {
-    return queryUpgradable(m_maxRange, towers::Upgrade::Range);
+    return m_stats.maxRange;
   }
 
   inline
   float
   Tower::getAttack() const noexcept {
-    return queryUpgradable(m_attack.damage, towers::Upgrade::Damage);
+    return m_stats.damage;
   }
 
   inline
   float
   Tower::getRotationSpeed() const noexcept {
-    return queryUpgradable(m_rotationSpeed, towers::Upgrade::RotationSpeed);
+    return m_stats.rotationSpeed;
   }
 
   inline
@@ -201,7 +201,7 @@ namespace tdef {
   inline
   float
   Tower::getEnergyRefill() const noexcept {
-    return queryUpgradable(m_energyRefill, towers::Upgrade::AttackSpeed);
+    return m_stats.refill;
   }
 
   inline
@@ -222,26 +222,26 @@ namespace tdef {
   inline
   float
   Tower::getAimingSpeed() const noexcept {
-    return queryUpgradable(m_shooting.aimSpeed, towers::Upgrade::AimSpeed);
+    return m_stats.aimSpeed;
   }
 
   inline
   float
   Tower::getAccuracy() const noexcept {
-    return queryUpgradable(m_attack.accuracy, towers::Upgrade::Accuracy);
+    return m_stats.accuracy;
   }
 
   inline
   float
   Tower::getProjectileSpeed() const noexcept {
-    return queryUpgradable(m_shooting.projectileSpeed, towers::Upgrade::ProjectileSpeed);
+    return m_stats.projectileSpeed;
   }
 
   inline
   float
   Tower::getFreezingPower() const noexcept {
     return utils::clamp(
-      100.0f * (1.0f - queryUpgradable(m_attack.speed, towers::Upgrade::FreezingPower)),
+      100.0f * (1.0f - m_stats.speed),
       0.0f,
       100.0f
     );
@@ -251,7 +251,7 @@ namespace tdef {
   float
   Tower::getFreezingSpeed() const noexcept {
     return utils::clamp(
-      100.0f * queryUpgradable(m_attack.slowdown, towers::Upgrade::FreezingSpeed),
+      100.0f * m_stats.slowdown,
       0.0f,
       100.0f
     );
@@ -260,22 +260,20 @@ namespace tdef {
   inline
   float
   Tower::getFreezingDuration() const noexcept {
-    // No upgrade related to freeze duration.
-    return m_attack.fDuration(0, m_exp.level);
+    return m_stats.fDuration;
   }
 
   inline
   float
   Tower::getPoisonDuration() const noexcept {
-    // No upgrade related to poison duration.
-    return m_attack.pDuration(0, m_exp.level);
+    return m_stats.pDuration;
   }
 
   inline
   float
   Tower::getStunChance() const noexcept {
     return utils::clamp(
-      100.0f * queryUpgradable(m_attack.stunProb, towers::Upgrade::StunChance),
+      100.0f * m_stats.stunProb,
       0.0f,
       100.0f
     );
@@ -284,7 +282,7 @@ namespace tdef {
   inline
   float
   Tower::getStunDuration() const noexcept {
-    return queryUpgradable(m_attack.sDuration, towers::Upgrade::StunDuration);
+    return m_stats.sDuration;
   }
 
   inline
@@ -409,18 +407,6 @@ namespace tdef {
     return dd;
   }
 
-  inline
-  bool
-  Tower::hasInfiniteProjectileSpeed(float speed) noexcept {
-    return speed < 0.0f;
-  }
-
-  inline
-  bool
-  Tower::hasInfiniteAimingSpeed(float speed) noexcept {
-    return speed <= 0.0f;
-  }
-
   inline
   int
   Tower::fetchUpgradeLevel(const towers::Upgrade& upgrade) const noexcept {